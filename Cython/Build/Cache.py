@@ -2,8 +2,11 @@ from dataclasses import dataclass
 import sys
 import os
 import hashlib
+import json
 import shutil
 import subprocess
+import tempfile
+import time
 from ..Utils import safe_makedirs, cached_function
 import zipfile
 from .. import __version__
@@ -26,6 +29,11 @@ except ImportError:
 
 zip_ext = ".zip"
 
+try:
+    import fcntl
+except ImportError:
+    fcntl = None
+
 MAX_CACHE_SIZE = 1024 * 1024 * 100
 
 join_path = cached_function(os.path.join)
@@ -86,6 +94,8 @@ class FingerprintFlags:
 
 
 class Cache:
+    supports_compiled = False
+
     def __init__(self, path, cache_size=None):
         if path is None:
             self.path = join_path(get_cython_cache_dir(), "compiler")
@@ -197,3 +207,286 @@ class Cache:
                 total_size -= size
                 if total_size < self.cache_size * ratio:
                     break
+
+
+class ContentAddressedCache(Cache):
+    r"""
+    Cache backend that can safely be shared by many concurrent processes.
+
+    Each fingerprint maps to a small JSON manifest that lists the generated
+    artifacts by the hash of their content.  The artifacts themselves are
+    stored once as compressed blobs, so that identical outputs are
+    deduplicated across modules and option sets.  All files are written
+    to a temporary name first and then renamed into place.
+
+    Instead of scanning the whole cache directory, usage is recorded in an
+    append-only index file that ``cleanup_cache()`` replays to evict the
+    least recently used entries.
+
+    Besides the generated C files, the backend can also store compiled
+    extension modules, keyed by a fingerprint of their C sources and the
+    C compiler configuration (see ``compiled_fingerprint()``).
+    """
+    index_name = "index.log"
+    lock_name = "index.lock"
+    supports_compiled = True
+
+    def __init__(self, path, cache_size=None):
+        if path is None:
+            path = join_path(get_cython_cache_dir(), "cas")
+        super().__init__(path, cache_size)
+        self.manifest_dir = join_path(self.path, "manifests")
+        self.blob_dir = join_path(self.path, "blobs")
+        self.index_path = join_path(self.path, self.index_name)
+
+    def _manifest_path(self, fingerprint):
+        return join_path(self.manifest_dir, fingerprint[:2], fingerprint + ".json")
+
+    def _blob_path(self, blob_hash):
+        return join_path(self.blob_dir, blob_hash[:2], blob_hash + gzip_ext)
+
+    def _write_atomic(self, path, write, mode=None):
+        dirname = os.path.dirname(path)
+        safe_makedirs(dirname)
+        fd, tmp_path = tempfile.mkstemp(dir=dirname, prefix=".tmp-")
+        try:
+            with os.fdopen(fd, "wb") as f:
+                write(f)
+            if mode is not None:
+                # mkstemp() creates the file as private, unlike a normal build.
+                umask = os.umask(0)
+                os.umask(umask)
+                os.chmod(tmp_path, mode & ~umask)
+            os.replace(tmp_path, path)
+        except BaseException:
+            try:
+                os.unlink(tmp_path)
+            except OSError:
+                pass
+            raise
+
+    def _lock_index(self, exclusive):
+        if fcntl is None:
+            return None
+        lock_file = open(join_path(self.path, self.lock_name), "ab")
+        fcntl.flock(lock_file, fcntl.LOCK_EX if exclusive else fcntl.LOCK_SH)
+        return lock_file
+
+    def _append_index(self, *fields):
+        line = ("%s %s\n" % (time.time(), " ".join(fields))).encode("UTF-8")
+        lock_file = self._lock_index(exclusive=False)
+        try:
+            fd = os.open(self.index_path, os.O_WRONLY | os.O_APPEND | os.O_CREAT, 0o644)
+            try:
+                os.write(fd, line)
+            finally:
+                os.close(fd)
+        finally:
+            if lock_file is not None:
+                lock_file.close()
+
+    def _store_blob(self, filename):
+        m = hashlib.sha256()
+        with open(filename, "rb") as f:
+            data = f.read(65000)
+            while data:
+                m.update(data)
+                data = f.read(65000)
+        blob_hash = m.hexdigest()
+        blob_path = self._blob_path(blob_hash)
+        if not os.path.exists(blob_path):
+            def write(out):
+                with open(filename, "rb") as f:
+                    with gzip_open(out, "wb") as g:
+                        shutil.copyfileobj(f, g)
+            self._write_atomic(blob_path, write)
+        return blob_hash, os.path.getsize(blob_path)
+
+    def _store_manifest(self, fingerprint, artifacts):
+        entries = []
+        for artifact in artifacts:
+            blob_hash, size = self._store_blob(artifact)
+            entries.append((os.path.basename(artifact), blob_hash, size))
+        manifest = json.dumps({"version": __version__, "artifacts": entries}).encode("UTF-8")
+        self._write_atomic(self._manifest_path(fingerprint), lambda f: f.write(manifest))
+        self._append_index(
+            "store", fingerprint,
+            *["%s:%d" % (blob_hash, size) for _, blob_hash, size in entries])
+
+    def _lookup_manifest(self, fingerprint):
+        manifest_path = self._manifest_path(fingerprint)
+        try:
+            with open(manifest_path, "rb") as f:
+                manifest = json.loads(f.read().decode("UTF-8"))
+        except (OSError, ValueError):
+            return None
+        # A concurrent cleanup may have evicted blobs that we refer to.
+        for _, blob_hash, _ in manifest["artifacts"]:
+            if not os.path.exists(self._blob_path(blob_hash)):
+                return None
+        return manifest_path
+
+    def _load_manifest(self, fingerprint, cached, target_dir, rename=None, mode=0o666):
+        with open(cached, "rb") as f:
+            manifest = json.loads(f.read().decode("UTF-8"))
+        for name, blob_hash, _ in manifest["artifacts"]:
+            target = join_path(target_dir, rename or name)
+            def write(out):
+                with gzip_open(self._blob_path(blob_hash), "rb") as g:
+                    shutil.copyfileobj(g, out)
+            self._write_atomic(target, write, mode)
+        self._append_index("use", fingerprint)
+
+    def lookup_cache(self, c_file, fingerprint):
+        return self._lookup_manifest(fingerprint)
+
+    def load_from_cache(self, c_file, cached):
+        fingerprint = os.path.splitext(os.path.basename(cached))[0]
+        self._load_manifest(fingerprint, cached, os.path.dirname(c_file) or os.curdir)
+
+    def store_to_cache(self, c_file, fingerprint, compilation_result):
+        self._store_manifest(fingerprint, compilation_result.get_generated_source_files())
+
+    def compiled_fingerprint(self, sources, depends, compiler_config):
+        r"""
+        Return a fingerprint for a compiled extension module.
+
+        It covers the content of the (generated) C sources and declared
+        dependencies, and ``compiler_config``, which should describe the
+        C compiler, its flags and the target platform.  Headers that are
+        not listed as dependencies are not tracked.
+        """
+        try:
+            m = hashlib.sha1(("compiled:" + __version__).encode("UTF-8"))
+            for source in sources:
+                m.update(file_hash(source).encode("UTF-8"))
+            for dep in sorted(depends):
+                if os.path.exists(dep):
+                    m.update(file_hash(dep).encode("UTF-8"))
+            m.update(repr(compiler_config).encode("UTF-8"))
+            return m.hexdigest()
+        except OSError:
+            return None
+
+    def lookup_compiled(self, fingerprint):
+        return self._lookup_manifest(fingerprint)
+
+    def load_compiled(self, cached, ext_path):
+        fingerprint = os.path.splitext(os.path.basename(cached))[0]
+        self._load_manifest(
+            fingerprint, cached, os.path.dirname(ext_path) or os.curdir,
+            rename=os.path.basename(ext_path), mode=0o777)
+
+    def store_compiled(self, fingerprint, ext_path):
+        self._store_manifest(fingerprint, [ext_path])
+
+    def cleanup_cache(self, ratio=0.85):
+        try:
+            with open(self.index_path, "rb") as f:
+                index_size = os.fstat(f.fileno()).st_size
+                if index_size < 1024 * 1024 and self._estimated_size(f) < self.cache_size:
+                    return
+        except OSError:
+            return
+
+        lock_file = self._lock_index(exclusive=True)
+        try:
+            self._compact_index(ratio)
+        finally:
+            if lock_file is not None:
+                lock_file.close()
+
+    def _read_index(self, f):
+        last_used = {}
+        blobs_by_manifest = {}
+        for line in f:
+            fields = line.decode("UTF-8", "replace").split()
+            if len(fields) < 3:
+                continue  # partially written line
+            try:
+                timestamp = float(fields[0])
+            except ValueError:
+                continue
+            kind, fingerprint = fields[1], fields[2]
+            if kind == "store":
+                blobs = []
+                for blob in fields[3:]:
+                    blob_hash, _, size = blob.partition(":")
+                    blobs.append((blob_hash, int(size) if size.isdigit() else 0))
+                blobs_by_manifest[fingerprint] = blobs
+            elif fingerprint not in blobs_by_manifest:
+                continue
+            last_used[fingerprint] = max(timestamp, last_used.get(fingerprint, 0))
+        return last_used, blobs_by_manifest
+
+    def _estimated_size(self, f):
+        _, blobs_by_manifest = self._read_index(f)
+        blob_sizes = {}
+        for blobs in blobs_by_manifest.values():
+            blob_sizes.update(blobs)
+        return sum(blob_sizes.values())
+
+    def _compact_index(self, ratio):
+        try:
+            with open(self.index_path, "rb") as f:
+                last_used, blobs_by_manifest = self._read_index(f)
+        except OSError:
+            return
+
+        blob_refs = {}
+        blob_sizes = {}
+        for blobs in blobs_by_manifest.values():
+            for blob_hash, size in blobs:
+                blob_refs[blob_hash] = blob_refs.get(blob_hash, 0) + 1
+                blob_sizes[blob_hash] = size
+        total_size = sum(blob_sizes.values())
+
+        if total_size > self.cache_size:
+            for fingerprint in sorted(last_used, key=last_used.get):
+                try:
+                    os.unlink(self._manifest_path(fingerprint))
+                except OSError:
+                    pass
+                for blob_hash, size in blobs_by_manifest.pop(fingerprint):
+                    blob_refs[blob_hash] -= 1
+                    if blob_refs[blob_hash] == 0:
+                        try:
+                            os.unlink(self._blob_path(blob_hash))
+                        except OSError:
+                            pass
+                        total_size -= size
+                del last_used[fingerprint]
+                if total_size < self.cache_size * ratio:
+                    break
+
+        lines = []
+        for fingerprint in sorted(last_used, key=last_used.get):
+            lines.append("%s store %s %s\n" % (
+                last_used[fingerprint], fingerprint,
+                " ".join("%s:%d" % blob for blob in blobs_by_manifest[fingerprint])))
+        self._write_atomic(self.index_path, lambda f: f.write("".join(lines).encode("UTF-8")))
+
+
+cache_backends = {
+    "files": Cache,
+    "content": ContentAddressedCache,
+}
+
+
+def get_cache(path, cache_size=None, backend=None):
+    r"""
+    Create the cache object for the ``cache`` option of ``cythonize()``.
+
+    ``backend`` can be a name from ``cache_backends`` or a ``Cache``
+    subclass.  It defaults to the ``CYTHON_CACHE_BACKEND`` environment
+    variable and otherwise to the single-directory "files" backend.
+    """
+    if backend is None:
+        backend = os.environ.get("CYTHON_CACHE_BACKEND") or "files"
+    if isinstance(backend, str):
+        try:
+            backend = cache_backends[backend]
+        except KeyError:
+            raise ValueError("Unknown cache backend '%s', expected one of: %s" % (
+                backend, ", ".join(sorted(cache_backends))))
+    return backend(path, cache_size)
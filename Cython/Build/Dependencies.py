@@ -6,7 +6,8 @@ import re, sys, time
 from glob import iglob
 from io import StringIO
 from os.path import relpath as _relpath
-from .Cache import Cache, FingerprintFlags
+from .Cache import get_cache, FingerprintFlags
+from .Scheduler import CompileHistory, CompileJob, run_jobs
 
 from collections.abc import Iterable
 
@@ -866,7 +867,10 @@ def cythonize(module_list, exclude=None, nthreads=0, aliases=None, quiet=False,
                     module names explicitly by passing them into the ``exclude`` option.
 
     :param nthreads: The number of concurrent builds for parallel compilation
-                     (requires the ``multiprocessing`` module).
+                     (requires the ``multiprocessing`` module).  Among the modules that
+                     need recompiling for the same reason, the most expensive ones are
+                     compiled first, based on the compile times of earlier runs that are
+                     stored in the ``cache`` directory (if enabled).
 
     :param aliases: If you want to use compiler directives like ``# distutils: ...`` but
                     can only know at compile time (when running the ``setup.py``) which values
@@ -926,6 +930,11 @@ def cythonize(module_list, exclude=None, nthreads=0, aliases=None, quiet=False,
     :param cache: If ``True`` the cache enabled with default path. If the value is a path to a directory,
                   then the directory is used to cache generated ``.c``/``.cpp`` files. By default cache is disabled.
                   See :ref:`cython-cache`.
+    :param cache_backend: The storage layout of the cache, either ``"files"`` (the default) or
+                          ``"content"`` for a content-addressed store that can be shared between
+                          concurrent builds.  See :ref:`cython-cache`.
+    :param pxd_cache: A directory in which analysed ``.pxd`` files are stored for reuse by all
+                      compiler processes, instead of parsing them again for each module.
     """
     if exclude is None:
         exclude = []
@@ -968,7 +977,7 @@ def cythonize(module_list, exclude=None, nthreads=0, aliases=None, quiet=False,
         # * options.cache is True (the default path to the cache base dir is used)
         # * options.cache is the explicit path to the cache base dir
         cache_path = None if options.cache is True else options.cache
-        cache = Cache(cache_path, getattr(options, 'cache_size', None))
+        cache = get_cache(cache_path, getattr(options, 'cache_size', None), options.cache_backend)
     else:
         cache = None
 
@@ -1074,39 +1083,39 @@ def cythonize(module_list, exclude=None, nthreads=0, aliases=None, quiet=False,
         m.sources = new_sources
 
     to_compile.sort()
-    # Drop "priority" component of "to_compile" entries and add a
-    # simple progress indicator.
-    N = len(to_compile)
-    progress_fmt = "[{0:%d}/{1}] " % len(str(N))
-    for i in range(N):
-        progress = progress_fmt.format(i+1, N)
-        to_compile[i] = to_compile[i][1:] + (progress,)
-
-    if N <= 1:
+    if len(to_compile) <= 1:
         nthreads = 0
-    if nthreads:
-        import multiprocessing
-        pool = multiprocessing.Pool(
-            nthreads, initializer=_init_multiprocessing_helper)
-        # This is a bit more involved than it should be, because KeyboardInterrupts
-        # break the multiprocessing workers when using a normal pool.map().
-        # See, for example:
-        # https://noswap.com/blog/python-multiprocessing-keyboardinterrupt
-        try:
-            result = pool.map_async(cythonize_one_helper, to_compile, chunksize=1)
-            pool.close()
-            while not result.ready():
-                try:
-                    result.get(99999)  # seconds
-                except multiprocessing.TimeoutError:
-                    pass
-        except KeyboardInterrupt:
-            pool.terminate()
-            raise
-        pool.join()
-    else:
-        for args in to_compile:
-            cythonize_one(*args)
+
+    # Parallel builds order the modules of the same priority by their expected
+    # cost, based on the compile times of earlier runs that are stored in the
+    # cache directory (if any).
+    history = CompileHistory(join_path(cache.path, "timings.json") if cache else None)
+    sizes = {}
+    for priority, source, c_file, *_ in to_compile:
+        sizes[c_file] = sum(
+            os.path.getsize(path) for path in [source] + list(deps.all_dependencies(source))
+            if os.path.isfile(path))
+    costs = history.estimate_costs(sizes)
+
+    # Modules that cimport the .pxd file of another module in this build
+    # benefit from waiting for it when analysed .pxd files are shared.
+    producers = {}
+    if c_options.pxd_cache:
+        for priority, source, c_file, *_ in to_compile:
+            producers[os.path.abspath(os.path.splitext(source)[0] + '.pxd')] = c_file
+    jobs = []
+    for priority, *args in to_compile:
+        source, c_file = args[:2]
+        requires = [
+            producers[path] for path in map(os.path.abspath, deps.all_dependencies(source))
+            if path in producers]
+        # Drop "priority" component of "to_compile" entries.
+        jobs.append(CompileJob(c_file, tuple(args), costs[c_file], requires, priority))
+
+    run_jobs(
+        jobs, cythonize_one_helper if nthreads else cythonize_one_timed, nthreads,
+        initializer=_init_multiprocessing_helper, history=history)
+    history.save()
 
     if exclude_failures:
         failed_modules = set()
@@ -1260,10 +1269,16 @@ def cythonize_one(pyx_file, c_file, fingerprint, cache, quiet, options=None,
         cache.store_to_cache(c_file, fingerprint, result)
 
 
+def cythonize_one_timed(m):
+    t = time.time()
+    cythonize_one(*m)
+    return time.time() - t
+
+
 def cythonize_one_helper(m):
     import traceback
     try:
-        return cythonize_one(*m)
+        return cythonize_one_timed(m)
     except Exception:
         traceback.print_exc()
         raise
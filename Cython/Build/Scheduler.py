@@ -0,0 +1,198 @@
+"""
+Scheduling of parallel cythonize() runs.
+
+Modules of the same priority are compiled in the order of their expected
+compile time, most expensive first, so that a single large module does not
+end up alone at the end of the build.  Idle workers take the next job from
+a shared queue as soon as they become free, and a module that waits for the
+.pxd file of another module in the same build becomes available as soon as
+that module is done.
+"""
+
+import heapq
+import json
+import os
+import queue
+import tempfile
+import time
+
+
+class CompileHistory:
+    """
+    Wall clock compile times of earlier builds, stored as a JSON file.
+    Without a path, the history only lives in memory.
+    """
+    def __init__(self, path=None):
+        self.path = path
+        self.timings = {}
+        if path is not None:
+            try:
+                with open(path, encoding="utf8") as f:
+                    timings = json.load(f)
+            except (OSError, ValueError):
+                timings = {}
+            if isinstance(timings, dict):
+                self.timings = {
+                    key: value for key, value in timings.items()
+                    if isinstance(value, (int, float))
+                }
+        self.changed = False
+
+    def record(self, key, seconds):
+        self.timings[key] = seconds
+        self.changed = True
+
+    def estimate_costs(self, sizes):
+        """
+        Map each key in 'sizes' (e.g. the total size of the source files of a
+        module) to its expected compile time.  Unknown modules are estimated
+        from their size, scaled by the time per byte of the known modules.
+        """
+        known = [(self.timings[key], size) for key, size in sizes.items() if key in self.timings]
+        known_size = sum(size for _, size in known)
+        seconds_per_byte = sum(seconds for seconds, _ in known) / known_size if known_size else 1e-6
+        return {
+            key: self.timings[key] if key in self.timings else size * seconds_per_byte
+            for key, size in sizes.items()
+        }
+
+    def save(self):
+        if self.path is None or not self.changed:
+            return
+        try:
+            fd, tmp_path = tempfile.mkstemp(dir=os.path.dirname(self.path) or ".", prefix=".tmp-")
+            with os.fdopen(fd, "w", encoding="utf8") as f:
+                json.dump(self.timings, f, indent=0, sort_keys=True)
+            os.replace(tmp_path, self.path)
+        except OSError:
+            # The history only serves to improve the scheduling.
+            pass
+        self.changed = False
+
+
+class CompileJob:
+    def __init__(self, key, args, cost=0.0, requires=(), priority=0):
+        self.key = key
+        self.args = args
+        self.cost = cost
+        self.priority = priority
+        self.requires = set(requires)
+        self.dependents = []
+
+
+class JobQueue:
+    """
+    Ready jobs ordered by priority and then by decreasing cost, and jobs that
+    wait for others.
+    """
+    def __init__(self, jobs):
+        self.ready = []
+        self.blocked = {}
+        self.running = 0
+        self._counter = 0
+        jobs_by_key = {job.key: job for job in jobs}
+        for job in jobs:
+            job.requires = {key for key in job.requires if key in jobs_by_key and key != job.key}
+            for key in job.requires:
+                jobs_by_key[key].dependents.append(job)
+            if job.requires:
+                self.blocked[job.key] = job
+            else:
+                self._push(job)
+
+    def _push(self, job):
+        # The counter keeps jobs with equal costs in their original order.
+        heapq.heappush(self.ready, (job.priority, -job.cost, self._counter, job))
+        self._counter += 1
+
+    def __bool__(self):
+        return bool(self.ready or self.blocked or self.running)
+
+    def pop(self):
+        """
+        Return the first ready job, or None if all remaining jobs wait for
+        running ones.
+        """
+        if not self.ready and self.blocked and not self.running:
+            # Only cyclic dependencies remain, so we start the first blocked job.
+            job = min(self.blocked.values(), key=lambda job: (job.priority, -job.cost))
+            del self.blocked[job.key]
+            job.requires.clear()
+            self._push(job)
+        if not self.ready:
+            return None
+        job = heapq.heappop(self.ready)[-1]
+        self.running += 1
+        return job
+
+    def done(self, job):
+        self.running -= 1
+        for dependent in job.dependents:
+            dependent.requires.discard(job.key)
+            if not dependent.requires and self.blocked.pop(dependent.key, None) is not None:
+                self._push(dependent)
+
+
+def run_jobs(jobs, run, nthreads=0, initializer=None, progress=True, history=None):
+    """
+    Call 'run(args)' for all jobs, with 'nthreads' worker processes.
+    Without worker processes, the jobs run in the given order.
+    'run' returns the elapsed time of a successful run, which is recorded
+    in the history.  If 'progress' is true, a progress indicator is appended
+    to the arguments of each job when it starts.
+    """
+    progress_fmt = "[{0:%d}/{1}] " % len(str(len(jobs)))
+    started = [0]
+
+    def next_args(job):
+        started[0] += 1
+        if progress:
+            return job.args + (progress_fmt.format(started[0], len(jobs)),)
+        return job.args
+
+    def finish(job, elapsed):
+        if history is not None and elapsed is not None:
+            history.record(job.key, elapsed)
+        job_queue.done(job)
+
+    if not nthreads:
+        for job in jobs:
+            elapsed = run(next_args(job))
+            if history is not None and elapsed is not None:
+                history.record(job.key, elapsed)
+        return
+
+    job_queue = JobQueue(jobs)
+    import multiprocessing
+    pool = multiprocessing.Pool(nthreads, initializer=initializer)
+    results = queue.Queue()
+    error = None
+    try:
+        while job_queue:
+            while error is None and job_queue.running < nthreads:
+                job = job_queue.pop()
+                if job is None:
+                    break
+                pool.apply_async(
+                    run, (next_args(job),),
+                    callback=lambda elapsed, job=job: results.put((job, elapsed, None)),
+                    error_callback=lambda exc, job=job: results.put((job, None, exc)))
+            if not job_queue.running:
+                break
+            while True:
+                # Wait with a timeout to stay responsive to KeyboardInterrupt.
+                try:
+                    job, elapsed, exc = results.get(timeout=1)
+                    break
+                except queue.Empty:
+                    pass
+            if exc is not None and error is None:
+                error = exc
+            finish(job, elapsed)
+    except KeyboardInterrupt:
+        pool.terminate()
+        raise
+    pool.close()
+    pool.join()
+    if error is not None:
+        raise error
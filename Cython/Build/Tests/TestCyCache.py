@@ -117,3 +117,151 @@ class TestCyCache(CythonTest):
         os.unlink(hash_c)
         self.fresh_cythonize(hash_pyx, cache=self.cache_dir, cplus=False, show_version=True)
         self.assertEqual(2, len(self.cache_files('options.c*')))
+
+
+class TestContentAddressedCache(TestCyCache):
+
+    def cache_manifests(self):
+        return glob.glob(os.path.join(self.cache_dir, 'manifests', '*', '*.json'))
+
+    def cache_blobs(self):
+        return glob.glob(os.path.join(self.cache_dir, 'blobs', '*', '*'))
+
+    def fresh_cythonize(self, *args, **kwargs):
+        kwargs.setdefault('cache_backend', 'content')
+        super().fresh_cythonize(*args, **kwargs)
+
+    def cache_files(self, file_glob):
+        # Map the file based layout of the tests in the base class to manifests.
+        return self.cache_manifests()
+
+    def test_cycache_uses_cache(self):
+        a_pyx = os.path.join(self.src_dir, 'a.pyx')
+        a_c = a_pyx[:-4] + '.c'
+        with open(a_pyx, 'w') as f:
+            f.write('pass')
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+        blobs = self.cache_blobs()
+        self.assertEqual(1, len(blobs))
+        with gzip.GzipFile(blobs[0], 'wb') as gzipfile:
+            gzipfile.write(b'fake stuff')
+        os.unlink(a_c)
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+        with open(a_c) as f:
+            a_contents = f.read()
+        self.assertEqual(a_contents, 'fake stuff',
+                         'Unexpected contents: %s...' % a_contents[:100])
+
+    def test_deduplication(self):
+        a_pyx = os.path.join(self.src_dir, 'a.pyx')
+        with open(a_pyx, 'w') as f:
+            f.write('pass')
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+        os.unlink(a_pyx[:-4] + '.c')
+        # Same output, different fingerprint.
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir, generate_pxi=True)
+        self.assertEqual(2, len(self.cache_manifests()))
+        self.assertEqual(1, len(self.cache_blobs()))
+
+    def test_missing_blob_is_a_miss(self):
+        a_pyx = os.path.join(self.src_dir, 'a.pyx')
+        a_c = a_pyx[:-4] + '.c'
+        with open(a_pyx, 'w') as f:
+            f.write('pass')
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+        for blob in self.cache_blobs():
+            os.unlink(blob)
+        os.unlink(a_c)
+        self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+        self.assertTrue(Cython.Utils.file_generated_by_this_cython(a_c))
+        self.assertEqual(1, len(self.cache_blobs()))
+
+    def test_cleanup_evicts_least_recently_used(self):
+        from Cython.Build.Cache import ContentAddressedCache
+        sources = []
+        for name in 'abc':
+            pyx = os.path.join(self.src_dir, name + '.pyx')
+            with open(pyx, 'w') as f:
+                f.write('value = "%s"\n' % name)
+            sources.append(pyx)
+            self.fresh_cythonize(pyx, cache=self.cache_dir)
+        self.assertEqual(3, len(self.cache_manifests()))
+        blob_size = max(os.path.getsize(blob) for blob in self.cache_blobs())
+
+        cache = ContentAddressedCache(self.cache_dir, cache_size=int(blob_size * 2.5))
+        cache.cleanup_cache(ratio=0.5)
+        self.assertEqual(1, len(self.cache_manifests()))
+        self.assertEqual(1, len(self.cache_blobs()))
+
+        # The index was compacted to the remaining entry, which is still loadable.
+        with open(os.path.join(self.cache_dir, 'index.log')) as f:
+            self.assertEqual(1, len(f.readlines()))
+        os.unlink(sources[-1][:-4] + '.c')
+        self.fresh_cythonize(sources[-1], cache=self.cache_dir)
+        with open(sources[-1][:-4] + '.c') as f:
+            self.assertIn('value = "c"', f.read())
+
+    def test_compiled_artifacts(self):
+        from Cython.Build.Cache import ContentAddressedCache
+        cache = ContentAddressedCache(self.cache_dir)
+        source = os.path.join(self.src_dir, 'mod.c')
+        with open(source, 'w') as f:
+            f.write('int x;\n')
+        module = os.path.join(self.src_dir, 'mod.so')
+        with open(module, 'wb') as f:
+            f.write(b'binary')
+
+        fingerprint = cache.compiled_fingerprint([source], [], ('gcc', '-O2'))
+        self.assertNotEqual(fingerprint, cache.compiled_fingerprint([source], [], ('gcc', '-O3')))
+        self.assertIsNone(cache.lookup_compiled(fingerprint))
+        cache.store_compiled(fingerprint, module)
+
+        target = os.path.join(self.src_dir, 'build', 'mod.cpython.so')
+        os.makedirs(os.path.dirname(target))
+        cache.load_compiled(cache.lookup_compiled(fingerprint), target)
+        with open(target, 'rb') as f:
+            self.assertEqual(b'binary', f.read())
+
+    @unittest.skipIf(sys.platform == 'win32', 'no POSIX file modes')
+    def test_restored_file_mode(self):
+        from Cython.Build.Cache import ContentAddressedCache
+        a_pyx = os.path.join(self.src_dir, 'a.pyx')
+        a_c = a_pyx[:-4] + '.c'
+        with open(a_pyx, 'w') as f:
+            f.write('pass')
+        umask = os.umask(0o022)
+        try:
+            self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+            built_mode = os.stat(a_c).st_mode & 0o777
+            os.unlink(a_c)
+            self.fresh_cythonize(a_pyx, cache=self.cache_dir)
+            self.assertEqual(0o644, built_mode)
+            self.assertEqual(built_mode, os.stat(a_c).st_mode & 0o777)
+
+            # Extension modules keep their exec bits.
+            cache = ContentAddressedCache(self.cache_dir)
+            module = os.path.join(self.src_dir, 'mod.so')
+            with open(module, 'wb') as f:
+                f.write(b'binary')
+            fingerprint = cache.compiled_fingerprint([a_c], [], ('gcc', '-O2'))
+            cache.store_compiled(fingerprint, module)
+            target = os.path.join(self.src_dir, 'mod.cpython.so')
+            cache.load_compiled(cache.lookup_compiled(fingerprint), target)
+            self.assertEqual(0o755, os.stat(target).st_mode & 0o777)
+        finally:
+            os.umask(umask)
+
+    def test_build_ext_without_compiled_cache(self):
+        try:
+            from Cython.Distutils import build_ext
+        except ImportError:
+            self.skipTest("build_ext needs distutils or setuptools")
+        from unittest import mock
+        built = []
+        cmd = build_ext.__new__(build_ext)
+        with mock.patch.dict(os.environ, {'CYTHON_CACHE_BACKEND': 'files'}), \
+                mock.patch.object(build_ext.__bases__[0], 'build_extension', built.append):
+            # The "files" backend cannot store compiled modules, so the extension is simply built.
+            cmd.build_extension_cached('ext', self.cache_dir)
+        self.assertEqual(['ext'], built)
+        self.assertEqual([], os.listdir(self.cache_dir))
@@ -0,0 +1,110 @@
+import os
+import tempfile
+import unittest
+
+from ..Scheduler import CompileHistory, CompileJob, JobQueue, run_jobs
+
+
+def _return_cost(args):
+    return args[0]
+
+
+def _fail(args):
+    raise ValueError(args[0])
+
+
+class TestJobQueue(unittest.TestCase):
+
+    def drain(self, job_queue):
+        order = []
+        while job_queue:
+            job = job_queue.pop()
+            order.append(job.key)
+            job_queue.done(job)
+        return order
+
+    def test_most_expensive_first(self):
+        jobs = [CompileJob(key, (), cost) for key, cost in [('a', 1), ('b', 5), ('c', 3), ('d', 3)]]
+        self.assertEqual(['b', 'c', 'd', 'a'], self.drain(JobQueue(jobs)))
+
+    def test_priority_first(self):
+        jobs = [CompileJob(key, (), cost, priority=priority)
+                for key, cost, priority in [('a', 1, 0), ('b', 5, 1), ('c', 3, 0), ('d', 9, 2)]]
+        self.assertEqual(['c', 'a', 'b', 'd'], self.drain(JobQueue(jobs)))
+
+    def test_dependencies(self):
+        jobs = [
+            CompileJob('user', (), 10, requires=['base']),
+            CompileJob('base', (), 1),
+            CompileJob('other', (), 5),
+        ]
+        job_queue = JobQueue(jobs)
+        first = job_queue.pop()
+        second = job_queue.pop()
+        self.assertEqual(['other', 'base'], [first.key, second.key])
+        self.assertIsNone(job_queue.pop())  # 'user' waits for 'base'
+        job_queue.done(second)
+        self.assertEqual('user', job_queue.pop().key)
+
+    def test_cycle(self):
+        jobs = [
+            CompileJob('a', (), 1, requires=['b']),
+            CompileJob('b', (), 2, requires=['a']),
+            CompileJob('c', (), 3, requires=['unknown', 'c']),
+        ]
+        self.assertEqual(['c', 'b', 'a'], self.drain(JobQueue(jobs)))
+
+
+class TestCompileHistory(unittest.TestCase):
+
+    def test_estimate_costs(self):
+        history = CompileHistory()
+        history.record('known', 4.0)
+        history.record('other', 1.0)
+        costs = history.estimate_costs({'known': 100, 'unknown': 300})
+        self.assertEqual({'known': 4.0, 'unknown': 12.0}, costs)
+
+    def test_save_and_load(self):
+        with tempfile.TemporaryDirectory() as temp_dir:
+            path = os.path.join(temp_dir, 'timings.json')
+            history = CompileHistory(path)
+            history.record('a', 1.5)
+            history.save()
+            self.assertEqual({'a': 1.5}, CompileHistory(path).timings)
+
+            with open(path, 'w') as f:
+                f.write('{broken')
+            self.assertEqual({}, CompileHistory(path).timings)
+
+
+class TestRunJobs(unittest.TestCase):
+
+    def jobs(self):
+        return [CompileJob(key, (cost,), cost) for key, cost in [('a', 1.0), ('b', 3.0), ('c', 2.0)]]
+
+    def test_serial(self):
+        calls = []
+
+        def run(args):
+            calls.append(args)
+            return args[0]
+
+        history = CompileHistory()
+        jobs = self.jobs()
+        jobs[0].requires = {'c'}  # ignored in serial builds
+        run_jobs(jobs, run, history=history)
+        self.assertEqual([(1.0, '[1/3] '), (3.0, '[2/3] '), (2.0, '[3/3] ')], calls)
+        self.assertEqual({'a': 1.0, 'b': 3.0, 'c': 2.0}, history.timings)
+
+    def test_parallel(self):
+        history = CompileHistory()
+        run_jobs(self.jobs(), _return_cost, nthreads=2, progress=False, history=history)
+        self.assertEqual({'a': 1.0, 'b': 3.0, 'c': 2.0}, history.timings)
+
+    def test_parallel_failure(self):
+        with self.assertRaises(ValueError):
+            run_jobs(self.jobs(), _fail, nthreads=2, progress=False)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -149,6 +149,16 @@ def create_cython_argparser():
                            'deduced from the import path if source file is in '
                            'a package, or equals the filename otherwise.')
     parser.add_argument('-M', '--depfile', action='store_true', help='produce depfiles for the sources')
+    parser.add_argument('--pxd-cache', metavar='DIR', dest='pxd_cache', type=str, action='store',
+                      help='Reuse analysed .pxd files from (and store them in) this directory.')
+    parser.add_argument('--profile-compile', metavar='REPORT', dest='profile_compile', type=str, action='store',
+                      help='Write the time, peak memory usage and visited tree nodes of each compiler phase '
+                           'to this JSON file.')
+    parser.add_argument('--low-memory', dest='low_memory', action='store_true',
+                      help='Keep the finished parts of the generated C code in a temporary file '
+                           'instead of in memory.')
+    parser.add_argument('--server', metavar='SOCKET', dest='compile_server', type=str, action='store',
+                      help='Run a compile server on this Unix domain socket, see cython-client.')
     parser.add_argument('sources', nargs='*', default=[])
 
     # TODO: add help
@@ -231,7 +241,7 @@ def parse_command_line(args):
 
     if options.use_listing_file and len(sources) > 1:
         parser.error("cython: Only one source file allowed when using -o\n")
-    if len(sources) == 0 and not options.show_version:
+    if len(sources) == 0 and not (options.show_version or options.compile_server):
         parser.error("cython: Need at least one source file\n")
     if Options.embed and len(sources) > 1:
         parser.error("cython: Only one source file allowed when using --embed\n")
@@ -40,6 +40,8 @@ cdef class FunctionState:
     cdef public object current_except
     cdef public bint in_try_finally
     cdef public bint can_trace
+    cdef public dict traced_lines
+    cdef public object trace_states_code
     cdef public bint gil_owned
 
     cdef public list temps_allocated
@@ -79,8 +81,10 @@ cdef class StringConst:
     cdef public object cname
     cdef public object text
     cdef public object escaped_value
+    cdef public bytes byte_string
     cdef public dict py_strings
     cdef public list py_versions
+    cdef public bint c_used
 
     cpdef get_py_string_const(self, encoding, identifier=*, bint is_str=*, py3str_cstring=*)
 
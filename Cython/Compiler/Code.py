@@ -16,6 +16,7 @@ import os
 import re
 import shutil
 import textwrap
+import zlib
 from string import Template
 from functools import partial
 from contextlib import closing, contextmanager
@@ -861,6 +862,8 @@ class FunctionState:
     # in_try_finally   boolean         inside try of try...finally
     # exc_vars         (string * 3)    exception variables for reraise, or None
     # can_trace        boolean         line tracing is supported in the current context
+    # traced_lines     {int: int}      source line -> index of its monitoring state
+    # trace_states_code CCodeWriter    insertion point for the monitoring states, or None
     # scope            Scope           the scope object of the current function
 
     # Not used for now, perhaps later
@@ -882,6 +885,8 @@ class FunctionState:
         self.exc_vars = None
         self.current_except = None
         self.can_trace = False
+        self.traced_lines = {}
+        self.trace_states_code = None
         self.gil_owned = True
 
         self.temps_allocated = []  # of (name, type, manage_ref, static)
@@ -1157,14 +1162,18 @@ class StringConst:
     """
     # cname            string
     # text             EncodedString or BytesLiteral
+    # byte_string      bytes
     # py_strings       {(identifier, encoding) : PyStringConst}
+    # c_used           boolean    Used as C string, not only to create Python strings
 
     def __init__(self, cname, text, byte_string):
         self.cname = cname
         self.text = text
+        self.byte_string = byte_string
         self.escaped_value = StringEncoding.escape_byte_string(byte_string)
         self.py_strings = None
         self.py_versions = []
+        self.c_used = False
 
     def add_py_version(self, version):
         if not version:
@@ -1278,6 +1287,11 @@ class GlobalState:
 
     directives = {}
 
+    # String constants are packed into C string literals of at most this size
+    # (MSVC rejects literals longer than 64KB), and compressed from this total size.
+    max_string_data_chunk_size = 30000
+    min_compressed_strings_size = 1024
+
     code_layout = [
         'h_code',
         'filename_table',
@@ -1514,7 +1528,7 @@ class GlobalState:
         # aren't just Python objects
         return c
 
-    def get_string_const(self, text, py_version=None):
+    def get_string_const(self, text, py_version=None, c_used=True):
         # return a C string constant, creating a new one if necessary
         if text.is_unicode:
             byte_string = text.utf8encode()
@@ -1525,6 +1539,8 @@ class GlobalState:
         except KeyError:
             c = self.new_string_const(text, byte_string)
         c.add_py_version(py_version)
+        if c_used:
+            c.c_used = True
         return c
 
     def get_pyunicode_ptr_const(self, text):
@@ -1542,10 +1558,10 @@ class GlobalState:
         py3str_cstring = None
         if is_str and unicode_value is not None \
                and unicode_value.utf8encode() != text.byteencode():
-            py3str_cstring = self.get_string_const(unicode_value, py_version=3)
-            c_string = self.get_string_const(text, py_version=2)
+            py3str_cstring = self.get_string_const(unicode_value, py_version=3, c_used=False)
+            c_string = self.get_string_const(text, py_version=2, c_used=False)
         else:
-            c_string = self.get_string_const(text)
+            c_string = self.get_string_const(text, c_used=False)
         py_string = c_string.get_py_string_const(
             text.encoding, identifier, is_str, py3str_cstring)
         return py_string
@@ -1738,7 +1754,6 @@ class GlobalState:
         c_consts = [(len(c.cname), c.cname, c) for c in self.string_const_index.values()]
         c_consts.sort()
         py_strings = []
-        longest_pystring = 0
         encodings = set()
 
         def normalise_encoding_name(py_string):
@@ -1750,24 +1765,21 @@ class GlobalState:
 
         decls_writer = self.parts['string_decls']
         for _, cname, c in c_consts:
-            conditional = False
-            if c.py_versions and (2 not in c.py_versions or 3 not in c.py_versions):
-                conditional = True
-                decls_writer.putln("#if PY_MAJOR_VERSION %s 3" % (
-                    (2 in c.py_versions) and '<' or '>='))
-            decls_writer.putln('static const char %s[] = "%s";' % (
-                cname, StringEncoding.split_string_literal(c.escaped_value)),
-                safe=True)  # Braces in user strings are not for indentation.
-            if conditional:
-                decls_writer.putln("#endif")
+            if c.c_used:
+                conditional = False
+                if c.py_versions and (2 not in c.py_versions or 3 not in c.py_versions):
+                    conditional = True
+                    decls_writer.putln("#if PY_MAJOR_VERSION %s 3" % (
+                        (2 in c.py_versions) and '<' or '>='))
+                decls_writer.putln('static const char %s[] = "%s";' % (
+                    cname, StringEncoding.split_string_literal(c.escaped_value)),
+                    safe=True)  # Braces in user strings are not for indentation.
+                if conditional:
+                    decls_writer.putln("#endif")
             if c.py_strings is not None:
-                if len(c.escaped_value) > longest_pystring:
-                    # This is not an accurate count since it adds up C escape characters,
-                    # but it's probably good enough for an upper bound.
-                    longest_pystring = len(c.escaped_value)
                 for py_string in c.py_strings.values():
                     encodings.add(normalise_encoding_name(py_string))
-                    py_strings.append((c.cname, len(py_string.cname), py_string))
+                    py_strings.append((c.cname, len(py_string.cname), py_string, c.byte_string))
 
         for c, cname in sorted(self.pyunicode_ptr_const_index.items()):
             utf16_array, utf32_array = StringEncoding.encode_pyunicode_string(c)
@@ -1785,13 +1797,19 @@ class GlobalState:
 
         py_strings.sort()
 
+        # TODO: 'py_string.py3str_cstring' can probably be removed
+        py_strings = [
+            (py_string, py_string.py3str_cstring.byte_string if py_string.py3str_cstring else byte_string)
+            for _, _, py_string, byte_string in py_strings
+        ]
+        longest_pystring = max(len(byte_string) for _, byte_string in py_strings)
+
         w = self.parts['pystring_table']
         w.putln("")
 
         # We use only type size macros from "pyport.h" here.
         w.put(textwrap.dedent("""\
         typedef struct {
-            const char *s;
         #if %(max_length)d <= 65535
             const unsigned short n;
         #elif %(max_length)d / 2 < INT_MAX
@@ -1832,11 +1850,11 @@ class GlobalState:
             ', '.join(encodings),
         ))
 
+        # The table only holds the length of each string.  Their bytes follow each other
+        # in a few large C string literals, which avoids a relocated pointer per string.
         w.putln("static const __Pyx_StringTabEntry %s[] = {" % Naming.stringtab_cname)
-        for n, (c_cname, _, py_string) in enumerate(py_strings):
-            # TODO: 'py_string.py3str_cstring' can probably be removed
+        for n, (py_string, byte_string) in enumerate(py_strings):
             if py_string.py3str_cstring:
-                c_cname = py_string.py3str_cstring.cname
                 encodings_index = 0
                 is_unicode = 1
                 is_str = 0
@@ -1851,28 +1869,76 @@ class GlobalState:
                 Naming.stringtab_cname,
                 n))
 
-            w.putln("{%s, sizeof(%s), %d, %d, %d, %d}, /* PyObject cname: %s */" % (
-                c_cname,
-                c_cname,
+            w.putln("{%d, %d, %d, %d, %d}, /* PyObject cname: %s */" % (
+                len(byte_string),
                 encodings_index,
                 is_unicode,
                 is_str,
                 py_string.intern,
                 py_string.cname
                 ))
-        w.putln("{0, 0, 0, 0, 0, 0}")
         w.putln("};")
 
         self.use_utility_code(UtilityCode.load_cached("InitStrings", "StringTools.c"))
-
         init_constants = self.parts['init_constants']
-        init_constants.putln(
-            "if (__Pyx_InitStrings(%s, %s->%s, %s) < 0) %s;" % (
-                Naming.stringtab_cname,
-                Naming.modulestateglobal_cname,
-                Naming.stringtab_cname,
-                Naming.stringtab_encodings_cname,
-                init_constants.error_goto(self.module_pos)))
+
+        data = b''.join([byte_string for _, byte_string in py_strings])
+        compressed_data = zlib.compress(data, 9) if len(data) >= self.min_compressed_strings_size else None
+        if compressed_data and len(compressed_data) < len(data) * 3 // 4:
+            self.use_utility_code(UtilityCode.load_cached("InitCompressedStrings", "StringTools.c"))
+            w.putln("#if CYTHON_COMPRESS_STRINGS")
+            w.putln('static const char %s[] = "%s";' % (
+                Naming.stringtab_zlib_data_cname,
+                StringEncoding.split_string_literal(StringEncoding.escape_byte_string(compressed_data))),
+                safe=True)
+            w.putln("#else")
+            init_constants.putln("#if CYTHON_COMPRESS_STRINGS")
+            init_constants.putln(
+                "if (__Pyx_InitCompressedStrings(%s, %d, %s, sizeof(%s) - 1, %s->%s, %s) < 0) %s;" % (
+                    Naming.stringtab_cname,
+                    py_string_count,
+                    Naming.stringtab_zlib_data_cname,
+                    Naming.stringtab_zlib_data_cname,
+                    Naming.modulestateglobal_cname,
+                    Naming.stringtab_cname,
+                    Naming.stringtab_encodings_cname,
+                    init_constants.error_goto(self.module_pos)))
+            init_constants.putln("#else")
+        else:
+            compressed_data = None
+
+        # Split the data to stay well below the maximum string literal length of MSVC.
+        chunks = []
+        first = chunk_size = 0
+        for n, (_, byte_string) in enumerate(py_strings):
+            if chunk_size and chunk_size + len(byte_string) > self.max_string_data_chunk_size:
+                chunks.append((first, n))
+                first, chunk_size = n, 0
+            chunk_size += len(byte_string)
+        chunks.append((first, py_string_count))
+
+        for i, (first, end) in enumerate(chunks):
+            chunk_cname = "%s_%d" % (Naming.stringtab_data_cname, i)
+            chunk_data = b''.join([byte_string for _, byte_string in py_strings[first:end]])
+            w.putln('static const char %s[] = "%s";' % (
+                chunk_cname,
+                StringEncoding.split_string_literal(StringEncoding.escape_byte_string(chunk_data))),
+                safe=True)
+            init_constants.putln(
+                "if (__Pyx_InitStrings(%s + %d, %d, %s, %s->%s + %d, %s) < 0) %s;" % (
+                    Naming.stringtab_cname,
+                    first,
+                    end - first,
+                    chunk_cname,
+                    Naming.modulestateglobal_cname,
+                    Naming.stringtab_cname,
+                    first,
+                    Naming.stringtab_encodings_cname,
+                    init_constants.error_goto(self.module_pos)))
+
+        if compressed_data:
+            w.putln("#endif")
+            init_constants.putln("#endif")
 
     def generate_codeobject_constants(self):
         w = self.parts['init_codeobjects']
@@ -2096,7 +2162,8 @@ class CCodeWriter:
 
     @cython.locals(create_from='CCodeWriter')
     def __init__(self, create_from=None, buffer=None, copy_formatting=False):
-        if buffer is None: buffer = StringIOTree()
+        if buffer is None:
+            buffer = StringIOTree(spill=create_from.buffer.spill if create_from is not None else None)
         self.buffer = buffer
         self.last_pos = None
         self.last_marked_pos = None
@@ -2238,6 +2305,8 @@ class CCodeWriter:
 
     def exit_cfunc_scope(self):
         self.funcstate.validate_exit()
+        if self.funcstate.trace_states_code is not None:
+            self.funcstate.trace_states_code.put_trace_monitoring_states(len(self.funcstate.traced_lines))
         self.funcstate = None
 
     def start_initcfunc(self, signature, scope=None, refnanny=False):
@@ -2323,8 +2392,10 @@ class CCodeWriter:
             self._write_lines("/* %s */\n" % self._build_marker(pos))
         if trace and self.funcstate and self.funcstate.can_trace and self.globalstate.directives['linetrace']:
             self.indent()
-            self._write_lines('__Pyx_TraceLine(%d,%d,%s)\n' % (
-                pos[1], not self.funcstate.gil_owned, self.error_goto(pos)))
+            traced_lines = self.funcstate.traced_lines
+            line_index = traced_lines.setdefault(pos[1], len(traced_lines))
+            self._write_lines('__Pyx_TraceLine(%d,%d,%d,%s)\n' % (
+                pos[1], line_index, not self.funcstate.gil_owned, self.error_goto(pos)))
 
     def _build_marker(self, pos):
         source_desc, line, col = pos
@@ -2713,16 +2784,16 @@ class CCodeWriter:
             variable = '__pyx_gilstate_save'
         self.putln("__Pyx_PyGILState_Release(%s);" % variable)
 
-    def put_acquire_freethreading_lock(self):
+    def put_acquire_freethreading_lock(self, mutex_cname=Naming.parallel_freethreading_mutex):
         self.globalstate.use_utility_code(
             UtilityCode.load_cached("AccessPyMutexForFreeThreading", "ModuleSetupCode.c"))
         self.putln("#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING")
-        self.putln(f"PyMutex_Lock(&{Naming.parallel_freethreading_mutex});")
+        self.putln(f"PyMutex_Lock(&{mutex_cname});")
         self.putln("#endif")
 
-    def put_release_freethreading_lock(self):
+    def put_release_freethreading_lock(self, mutex_cname=Naming.parallel_freethreading_mutex):
         self.putln("#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING")
-        self.putln(f"PyMutex_Unlock(&{Naming.parallel_freethreading_mutex});")
+        self.putln(f"PyMutex_Unlock(&{mutex_cname});")
         self.putln("#endif")
 
     def put_acquire_gil(self, variable=None, unknown_gil_state=True):
@@ -2886,6 +2957,20 @@ class CCodeWriter:
 
     def put_trace_declarations(self):
         self.putln('__Pyx_TraceDeclarations')
+        # written by exit_cfunc_scope(), when all traced lines are known
+        self.funcstate.trace_states_code = self.insertion_point()
+
+    def put_trace_monitoring_states(self, line_count):
+        event_types = ['PY_MONITORING_EVENT_PY_START', 'PY_MONITORING_EVENT_PY_RETURN', 'PY_MONITORING_EVENT_PY_UNWIND']
+        event_types += ['PY_MONITORING_EVENT_LINE'] * line_count
+        self.putln("#if CYTHON_USE_SYS_MONITORING")
+        self.putln("static const uint8_t %s[] = {" % Naming.monitoring_events_cname)
+        for i in range(0, len(event_types), 4):
+            self.putln("  %s," % ", ".join(event_types[i:i+4]))
+        self.putln("};")
+        self.putln("static PyMonitoringState %s[%d];" % (Naming.monitoring_states_cname, len(event_types)))
+        self.putln("static uint64_t %s = 0;" % Naming.monitoring_version_cname)
+        self.putln("#endif")
 
     def put_trace_frame_init(self, codeobj=None):
         if codeobj:
@@ -2901,6 +2986,21 @@ class CCodeWriter:
     def put_trace_return(self, retvalue_cname, nogil=False):
         self.putln("__Pyx_TraceReturn(%s, %d);" % (retvalue_cname, nogil))
 
+    def put_sampling_declarations(self, name, pos):
+        file_path = pos[0].get_filenametable_entry()
+        if os.path.isabs(file_path):
+            file_path = os.path.basename(file_path)  # never include absolute paths
+        self.putln('__Pyx_SamplingDeclarations(%s, %s, %d)' % (
+            StringEncoding.EncodedString(name).as_c_string_literal(),
+            StringEncoding.EncodedString(file_path).as_c_string_literal(),
+            pos[1]))
+
+    def put_sampling_enter(self):
+        self.putln("__Pyx_SamplingEnter();")
+
+    def put_sampling_exit(self):
+        self.putln("__Pyx_SamplingExit();")
+
     def putln_openmp(self, string):
         self.putln("#ifdef _OPENMP")
         self.putln(string)
@@ -3827,9 +3827,12 @@ class ParallelThreadsAvailableNode(AtomicExprNode):
 class ParallelThreadIdNode(AtomicExprNode):  #, Nodes.ParallelNode):
     """
     Implements cython.parallel.threadid()
+
+    parallel_block   ParallelStatNode or None   the outermost enclosing parallel block
     """
 
     type = PyrexTypes.c_int_type
+    parallel_block = None
 
     def analyse_types(self, env):
         self.is_temp = True
@@ -3837,6 +3840,10 @@ class ParallelThreadIdNode(AtomicExprNode):  #, Nodes.ParallelNode):
         return self
 
     def generate_result_code(self, code):
+        if self.parallel_block is not None and self.parallel_block.uses_threadpool:
+            code.putln("%s = __Pyx_ThreadPool_ThreadNum(%s);" % (
+                self.temp_code, Naming.threadpool_thread))
+            return
         code.putln("#ifdef _OPENMP")
         code.putln("%s = omp_get_thread_num();" % self.temp_code)
         code.putln("#else")
@@ -5070,6 +5077,8 @@ class MemoryViewSliceNode(MemoryViewIndexNode):
                 rhs.type.is_pyobject):
             # scalar assignment
             return MemoryCopyScalar(self.pos, self)
+        elif isinstance(rhs, MemoryViewElementwiseNode):
+            return MemoryCopyElementwise(self.pos, self)
         else:
             return MemoryCopySlice(self.pos, self)
 
@@ -5267,6 +5276,164 @@ class MemoryCopyScalar(MemoryCopyNode):
         code.end_block()
 
 
+class MemoryCopyElementwise(MemoryCopyNode):
+    """
+    Assign the result of element-wise arithmetic on slices and scalars to
+    a slice, broadcasting the operands to the shape of dst. Does not support
+    indirect slices.
+
+        memslice1[...] = memslice2 * memslice3 + 1.0
+        memslice1[:] = memslice2 / scalar
+    """
+
+    is_memview_copy_assignment = True
+
+    def _generate_assignment_code(self, rhs, code):
+        from . import MemoryView
+
+        dst = self.dst
+        if not dst.type.assert_direct_dims(dst.pos):
+            return
+        for operand in rhs.slices:
+            if not operand.type.assert_direct_dims(operand.pos):
+                return
+
+        code.begin_block()
+        if dst.result_in_temp() or dst.is_simple():
+            dst_temp = dst.result()
+        else:
+            code.putln("%s __pyx_temp_dst = %s;" % (dst.type.declaration_code(""), dst.result()))
+            dst_temp = "__pyx_temp_dst"
+
+        MemoryView.ElementwiseSliceLoops(
+            dst.type, dst_temp, rhs.slices, rhs.slice_items, rhs.element_expr, code,
+        ).generate_loops(dst.pos)
+        code.end_block()
+
+
+class MemoryViewElementwiseNode(ExprNode):
+    """
+    Element-wise arithmetic on memoryview slices and C scalars, e.g. "a * b + 1.0".
+    The result is never stored in a temporary slice.  Instead, an assignment to
+    a slice (MemoryCopyElementwise) evaluates the operation in a single loop nest.
+
+        operands       [ExprNode]   all slices and scalars, evaluated once before the loop
+        slices         [ExprNode]   the memoryview slices in operands
+        slice_items    [MemoryViewItemNode]   the current item of each slice inside the loop
+        element_expr   ExprNode     the operation on the current items
+    """
+
+    subexprs = ['operands']
+    child_attrs = ['operands', 'element_expr']
+
+    @classmethod
+    def from_binop(cls, binop, env):
+        slices = []
+        slice_items = []
+        items = []
+        operand_lists = []
+        for operand in (binop.operand1, binop.operand2):
+            if isinstance(operand, MemoryViewElementwiseNode):
+                operands = operand.operands
+                slices.extend(operand.slices)
+                slice_items.extend(operand.slice_items)
+                item = operand.element_expr
+            elif operand.type.is_memoryviewslice:
+                if not (operand.type.dtype.is_numeric or operand.type.dtype.is_enum):
+                    binop.type_error()
+                    return binop
+                if not (operand.is_simple() or operand.result_in_temp()):
+                    operand = operand.coerce_to_temp(env)
+                operands = [operand]
+                item = MemoryViewItemNode(operand.pos, type=operand.type.dtype)
+                slices.append(operand)
+                slice_items.append(item)
+            else:
+                # C scalar, evaluated only once
+                operands = []
+                item = operand
+                if not item.is_literal:
+                    item = item.coerce_to_simple(env)
+                    operands.append(item)
+                    item = CloneNode(item)
+            operand_lists.append(operands)
+            items.append(item)
+
+        element_expr = copy.copy(binop)
+        element_expr.operand1, element_expr.operand2 = items
+        element_expr.analyse_operation(env)
+        if element_expr.type.is_error:
+            return element_expr
+        if element_expr.type.is_pyobject:
+            binop.type_error()
+            return binop
+
+        return cls(
+            binop.pos,
+            operands=operand_lists[0] + operand_lists[1],
+            slices=slices,
+            slice_items=slice_items,
+            element_expr=element_expr,
+            type=PyrexTypes.MemoryViewSliceType(
+                element_expr.type, [('direct', 'strided')] * max(s.type.ndim for s in slices)),
+        )
+
+    def analyse_types(self, env):
+        return self
+
+    def coerce_to(self, dst_type, env):
+        if not (self.is_memview_copy_assignment and dst_type.is_memoryviewslice):
+            if not dst_type.is_error:
+                error(self.pos, "Element-wise memoryview arithmetic is only supported when assigning to a slice, "
+                                "e.g. 'out[:] = a + b'")
+            self.type = error_type
+            return self
+        dtype = dst_type.dtype
+        if not (dtype.is_numeric or dtype.is_enum):
+            error(self.pos, "Cannot assign element-wise arithmetic result to slice of type '%s'" % dst_type)
+            self.type = error_type
+            return self
+        self.element_expr = self.element_expr.coerce_to(dtype, env)
+        self.type = dst_type
+        return self
+
+    def nogil_check(self, env):
+        pass
+
+    def calculate_result_code(self):
+        error(self.pos, "Element-wise memoryview arithmetic is only supported when assigning to a slice, "
+                        "e.g. 'out[:] = a + b'")
+        return "<error>"
+
+    def generate_result_code(self, code):
+        pass
+
+
+class MemoryViewItemNode(ExprNode):
+    """
+    The current item of a memoryview slice inside the loop of an element-wise operation.
+    The code generation of the loop sets 'item_code'.
+    """
+
+    subexprs = []
+    item_code = None
+
+    def analyse_types(self, env):
+        return self
+
+    def nogil_check(self, env):
+        pass
+
+    def is_simple(self):
+        return True
+
+    def calculate_result_code(self):
+        return self.item_code
+
+    def generate_result_code(self, code):
+        pass
+
+
 class SliceIndexNode(ExprNode):
     #  2-element slice indexing
     #
@@ -6590,7 +6757,15 @@ class PyMethodCallNode(CallNode):
         code.mark_pos(self.pos)
         self.allocate_temp_result(code)
 
-        self.function.generate_evaluation_code(code)
+        # With a per-site attribute cache, look up the method without creating a bound method object.
+        use_method_cache = (
+            self.unpack and self.function.is_attribute and self.function.is_py_attr and
+            not self.function.is_special_lookup and
+            code.globalstate.directives['optimize.cache_attribute_lookups'])
+        if use_method_cache:
+            self_arg, arg_offset_cname, function = self.generate_cached_method_lookup(code)
+        else:
+            self.function.generate_evaluation_code(code)
         assert self.arg_tuple.mult_factor is None
         args = self.arg_tuple.args
         kwargs_key_value_pairs = None
@@ -6604,8 +6779,10 @@ class PyMethodCallNode(CallNode):
             self.kwdict.generate_evaluation_code(code)
 
         # make sure function is in temp so that we can replace the reference below if it's a method
-        reuse_function_temp = self.function.is_temp
-        if reuse_function_temp:
+        reuse_function_temp = self.function.is_temp and not use_method_cache
+        if use_method_cache:
+            pass
+        elif reuse_function_temp:
             function = self.function.result()
         else:
             function = code.funcstate.allocate_temp(py_object_type, manage_ref=True)
@@ -6614,10 +6791,11 @@ class PyMethodCallNode(CallNode):
             self.function.generate_disposal_code(code)
             self.function.free_temps(code)
 
-        self_arg = code.funcstate.allocate_temp(py_object_type, manage_ref=True)
-        code.putln("%s = NULL;" % self_arg)
-        arg_offset_cname = code.funcstate.allocate_temp(PyrexTypes.c_uint_type, manage_ref=False)
-        code.putln("%s = 0;" % arg_offset_cname)
+        if not use_method_cache:
+            self_arg = code.funcstate.allocate_temp(py_object_type, manage_ref=True)
+            code.putln("%s = NULL;" % self_arg)
+            arg_offset_cname = code.funcstate.allocate_temp(PyrexTypes.c_uint_type, manage_ref=False)
+            code.putln("%s = 0;" % arg_offset_cname)
 
         def attribute_is_likely_method(attr):
             obj = attr.obj
@@ -6751,6 +6929,32 @@ class PyMethodCallNode(CallNode):
             code.funcstate.release_temp(function)
         code.putln("}")
 
+    def generate_cached_method_lookup(self, code):
+        # Evaluate 'obj.attr' as an unbound method and 'obj' if possible,
+        # returning the temps for the self argument, the argument offset and the function.
+        obj = self.function.obj
+        obj.generate_evaluation_code(code)
+        code.globalstate.use_utility_code(
+            UtilityCode.load_cached("PyObjectGetAttrStrCached", "ObjectHandling.c"))
+        function = code.funcstate.allocate_temp(py_object_type, manage_ref=True)
+        self_arg = code.funcstate.allocate_temp(py_object_type, manage_ref=True)
+        arg_offset_cname = code.funcstate.allocate_temp(PyrexTypes.c_uint_type, manage_ref=False)
+        code.putln("%s = NULL;" % self_arg)
+        code.putln("__Pyx_PyObject_GetMethodCached(%s, %s, %s, %s); %s" % (
+            function,
+            arg_offset_cname,
+            obj.py_result(),
+            code.intern_identifier(self.function.attribute),
+            code.error_goto_if_null(function, self.function.pos)))
+        code.put_gotref(function, py_object_type)
+        code.putln("if (%s) {" % arg_offset_cname)
+        code.putln("%s = %s;" % (self_arg, obj.py_result()))
+        code.put_incref(self_arg, py_object_type)
+        code.putln("}")
+        obj.generate_disposal_code(code)
+        obj.free_temps(code)
+        return self_arg, arg_offset_cname, function
+
     @staticmethod
     def can_be_used_for_posargs(positional_args, has_kwargs, kwds_is_dict_node=None):
         """
@@ -7409,12 +7613,14 @@ class AttributeNode(ExprNode):
     #  member               string    C name of struct member
     #  is_called            boolean   Function call is being done on result
     #  entry                Entry     Symbol table entry of attribute
+    #  is_atomic_access     boolean   Use relaxed atomic loads/stores for a scalar C attribute
 
     is_attribute = 1
     subexprs = ['obj']
 
     entry = None
     is_called = 0
+    is_atomic_access = False
     needs_none_check = True
     is_memslice_transpose = False
     is_special_lookup = False
@@ -7845,8 +8051,14 @@ class AttributeNode(ExprNode):
         result = self.calculate_access_code()
         if self.entry and self.entry.is_cpp_optional and not self.is_target:
             result = "(*%s)" % result
+        if self.is_atomic_access and not self.is_target:
+            result = "%s(%s, %s)" % (
+                self.atomic_access_macro("Load"), self.type.empty_declaration_code(), result)
         return result
 
+    def atomic_access_macro(self, operation):
+        return "__Pyx_AtomicScalar%s%s" % (operation, "Float" if self.type.is_float else "")
+
     def calculate_access_code(self):
         # Does the job of calculate_result_code but doesn't dereference cpp_optionals
         # Therefore allowing access to the holder variable
@@ -7884,11 +8096,25 @@ class AttributeNode(ExprNode):
             return "%s%s%s" % (obj_code, self.op, self.member)
 
     def generate_result_code(self, code):
+        if self.is_atomic_access:
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("AtomicScalarAccess", "ModuleSetupCode.c"))
         if self.is_py_attr:
             if self.is_special_lookup:
                 code.globalstate.use_utility_code(
                     UtilityCode.load_cached("PyObjectLookupSpecial", "ObjectHandling.c"))
                 lookup_func_name = '__Pyx_PyObject_LookupSpecial'
+            elif code.globalstate.directives['optimize.cache_attribute_lookups']:
+                code.globalstate.use_utility_code(
+                    UtilityCode.load_cached("PyObjectGetAttrStrCached", "ObjectHandling.c"))
+                code.putln(
+                    '__Pyx_PyObject_GetAttrStrCached(%s, %s, %s); %s' % (
+                        self.result(),
+                        self.obj.py_result(),
+                        code.intern_identifier(self.attribute),
+                        code.error_goto_if_null(self.result(), self.pos)))
+                self.generate_gotref(code)
+                return
             else:
                 code.globalstate.use_utility_code(
                     UtilityCode.load_cached("PyObjectGetAttrStr", "ObjectHandling.c"))
@@ -7980,7 +8206,13 @@ class AttributeNode(ExprNode):
                 MemoryView.put_assign_to_memviewslice(
                         select_code, rhs, rhs.result(), self.type, code)
 
-            if not self.type.is_memoryviewslice:
+            if self.is_atomic_access:
+                code.globalstate.use_utility_code(
+                    UtilityCode.load_cached("AtomicScalarAccess", "ModuleSetupCode.c"))
+                code.putln("%s(%s, %s, %s);" % (
+                    self.atomic_access_macro("Store"), self.type.empty_declaration_code(),
+                    select_code, rhs.result_as(self.ctype())))
+            elif not self.type.is_memoryviewslice:
                 code.putln(
                     "%s = %s;" % (
                         select_code,
@@ -10515,6 +10747,8 @@ class YieldExprNode(ExprNode):
         code.put_xgiveref(Naming.retval_cname, py_object_type)
         profile = code.globalstate.directives['profile']
         linetrace = code.globalstate.directives['linetrace']
+        if code.globalstate.directives['sampling_profile']:
+            code.put_sampling_exit()
         if profile or linetrace:
             code.put_trace_return(Naming.retval_cname,
                                   nogil=not code.funcstate.gil_owned)
@@ -11830,6 +12064,8 @@ class BinopNode(ExprNode):
     def analyse_types(self, env):
         self.operand1 = self.operand1.analyse_types(env)
         self.operand2 = self.operand2.analyse_types(env)
+        if self.is_memview_operation():
+            return MemoryViewElementwiseNode.from_binop(self, env)
         self.analyse_operation(env)
         return self
 
@@ -11859,6 +12095,12 @@ class BinopNode(ExprNode):
     def is_pythran_operation(self, env):
         return self.is_pythran_operation_types(self.operand1.type, self.operand2.type, env)
 
+    def is_memview_operation(self):
+        return self.is_memview_operation_types(self.operand1.type, self.operand2.type)
+
+    def is_memview_operation_types(self, type1, type2):
+        return False
+
     def is_pythran_operation_types(self, type1, type2, env):
         # Support only expr op supported_type, or supported_type op expr
         return has_np_pythran(env) and \
@@ -11895,6 +12137,8 @@ class BinopNode(ExprNode):
     def result_type(self, type1, type2, env):
         if self.is_pythran_operation_types(type1, type2, env):
             return PythranExpr(pythran_binop_type(self.operator, type1, type2))
+        if self.is_memview_operation_types(type1, type2):
+            return self.memview_result_type(type1, type2, env)
         if self.is_py_operation_types(type1, type2):
             if type2.is_string:
                 type2 = Builtin.bytes_type
@@ -11920,6 +12164,19 @@ class BinopNode(ExprNode):
     def infer_builtin_types_operation(self, type1, type2):
         return None
 
+    def memview_result_type(self, type1, type2, env):
+        # Element-wise operation, the result has the dimensions of the widest slice.
+        ndim = max(type1.ndim if type1.is_memoryviewslice else 0,
+                   type2.ndim if type2.is_memoryviewslice else 0)
+        if type1.is_memoryviewslice:
+            type1 = type1.dtype
+        if type2.is_memoryviewslice:
+            type2 = type2.dtype
+        dtype = self.result_type(type1, type2, env)
+        if dtype is None or dtype.is_error or dtype.is_pyobject:
+            return PyrexTypes.error_type
+        return PyrexTypes.MemoryViewSliceType(dtype, [('direct', 'strided')] * ndim)
+
     def nogil_check(self, env):
         if self.is_py_operation():
             self.gil_error()
@@ -12100,6 +12357,12 @@ class NumBinopNode(BinopNode):
         return (type1.is_numeric or type1.is_enum) \
             and (type2.is_numeric or type2.is_enum)
 
+    def is_memview_operation_types(self, type1, type2):
+        # Operations with Python objects keep using the Python protocols of the memoryview object.
+        return ((type1.is_memoryviewslice or type2.is_memoryviewslice) and
+                not (type1.is_pyobject or type2.is_pyobject) and
+                self.operator != '@')
+
     def generate_evaluation_code(self, code):
         if self.overflow_check:
             self.overflow_bit_node = self
@@ -12261,6 +12524,8 @@ class MulNode(NumBinopNode):
     def analyse_types(self, env):
         self.operand1 = self.operand1.analyse_types(env)
         self.operand2 = self.operand2.analyse_types(env)
+        if self.is_memview_operation():
+            return MemoryViewElementwiseNode.from_binop(self, env)
         self.is_sequence_mul = self.calculate_is_sequence_mul()
 
         # TODO: we could also optimise the case of "[...] * 2 * n", i.e. with an existing 'mult_factor'
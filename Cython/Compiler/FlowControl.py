@@ -712,6 +712,7 @@ class ControlFlowAnalysis(CythonTransform):
         self.reductions = set()
 
         self.in_inplace_assignment = False
+        self.minmax_reduction_name = None
         self.env = node.scope
         self.flow = ControlFlow()
         self.stack = []  # a stack of (env, flow) tuples
@@ -838,7 +839,12 @@ class ControlFlowAnalysis(CythonTransform):
         raise InternalError("Unhandled assignment node %s" % type(node))
 
     def visit_SingleAssignmentNode(self, node):
+        if node.reduction_operator:
+            # 'x = min(x, y)' in a prange reads the thread-private copy of 'x',
+            # which starts with the value of 'x' before the loop
+            self.minmax_reduction_name = node.lhs.name
         self._visit(node.rhs)
+        self.minmax_reduction_name = None
         self.mark_assignment(node.lhs, node.rhs)
         return node
 
@@ -888,7 +894,7 @@ class ControlFlowAnalysis(CythonTransform):
         return node
 
     def visit_NameNode(self, node):
-        if self.flow.block:
+        if self.flow.block and node.name != self.minmax_reduction_name:
             entry = node.entry or self.env.lookup(node.name)
             if entry:
                 self.flow.mark_reference(node, entry)
@@ -1071,7 +1077,7 @@ class ControlFlowAnalysis(CythonTransform):
         # Body block
         if isinstance(node, Nodes.ParallelRangeNode):
             # In case of an invalid
-            self._delete_privates(node, exclude=node.target.entry)
+            self._delete_privates(node, exclude=[target.entry for target in node.targets()])
 
         self.flow.nextblock()
         self._visit(node.body)
@@ -1095,9 +1101,9 @@ class ControlFlowAnalysis(CythonTransform):
             self.flow.block = None
         return node
 
-    def _delete_privates(self, node, exclude=None):
+    def _delete_privates(self, node, exclude=()):
         for private_node in node.assigned_nodes:
-            if not exclude or private_node.entry is not exclude:
+            if private_node.entry not in exclude:
                 self.flow.mark_deletion(private_node, private_node.entry)
 
     def visit_ParallelRangeNode(self, node):
@@ -1105,7 +1111,8 @@ class ControlFlowAnalysis(CythonTransform):
 
         # if node.target is None or not a NameNode, an error will have
         # been previously issued
-        if hasattr(node.target, 'entry'):
+        targets = node.targets()
+        if targets and all(target.is_name for target in targets):
             self.reductions = set(reductions)
 
             for private_node in node.assigned_nodes:
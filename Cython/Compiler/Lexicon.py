@@ -11,6 +11,10 @@ char_prefixes = "cC"
 any_string_prefix = raw_prefixes + string_prefixes + char_prefixes
 IDENT = 'IDENT'
 
+# Increase when the format of the stored lexicon tables changes.
+lexicon_tables_version = 1
+lexicon_tables_file = "Lexicon.tables"
+
 
 def make_lexicon():
     from ..Plex import \
@@ -152,6 +156,74 @@ def make_lexicon():
         )
 
 
+def _lexicon_tables_path():
+    import os
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), lexicon_tables_file)
+
+
+def _lexicon_tables_key():
+    # The tables must be rebuilt when the lexicon definition or Plex changes.
+    import hashlib
+    import os
+    from .. import __version__
+    from .. import Plex
+    key = hashlib.sha1(("%s %s" % (lexicon_tables_version, __version__)).encode("UTF-8"))
+    plex_dir = os.path.dirname(os.path.abspath(Plex.__file__))
+    source_files = [os.path.splitext(os.path.abspath(__file__))[0] + ".py"] + [
+        os.path.join(plex_dir, name) for name in ("Regexps.py", "Machines.py", "DFA.py", "Lexicons.py")]
+    for source_file in source_files:
+        try:
+            with open(source_file, "rb") as f:
+                key.update(f.read())
+        except OSError:
+            key.update(os.path.basename(source_file).encode("UTF-8"))
+    return key.hexdigest()
+
+
+def write_lexicon_tables(path=None):
+    """
+    Build the lexicon and store its state tables, so that later compiler
+    runs can load them instead of building the lexicon again.
+    """
+    import marshal
+    import os
+    import tempfile
+    if path is None:
+        path = _lexicon_tables_path()
+    data = marshal.dumps((_lexicon_tables_key(), make_lexicon().get_tables()))
+    fd, tmp_path = tempfile.mkstemp(dir=os.path.dirname(path) or ".", prefix=".tmp-")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            f.write(data)
+        # mkstemp() creates the file as private, but it gets installed for all users.
+        umask = os.umask(0)
+        os.umask(umask)
+        os.chmod(tmp_path, 0o666 & ~umask)
+        os.replace(tmp_path, path)
+    except BaseException:
+        os.unlink(tmp_path)
+        raise
+
+
+def load_lexicon_tables(path=None):
+    """
+    Load the lexicon from the stored state tables, or return None
+    if they are missing or outdated.
+    """
+    import marshal
+    from ..Plex import Lexicon
+    if path is None:
+        path = _lexicon_tables_path()
+    try:
+        with open(path, "rb") as f:
+            key, tables = marshal.load(f)
+        if key != _lexicon_tables_key():
+            return None
+        return Lexicon.from_tables(tables)
+    except (OSError, ValueError, TypeError, EOFError):
+        return None
+
+
 # BEGIN GENERATED CODE
 # Generated with 'cython-generate-lexicon.py' based on:
 # cpython 3.13.0a1+ (heads/master:7bcf184dac, Nov  3 2023, 10:30:09) [GCC 11.4.0]
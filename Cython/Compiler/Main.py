@@ -80,6 +80,7 @@ class Context:
         self.options = options
 
         self.pxds = {}  # full name -> node tree
+        self.pxd_cache = None
         self._interned = {}  # (type(value), value, *key_args) -> interned_value
 
         if language_level is not None:
@@ -130,10 +131,22 @@ class Context:
             pipeline = Pipeline.create_pyx_as_pxd_pipeline(self, result_sink)
             result = Pipeline.run_pipeline(pipeline, source)
         else:
+            pxd_cache = self.get_pxd_cache()
+            if pxd_cache is not None:
+                return pxd_cache.process_pxd(source_desc, scope, module_name)
             pipeline = Pipeline.create_pxd_pipeline(self, scope, module_name)
             result = Pipeline.run_pipeline(pipeline, source_desc)
         return result
 
+    def get_pxd_cache(self):
+        if self.pxd_cache is None:
+            path = getattr(self.options, 'pxd_cache', None)
+            if not path:
+                return None
+            from .PxdCache import PxdCache
+            self.pxd_cache = PxdCache(path, self)
+        return self.pxd_cache
+
     def nonfatal_error(self, exc):
         return Errors.report_error(exc)
 
@@ -526,7 +539,16 @@ def run_pipeline(source, options, full_module_name=None, context=None):
                 "Filename implies a c++ file but Cython is not in c++ mode.",
                 level=1)
 
-    err, enddata = Pipeline.run_pipeline(pipeline, source)
+    profile = None
+    if options.profile_compile:
+        profile = Pipeline.CompileProfile()
+        profile.activate()
+    try:
+        err, enddata = Pipeline.run_pipeline(pipeline, source)
+    finally:
+        if profile is not None:
+            profile.deactivate()
+            profile.write(options.profile_compile)
     context.teardown_errors(err, options, result)
     if err is None and options.depfile:
         from ..Build.Dependencies import create_dependency_tree
@@ -565,6 +587,7 @@ class CompilationResult:
     extension_file   string or None   Result of linking the object file
     num_errors       integer          Number of compilation errors
     compilation_source CompilationSource
+    utility_code_count integer or None Number of utility code blocks in the C file
     """
 
     c_file = None
@@ -575,6 +598,7 @@ class CompilationResult:
     object_file = None
     extension_file = None
     main_source_file = None
+    utility_code_count = None
 
     def get_generated_source_files(self):
         return [
@@ -765,6 +789,15 @@ def main(command_line = 0):
     if options.show_version:
         Utils.print_version()
 
+    if options.compile_server:
+        from .Server import serve
+        try:
+            serve(options.compile_server, options.pxd_cache)
+        except OSError as e:
+            sys.stderr.write(str(e) + '\n')
+            sys.exit(1)
+        return
+
     if options.working_path!="":
         os.chdir(options.working_path)
 
@@ -478,6 +478,179 @@ class StridedSliceIter(SliceIter):
         code.end_block()
 
 
+def _uses_temps(node):
+    return node.is_temp or any(_uses_temps(subexpr) for subexpr in node.subexpr_nodes())
+
+
+class ElementwiseSliceLoops:
+    """
+    Generates a loop nest over the items of a destination slice that assigns
+    an element-wise expression of other slices to them.
+
+    The slices are broadcast to the shape of the destination slice and copied
+    to temporary memory first if they overlap with it.  If the innermost
+    dimension is declared contiguous in all slices, the innermost loop indexes
+    typed pointers to allow C compilers to vectorise it.
+    """
+
+    def __init__(self, dst_type, dst_result, slices, slice_items, element_expr, code):
+        self.dst_type = dst_type
+        self.dst_result = dst_result
+        self.slices = slices
+        self.slice_items = slice_items
+        self.element_expr = element_expr
+        self.code = code
+        self.ndim = dst_type.ndim
+        self.dims = list(range(self.ndim))
+        if dst_type.is_f_contig:
+            # iterate over the first dimension in the innermost loop
+            self.dims.reverse()
+
+    def generate_loops(self, pos):
+        code = self.code
+        code.globalstate.use_utility_code(broadcast_utility)
+        dst = self.dst_result
+        ndim = self.ndim
+        dst_type_decl = self.dst_type.dtype.empty_declaration_code()
+
+        for depth, dim in enumerate(self.dims):
+            code.putln("Py_ssize_t __pyx_temp_extent_%d = %s.shape[%d];" % (depth, dst, dim))
+            code.putln("Py_ssize_t __pyx_temp_idx_%d;" % depth)
+            code.putln("char *__pyx_temp_dst_%d;" % depth)
+        for k, operand in enumerate(self.slices):
+            code.putln("%s __pyx_temp_slice_%d = %s;" % (memviewslice_cname, k, operand.result()))
+            code.putln("Py_ssize_t __pyx_temp_strides_%d[%d];" % (k, ndim))
+            code.putln("void *__pyx_temp_copy_%d = NULL;" % k)
+            for depth in range(ndim):
+                code.putln("char *__pyx_temp_pointer_%d_%d;" % (k, depth))
+
+        outer_error_label = code.new_error_label()
+        cleanup_error_label = code.error_label
+        simd_error_label = None
+
+        for k, operand in enumerate(self.slices):
+            slice_cname = "__pyx_temp_slice_%d" % k
+            code.putln("if (unlikely(__pyx_memoryview_needs_copy(&%s, %d, sizeof(%s), &%s, %d, sizeof(%s)))) {" % (
+                slice_cname, operand.type.ndim, operand.type.dtype.empty_declaration_code(),
+                dst, ndim, dst_type_decl))
+            code.putln("%s __pyx_temp_tmpslice;" % memviewslice_cname)
+            code.putln("__pyx_temp_copy_%d = __pyx_memoryview_copy_data_to_temp(&%s, &__pyx_temp_tmpslice, 'C', %d);" % (
+                k, slice_cname, operand.type.ndim))
+            code.putln(code.error_goto_if_null("__pyx_temp_copy_%d" % k, pos))
+            code.putln("%s = __pyx_temp_tmpslice;" % slice_cname)
+            code.putln("}")
+            code.putln(code.error_goto_if_neg(
+                "__pyx_memoryview_broadcast_strides(&%s, %d, &%s, %d, __pyx_temp_strides_%d)" % (
+                    slice_cname, operand.type.ndim, dst, ndim, k),
+                pos))
+
+        for depth, dim in enumerate(self.dims):
+            if depth == 0:
+                code.putln("__pyx_temp_dst_0 = %s.data;" % dst)
+                for k in range(len(self.slices)):
+                    code.putln("__pyx_temp_pointer_%d_0 = __pyx_temp_slice_%d.data;" % (k, k))
+            else:
+                code.putln("__pyx_temp_dst_%d = __pyx_temp_dst_%d;" % (depth, depth - 1))
+                for k in range(len(self.slices)):
+                    code.putln("__pyx_temp_pointer_%d_%d = __pyx_temp_pointer_%d_%d;" % (k, depth, k, depth - 1))
+            if depth < ndim - 1:
+                self.put_for_loop(depth)
+
+        depth = ndim - 1
+        if self.has_contig_inner_dim():
+            inner_dim = self.dims[depth]
+            code.putln("if (%s) {" % " && ".join([
+                "__pyx_temp_strides_%d[%d] == sizeof(%s)" % (k, inner_dim, operand.type.dtype.empty_declaration_code())
+                for k, operand in enumerate(self.slices)]))
+            code.putln("%s *__pyx_temp_dst_items = (%s *) __pyx_temp_dst_%d;" % (
+                dst_type_decl, dst_type_decl, depth))
+            for k, operand in enumerate(self.slices):
+                type_decl = operand.type.dtype.empty_declaration_code()
+                code.putln("%s *__pyx_temp_items_%d = (%s *) __pyx_temp_pointer_%d_%d;" % (
+                    type_decl, k, type_decl, k, depth))
+
+            simd_pragma = code.insertion_point()
+            code.new_error_label()
+            simd_error_label = code.error_label
+            self.put_for_loop(depth)
+            self.put_assignment(
+                "__pyx_temp_dst_items[__pyx_temp_idx_%d]" % depth,
+                ["__pyx_temp_items_%d[__pyx_temp_idx_%d]" % (k, depth) for k in range(len(self.slices))])
+            code.putln("}")
+            code.error_label = cleanup_error_label
+            if not code.label_used(simd_error_label) and not _uses_temps(self.element_expr):
+                # Safe, the slices do not overlap (or are identical) and there are no other side effects.
+                simd_pragma.putln("#if defined(_OPENMP) && _OPENMP >= 201307")
+                simd_pragma.putln("#pragma omp simd")
+                simd_pragma.putln("#endif")
+            code.putln("} else {")
+            self.put_strided_inner_loop()
+            code.putln("}")
+        else:
+            self.put_strided_inner_loop()
+
+        for depth in range(ndim - 2, -1, -1):
+            self.put_pointer_increments(depth)
+            code.putln("}")
+
+        for k in range(len(self.slices)):
+            code.putln("free(__pyx_temp_copy_%d);" % k)
+
+        error_labels = [label for label in (simd_error_label, cleanup_error_label)
+                        if label is not None and code.label_used(label)]
+        if error_labels:
+            exit_label = code.new_label('elementwise_exit')
+            code.put_goto(exit_label)
+            for label in error_labels:
+                code.put_label(label)
+            for k in range(len(self.slices)):
+                code.putln("free(__pyx_temp_copy_%d);" % k)
+            code.put_goto(outer_error_label)
+            code.put_label(exit_label)
+        code.error_label = outer_error_label
+
+    def has_contig_inner_dim(self):
+        inner_dim = self.dims[-1]
+        if self.dst_type.axes[inner_dim][1] != 'contig':
+            return False
+        for operand in self.slices:
+            dim = inner_dim - (self.ndim - operand.type.ndim)
+            if dim < 0 or operand.type.axes[dim][1] != 'contig':
+                return False
+        return True
+
+    def put_for_loop(self, depth):
+        self.code.putln(
+            "for (__pyx_temp_idx_%d = 0; __pyx_temp_idx_%d < __pyx_temp_extent_%d; __pyx_temp_idx_%d++) {" % (
+                depth, depth, depth, depth))
+
+    def put_pointer_increments(self, depth):
+        dim = self.dims[depth]
+        self.code.putln("__pyx_temp_dst_%d += %s.strides[%d];" % (depth, self.dst_result, dim))
+        for k in range(len(self.slices)):
+            self.code.putln("__pyx_temp_pointer_%d_%d += __pyx_temp_strides_%d[%d];" % (k, depth, k, dim))
+
+    def put_strided_inner_loop(self):
+        depth = self.ndim - 1
+        self.put_for_loop(depth)
+        self.put_assignment(
+            "*(%s *) __pyx_temp_dst_%d" % (self.dst_type.dtype.empty_declaration_code(), depth),
+            ["(*(%s *) __pyx_temp_pointer_%d_%d)" % (operand.type.dtype.empty_declaration_code(), k, depth)
+             for k, operand in enumerate(self.slices)])
+        self.put_pointer_increments(depth)
+        self.code.putln("}")
+
+    def put_assignment(self, dst_item, item_codes):
+        code = self.code
+        for item, item_code in zip(self.slice_items, item_codes):
+            item.item_code = item_code
+        expr = self.element_expr
+        expr.generate_evaluation_code(code)
+        code.putln("%s = %s;" % (dst_item, expr.result()))
+        expr.generate_disposal_code(code)
+        expr.free_temps(code)
+
+
 def copy_c_or_fortran_cname(memview):
     if memview.is_c_contig:
         c_or_f = 'c'
@@ -835,6 +1008,8 @@ typeinfo_to_format_code = load_memview_cy_utility(
 
 is_contig_utility = load_memview_c_utility("MemviewSliceIsContig", context)
 overlapping_utility = load_memview_c_utility("OverlappingSlices", context)
+copy_strided_utility = load_memview_c_utility("MemviewSliceCopyStrided", context)
+broadcast_utility = load_memview_c_utility("MemviewSliceBroadcast", context, requires=[overlapping_utility])
 copy_contents_new_utility = load_memview_c_utility(
     "MemviewSliceCopyTemplate",
     context,
@@ -849,6 +1024,7 @@ view_utility_code = load_memview_cy_utility(
                   memviewslice_init_code,
                   is_contig_utility,
                   overlapping_utility,
+                  copy_strided_utility,
                   copy_contents_new_utility,
                   ],
 )
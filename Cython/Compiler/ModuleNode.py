@@ -29,6 +29,7 @@ from . import Pythran
 from .Errors import error, warning, CompileError, format_position
 from .PyrexTypes import py_object_type
 from ..Utils import open_new_file, replace_suffix, decode_filename, build_hex_version, is_cython_generated_file
+from ..StringIOTree import StringIOTree, SpillFile
 from .Code import UtilityCode, IncludeCode, TempitaUtilityCode
 from .StringEncoding import EncodedString, encoded_string_or_bytes_literal
 from .Pythran import has_np_pythran
@@ -472,6 +473,8 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                 show_entire_c_code=show_entire_c_code,
                 source_desc=self.compilation_source.source_desc,
             )
+        elif options.low_memory:
+            rootwriter = Code.CCodeWriter(buffer=StringIOTree(spill=SpillFile()))
         else:
             rootwriter = Code.CCodeWriter()
 
@@ -511,6 +514,10 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
         # generate normal variable and function definitions
         self.generate_lambda_definitions(env, code)
         self.generate_variable_definitions(env, code)
+        # The functions are generated one after the other into the same writer.
+        # Each one registers constants, cached builtins and utility code in the
+        # global state and marks entries as used, which the later functions and
+        # the module init code depend on, so they cannot be generated apart.
         self.body.generate_function_definitions(env, code)
 
         # generate extension types and methods
@@ -541,6 +548,7 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
         for utilcode in env.utility_code_list[:]:
             globalstate.use_utility_code(utilcode)
         globalstate.finalize_main_c_code()
+        result.utility_code_count = len(globalstate.utility_codes)
 
         self.generate_module_state_end(env, modules, globalstate)
 
@@ -549,6 +557,8 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
             rootwriter.copyto(f)
         finally:
             f.close()
+            if rootwriter.buffer.spill is not None:
+                rootwriter.buffer.spill.close()
         result.c_file_generated = 1
         if options.gdb_debug:
             self._serialize_lineno_map(env, rootwriter)
@@ -1343,6 +1353,10 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                 "struct %s *%s;" % (
                     type.vtabstruct_cname,
                     type.vtabslot_cname))
+        if type.scope.lookup_vectorcall_call()[1] is type.scope:
+            code.putln("#if CYTHON_USE_TYPE_VECTORCALL")
+            code.putln("__pyx_vectorcallfunc %s;" % Naming.vectorcall_slot_cname)
+            code.putln("#endif")
         for attr in type.scope.var_entries:
             if attr.is_declared_generic:
                 attr_type = py_object_type
@@ -1476,6 +1490,7 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                 if scope:  # could be None if there was an error
                     self.generate_exttype_vtable(scope, code)
                     self.generate_new_function(scope, code, entry)
+                    self.generate_vectorcall_function(scope, code)
                     self.generate_del_function(scope, code)
                     self.generate_dealloc_function(scope, code)
 
@@ -1572,14 +1587,25 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
             freelist_size = 0  # not currently supported
         else:
             freelist_size = scope.directives.get('freelist', 0)
+        freelist_pool_size = scope.directives.get('freelist_pool', 0) if freelist_size else 0
         freelist_name = scope.mangle_internal(Naming.freelist_name)
         freecount_name = scope.mangle_internal(Naming.freecount_name)
+        freelist_pool_name = scope.mangle_internal(Naming.freelist_pool_name)
 
         decls = code.globalstate['decls']
         decls.putln("static PyObject *%s(PyTypeObject *t, PyObject *a, PyObject *k); /*proto*/" %
                     slot_func)
         code.putln("")
-        if freelist_size:
+        if freelist_pool_size:
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("FreelistPool", "ExtensionTypes.c"))
+            code.putln("#if CYTHON_USE_FREELIST_POOLS")
+            code.putln("static __Pyx_FreelistPool %s;" % freelist_pool_name)
+            code.putln("__Pyx_FREELIST_CACHE_STORAGE struct { __Pyx_FreelistCache header; PyObject *items[%d]; } %s;" % (
+                freelist_size, freelist_name))
+            code.putln("#endif")
+            code.putln("")
+        elif freelist_size:
             code.putln("#if CYTHON_USE_FREELISTS")
             code.putln("static %s[%d];" % (
                 scope.parent_type.declaration_code(freelist_name),
@@ -1591,6 +1617,11 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
             "static PyObject *%s(PyTypeObject *t, %sPyObject *a, %sPyObject *k) {" % (
                 slot_func, unused_marker, unused_marker))
 
+        if scope.sets_vectorcall_call():
+            vectorcall_call_entry, vectorcall_field_scope = scope.lookup_vectorcall_call()
+        else:
+            vectorcall_call_entry = vectorcall_field_scope = None
+
         need_self_cast = (type.vtabslot_cname or
                           (py_buffers or memoryview_slices or py_attrs) or
                           cpp_constructable_attrs)
@@ -1615,12 +1646,21 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                 else:
                     type_safety_check = ' & (int)(!__Pyx_PyType_HasFeature(t, (Py_TPFLAGS_IS_ABSTRACT | Py_TPFLAGS_HEAPTYPE)))'
                 obj_struct = type.declaration_code("", deref=True)
-                code.putln("#if CYTHON_USE_FREELISTS")
-                code.putln(
-                    "if (likely((int)(%s > 0) & (int)(t->tp_basicsize == sizeof(%s))%s)) {" % (
-                        freecount_name, obj_struct, type_safety_check))
-                code.putln("o = (PyObject*)%s[--%s];" % (
-                    freelist_name, freecount_name))
+                if freelist_pool_size:
+                    code.putln("#if CYTHON_USE_FREELIST_POOLS")
+                    code.putln(
+                        "o = likely((int)(t->tp_basicsize == sizeof(%s))%s) ? "
+                        "__Pyx_FreelistPool_Pop(&%s, &%s.header, %s.items, %d) : NULL;" % (
+                            obj_struct, type_safety_check,
+                            freelist_pool_name, freelist_name, freelist_name, freelist_size))
+                    code.putln("if (likely(o)) {")
+                else:
+                    code.putln("#if CYTHON_USE_FREELISTS")
+                    code.putln(
+                        "if (likely((int)(%s > 0) & (int)(t->tp_basicsize == sizeof(%s))%s)) {" % (
+                            freecount_name, obj_struct, type_safety_check))
+                    code.putln("o = (PyObject*)%s[--%s];" % (
+                        freelist_name, freecount_name))
                 code.putln("memset(o, 0, sizeof(%s));" % obj_struct)
                 code.putln("(void) PyObject_INIT(o, t);")
                 if scope.needs_gc():
@@ -1660,6 +1700,14 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                 type.vtabslot_cname,
                 struct_type_cast, type.vtabptr_cname))
 
+        if vectorcall_call_entry:
+            code.putln("#if CYTHON_USE_TYPE_VECTORCALL")
+            code.putln("%s->%s = %s;" % (
+                "p" if need_self_cast else type.cast_code("o"),
+                scope.vectorcall_field_path(vectorcall_field_scope),
+                vectorcall_call_entry.vectorcall_cname))
+            code.putln("#endif")
+
         for entry in cpp_constructable_attrs:
             if entry.is_cpp_optional:
                 decl_code = entry.type.cpp_optional_declaration_code("")
@@ -1704,6 +1752,32 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
         code.putln(
             "}")
 
+    def generate_vectorcall_function(self, scope, code):
+        # Create the object with tp_new() and pass the call arguments directly to the vectorcall
+        # version of __init__().  This is only possible if no __cinit__() needs the arguments.
+        init_entry = scope.lookup_vectorcall_init()
+        if init_entry is None:
+            return
+        slot_func = scope.mangle_internal("tp_vectorcall")
+        tp_new = TypeSlots.get_slot_code_by_name(scope, 'tp_new')
+        if tp_new == '0':
+            tp_new = "((PyTypeObject*)t)->tp_new"
+
+        code.putln("")
+        code.putln("#if CYTHON_USE_TYPE_VECTORCALL")
+        code.putln(
+            "static PyObject *%s(PyObject *t, PyObject *const *args, size_t nargsf, PyObject *kwnames) {" % (
+                slot_func))
+        code.putln("PyObject *o = %s((PyTypeObject*)t, %s, NULL);" % (tp_new, Naming.empty_tuple))
+        code.putln("if (unlikely(!o)) return NULL;")
+        code.putln("if (unlikely(%s(o, args, nargsf, kwnames) < 0)) {" % init_entry.vectorcall_cname)
+        code.put_decref_clear("o", py_object_type, nanny=False)
+        code.putln("return NULL;")
+        code.putln("}")
+        code.putln("return o;")
+        code.putln("}")
+        code.putln("#endif")
+
     def generate_del_function(self, scope, code):
         tp_slot = TypeSlots.get_slot_by_name("tp_finalize", scope.directives)
         slot_func_cname = scope.mangle_internal("tp_finalize")
@@ -1845,6 +1919,7 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                     UtilityCode.load_cached("CallNextTpDealloc", "ExtensionTypes.c"))
         else:
             freelist_size = scope.directives.get('freelist', 0)
+            freelist_pool_size = scope.directives.get('freelist_pool', 0) if freelist_size else 0
             if freelist_size:
                 freelist_name = scope.mangle_internal(Naming.freelist_name)
                 freecount_name = scope.mangle_internal(Naming.freecount_name)
@@ -1856,6 +1931,18 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
                         ' & (int)(!__Pyx_PyType_HasFeature(Py_TYPE(o), (Py_TPFLAGS_IS_ABSTRACT | Py_TPFLAGS_HEAPTYPE)))')
 
                 type = scope.parent_type
+            if freelist_pool_size:
+                code.putln("#if CYTHON_USE_FREELIST_POOLS")
+                code.putln(
+                    "if (!((int)(Py_TYPE(o)->tp_basicsize == sizeof(%s))%s) ||"
+                    " !__Pyx_FreelistPool_Push(&%s, &%s.header, %s.items, %d, o))" % (
+                        type.declaration_code("", deref=True),
+                        type_safety_check,
+                        scope.mangle_internal(Naming.freelist_pool_name),
+                        freelist_name, freelist_name, freelist_size))
+                code.putln("#endif")
+                code.putln("{")
+            elif freelist_size:
                 code.putln("#if CYTHON_USE_FREELISTS")
                 code.putln(
                     "if (((int)(%s < %d) & (int)(Py_TYPE(o)->tp_basicsize == sizeof(%s))%s)) {" % (
@@ -3471,9 +3558,16 @@ class ModuleNode(Nodes.Node, Nodes.BlockNode):
             cclass_type = entry.type
             if cclass_type.is_external or cclass_type.base_type:
                 continue
-            if cclass_type.scope.directives.get('freelist', 0):
-                scope = cclass_type.scope
-                freelist_name = scope.mangle_internal(Naming.freelist_name)
+            if not cclass_type.scope.directives.get('freelist', 0):
+                continue
+            scope = cclass_type.scope
+            freelist_name = scope.mangle_internal(Naming.freelist_name)
+            if scope.directives.get('freelist_pool', 0):
+                code.putln('#if CYTHON_USE_FREELIST_POOLS')
+                code.putln("__Pyx_FreelistPool_Clear(&%s, &%s.header, %s.items);" % (
+                    scope.mangle_internal(Naming.freelist_pool_name), freelist_name, freelist_name))
+                code.putln('#endif')
+            else:
                 freecount_name = scope.mangle_internal(Naming.freecount_name)
                 code.putln('#if CYTHON_USE_FREELISTS')
                 code.putln("while (%s > 0) {" % freecount_name)
@@ -26,6 +26,7 @@ func_prefix       = pyrex_prefix + "f_"
 func_prefix_api   = pyrex_prefix + "api_f_"
 pyfunc_prefix     = pyrex_prefix + "pf_"
 pywrap_prefix     = pyrex_prefix + "pw_"
+pyvectorcall_prefix = pyrex_prefix + "pvc_"
 genbody_prefix    = pyrex_prefix + "gb_"
 gstab_prefix      = pyrex_prefix + "getsets_"
 prop_get_prefix   = pyrex_prefix + "getprop_"
@@ -78,10 +79,12 @@ interned_prefixes = {
 ctuple_type_prefix = pyrex_prefix + "ctuple_"
 args_cname       = pyrex_prefix + "args"
 nargs_cname      = pyrex_prefix + "nargs"
+nargsf_cname     = pyrex_prefix + "nargsf"
 kwvalues_cname   = pyrex_prefix + "kwvalues"
 generator_cname  = pyrex_prefix + "generator"
 sent_value_cname = pyrex_prefix + "sent_value"
 pykwdlist_cname  = pyrex_prefix + "pyargnames"
+pykwdhash_cname  = pyrex_prefix + "pyargnames_hash"
 obj_base_cname   = pyrex_prefix + "base"
 builtins_cname   = pyrex_prefix + "b"
 preimport_cname  = pyrex_prefix + "i"
@@ -107,7 +110,10 @@ self_cname       = pyrex_prefix + "self"
 stringtab_cname  = pyrex_prefix + "string_tab"
 codeobjtab_cname = pyrex_prefix + "codeobj_tab"
 stringtab_encodings_cname  = pyrex_prefix + "string_tab_encodings"
+stringtab_data_cname = pyrex_prefix + "string_tab_data"
+stringtab_zlib_data_cname = pyrex_prefix + "string_tab_zlib_data"
 vtabslot_cname   = pyrex_prefix + "vtab"
+vectorcall_slot_cname = pyrex_prefix + "vectorcall"
 c_api_tab_cname  = pyrex_prefix + "c_api_tab"
 gilstate_cname   = pyrex_prefix + "state"
 skip_dispatch_cname = pyrex_prefix + "skip_dispatch"
@@ -130,6 +136,9 @@ cur_scope_cname  = pyrex_prefix + "cur_scope"
 enc_scope_cname  = pyrex_prefix + "enc_scope"
 frame_cname      = pyrex_prefix + "frame"
 frame_code_cname = pyrex_prefix + "frame_code"
+monitoring_states_cname = pyrex_prefix + "monitoring_states"
+monitoring_events_cname = pyrex_prefix + "monitoring_events"
+monitoring_version_cname = pyrex_prefix + "monitoring_version"
 error_without_exception_cname = pyrex_prefix + "error_without_exception"
 binding_cfunc    = pyrex_prefix + "binding_PyCFunctionType"
 fused_func_prefix = pyrex_prefix + 'fuse_'
@@ -152,6 +161,7 @@ global_code_object_cache_insert = pyrex_prefix + 'insert_code_object'
 genexpr_id_ref = 'genexpr'
 freelist_name  = 'freelist'
 freecount_name = 'freecount'
+freelist_pool_name = 'freelist_pool'
 
 line_c_macro = "__LINE__"
 
@@ -172,6 +182,18 @@ parallel_filename = pyrex_prefix + "parallel_filename"
 parallel_lineno = pyrex_prefix + "parallel_lineno"
 parallel_clineno = pyrex_prefix + "parallel_clineno"
 parallel_why = pyrex_prefix + "parallel_why"
+parallel_temp_prefix = pyrex_prefix + "parallel_temp"
+
+# prange loops on the thread pool ('parallel_backend' directive)
+threadpool_body_prefix = pyrex_prefix + "prange_body"
+threadpool_ctx_prefix = pyrex_prefix + "prange_ctx"
+threadpool_ctx = pyrex_prefix + "pool_ctx"
+threadpool_thread = pyrex_prefix + "pool_thread"
+threadpool_freethreading_mutex = pyrex_prefix + "pool_freethreading_mutex"
+threadpool_exc_vars = (pyrex_prefix + "pool_exc_type", pyrex_prefix + "pool_exc_value", pyrex_prefix + "pool_exc_tb")
+threadpool_pos_info = (pyrex_prefix + "pool_filename", pyrex_prefix + "pool_lineno", pyrex_prefix + "pool_clineno")
+threadpool_why = pyrex_prefix + "pool_why"
+threadpool_temp_prefix = pyrex_prefix + "pool_temp"
 
 exc_vars = (exc_type_name, exc_value_name, exc_tb_name)
 
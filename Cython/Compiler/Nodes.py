@@ -1865,6 +1865,7 @@ class FuncDefNode(StatNode, BlockNode):
     #       with fused argument types with a FusedCFuncDefNode
 
     py_func = None
+    critical_section = None  # False to ignore the 'critical_section' directive
     needs_closure = False
     needs_outer_scope = False
     pymethdef_required = False
@@ -1998,6 +1999,12 @@ class FuncDefNode(StatNode, BlockNode):
                 code.use_fast_gil_utility_code()
             code.globalstate.use_utility_code(
                 UtilityCode.load_cached("Profile", "Profile.c"))
+        # generators are sampled when iterated, not at creation
+        sampling_profile = (code.globalstate.directives['sampling_profile']
+                            and not self.is_generator and not self.is_wrapper)
+        if sampling_profile:
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("SamplingProfile", "Profile.c"))
 
         # Generate C code for header and body of function
         code.enter_cfunc_scope(lenv)
@@ -2086,6 +2093,8 @@ class FuncDefNode(StatNode, BlockNode):
                 tempvardecl_code.put_trace_declarations()
                 code_object = self.code_object.calculate_result_code(code) if self.code_object else None
                 code.put_trace_frame_init(code_object)
+        if sampling_profile:
+            tempvardecl_code.put_sampling_declarations(self.entry.qualified_name, self.pos)
 
         # ----- Special check for getbuffer
         if is_getbuffer_slot:
@@ -2152,6 +2161,8 @@ class FuncDefNode(StatNode, BlockNode):
                 code.put_trace_call(
                     trace_name, self.pos, nogil=not code.funcstate.gil_owned)
             code.funcstate.can_trace = True
+        if sampling_profile:
+            code.put_sampling_enter()
         # ----- Fetch arguments
         self.generate_argument_parsing_code(env, code)
         # If an argument is assigned to in the body, we must
@@ -2413,6 +2424,8 @@ class FuncDefNode(StatNode, BlockNode):
             code.putln("if (unlikely(%s == -1) && !PyErr_Occurred()) %s = -2;" % (
                 Naming.retval_cname, Naming.retval_cname))
 
+        if sampling_profile:
+            code.put_sampling_exit()
         if profile or linetrace:
             code.funcstate.can_trace = False
             if not self.is_generator:
@@ -3076,6 +3089,7 @@ class DefNode(FuncDefNode):
     specialized_cpdefs = None
     py_wrapper = None
     py_wrapper_required = True
+    py_vectorcall_wrapper = None
     func_cname = None
 
     defaults_getter = None
@@ -3233,6 +3247,20 @@ class DefNode(FuncDefNode):
             return_type=self.return_type)
         self.py_wrapper.analyse_declarations(env)
 
+        if (env.is_c_class_scope and self.entry.is_special and self.name in ('__init__', '__call__')
+                and not self.has_fused_arguments and not self.uses_args_tuple()):
+            # Extension types can call these through vectorcall without packing the arguments.
+            self.py_vectorcall_wrapper = DefNodeWrapper(
+                self.pos,
+                target=self,
+                name=self.entry.name,
+                args=self.args,
+                star_arg=self.star_arg,
+                starstar_arg=self.starstar_arg,
+                return_type=self.return_type,
+                is_vectorcall=True)
+            self.py_vectorcall_wrapper.analyse_declarations(env)
+
     def analyse_argument_types(self, env):
         self.directive_locals = env.directives.get('locals', {})
         allow_none_for_extension_args = env.directives['allow_none_for_extension_args']
@@ -3383,23 +3411,23 @@ class DefNode(FuncDefNode):
         mf = sig.method_flags()
         if mf and TypeSlots.method_varargs in mf and not self.entry.is_special:
             # 3. If the function uses the full args tuple, it's more
-            #    efficient to use METH_VARARGS. This happens when the function
-            #    takes *args but no other positional arguments (apart from
-            #    possibly self). We don't do the analogous check for keyword
-            #    arguments since the kwargs dict is copied anyway.
-            if self.star_arg:
-                uses_args_tuple = True
-                for arg in self.args:
-                    if (arg.is_generic and not arg.kw_only and
-                            not arg.is_self_arg and not arg.is_type_arg):
-                        # Other positional argument
-                        uses_args_tuple = False
-            else:
-                uses_args_tuple = False
-
-            if not uses_args_tuple:
+            #    efficient to use METH_VARARGS.
+            if not self.uses_args_tuple():
                 sig = self.entry.signature = sig.with_fastcall()
 
+    def uses_args_tuple(self):
+        # This happens when the function takes *args but no other positional
+        # arguments (apart from possibly self). We don't do the analogous check
+        # for keyword arguments since the kwargs dict is copied anyway.
+        if not self.star_arg:
+            return False
+        for arg in self.args:
+            if (arg.is_generic and not arg.kw_only and
+                    not arg.is_self_arg and not arg.is_type_arg):
+                # Other positional argument
+                return False
+        return True
+
     def bad_signature(self):
         sig = self.entry.signature
         expected_str = "%d" % sig.min_num_fixed_args()
@@ -3521,6 +3549,10 @@ class DefNode(FuncDefNode):
             # func_cname might be modified by @cname
             self.py_wrapper.func_cname = self.entry.func_cname
             self.py_wrapper.generate_function_definitions(env, code)
+            if self.py_vectorcall_wrapper and self.py_vectorcall_wrapper.is_used(env):
+                code.putln("#if CYTHON_USE_TYPE_VECTORCALL")
+                self.py_vectorcall_wrapper.generate_function_definitions(env, code)
+                code.putln("#endif")
         FuncDefNode.generate_function_definitions(self, env, code)
 
     def generate_function_header(self, code, with_pymethdef, proto_only=0):
@@ -3610,12 +3642,48 @@ class DefNode(FuncDefNode):
         pass
 
 
+def keyword_hash(name, seed):
+    # FNV-1a over the code points, must match __Pyx_FindKeywordHashed() in FunctionArguments.c
+    h = seed
+    for c in name:
+        h = ((h ^ ord(c)) * 16777619) & 0xffffffff
+    return h
+
+
+def find_keyword_hash_table(names, max_seeds=256):
+    """
+    Search a perfect hash table for the keyword argument names of a function.
+    Returns (seed, table) where table[keyword_hash(name, seed) & (len(table)-1)]
+    is the index of the name plus one, or None if there is no such table.
+    """
+    if len(names) >= 255:
+        return None
+    min_size = 8
+    while min_size < 2 * len(names):
+        min_size *= 2
+    for size in (min_size, min_size * 2, min_size * 4):
+        mask = size - 1
+        for seed in range(2166136261, 2166136261 + max_seeds):
+            table = [0] * size
+            for i, name in enumerate(names):
+                slot = keyword_hash(name, seed) & mask
+                if table[slot]:
+                    break
+                table[slot] = i + 1
+            else:
+                return seed, table
+    return None
+
+
 class DefNodeWrapper(FuncDefNode):
     # DefNode python wrapper code generator
 
     defnode = None
     target = None  # Target DefNode
     needs_values_cleanup = False
+    is_vectorcall = False  # Implements a special method of an extension type as vectorcall function
+    # Look up keywords in a perfect hash table from this number of keyword arguments.
+    keyword_hash_min_args = 8
 
     def __init__(self, *args, **kwargs):
         FuncDefNode.__init__(self, *args, **kwargs)
@@ -3630,10 +3698,13 @@ class DefNodeWrapper(FuncDefNode):
         target_entry = self.target.entry
         name = self.name
         prefix = env.next_id(env.scope_prefix)
-        target_entry.func_cname = punycodify_name(Naming.pywrap_prefix + prefix + name)
-        target_entry.pymethdef_cname = punycodify_name(Naming.pymethdef_prefix + prefix + name)
-
-        self.signature = target_entry.signature
+        if self.is_vectorcall:
+            target_entry.vectorcall_cname = punycodify_name(Naming.pyvectorcall_prefix + prefix + name)
+            self.signature = target_entry.signature.with_fastcall()
+        else:
+            target_entry.func_cname = punycodify_name(Naming.pywrap_prefix + prefix + name)
+            target_entry.pymethdef_cname = punycodify_name(Naming.pymethdef_prefix + prefix + name)
+            self.signature = target_entry.signature
 
         self.np_args_idx = self.target.np_args_idx
 
@@ -3659,6 +3730,12 @@ class DefNodeWrapper(FuncDefNode):
                 if not ass.is_arg and ass.lhs.is_name:
                     ass.lhs.cf_maybe_null = True
 
+    def is_used(self, env):
+        if self.target.name == '__init__':
+            return env.lookup_vectorcall_init() is self.target.entry
+        else:
+            return env.lookup_vectorcall_call()[0] is self.target.entry
+
     def signature_has_nongeneric_args(self):
         argcount = len(self.args)
         if argcount == 0 or (
@@ -3798,7 +3875,10 @@ class DefNodeWrapper(FuncDefNode):
         if sig.has_generic_args:
             varargs_args = "PyObject *%s, PyObject *%s" % (
                     Naming.args_cname, Naming.kwds_cname)
-            if sig.use_fastcall:
+            if self.is_vectorcall:
+                arg_code_list.append("PyObject *const *%s, size_t %s, PyObject *%s" % (
+                        Naming.args_cname, Naming.nargsf_cname, Naming.kwds_cname))
+            elif sig.use_fastcall:
                 fastcall_args = "PyObject *const *%s, Py_ssize_t %s, PyObject *%s" % (
                         Naming.args_cname, Naming.nargs_cname, Naming.kwds_cname)
                 arg_code_list.append(
@@ -3818,10 +3898,15 @@ class DefNodeWrapper(FuncDefNode):
             mf = "CYTHON_UNUSED "
             with_pymethdef = False
 
-        dc = self.return_type.declaration_code(entry.func_cname)
+        dc = self.return_type.declaration_code(
+            entry.vectorcall_cname if self.is_vectorcall else entry.func_cname)
         header = "%sstatic %s(%s)" % (mf, dc, arg_code)
         code.putln("%s; /*proto*/" % header)
 
+        if self.is_vectorcall:
+            code.putln("%s {" % header)
+            return
+
         if proto_only:
             if self.target.fused_py_func:
                 # If we are the specialized version of the cpdef, we still
@@ -3873,7 +3958,10 @@ class DefNodeWrapper(FuncDefNode):
         if self.signature_has_generic_args():
             # error handling for this is checked after the declarations
             nargs_code = "CYTHON_UNUSED Py_ssize_t %s;" % Naming.nargs_cname
-            if self.signature.use_fastcall:
+            if self.is_vectorcall:
+                code.putln("CYTHON_UNUSED Py_ssize_t %s = __Pyx_PyVectorcall_NARGS(%s);" % (
+                    Naming.nargs_cname, Naming.nargsf_cname))
+            elif self.signature.use_fastcall:
                 code.putln("#if !CYTHON_METH_FASTCALL")
                 code.putln(nargs_code)
                 code.putln("#endif")
@@ -4454,7 +4542,12 @@ class DefNodeWrapper(FuncDefNode):
             if max_positional_args > num_pos_only_args:
                 code.putln('}')
 
-        if has_kw_only_args:
+        keyword_names = [arg.entry.name for arg in all_args if not arg.pos_only]
+        keyword_hash_table = None
+        if len(keyword_names) >= self.keyword_hash_min_args:
+            keyword_hash_table = find_keyword_hash_table(keyword_names)
+
+        if has_kw_only_args and not keyword_hash_table:
             # unpack optional keyword-only arguments separately because
             # checking for interned strings in a dict is faster than iterating
             self.generate_optional_kwonly_args_unpacking_code(all_args, code)
@@ -4501,17 +4594,36 @@ class DefNodeWrapper(FuncDefNode):
             values_array = 'values + %d' % num_pos_only_args
         else:
             values_array = 'values'
-        code.globalstate.use_utility_code(
-            UtilityCode.load_cached("ParseKeywords", "FunctionArguments.c"))
-        code.putln('if (unlikely(__Pyx_ParseOptionalKeywords(%s, %s, %s, %s, %s, %s, %s) < 0)) %s' % (
-            Naming.kwds_cname,
-            Naming.kwvalues_cname,
-            Naming.pykwdlist_cname,
-            self.starstar_arg and self.starstar_arg.entry.cname or '0',
-            values_array,
-            pos_arg_count,
-            self_name_csafe,
-            code.error_goto(self.pos)))
+        if keyword_hash_table:
+            seed, table = keyword_hash_table
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("ParseKeywordsHashed", "FunctionArguments.c"))
+            code.putln('static const unsigned char %s[%d] = {%s};' % (
+                Naming.pykwdhash_cname, len(table), ','.join(map(str, table))))
+            code.putln('if (unlikely(__Pyx_ParseKeywordsHashed(%s, %s, %s, %s, %dU, %d, %s, %s, %s, %s) < 0)) %s' % (
+                Naming.kwds_cname,
+                Naming.kwvalues_cname,
+                Naming.pykwdlist_cname,
+                Naming.pykwdhash_cname,
+                seed,
+                len(table) - 1,
+                self.starstar_arg and self.starstar_arg.entry.cname or '0',
+                values_array,
+                pos_arg_count,
+                self_name_csafe,
+                code.error_goto(self.pos)))
+        else:
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("ParseKeywords", "FunctionArguments.c"))
+            code.putln('if (unlikely(__Pyx_ParseOptionalKeywords(%s, %s, %s, %s, %s, %s, %s) < 0)) %s' % (
+                Naming.kwds_cname,
+                Naming.kwvalues_cname,
+                Naming.pykwdlist_cname,
+                self.starstar_arg and self.starstar_arg.entry.cname or '0',
+                values_array,
+                pos_arg_count,
+                self_name_csafe,
+                code.error_goto(self.pos)))
         code.putln('}')
 
     def generate_optional_kwonly_args_unpacking_code(self, all_args, code):
@@ -4798,6 +4910,11 @@ class GeneratorBodyDefNode(DefNode):
             code.funcstate.can_trace = True
             code_object = self.code_object.calculate_result_code(code) if self.code_object else None
             code.put_trace_frame_init(code_object)
+        sampling_profile = code.globalstate.directives['sampling_profile']
+        if sampling_profile:
+            code.globalstate.use_utility_code(
+                UtilityCode.load_cached("SamplingProfile", "Profile.c"))
+            tempvardecl_code.put_sampling_declarations(env.qualify_name(self.name), self.pos)
 
         # ----- Resume switch point.
         code.funcstate.init_closure_temps(lenv.scope_class.type.scope)
@@ -4879,6 +4996,8 @@ class GeneratorBodyDefNode(DefNode):
         code.putln('%s->resume_label = -1;' % Naming.generator_cname)
         # clean up as early as possible to help breaking any reference cycles
         code.putln('__Pyx_Coroutine_clear((PyObject*)%s);' % Naming.generator_cname)
+        if sampling_profile:
+            code.put_sampling_exit()
         if profile or linetrace:
             code.put_trace_return(Naming.retval_cname,
                                   nogil=not code.funcstate.gil_owned)
@@ -4892,6 +5011,8 @@ class GeneratorBodyDefNode(DefNode):
         if profile or linetrace:
             resume_code.put_trace_call(self.entry.qualified_name, self.pos,
                                        nogil=not code.funcstate.gil_owned)
+        if sampling_profile:
+            resume_code.put_sampling_enter()
         resume_code.putln("switch (%s->resume_label) {" % (
                        Naming.generator_cname))
 
@@ -4900,6 +5021,8 @@ class GeneratorBodyDefNode(DefNode):
         for i, label in code.yield_labels:
             resume_code.putln("case %d: goto %s;" % (i, label))
         resume_code.putln("default: /* CPython raises the right error here */")
+        if sampling_profile:
+            resume_code.put_sampling_exit()
         if profile or linetrace:
             resume_code.put_trace_return("Py_None",
                                          nogil=not code.funcstate.gil_owned)
@@ -5448,6 +5571,8 @@ class CClassDefNode(ClassDefNode):
                 self.base_type = base_type
             if env.directives.get('freelist', 0) > 0 and base_type != PyrexTypes.py_object_type:
                 warning(self.pos, "freelists cannot be used on subtypes, only the base class can manage them", 1)
+        if env.directives.get('freelist_pool', 0) > 0 and not env.directives.get('freelist', 0):
+            warning(self.pos, "freelist_pool has no effect without a freelist size", 1)
 
         has_body = self.body is not None
         if has_body and self.base_type and not self.base_type.scope:
@@ -5783,6 +5908,22 @@ class CClassDefNode(ClassDefNode):
                 code.putln("}")
                 code.putln("#endif")  # if !CYTHON_COMPILING_IN_LIMITED_API
 
+            # Call __init__() and __call__() without packing their arguments into a tuple and dict.
+            # tp_vectorcall is never inherited, but the instance vectorcall offset is.
+            vectorcall_call_entry, vectorcall_field_scope = scope.lookup_vectorcall_call()
+            if scope.lookup_vectorcall_init() or vectorcall_call_entry:
+                code.putln("#if CYTHON_USE_TYPE_VECTORCALL")
+                if scope.lookup_vectorcall_init():
+                    code.putln("%s->tp_vectorcall = %s;" % (
+                        typeptr_cname, scope.mangle_internal("tp_vectorcall")))
+                if vectorcall_call_entry:
+                    code.putln("%s->tp_vectorcall_offset = offsetof(%s, %s);" % (
+                        typeptr_cname,
+                        type.declaration_code("", deref=True),
+                        scope.vectorcall_field_path(vectorcall_field_scope)))
+                    code.putln("%s->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;" % typeptr_cname)
+                code.putln("#endif")
+
             # Fix special method docstrings. This is a bit of a hack, but
             # unless we let PyType_Ready create the slot wrappers we have
             # a significant performance hit. (See trac #561.)
@@ -5828,6 +5969,18 @@ class CClassDefNode(ClassDefNode):
                 code.globalstate.use_utility_code(
                     UtilityCode.load_cached('MergeVTables', 'ImportExport.c'))
                 code.put_error_if_neg(entry.pos, "__Pyx_MergeVtables(%s)" % typeptr_cname)
+            freelist_size = scope.directives.get('freelist', 0)
+            if freelist_size and scope.directives.get('freelist_pool', 0) and not type.base_type:
+                freelist_name = scope.mangle_internal(Naming.freelist_name)
+                code.putln("#if CYTHON_USE_FREELIST_POOLS")
+                code.put_error_if_neg(entry.pos, "__Pyx_FreelistPool_Setup(%s, &%s, &%s.header, %d, %d)" % (
+                    typeptr_cname,
+                    scope.mangle_internal(Naming.freelist_pool_name),
+                    freelist_name,
+                    freelist_size,
+                    scope.directives['freelist_pool'],
+                ))
+                code.putln("#endif")
             if not type.scope.is_internal and not type.scope.directives.get('internal'):
                 # scope.is_internal is set for types defined by
                 # Cython (such as closures), the 'internal'
@@ -6084,6 +6237,7 @@ class SingleAssignmentNode(AssignmentNode):
     #  first                    bool          Is this guaranteed the first assignment to lhs?
     #  is_overloaded_assignment bool          Is this assignment done via an overloaded operator=
     #  is_assignment_expression bool          Internally SingleAssignmentNode is used to implement assignment expressions
+    #  reduction_operator       string or None 'min' or 'max' for 'x = min(x, y)' reductions in prange loops
     #  exception_check
     #  exception_value
 
@@ -6091,6 +6245,7 @@ class SingleAssignmentNode(AssignmentNode):
     first = False
     is_overloaded_assignment = False
     is_assignment_expression = False
+    reduction_operator = None
     declaration_only = False
 
     def analyse_declarations(self, env):
@@ -8832,6 +8987,109 @@ class EnsureGILNode(GILExitNode):
         code.put_ensure_gil(declare_gilstate=False)
 
 
+class CriticalSectionStatNode(TryFinallyStatNode):
+    """
+    'with cython.critical_section(obj[, obj2])' statement, also used for
+    the methods of extension types with the 'critical_section' directive.
+    Only locks the objects in free-threaded Python.
+
+    args    [ExprNode]    the objects to lock
+    """
+
+    child_attrs = ["args"] + TryFinallyStatNode.child_attrs
+    preserve_exception = False
+    gil_message = "Critical section"
+
+    def __init__(self, pos, args, body, **kwds):
+        TryFinallyStatNode.__init__(
+            self, pos,
+            args=args,
+            body=body,
+            finally_clause=CriticalSectionExitNode(pos),
+            **kwds)
+
+    def analyse_declarations(self, env):
+        from .ParseTreeTransforms import YieldNodeCollector
+        collector = YieldNodeCollector()
+        collector.visitchildren(self.body)
+        if collector.yields:
+            error(collector.yields[0].pos, "Cannot yield or await inside of a critical section")
+        return super().analyse_declarations(env)
+
+    def analyse_expressions(self, env):
+        self.args = [arg.analyse_types(env).coerce_to_pyobject(env) for arg in self.args]
+        return TryFinallyStatNode.analyse_expressions(self, env)
+
+    def _is_borrowable(self, arg):
+        # Arguments that cannot change during the critical section do not need their own reference.
+        entry = arg.entry if arg.is_name else None
+        return entry is not None and entry.is_arg and not entry.cf_is_reassigned
+
+    def generate_execution_code(self, code):
+        code.globalstate.use_utility_code(
+            UtilityCode.load_cached("CriticalSections", "ModuleSetupCode.c"))
+        code.mark_pos(self.pos)
+        code.begin_block()
+
+        # Keep the locked objects alive until the end of the critical section.
+        # The exit node releases the references on all paths, so the temps
+        # must not be managed (and cleaned up again) by return statements.
+        objects = []
+        owned_temps = []
+        for arg in self.args:
+            arg.generate_evaluation_code(code)
+            if self._is_borrowable(arg):
+                objects.append(arg.py_result())
+                continue
+            temp = code.funcstate.allocate_temp(py_object_type, manage_ref=False)
+            arg.make_owned_reference(code)
+            code.putln("%s = %s;" % (temp, arg.py_result()))
+            arg.generate_post_assignment_code(code)
+            arg.free_temps(code)
+            objects.append(temp)
+            owned_temps.append(temp)
+
+        section_type = PyrexTypes.c_py_critical_section2_type if len(objects) == 2 else PyrexTypes.c_py_critical_section_type
+        section_temp = code.funcstate.allocate_temp(section_type, manage_ref=False)
+        code.putln("__Pyx_PyCriticalSection_Begin%d(&%s, %s);" % (
+            len(objects), section_temp, ", ".join(objects)))
+
+        for exit_node in (self.finally_clause, self.finally_except_clause):
+            exit_node.section_temp = section_temp
+            exit_node.object_count = len(objects)
+            exit_node.owned_temps = owned_temps
+
+        TryFinallyStatNode.generate_execution_code(self, code)
+
+        code.funcstate.release_temp(section_temp)
+        for temp in owned_temps:
+            code.funcstate.release_temp(temp)
+        for arg in self.args:
+            if self._is_borrowable(arg):
+                arg.generate_disposal_code(code)
+                arg.free_temps(code)
+        code.end_block()
+
+
+class CriticalSectionExitNode(StatNode):
+    """
+    Used as the 'finally' block in a CriticalSectionStatNode
+    """
+
+    child_attrs = []
+    section_temp = None
+    object_count = 1
+    owned_temps = ()
+
+    def analyse_expressions(self, env):
+        return self
+
+    def generate_execution_code(self, code):
+        code.putln("__Pyx_PyCriticalSection_End%d(&%s);" % (self.object_count, self.section_temp))
+        for temp in self.owned_temps:
+            code.put_decref_clear(temp, py_object_type)
+
+
 def cython_view_utility_code():
     from . import MemoryView
     return MemoryView.view_utility_code
@@ -9137,6 +9395,11 @@ class ParallelStatNode(StatNode, ParallelNode):
     args         tuple          the arguments passed to the parallel construct
     kwargs       DictNode       the keyword arguments passed to the parallel
                                 construct (replaced by its compile time value)
+    reduction_vars  [NameNode]  the memoryviews and C++ objects passed as
+                                'reduction' argument to prange
+    uses_threadpool boolean     whether the loop body runs on the thread pool
+                                of the 'parallel_backend' directive instead
+                                of OpenMP (only for the outermost prange)
     """
 
     child_attrs = ['body', 'num_threads', 'threading_condition']
@@ -9151,6 +9414,12 @@ class ParallelStatNode(StatNode, ParallelNode):
     num_threads = None
     chunksize = None
     threading_condition = None
+    reduction_vars = None
+    uses_threadpool = False
+
+    parallel_why = Naming.parallel_why
+    parallel_temp_prefix = Naming.parallel_temp_prefix
+    parallel_freethreading_mutex = Naming.parallel_freethreading_mutex
 
     parallel_exc = (
         Naming.parallel_exc_type,
@@ -9212,6 +9481,9 @@ class ParallelStatNode(StatNode, ParallelNode):
                 elif self.is_prange and dictitem.key.value == 'chunksize':
                     if not dictitem.value.is_none:
                         self.chunksize = dictitem.value
+                elif self.is_prange and dictitem.key.value == 'reduction':
+                    if not dictitem.value.is_none:
+                        self.reduction_vars = dictitem.value
                 else:
                     pairs.append(dictitem)
 
@@ -9284,8 +9556,8 @@ class ParallelStatNode(StatNode, ParallelNode):
                 continue
 
             # By default all variables should have the same values as if
-            # executed sequentially
-            lastprivate = True
+            # executed sequentially, min() and max() reductions are merged
+            lastprivate = op not in ('min', 'max')
             self.propagate_var_privatization(entry, pos, op, lastprivate)
 
     def propagate_var_privatization(self, entry, pos, op, lastprivate):
@@ -9381,11 +9653,11 @@ class ParallelStatNode(StatNode, ParallelNode):
         code.putln("%s = %s;" % (cname, entry.cname))
         entry.cname = cname
 
-    def initialize_privates_to_nan(self, code, exclude=None):
+    def initialize_privates_to_nan(self, code, exclude=()):
         first = True
 
         for entry, (op, lastprivate) in sorted(self.privates.items()):
-            if not op and (not exclude or entry != exclude):
+            if not op and entry not in exclude:
                 invalid_value = entry.type.invalid_value()
 
                 if invalid_value:
@@ -9425,7 +9697,10 @@ class ParallelStatNode(StatNode, ParallelNode):
         """
         self.modified_entries = []
 
-        for entry in sorted(self.assignments):
+        entries = set(self.assignments)
+        if self.reduction_vars:
+            entries.update(var.entry for var in self.reduction_vars)
+        for entry in sorted(entries):
             if entry.from_closure or entry.in_closure:
                 self._allocate_closure_temp(code, entry)
 
@@ -9463,14 +9738,14 @@ class ParallelStatNode(StatNode, ParallelNode):
                 c.put(" firstprivate(%s)" % ", ".join(firstprivates))
 
             if self.breaking_label_used:
-                shared_vars = [Naming.parallel_why]
+                shared_vars = [self.parallel_why]
                 if self.error_label_used:
                     shared_vars.extend(self.parallel_exc)
                     c.globalstate.use_utility_code(
                         UtilityCode.load_cached(
                             "SharedInFreeThreading",
                             "ModuleSetupCode.c"))
-                    c.put(f" __Pyx_shared_in_cpython_freethreading({Naming.parallel_freethreading_mutex})")
+                    c.put(f" __Pyx_shared_in_cpython_freethreading({self.parallel_freethreading_mutex})")
                     c.put(" private(%s, %s, %s)" % self.pos_info)
 
                 c.put(" shared(%s)" % ', '.join(shared_vars))
@@ -9611,7 +9886,12 @@ class ParallelStatNode(StatNode, ParallelNode):
                     self.error_label_used = True
                     self.fetch_parallel_exception(code)
 
-                code.putln("%s = %d;" % (Naming.parallel_why, i + 1))
+                code.putln("%s = %d;" % (self.parallel_why, i + 1))
+                if self.uses_threadpool and label == code.return_label and self.threadpool_return_type(
+                        code.funcstate.scope) is not None:
+                    # the body of the thread pool loop sets its own copy of the return value
+                    code.putln("%s = %s;" % (
+                        self.threadpool_shared_code(Naming.retval_cname), Naming.retval_cname))
 
             if (self.breaking_label_used and self.is_prange and not
                     is_continue_label):
@@ -9627,8 +9907,8 @@ class ParallelStatNode(StatNode, ParallelNode):
 
             code.put_label(dont_return_label)
 
-            if should_flush and self.breaking_label_used:
-                code.putln_openmp("#pragma omp flush(%s)" % Naming.parallel_why)
+            if should_flush and self.breaking_label_used and not self.uses_threadpool:
+                code.putln_openmp("#pragma omp flush(%s)" % self.parallel_why)
 
     def save_parallel_vars(self, code):
         """
@@ -9640,10 +9920,8 @@ class ParallelStatNode(StatNode, ParallelNode):
         variables, so we keep those values.
         """
         section_name = "__pyx_parallel_lastprivates%d" % self.critical_section_counter
-        code.putln_openmp("#pragma omp critical(%s)" % section_name)
         ParallelStatNode.critical_section_counter += 1
-
-        code.begin_block()  # begin critical section
+        self.begin_critical_section(code, section_name)
 
         c = self.begin_of_parallel_control_block_point
 
@@ -9656,7 +9934,7 @@ class ParallelStatNode(StatNode, ParallelNode):
                 type_decl = entry.type.cpp_optional_declaration_code("")
             else:
                 type_decl = entry.type.empty_declaration_code()
-            temp_cname = "__pyx_parallel_temp%d" % temp_count
+            temp_cname = "%s%d" % (self.parallel_temp_prefix, temp_count)
             private_cname = entry.cname
 
             temp_count += 1
@@ -9677,11 +9955,28 @@ class ParallelStatNode(StatNode, ParallelNode):
                     UtilityCode.load_cached("MoveIfSupported", "CppSupport.cpp"))
                 private_cname = "__PYX_STD_MOVE_IF_SUPPORTED(%s)" % private_cname
             # Initialize before escaping
-            code.putln("%s = %s;" % (temp_cname, private_cname))
+            if self.uses_threadpool:
+                code.putln("%s = %s;" % (self.threadpool_shared_code(temp_cname), private_cname))
+            else:
+                code.putln("%s = %s;" % (temp_cname, private_cname))
 
+        self.end_critical_section(code)
 
+    def begin_critical_section(self, code, name):
+        """
+        Start a block that only one thread of the parallel section executes
+        at a time.
+        """
+        if self.uses_threadpool:
+            code.putln("__Pyx_ThreadPool_Lock(%s);" % Naming.threadpool_thread)
+        else:
+            code.putln_openmp("#pragma omp critical(%s)" % name)
+        code.begin_block()
 
-        code.end_block()  # end critical section
+    def end_critical_section(self, code):
+        code.end_block()
+        if self.uses_threadpool:
+            code.putln("__Pyx_ThreadPool_Unlock(%s);" % Naming.threadpool_thread)
 
     def fetch_parallel_exception(self, code):
         """
@@ -9712,22 +10007,23 @@ class ParallelStatNode(StatNode, ParallelNode):
         """
         code.begin_block()
         code.put_ensure_gil(declare_gilstate=True)
-        code.put_acquire_freethreading_lock()
+        code.put_acquire_freethreading_lock(self.parallel_freethreading_mutex)
 
-        code.putln_openmp("#pragma omp flush(%s)" % Naming.parallel_exc_type)
+        if not self.uses_threadpool:
+            code.putln_openmp("#pragma omp flush(%s)" % self.parallel_exc[0])
         code.putln(
-            "if (!%s) {" % Naming.parallel_exc_type)
+            "if (!%s) {" % self.parallel_exc[0])
 
         code.putln("__Pyx_ErrFetchWithState(&%s, &%s, &%s);" % self.parallel_exc)
         pos_info = chain(*zip(self.parallel_pos_info, self.pos_info))
         code.funcstate.uses_error_indicator = True
         code.putln("%s = %s; %s = %s; %s = %s;" % tuple(pos_info))
-        code.put_gotref(Naming.parallel_exc_type, py_object_type)
+        code.put_gotref(self.parallel_exc[0], py_object_type)
 
         code.putln(
             "}")
 
-        code.put_release_freethreading_lock()
+        code.put_release_freethreading_lock(self.parallel_freethreading_mutex)
         code.put_release_ensured_gil()
         code.end_block()
 
@@ -9735,14 +10031,14 @@ class ParallelStatNode(StatNode, ParallelNode):
         "Re-raise a parallel exception"
         code.begin_block()
         code.put_ensure_gil(declare_gilstate=True)
-        code.put_acquire_freethreading_lock()
+        code.put_acquire_freethreading_lock(self.parallel_freethreading_mutex)
 
-        code.put_giveref(Naming.parallel_exc_type, py_object_type)
+        code.put_giveref(self.parallel_exc[0], py_object_type)
         code.putln("__Pyx_ErrRestoreWithState(%s, %s, %s);" % self.parallel_exc)
         pos_info = chain(*zip(self.pos_info, self.parallel_pos_info))
         code.putln("%s = %s; %s = %s; %s = %s;" % tuple(pos_info))
 
-        code.put_release_freethreading_lock()
+        code.put_release_freethreading_lock(self.parallel_freethreading_mutex)
         code.put_release_ensured_gil()
         code.end_block()
 
@@ -9783,14 +10079,14 @@ class ParallelStatNode(StatNode, ParallelNode):
             c.putln("const char *%s = NULL; int %s = 0, %s = 0;" % self.parallel_pos_info)
             c.putln("PyObject *%s = NULL, *%s = NULL, *%s = NULL;" % self.parallel_exc)
             c.putln("#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING")
-            c.putln(f"PyMutex {Naming.parallel_freethreading_mutex} = {{0}};")
+            c.putln(f"PyMutex {self.parallel_freethreading_mutex} = {{0}};")
             c.putln("#endif")
 
             code.putln(
-                "if (%s) {" % Naming.parallel_exc_type)
+                "if (%s) {" % self.parallel_exc[0])
             code.putln("/* This may have been overridden by a continue, "
                        "break or return in another thread. Prefer the error. */")
-            code.putln("%s = 4;" % Naming.parallel_why)
+            code.putln("%s = 4;" % self.parallel_why)
             code.putln(
                 "}")
 
@@ -9801,11 +10097,11 @@ class ParallelStatNode(StatNode, ParallelNode):
 
         if any_label_used:
             # __pyx_parallel_why is used, declare and initialize
-            c.putln("int %s;" % Naming.parallel_why)
-            c.putln("%s = 0;" % Naming.parallel_why)
+            c.putln("int %s;" % self.parallel_why)
+            c.putln("%s = 0;" % self.parallel_why)
 
             code.putln(
-                "if (%s) {" % Naming.parallel_why)
+                "if (%s) {" % self.parallel_why)
 
             for temp_cname, private_cname, temp_type in self.parallel_private_temps:
                 if temp_type.is_cpp_class:
@@ -9813,7 +10109,7 @@ class ParallelStatNode(StatNode, ParallelNode):
                     temp_cname = "__PYX_STD_MOVE_IF_SUPPORTED(%s)" % temp_cname
                 code.putln("%s = %s;" % (private_cname, temp_cname))
 
-            code.putln("switch (%s) {" % Naming.parallel_why)
+            code.putln("switch (%s) {" % self.parallel_why)
             if continue_:
                 code.put("    case 1: ")
                 code.put_goto(code.continue_label)
@@ -9942,8 +10238,12 @@ class ParallelRangeNode(ParallelStatNode):
     """
     This node represents a 'for i in cython.parallel.prange():' construct.
 
-    target       NameNode       the target iteration variable
+    target       NameNode or TupleNode   the target iteration variable, or the
+                                         variables of a collapsed loop nest
     else_clause  Node or None   the else clause of this loop
+    extents      [ExprNode] or None      the number of iterations of each
+                                         variable of a collapsed loop nest
+    sequence     ExprNode or None        the C++ container iterated over
     """
 
     child_attrs = ['body', 'target', 'else_clause', 'args', 'num_threads',
@@ -9952,6 +10252,7 @@ class ParallelRangeNode(ParallelStatNode):
     body = target = else_clause = args = None
 
     start = stop = step = None
+    extents = sequence = None
 
     is_prange = True
 
@@ -9965,17 +10266,32 @@ class ParallelRangeNode(ParallelStatNode):
         # Pretend to be a ForInStatNode for control flow analysis
         self.iterator = PassStatNode(pos)
 
+    def targets(self):
+        if self.target is None:
+            return []
+        elif self.target.is_sequence_constructor:
+            return self.target.args
+        return [self.target]
+
     def analyse_declarations(self, env):
         super().analyse_declarations(env)
-        self.target.analyse_target_declaration(env)
+        targets = self.targets()
+        for target in targets:
+            target.analyse_target_declaration(env)
         if self.else_clause is not None:
             self.else_clause.analyse_declarations(env)
 
-        if not self.args or len(self.args) > 3:
+        if self.target is not None and self.target.is_sequence_constructor:
+            # 'for i, j in prange(n, m)' iterates over the flattened range
+            # of both loops, n * m iterations in total
+            if len(self.args) != len(targets):
+                error(self.pos, "prange() over %d variables needs one extent "
+                                "argument per variable" % len(targets))
+            self.extents = self.args
+        elif not self.args or len(self.args) > 3:
             error(self.pos, "Invalid number of positional arguments to prange")
             return
-
-        if len(self.args) == 1:
+        elif len(self.args) == 1:
             self.stop, = self.args
         elif len(self.args) == 2:
             self.start, self.stop = self.args
@@ -9985,6 +10301,19 @@ class ParallelRangeNode(ParallelStatNode):
         if self.schedule not in (None, 'static', 'dynamic', 'guided', 'runtime'):
             error(self.pos, "Invalid schedule argument to prange: %s" % (self.schedule,))
 
+        if self.reduction_vars is not None:
+            reduction_vars = self.reduction_vars
+            if reduction_vars.is_sequence_constructor:
+                reduction_vars = reduction_vars.args
+            else:
+                reduction_vars = [reduction_vars]
+            if all(var.is_name for var in reduction_vars):
+                self.reduction_vars = reduction_vars
+            else:
+                error(self.reduction_vars.pos,
+                      "reduction argument to prange must be a variable or a tuple of variables")
+                self.reduction_vars = None
+
     def analyse_expressions(self, env):
         was_nogil = env.nogil
         if self.nogil:
@@ -9994,19 +10323,13 @@ class ParallelRangeNode(ParallelStatNode):
             error(self.pos, "prange() can only be used as part of a for loop")
             return self
 
-        self.target = self.target.analyse_target_types(env)
-
-        if not self.target.type.is_numeric:
-            # Not a valid type, assume one for now anyway
-
-            if not self.target.type.is_pyobject:
-                # nogil_check will catch the is_pyobject case
-                error(self.target.pos,
-                      "Must be of numeric type, not %s" % self.target.type)
-
-            self.index_type = PyrexTypes.c_py_ssize_t_type
+        targets = [target.analyse_target_types(env) for target in self.targets()]
+        if self.target.is_sequence_constructor:
+            self.target.args = targets
+            # the tuple itself is never built, only its items are assigned
+            self.target.type = PyrexTypes.error_type
         else:
-            self.index_type = self.target.type
+            self.target, = targets
 
         # Setup start, stop and step, allocating temps if needed
         self.names = 'start', 'stop', 'step'
@@ -10014,31 +10337,66 @@ class ParallelRangeNode(ParallelStatNode):
 
         for node, name in zip(start_stop_step, self.names):
             if node is not None:
-                node.analyse_types(env)
-                if not node.type.is_numeric:
-                    error(node.pos, "%s argument must be numeric" % name)
+                node = node.analyse_types(env)
+                if name == 'stop' and self.start is None and self.is_cpp_sequence(node):
+                    # for x in prange(vec)
+                    self.stop = None
+                    self.sequence = node if node.is_simple() else node.coerce_to_temp(env)
+                    # let the GIL check see the expression that gets evaluated
+                    self.args = [self.sequence]
+                    self.analyse_cpp_sequence(env)
                     continue
+                setattr(self, name, self.analyse_range_argument(node, name, env))
+        if self.extents:
+            self.extents = [self.analyse_range_argument(node.analyse_types(env), 'extent', env)
+                            for node in self.extents]
 
-                if not node.is_literal:
-                    node = node.coerce_to_temp(env)
-                    setattr(self, name, node)
+        if self.sequence is not None:
+            self.index_type = PyrexTypes.c_py_ssize_t_type
+        else:
+            self.index_type = None
+            for target in targets:
+                if not target.type.is_numeric:
+                    # Not a valid type, assume one for now anyway
+
+                    if not target.type.is_pyobject:
+                        # nogil_check will catch the is_pyobject case
+                        error(target.pos,
+                              "Must be of numeric type, not %s" % target.type)
 
+                    target_type = PyrexTypes.c_py_ssize_t_type
+                else:
+                    target_type = target.type
+                self.index_type = PyrexTypes.widest_numeric_type(
+                    self.index_type, target_type) if self.index_type else target_type
+
+            if self.extents:
+                # The product of the extents easily overflows their own type,
+                # so the flattened loop counts in Py_ssize_t.
+                self.index_type = PyrexTypes.c_py_ssize_t_type
+            else:
                 # As we range from 0 to nsteps, computing the index along the
                 # way, we need a fitting type for 'i' and 'nsteps'
-                self.index_type = PyrexTypes.widest_numeric_type(
-                    self.index_type, node.type)
+                for node in (self.start, self.stop, self.step):
+                    if node is not None and node.type.is_numeric:
+                        self.index_type = PyrexTypes.widest_numeric_type(
+                            self.index_type, node.type)
 
         if self.else_clause is not None:
             self.else_clause = self.else_clause.analyse_expressions(env)
 
+        if self.reduction_vars:
+            self.reduction_vars = [var.analyse_types(env) for var in self.reduction_vars]
+
         # Although not actually an assignment in this scope, it should be
         # treated as such to ensure it is unpacked if a closure temp, and to
         # ensure lastprivate behaviour and propagation. If the target index is
         # not a NameNode, it won't have an entry, and an error was issued by
         # ParallelRangeTransform
-        target_entry = getattr(self.target, 'entry', None)
-        if target_entry:
-            self.assignments[self.target.entry] = self.target.pos, None
+        for target in targets:
+            target_entry = getattr(target, 'entry', None)
+            if target_entry:
+                self.assignments[target_entry] = target.pos, None
 
         node = super().analyse_expressions(env)
 
@@ -10061,6 +10419,17 @@ class ParallelRangeNode(ParallelStatNode):
             env.nogil = was_nogil
 
         node.is_nested_prange = node.parent and node.parent.is_prange
+        node.uses_threadpool = (
+            env.directives['parallel_backend'] == 'threadpool' and not node.parent)
+        if node.uses_threadpool:
+            # The outlined loop body refers to these through its context
+            # struct, keep them apart from the variables of nested prange loops.
+            node.parallel_why = Naming.threadpool_why
+            node.parallel_temp_prefix = Naming.threadpool_temp_prefix
+            node.parallel_freethreading_mutex = Naming.threadpool_freethreading_mutex
+            node.parallel_exc = Naming.threadpool_exc_vars
+            node.parallel_pos_info = Naming.threadpool_pos_info
+        node.analyse_reductions(env)
         if node.is_nested_prange:
             parent = node
             while parent.parent and parent.parent.is_prange:
@@ -10071,10 +10440,138 @@ class ParallelRangeNode(ParallelStatNode):
             parent.assigned_nodes.extend(node.assigned_nodes)
         return node
 
+    def analyse_range_argument(self, node, name, env):
+        if not node.type.is_numeric:
+            error(node.pos, "%s argument must be numeric" % name)
+        elif not node.is_literal:
+            node = node.coerce_to_temp(env)
+        return node
+
+    def is_cpp_sequence(self, node):
+        type = node.type
+        if type.is_reference:
+            type = type.ref_base_type
+        return type.is_cpp_class
+
+    def analyse_cpp_sequence(self, env):
+        """
+        Check that 'for x in prange(seq)' iterates over a C++ container with
+        random access iterators, which the loop indexes as '*(seq.begin() + i)'.
+        """
+        sequence_type = self.sequence.type
+        if sequence_type.is_reference:
+            sequence_type = sequence_type.ref_base_type
+        begin = sequence_type.scope.lookup("begin")
+        end = sequence_type.scope.lookup("end")
+        for name, entry in [("begin", begin), ("end", end)]:
+            if entry is None or not entry.type.is_cfunction or entry.type.args:
+                error(self.sequence.pos, "missing %s() on %s" % (name, sequence_type))
+                return
+        iter_type = begin.type.return_type
+        if iter_type.is_ptr:
+            item_type = iter_type.base_type
+        elif iter_type.is_cpp_class:
+            for op, arg_types in [("-", [iter_type, end.type.return_type]),
+                                  ("+", [iter_type, PyrexTypes.c_py_ssize_t_type])]:
+                if env.lookup_operator_for_types(self.pos, op, arg_types) is None:
+                    error(self.sequence.pos, "prange() requires random access iterators, "
+                                             "missing operator%s on result of begin() on %s" % (
+                                                 op, sequence_type))
+                    return
+            deref = env.lookup_operator_for_types(self.pos, "*", [iter_type])
+            if deref is None:
+                error(self.sequence.pos, "missing operator* on result of begin() on %s" % sequence_type)
+                return
+            item_type = deref.type.return_type
+        else:
+            error(self.sequence.pos, "result type of begin() on %s must be a C++ class or pointer" % (
+                sequence_type))
+            return
+        if item_type.is_reference:
+            item_type = item_type.ref_base_type
+        self.iterator_type = iter_type
+        if not self.target.type.assignable_from(item_type):
+            error(self.target.pos, "Cannot assign type '%s' to '%s'" % (item_type, self.target.type))
+
+    def analyse_reductions(self, env):
+        """
+        Check the reductions that are not mapped to OpenMP reduction clauses:
+
+            x = min(x, y) and x = max(x, y)
+                each thread starts with the value of 'x' before the loop,
+                the results are merged in a critical section
+
+            prange(..., reduction=hist) for memoryviews
+                each thread updates a zero initialised buffer of the shape
+                of 'hist', the buffers are added to 'hist' in parallel
+
+            prange(..., reduction=obj) for C++ objects
+                each thread updates a default constructed object, the
+                results are merged with 'obj = obj + thread_obj'
+
+        These are handled by the outermost parallel prange.
+        """
+        for entry, (op, lastprivate) in self.privates.items():
+            if op not in ('min', 'max'):
+                continue
+            if not self.is_parallel:
+                error(self.pos, "min() and max() reductions are not supported "
+                                "in prange loops inside of parallel blocks")
+                break
+            if not (entry.type.is_int or entry.type.is_float):
+                error(self.pos, "min() and max() reductions require a C integer "
+                                "or floating point type, not '%s'" % entry.type)
+
+        if not self.reduction_vars:
+            return
+        if not self.is_parallel or self.is_nested_prange:
+            error(self.pos, "The reduction argument of prange is not supported "
+                            "inside of other parallel sections")
+            return
+
+        for var in self.reduction_vars:
+            entry = var.entry
+            if entry is None:
+                continue
+            type = entry.type
+            if type.is_memoryviewslice:
+                if not (type.dtype.is_int or type.dtype.is_float) or type.dtype.is_const:
+                    error(var.pos, "Memoryview reductions require a writable C integer or "
+                                   "floating point item type, not '%s'" % type.dtype)
+                elif any(access != 'direct' for access, packing in type.axes):
+                    error(var.pos, "Memoryview reductions require direct memory access")
+            elif type.is_cpp_class:
+                if not type.scope or not type.scope.lookup_here('operator+'):
+                    error(var.pos, "C++ reductions require an operator+ to merge "
+                                   "the results of the threads, '%s' has none" % type)
+                elif env.directives['cpp_locals']:
+                    error(var.pos, "C++ reductions are not supported with the "
+                                   "cpp_locals directive")
+            else:
+                error(var.pos, "reduction argument to prange must be a memoryview "
+                               "or C++ object, reductions of C variables are "
+                               "inferred from in-place operators")
+                continue
+
+            op, lastprivate = self.privates.pop(entry, (None, False))
+            if lastprivate and not op:
+                error(var.pos, "Cannot assign to reduction variable '%s'" % entry.name)
+
     def nogil_check(self, env):
-        names = 'start', 'stop', 'step', 'target', 'use_threads_if'
-        nodes = self.start, self.stop, self.step, self.target, self.threading_condition
+        names = 'start', 'stop', 'step', 'sequence', 'use_threads_if'
+        nodes = self.start, self.stop, self.step, self.sequence, self.threading_condition
         self._parameters_nogil_check(env, names, nodes)
+        self._parameters_nogil_check(env, ['target'] * len(self.targets()), self.targets())
+        if self.extents:
+            self._parameters_nogil_check(env, ['extent'] * len(self.extents), self.extents)
+
+    def generate_function_definitions(self, env, code):
+        if self.uses_threadpool:
+            # the loop body goes into a function before the enclosing one
+            self.body_function_code = code.insertion_point()
+        self.body.generate_function_definitions(env, code)
+        if self.else_clause is not None:
+            self.else_clause.generate_function_definitions(env, code)
 
     def generate_execution_code(self, code):
         """
@@ -10114,19 +10611,22 @@ class ParallelRangeNode(ParallelStatNode):
                 'for i from x < i < y:' does not suffer from this problem
                 as the relational operator is known at compile time!
 
+                Collapsed loops 'for i, j in prange(n, m)' run the same loop
+                over nsteps = n * m and compute 'i = temp / m; j = temp % m',
+                and 'for x in prange(vec)' runs it over vec.end() - vec.begin()
+                steps, computing 'x = *(begin + temp)'.
+
             4) release our temps and write back any private closure variables
         """
         self.declare_closure_privates(code)
 
-        # This can only be a NameNode
-        target_index_cname = self.target.entry.cname
-
         # This will be used as the dict to format our code strings, holding
         # the start, stop , step, temps and target cnames
-        fmt_dict = {
-            'target': target_index_cname,
-            'target_type': self.target.type.empty_declaration_code()
-        }
+        fmt_dict = {}
+        if not self.target.is_sequence_constructor:
+            # This can only be a NameNode
+            fmt_dict['target'] = self.target.entry.cname
+            fmt_dict['target_type'] = self.target.type.empty_declaration_code()
 
         # Setup start, stop and step, allocating temps if needed
         start_stop_step = self.start, self.stop, self.step
@@ -10142,10 +10642,24 @@ class ParallelRangeNode(ParallelStatNode):
 
             fmt_dict[name] = result
 
+        fmt_dict['extents'] = extents = []
+        for node in self.extents or ():
+            if node.is_literal:
+                result = node.get_constant_c_result_code()
+            else:
+                node.generate_evaluation_code(code)
+                result = node.result()
+            extents.append(self.index_type.cast_code("(%s)" % result))
+        if self.sequence is not None:
+            self.sequence.generate_evaluation_code(code)
+            fmt_dict['sequence'] = self.sequence.result()
+            fmt_dict['iterator'] = code.funcstate.allocate_temp(self.iterator_type, False)
+
         if self.threading_condition is not None:
             self.threading_condition.generate_evaluation_code(code)
 
-        fmt_dict['i'] = code.funcstate.allocate_temp(self.index_type, False)
+        if not self.uses_threadpool:
+            fmt_dict['i'] = code.funcstate.allocate_temp(self.index_type, False)
         fmt_dict['nsteps'] = code.funcstate.allocate_temp(self.index_type, False)
 
         # TODO: check if the step is 0 and if so, raise an exception in a
@@ -10156,9 +10670,21 @@ class ParallelRangeNode(ParallelStatNode):
             code.putln("if (((%(step)s) == 0)) abort();" % fmt_dict)
 
         self.setup_parallel_control_flow_block(code)  # parallel control flow block
+        reductions_setup_code = code.insertion_point()
+        self.allocate_reduction_temps(code)
 
         # Note: nsteps is private in an outer scope if present
-        code.putln("%(nsteps)s = (%(stop)s - %(start)s + %(step)s - %(step)s/abs(%(step)s)) / %(step)s;" % fmt_dict)
+        if self.sequence is not None:
+            code.putln("%(iterator)s = %(sequence)s.begin();" % fmt_dict)
+            code.putln("%(nsteps)s = %(sequence)s.end() - %(iterator)s;" % fmt_dict)
+        elif self.extents:
+            # an empty extent leaves the targets unaffected, as for nested loops
+            code.putln("%s = (%s) ? %s : 0;" % (
+                fmt_dict['nsteps'],
+                " && ".join("%s > 0" % extent for extent in extents),
+                " * ".join(extents)))
+        else:
+            code.putln("%(nsteps)s = (%(stop)s - %(start)s + %(step)s - %(step)s/abs(%(step)s)) / %(step)s;" % fmt_dict)
 
         # The target iteration variable might not be initialized, do it only if
         # we are executing at least 1 iteration, otherwise we should leave the
@@ -10168,14 +10694,21 @@ class ParallelRangeNode(ParallelStatNode):
         # target index uninitialized
         code.putln("if (%(nsteps)s > 0)" % fmt_dict)
         code.begin_block()  # if block
-        self.generate_loop(code, fmt_dict)
+        if self.uses_threadpool:
+            self.generate_threadpool_loop(code, fmt_dict)
+        else:
+            self.generate_loop(code, fmt_dict)
         code.end_block()  # end if block
 
+        # num_threads is known after generating the loop
+        self.setup_reductions(reductions_setup_code)
+        self.finish_reductions(code)
+
         self.restore_labels(code)
 
         if self.else_clause:
             if self.breaking_label_used:
-                code.put("if (%s < 2)" % Naming.parallel_why)
+                code.put("if (%s < 2)" % self.parallel_why)
 
             code.begin_block()  # else block
             code.putln("/* else */")
@@ -10187,12 +10720,16 @@ class ParallelRangeNode(ParallelStatNode):
 
         # And finally, release our privates and write back any closure
         # variables
-        for temp in start_stop_step + (self.chunksize, self.threading_condition):
+        for temp in start_stop_step + tuple(self.extents or ()) + (
+                self.sequence, self.chunksize, self.threading_condition):
             if temp is not None:
                 temp.generate_disposal_code(code)
                 temp.free_temps(code)
 
-        code.funcstate.release_temp(fmt_dict['i'])
+        if self.sequence is not None:
+            code.funcstate.release_temp(fmt_dict['iterator'])
+        if not self.uses_threadpool:
+            code.funcstate.release_temp(fmt_dict['i'])
         code.funcstate.release_temp(fmt_dict['nsteps'])
 
         self.release_closure_privates(code)
@@ -10222,6 +10759,7 @@ class ParallelRangeNode(ParallelStatNode):
 
             # Initialize the GIL if needed for this thread
             self.begin_parallel_block(code)
+            self.begin_reductions(code)
 
             if self.is_nested_prange:
                 code.putln("#if 0")
@@ -10229,9 +10767,13 @@ class ParallelRangeNode(ParallelStatNode):
                 code.putln("#ifdef _OPENMP")
             code.put("#pragma omp for")
 
+        target_entries = [target.entry for target in self.targets()]
         for entry, (op, lastprivate) in sorted(self.privates.items()):
+            if op in ('min', 'max'):
+                # see allocate_reduction_temps()
+                continue
             # Don't declare the index variable as a reduction
-            if op and op in "+*-&^|" and entry != self.target.entry:
+            if op and op in "+*-&^|" and entry not in target_entries:
                 if entry.type.is_pyobject:
                     error(self.pos, "Python objects cannot be reductions")
                 else:
@@ -10240,7 +10782,7 @@ class ParallelRangeNode(ParallelStatNode):
                     reduction_codepoint.put(
                                 " reduction(%s:%s)" % (op, entry.cname))
             else:
-                if entry == self.target.entry:
+                if entry in target_entries:
                     code.put(" firstprivate(%s)" % entry.cname)
                     code.put(" lastprivate(%s)" % entry.cname)
                     continue
@@ -10261,6 +10803,11 @@ class ParallelRangeNode(ParallelStatNode):
 
             code.put(" schedule(%s%s)" % (self.schedule, chunksize))
 
+        for entry, op, shared in self.minmax_reductions:
+            reduction_codepoint.put(" firstprivate(%s)" % entry.cname)
+        for entry in [reduction[0] for reduction in self.memoryview_reductions + self.cpp_reductions]:
+            reduction_codepoint.put(" private(%s)" % entry.cname)
+
         self.put_num_threads(reduction_codepoint)
 
         code.putln("")
@@ -10275,8 +10822,7 @@ class ParallelRangeNode(ParallelStatNode):
         # at least it doesn't spoil indentation
         code.begin_block()
 
-        code.putln("%(target)s = (%(target_type)s)(%(start)s + %(step)s * %(i)s);" % fmt_dict)
-        self.initialize_privates_to_nan(code, exclude=self.target.entry)
+        self.put_target_assignments(code, fmt_dict)
 
         if self.is_parallel and not self.is_nested_prange:
             # nested pranges are not omp'ified, temps go to outer loops
@@ -10291,16 +10837,601 @@ class ParallelRangeNode(ParallelStatNode):
         if self.breaking_label_used:
             # Put a guard around the loop body in case return, break or
             # exceptions might be used
-            guard_around_body_codepoint.putln("if (%s < 2)" % Naming.parallel_why)
+            guard_around_body_codepoint.putln("if (%s < 2)" % self.parallel_why)
 
         code.end_block()  # end guard around loop body
         code.end_block()  # end for loop block
 
         if self.is_parallel:
+            self.merge_reductions(code)
+
             # Release the GIL and deallocate the thread state
             self.end_parallel_block(code)
             code.end_block()  # pragma omp parallel end block
 
+    def put_target_assignments(self, code, fmt_dict):
+        """
+        Compute the target iteration variables from the loop counter.
+        """
+        targets = self.targets()
+        if self.sequence is not None:
+            code.putln("%s = *(%s + %s);" % (
+                self.target.entry.cname, fmt_dict['iterator'], fmt_dict['i']))
+        elif self.extents:
+            extents = fmt_dict['extents']
+            for dim, target in enumerate(targets):
+                index = fmt_dict['i']
+                if dim + 1 < len(extents):
+                    index = "%s / (%s)" % (index, " * ".join(extents[dim + 1:]))
+                if dim:
+                    index = "(%s) %% %s" % (index, extents[dim])
+                code.putln("%s = (%s)(%s);" % (
+                    target.entry.cname, target.type.empty_declaration_code(), index))
+        else:
+            code.putln("%(target)s = (%(target_type)s)(%(start)s + %(step)s * %(i)s);" % fmt_dict)
+        self.initialize_privates_to_nan(
+            code, exclude=[target.entry for target in targets])
+
+    threadpool_counter = 0
+
+    threadpool_schedules = {
+        None: '__Pyx_ThreadPool_SCHEDULE_STEAL',
+        'runtime': '__Pyx_ThreadPool_SCHEDULE_STEAL',
+        'static': '__Pyx_ThreadPool_SCHEDULE_STATIC',
+        'dynamic': '__Pyx_ThreadPool_SCHEDULE_DYNAMIC',
+        'guided': '__Pyx_ThreadPool_SCHEDULE_GUIDED',
+    }
+
+    def generate_threadpool_loop(self, code, fmt_dict):
+        """
+        Generate the loop for the thread pool of the 'parallel_backend'
+        directive.  The loop body becomes a function that each thread of the
+        pool calls with a struct of the loop bounds and of pointers to the
+        variables of the enclosing function.  As in closures, the body refers
+        to the shared variables through the struct:
+
+            struct __pyx_prange_ctx0 { long __pyx_nsteps; int *__pyx_v_n; int *__pyx_v_sum; ... };
+
+            static void __pyx_prange_body0(void *ctx, void *thread) {
+                int __pyx_v_sum = 0;  /* privates and reductions */
+
+                while (__Pyx_ThreadPool_NextChunk(thread, &begin, &end)) {
+                    for (i = begin; i < end; i++) {
+                        ... (*__pyx_pool_ctx->__pyx_v_n) ...
+                    }
+                    if (end == __pyx_pool_ctx->__pyx_nsteps) {
+                        /* store the lastprivates */
+                    }
+                }
+                /* merge the reductions in a critical section */
+            }
+
+        The shared variables are the local variables of the enclosing function
+        that the body uses, and the control flow variables and temps of this loop.
+        """
+        code.globalstate.use_utility_code(
+            UtilityCode.load_cached("ThreadPool", "Parallel.c"))
+        body_cname = "%s%d" % (Naming.threadpool_body_prefix, self.threadpool_counter)
+        ctx_type = "struct %s%d" % (Naming.threadpool_ctx_prefix, self.threadpool_counter)
+        ParallelRangeNode.threadpool_counter += 1
+        ctx = Naming.threadpool_ctx
+        thread = Naming.threadpool_thread
+        cpp_locals = code.globalstate.directives['cpp_locals']
+        scope = code.funcstate.scope
+
+        fields = []  # [(name, declaration, preprocessor guard, value in the enclosing function)]
+
+        def add_value(name, type, value):
+            fields.append((name, type.declaration_code(name), None, value))
+            return "%s->%s" % (ctx, name)
+
+        def add_shared(cname, type, is_cpp_optional=None):
+            fields.append((cname, self.threadpool_declaration(
+                code, type, cname, pointer=True, is_cpp_optional=is_cpp_optional), None, "&%s" % cname))
+
+        fcode = self.body_function_code
+        self.body_function_code = None
+        fcode.enter_cfunc_scope(scope)
+        # privates that replace closure variables are named like the temps of the enclosing function
+        fcode.funcstate.names_taken = set(
+            name for name, type, manage_ref, static in code.funcstate.temps_allocated)
+        fcode.funcstate.gil_owned = False
+        fcode.funcstate.should_declare_error_indicator = True
+        fcode.new_loop_labels()
+
+        fcode.putln("")
+        struct_code = fcode.insertion_point()
+        fcode.putln("static void %s(void *%s_arg, void *%s) {" % (body_cname, ctx, thread))
+        fcode.putln("%s *%s = (%s *) %s_arg;" % (ctx_type, ctx, ctx_type, ctx))
+        decl_code = fcode.insertion_point()
+        gil_code = fcode.insertion_point()
+
+        # Declare the privates, starting with the identity of the reductions,
+        # and the values of the lastprivates and min() and max() reductions.
+        identities = {'+': '0', '-': '0', '|': '0', '^': '0', '*': '1', '&': '~0'}
+        lastprivates = []
+        op_reductions = []
+        target_entries = [target.entry for target in self.targets()]
+        for entry, (op, lastprivate) in sorted(self.privates.items()):
+            if entry.type.is_pyobject:
+                # shared, as with OpenMP
+                continue
+            init = ''
+            is_shared = True
+            if op in identities and entry not in target_entries:
+                init = ' = %s' % entry.type.cast_code(identities[op])
+                op_reductions.append((entry, op))
+            elif op in ('min', 'max') or lastprivate:
+                if lastprivate:
+                    lastprivates.append(entry)
+                if not (entry.type.is_cpp_class and not entry.type.is_fake_reference and cpp_locals):
+                    # C++ optionals start empty, as the lastprivates of OpenMP
+                    init = ' = *%s->%s' % (ctx, entry.cname)
+            else:
+                is_shared = False
+            decl_code.putln("%s%s;" % (
+                self.threadpool_declaration(code, entry.type, entry.cname), init))
+            if is_shared:
+                add_shared(entry.cname, entry.type)
+        for entry in [reduction[0] for reduction in self.memoryview_reductions + self.cpp_reductions]:
+            decl_code.putln("%s;" % entry.type.declaration_code(entry.cname))
+
+        # Pass the loop bounds by value.
+        loop_dict = dict(fmt_dict, thread=thread, ctx=ctx)
+        loop_dict['nsteps'] = add_value(Naming.pyrex_prefix + 'nsteps', self.index_type, fmt_dict['nsteps'])
+        if self.sequence is not None:
+            loop_dict['iterator'] = add_value(
+                Naming.pyrex_prefix + 'iterator', self.iterator_type, fmt_dict['iterator'])
+        elif self.extents:
+            loop_dict['extents'] = [
+                add_value("%sextent%d" % (Naming.pyrex_prefix, dim), self.index_type, extent)
+                for dim, extent in enumerate(fmt_dict['extents'])]
+        else:
+            for name in ('start', 'step'):
+                loop_dict[name] = add_value(Naming.pyrex_prefix + name, self.index_type, fmt_dict[name])
+
+        # While generating the body, refer to the shared variables through the struct.
+        used_entries = self.threadpool_used_entries()
+        shared_entries = self.threadpool_shared_entries(scope, used_entries)
+        original_cnames = [entry.cname for entry in shared_entries]
+        for entry in shared_entries:
+            entry.cname = self.threadpool_shared_code(entry.cname)
+        shared_code = self.threadpool_shared_code
+        control_flow = (
+            self.parallel_why, self.parallel_exc, self.parallel_pos_info, self.parallel_freethreading_mutex)
+        reductions = (self.minmax_reductions, self.cpp_reductions, self.memoryview_reductions)
+        self.parallel_why = shared_code(self.parallel_why)
+        self.parallel_exc = tuple(shared_code(cname) for cname in self.parallel_exc)
+        self.parallel_pos_info = tuple(shared_code(cname) for cname in self.parallel_pos_info)
+        self.parallel_freethreading_mutex = shared_code(self.parallel_freethreading_mutex)
+        self.minmax_reductions = [
+            (entry, op, shared_code(shared)) for entry, op, shared in self.minmax_reductions]
+        self.cpp_reductions = [
+            (entry, shared_code(pointer)) for entry, pointer in self.cpp_reductions]
+        self.memoryview_reductions = [
+            (entry, shared_code(shared), shared_code(size), shared_code(buffer))
+            for entry, shared, size, buffer in self.memoryview_reductions]
+
+        self.begin_reductions(fcode)
+
+        loop_dict['i'] = fcode.funcstate.allocate_temp(self.index_type, False)
+        loop_dict['begin'] = fcode.funcstate.allocate_temp(PyrexTypes.c_py_ssize_t_type, False)
+        loop_dict['end'] = fcode.funcstate.allocate_temp(PyrexTypes.c_py_ssize_t_type, False)
+
+        fcode.put("while (")
+        guard_around_loop_codepoint = fcode.insertion_point()
+        fcode.putln("__Pyx_ThreadPool_NextChunk(%(thread)s, &%(begin)s, &%(end)s)) {" % loop_dict)
+        fcode.put("for (%(i)s = %(begin)s; %(i)s < %(end)s; %(i)s++)" % loop_dict)
+        fcode.begin_block()  # for loop block
+        guard_around_body_codepoint = fcode.insertion_point()
+        fcode.begin_block()
+        self.put_target_assignments(fcode, loop_dict)
+        self.body.generate_execution_code(fcode)
+        self.trap_parallel_exit(fcode, should_flush=True)
+        if self.breaking_label_used:
+            guard_around_loop_codepoint.put("%s < 2 && " % self.parallel_why)
+            guard_around_body_codepoint.putln("if (%s < 2)" % self.parallel_why)
+        fcode.end_block()  # end guard around loop body
+        fcode.end_block()  # end for loop block
+
+        # The thread that ran the last iteration stores the lastprivates.
+        fcode.putln("if (%(end)s == (Py_ssize_t) %(nsteps)s) {" % loop_dict)
+        for entry in lastprivates:
+            value = entry.cname
+            if entry.type.is_cpp_class:
+                # this thread is done with its private copy
+                code.globalstate.use_utility_code(
+                    UtilityCode.load_cached("MoveIfSupported", "CppSupport.cpp"))
+                value = "__PYX_STD_MOVE_IF_SUPPORTED(%s)" % value
+            fcode.putln("*%s->%s = %s;" % (ctx, entry.cname, value))
+        fcode.putln("}")
+        fcode.putln("}")  # end while loop
+        for name in ('i', 'begin', 'end'):
+            fcode.funcstate.release_temp(loop_dict[name])
+
+        if op_reductions or self.minmax_reductions or self.cpp_reductions or self.memoryview_reductions:
+            self.begin_critical_section(fcode, None)
+            for entry, op in op_reductions:
+                fcode.putln("*%s->%s = *%s->%s %s %s;" % (
+                    ctx, entry.cname, ctx, entry.cname, '+' if op == '-' else op, entry.cname))
+            for entry, op, shared in self.minmax_reductions:
+                fcode.putln("if (%s %s %s) %s = %s;" % (
+                    entry.cname, '<' if op == 'min' else '>', shared, shared, entry.cname))
+            for entry, pointer in self.cpp_reductions:
+                fcode.putln("*%s = *%s + %s;" % (pointer, pointer, entry.cname))
+            for entry, shared, size, buffer in self.memoryview_reductions:
+                # add the contiguous buffer of this thread to the shared slice
+                dtype = entry.type.dtype.empty_declaration_code()
+                fcode.begin_block()
+                fcode.putln("Py_ssize_t __pyx_reduction_item;")
+                fcode.putln("for (__pyx_reduction_item = 0; __pyx_reduction_item < %s; __pyx_reduction_item++) {" % size)
+                fcode.putln("Py_ssize_t __pyx_reduction_index = __pyx_reduction_item;")
+                fcode.putln("char *__pyx_reduction_data = %s.data;" % shared)
+                for dim in range(entry.type.ndim - 1, 0, -1):
+                    fcode.putln("__pyx_reduction_data += (__pyx_reduction_index %% %s.shape[%d]) * %s.strides[%d];" % (
+                        shared, dim, shared, dim))
+                    fcode.putln("__pyx_reduction_index /= %s.shape[%d];" % (shared, dim))
+                fcode.putln("__pyx_reduction_data += __pyx_reduction_index * %s.strides[0];" % shared)
+                fcode.putln("*(%s *) __pyx_reduction_data += ((%s *) %s.data)[__pyx_reduction_item];" % (
+                    dtype, dtype, entry.cname))
+                fcode.putln("}")
+                fcode.end_block()
+            self.end_critical_section(fcode)
+
+        for entry, cname in zip(shared_entries, original_cnames):
+            entry.cname = cname
+        (self.parallel_why, self.parallel_exc, self.parallel_pos_info,
+            self.parallel_freethreading_mutex) = control_flow
+        self.minmax_reductions, self.cpp_reductions, self.memoryview_reductions = reductions
+
+        if self.error_label_used:
+            # As in end_parallel_block(), keep a thread state while running
+            # the body, and release the GIL.
+            gil_code.put_ensure_gil(declare_gilstate=True)
+            gil_code.putln("Py_BEGIN_ALLOW_THREADS")
+            fcode.putln("Py_END_ALLOW_THREADS")
+            fcode.putln("/* Clean up any temporaries */")
+            for temp, type, manage_ref, static in sorted(fcode.funcstate.temps_allocated):
+                if type.is_pyobject or type.is_memoryviewslice:
+                    fcode.put_xdecref_clear(temp, type, have_gil=False)
+            fcode.put_release_ensured_gil()
+        fcode.putln("}")
+
+        # Pass the variables that the body used, and copy the closure scopes
+        # and the refnanny context of the enclosing function.
+        for entry in shared_entries:
+            add_shared(entry.cname, entry.type, entry.is_cpp_optional)
+        for cname, type in self.threadpool_scope_variables(scope, used_entries):
+            decl_code.putln("%s = %s;" % (type.declaration_code(cname), add_value(cname, type, cname)))
+        if self.breaking_label_used:
+            add_shared(self.parallel_why, PyrexTypes.c_int_type)
+        if self.error_label_used:
+            for cname in self.parallel_exc:
+                add_shared(cname, py_object_type)
+            for cname, type in zip(self.parallel_pos_info, (
+                    PyrexTypes.c_const_char_ptr_type, PyrexTypes.c_int_type, PyrexTypes.c_int_type)):
+                add_shared(cname, type)
+            fields.append((self.parallel_freethreading_mutex, "PyMutex *%s" % self.parallel_freethreading_mutex,
+                           "CYTHON_COMPILING_IN_CPYTHON_FREETHREADING", "&%s" % self.parallel_freethreading_mutex))
+        for temp_cname, private_cname, type in self.parallel_private_temps:
+            add_shared(temp_cname, type, type.is_cpp_class and not type.is_fake_reference and cpp_locals)
+        for entry, op, shared in self.minmax_reductions:
+            add_shared(shared, entry.type)
+        for entry, pointer in self.cpp_reductions:
+            add_shared(pointer, PyrexTypes.c_ptr_type(entry.type))
+        for entry, shared, size, buffer in self.memoryview_reductions:
+            add_shared(shared, entry.type)
+            add_shared(size, PyrexTypes.c_py_ssize_t_type)
+            add_shared(buffer, PyrexTypes.c_char_ptr_type)
+        return_type = self.threadpool_return_type(scope)
+        if return_type is not None and fcode.label_used(fcode.return_label):
+            # see trap_parallel_exit()
+            add_shared(Naming.retval_cname, return_type)
+            decl_code.putln("%s = *%s->%s;" % (
+                return_type.declaration_code(Naming.retval_cname), ctx, Naming.retval_cname))
+        if fcode.funcstate.needs_refnanny:
+            # use the refnanny context of the enclosing function
+            code.funcstate.needs_refnanny = True
+            fields.append(("__pyx_refnanny", "void *__pyx_refnanny", "CYTHON_REFNANNY", "__pyx_refnanny"))
+            self.put_guarded(decl_code, "CYTHON_REFNANNY", "void *__pyx_refnanny = %s->__pyx_refnanny;" % ctx)
+
+        decl_code.put_temp_declarations(fcode.funcstate)
+        # The body jumps to its own labels, let the enclosing function
+        # know which ways out of the loop it needs to handle.
+        for label, outer_label in zip(fcode.get_all_labels(), code.get_all_labels()):
+            if fcode.label_used(label):
+                code.use_label(outer_label)
+        fcode.exit_cfunc_scope()
+
+        struct_code.putln("%s {" % ctx_type)
+        for name, declaration, guard, value in fields:
+            self.put_guarded(struct_code, guard, "%s;" % declaration)
+        struct_code.putln("};")
+
+        # Run the loop.
+        code.begin_block()
+        code.putln("%s %s;" % (ctx_type, ctx))
+        for name, declaration, guard, value in fields:
+            self.put_guarded(code, guard, "%s.%s = %s;" % (ctx, name, value))
+
+        num_threads = "0"
+        if self.num_threads is not None:
+            num_threads = self.evaluate_before_block(code, self.num_threads)
+        if self.threading_condition is not None:
+            num_threads = "(%s) ? %s : 1" % (self.threading_condition.result(), num_threads)
+        chunksize = "0"
+        if self.chunksize is not None:
+            chunksize = self.evaluate_before_block(code, self.chunksize)
+
+        if self.error_label_used:
+            # Threads that need the GIL must not wait for this one.
+            code.put_ensure_gil(declare_gilstate=True)
+            code.putln("Py_BEGIN_ALLOW_THREADS")
+        code.putln("__Pyx_ThreadPool_Run(%s, &%s, (Py_ssize_t) %s, %s, %s, %s);" % (
+            body_cname, ctx, fmt_dict['nsteps'], self.threadpool_schedules[self.schedule],
+            chunksize, num_threads))
+        if self.error_label_used:
+            code.putln("Py_END_ALLOW_THREADS")
+            code.put_release_ensured_gil()
+        code.end_block()
+
+    def threadpool_used_entries(self):
+        """
+        Collect the entries that the nodes of the loop body refer to.
+        """
+        used_entries = set()
+        nodes = [self.body]
+        while nodes:
+            node = nodes.pop()
+            if isinstance(node, list):
+                nodes.extend(node)
+                continue
+            entry = getattr(node, 'entry', None)
+            if entry is not None:
+                used_entries.add(entry)
+            for attr in node.child_attrs:
+                child = getattr(node, attr, None)
+                if child is not None:
+                    nodes.append(child)
+        return used_entries
+
+    def threadpool_shared_entries(self, scope, used_entries):
+        """
+        Find the local variables of the enclosing function that the loop body
+        uses and that are not private to its threads.  Variables in closure
+        scopes are reached through the scope object instead, unless they were
+        copied to temps by declare_closure_privates().
+        """
+        if scope is None or scope.is_module_scope:
+            return []
+        closure_privates = set(entry for entry, original_cname in self.modified_entries)
+        private_entries = set(entry for entry in self.privates if not entry.type.is_pyobject)
+        private_entries.update(reduction[0] for reduction in self.memoryview_reductions + self.cpp_reductions)
+
+        shared_entries = []
+        for entry in scope.var_entries + scope.arg_entries:
+            if entry not in used_entries or not entry.cname or entry in private_entries:
+                continue
+            if (entry.in_closure or entry.from_closure) and entry not in closure_privates:
+                continue
+            shared_entries.append(entry)
+            if entry.buffer_aux is not None:
+                shared_entries.append(entry.buffer_aux.buflocal_nd_var)
+                shared_entries.append(entry.buffer_aux.rcbuf_var)
+        return shared_entries
+
+    def threadpool_scope_variables(self, scope, used_entries):
+        """
+        Yield (cname, type) for the closure scope objects of the enclosing
+        function, if the loop body uses variables of closures.
+        """
+        if scope is None or scope.is_module_scope:
+            return
+        closure_privates = set(entry for entry, original_cname in self.modified_entries)
+        closure_entries = [
+            entry for entry in used_entries
+            if (entry.in_closure or entry.from_closure) and entry not in closure_privates]
+        if not closure_entries:
+            return
+        scope_class = getattr(scope, 'scope_class', None)
+        if scope_class is not None:
+            yield Naming.cur_scope_cname, scope_class.type
+        if scope_class is None or scope.is_passthrough:
+            # otherwise, the outer scope is a field of the current one
+            outer_scope = scope.outer_scope
+            while outer_scope is not None and (outer_scope.is_py_class_scope or outer_scope.is_c_class_scope):
+                outer_scope = outer_scope.outer_scope
+            if outer_scope is not None and getattr(outer_scope, 'scope_class', None) is not None:
+                if any(entry.from_closure for entry in closure_entries):
+                    yield Naming.outer_scope_cname, outer_scope.scope_class.type
+
+    def threadpool_return_type(self, scope):
+        """
+        The type of the return value variable of the enclosing function, or None.
+        """
+        return_type = scope.return_type if scope is not None and not scope.is_module_scope else None
+        if return_type is None or return_type.is_void:
+            return None
+        if return_type.is_cv_qualified and return_type.is_const:
+            return_type = return_type.cv_base_type
+        return return_type
+
+    def threadpool_shared_code(self, cname):
+        """
+        The C expression that refers to a shared variable of the enclosing
+        function from the body function of the thread pool.
+        """
+        return "(*%s->%s)" % (Naming.threadpool_ctx, cname)
+
+    def threadpool_declaration(self, code, type, cname, pointer=False, is_cpp_optional=None):
+        if is_cpp_optional is None:
+            is_cpp_optional = (
+                type.is_cpp_class and not type.is_fake_reference and code.globalstate.directives['cpp_locals'])
+        if is_cpp_optional:
+            return type.cpp_optional_declaration_code("*%s" % cname if pointer else cname)
+        if pointer:
+            type = PyrexTypes.c_ptr_type(type)
+        return type.declaration_code(cname)
+
+    def put_guarded(self, code, guard, line):
+        if guard:
+            code.putln("#if %s" % guard)
+        code.putln(line)
+        if guard:
+            code.putln("#endif")
+
+    def allocate_reduction_temps(self, code):
+        """
+        Allocate the shared state of the reductions described in
+        analyse_reductions(), before generating the parallel section.
+        """
+        self.minmax_reductions = []
+        self.memoryview_reductions = []
+        self.cpp_reductions = []
+        if not self.is_parallel or self.is_nested_prange:
+            return
+
+        allocate_temp = code.funcstate.allocate_temp
+        for entry, (op, lastprivate) in sorted(self.privates.items()):
+            if op in ('min', 'max'):
+                self.minmax_reductions.append((entry, op, allocate_temp(entry.type, False)))
+
+        for var in self.reduction_vars or ():
+            entry = var.entry
+            if entry.type.is_memoryviewslice:
+                self.memoryview_reductions.append((
+                    entry,
+                    allocate_temp(entry.type, False),
+                    allocate_temp(PyrexTypes.c_py_ssize_t_type, False),
+                    allocate_temp(PyrexTypes.c_char_ptr_type, False),
+                ))
+            else:
+                self.cpp_reductions.append((entry, allocate_temp(PyrexTypes.c_ptr_type(entry.type), False)))
+
+    def setup_reductions(self, code):
+        """
+        Save the initial values and allocate the per-thread memoryview buffers.
+        This runs outside of the parallel section, so errors go to the old
+        error label.
+        """
+        for entry, op, shared in self.minmax_reductions:
+            code.putln("%s = %s;" % (shared, entry.cname))
+        for entry, pointer in self.cpp_reductions:
+            code.putln("%s = &%s;" % (pointer, entry.cname))
+        if not self.memoryview_reductions:
+            return
+
+        code.globalstate.use_utility_code(
+            UtilityCode.load_cached("ParallelReductionBuffer", "Parallel.c"))
+        num_threads = self.num_threads.result() if self.num_threads is not None else "0"
+        if self.uses_threadpool:
+            num_threads = "__Pyx_ThreadPool_MaxThreads(%s)" % num_threads
+
+        error_label = code.error_label
+        code.error_label = self.old_error_label
+        allocated = []
+        for entry, shared, size, buffer in self.memoryview_reductions:
+            code.putln("%s = %s;" % (shared, entry.cname))
+            code.putln("%s = %s;" % (size, " * ".join(
+                "%s.shape[%d]" % (entry.cname, dim) for dim in range(entry.type.ndim))))
+            code.putln("%s = __Pyx_ParallelReductionBuffer(%s, %s * (Py_ssize_t) sizeof(%s));" % (
+                buffer, num_threads, size, entry.type.dtype.empty_declaration_code()))
+            code.putln("if (unlikely(!%s)) {" % buffer)
+            for allocated_buffer in allocated:
+                code.putln("free(%s);" % allocated_buffer)
+            code.putln(code.error_goto(self.pos))
+            code.putln("}")
+            allocated.append(buffer)
+        code.error_label = error_label
+
+    def begin_reductions(self, code):
+        """
+        Point the private memoryview slices of each thread to its own buffer.
+        """
+        for entry, shared, size, buffer in self.memoryview_reductions:
+            dtype = entry.type.dtype.empty_declaration_code()
+            ndim = entry.type.ndim
+            code.putln("%s = %s;" % (entry.cname, shared))
+            if self.uses_threadpool:
+                code.putln("%s.data = %s + (size_t) __Pyx_ThreadPool_ThreadNum(%s) * (size_t) %s * sizeof(%s);" % (
+                    entry.cname, buffer, Naming.threadpool_thread, size, dtype))
+            else:
+                code.putln("#ifdef _OPENMP")
+                code.putln("%s.data = %s + (size_t) omp_get_thread_num() * (size_t) %s * sizeof(%s);" % (
+                    entry.cname, buffer, size, dtype))
+                code.putln("#else")
+                code.putln("%s.data = %s;" % (entry.cname, buffer))
+                code.putln("#endif /* _OPENMP */")
+            code.putln("%s.strides[%d] = sizeof(%s);" % (entry.cname, ndim - 1, dtype))
+            for dim in range(ndim - 2, -1, -1):
+                code.putln("%s.strides[%d] = %s.strides[%d] * %s.shape[%d];" % (
+                    entry.cname, dim, entry.cname, dim + 1, entry.cname, dim + 1))
+
+    def merge_reductions(self, code):
+        """
+        Merge the results of the threads at the end of the parallel section.
+        """
+        if self.minmax_reductions or self.cpp_reductions:
+            code.putln_openmp("#pragma omp critical(__pyx_parallel_reductions)")
+            code.begin_block()
+            for entry, op, shared in self.minmax_reductions:
+                code.putln("if (%s %s %s) %s = %s;" % (
+                    entry.cname, '<' if op == 'min' else '>', shared, shared, entry.cname))
+            if self.cpp_reductions:
+                # Without OpenMP, the loop updates the original objects.
+                code.putln("#ifdef _OPENMP")
+                for entry, pointer in self.cpp_reductions:
+                    code.putln("*%s = *%s + %s;" % (pointer, pointer, entry.cname))
+                code.putln("#endif /* _OPENMP */")
+            code.end_block()
+
+        # After the implicit barrier of the loop, add up the memoryview buffers
+        # of all threads, with the items split between the threads.
+        for entry, shared, size, buffer in self.memoryview_reductions:
+            dtype = entry.type.dtype.empty_declaration_code()
+            code.begin_block()
+            code.putln("Py_ssize_t __pyx_reduction_item;")
+            code.putln("int __pyx_reduction_thread, __pyx_reduction_threads = 1;")
+            code.putln("#ifdef _OPENMP")
+            code.putln("__pyx_reduction_threads = omp_get_num_threads();")
+            code.putln("#pragma omp for")
+            code.putln("#endif /* _OPENMP */")
+            code.putln("for (__pyx_reduction_item = 0; __pyx_reduction_item < %s; __pyx_reduction_item++) {" % size)
+            code.putln("%s __pyx_reduction_sum = 0;" % dtype)
+            code.putln("Py_ssize_t __pyx_reduction_index = __pyx_reduction_item;")
+            code.putln("char *__pyx_reduction_data = %s.data;" % shared)
+            code.putln("for (__pyx_reduction_thread = 0; __pyx_reduction_thread < __pyx_reduction_threads; __pyx_reduction_thread++) {")
+            code.putln("__pyx_reduction_sum += ((%s *) %s)[__pyx_reduction_thread * %s + __pyx_reduction_item];" % (
+                dtype, buffer, size))
+            code.putln("}")
+            for dim in range(entry.type.ndim - 1, 0, -1):
+                code.putln("__pyx_reduction_data += (__pyx_reduction_index %% %s.shape[%d]) * %s.strides[%d];" % (
+                    shared, dim, shared, dim))
+                code.putln("__pyx_reduction_index /= %s.shape[%d];" % (shared, dim))
+            code.putln("__pyx_reduction_data += __pyx_reduction_index * %s.strides[0];" % shared)
+            code.putln("*(%s *) __pyx_reduction_data += __pyx_reduction_sum;" % dtype)
+            code.putln("}")
+            code.end_block()
+
+    def finish_reductions(self, code):
+        """
+        Store the merged results after the parallel section and release the
+        shared state.
+        """
+        release_temp = code.funcstate.release_temp
+        for entry, op, shared in self.minmax_reductions:
+            code.putln("%s = %s;" % (entry.cname, shared))
+            release_temp(shared)
+        for entry, shared, size, buffer in self.memoryview_reductions:
+            # restore the data pointer and strides if the slice was not private
+            code.putln("%s = %s;" % (entry.cname, shared))
+            code.putln("free(%s);" % buffer)
+            release_temp(shared)
+            release_temp(size)
+            release_temp(buffer)
+        for entry, pointer in self.cpp_reductions:
+            release_temp(pointer)
+
 
 class CnameDecoratorNode(StatNode):
     """
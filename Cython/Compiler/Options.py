@@ -200,8 +200,10 @@ _directive_defaults = {
     'nogil' : False,
     'gil' : False,
     'with_gil' : False,
+    'critical_section' : False,  # lock 'self' in extension type methods (free-threading)
     'profile': False,
     'linetrace': False,
+    'sampling_profile': False,
     'emit_code_comments': True,  # copy original source code into C code comments
     'annotation_typing': True,  # read type declarations from Python function annotations
     'infer_types': None,
@@ -222,6 +224,7 @@ _directive_defaults = {
     'np_pythran': False,
     'fast_gil': False,
     'cpp_locals': False,  # uses std::optional for C++ locals, so that they work more like Python locals
+    'parallel_backend': 'openmp',  # run prange loops with OpenMP or on Cython's own thread pool
     'legacy_implicit_noexcept': False,
 
     # set __file__ and/or __path__ to known source/target path at import time (instead of not having them available)
@@ -242,6 +245,7 @@ _directive_defaults = {
     'optimize.unpack_method_calls': True,  # increases code size when True
     'optimize.unpack_method_calls_in_pyinit': False,  # uselessly increases code size when True
     'optimize.use_switch': True,
+    'optimize.cache_attribute_lookups': False,  # static cache per lookup site
 
 # remove unreachable code
     'remove_unreachable': True,
@@ -325,6 +329,7 @@ directive_types = {
     'final' : bool,  # final cdef classes and methods
     'collection_type': one_of('sequence'),
     'nogil' : DEFER_ANALYSIS_OF_ARGUMENTS,
+    'critical_section' : DEFER_ANALYSIS_OF_ARGUMENTS,
     'gil' : DEFER_ANALYSIS_OF_ARGUMENTS,
     'with_gil' : None,
     'internal' : bool,  # cdef class visibility in the module dict
@@ -343,6 +348,7 @@ directive_types = {
     'exceptval': type,  # actually (type, check=True/False), but has its own parser
     'set_initial_path': str,
     'freelist': int,
+    'freelist_pool': int,
     'c_string_type': one_of('bytes', 'bytearray', 'str', 'unicode'),
     'c_string_encoding': normalise_encoding_name,
     'trashcan': bool,
@@ -350,6 +356,7 @@ directive_types = {
     'dataclasses.dataclass': DEFER_ANALYSIS_OF_ARGUMENTS,
     'dataclasses.field': DEFER_ANALYSIS_OF_ARGUMENTS,
     'embedsignature.format': one_of('c', 'clinic', 'python'),
+    'parallel_backend': one_of('openmp', 'threadpool'),
 }
 
 for key, val in _directive_defaults.items():
@@ -365,6 +372,7 @@ directive_scopes = {  # defaults to available everywhere
     'nogil' : ('function', 'with statement'),
     'gil' : ('with statement'),
     'with_gil' : ('function',),
+    'critical_section' : ('cclass', 'function'),
     'inline' : ('function',),
     'cfunc' : ('function', 'with statement'),
     'ccall' : ('function', 'with statement'),
@@ -385,6 +393,7 @@ directive_scopes = {  # defaults to available everywhere
     'test_assert_c_code_has' : ('module',),
     'test_fail_if_c_code_has' : ('module',),
     'freelist': ('cclass',),
+    'freelist_pool': ('cclass',),
     'formal_grammar': ('module',),
     'emit_code_comments': ('module',),
     # Avoid scope-specific to/from_py_functions for c_string.
@@ -403,6 +412,7 @@ directive_scopes = {  # defaults to available everywhere
     'total_ordering': ('class', 'cclass'),
     'dataclasses.dataclass' : ('class', 'cclass'),
     'cpp_locals': ('module', 'function', 'cclass'),  # I don't think they make sense in a with_statement
+    'parallel_backend': ('module', 'function'),
     'ufunc': ('function',),
     'legacy_implicit_noexcept': ('module', ),
     'control_flow.dot_output': ('module',),
@@ -417,7 +427,7 @@ immediate_decorator_directives = {
     # function signature directives
     'inline', 'exceptval', 'returns', 'with_gil',  # 'nogil',
     # class directives
-    'freelist', 'no_gc', 'no_gc_clear', 'type_version_tag', 'final',
+    'freelist', 'freelist_pool', 'no_gc', 'no_gc_clear', 'type_version_tag', 'final',
     'auto_pickle', 'internal', 'collection_type', 'total_ordering',
     # testing directives
     'test_fail_if_path_exists', 'test_assert_path_exists',
@@ -690,13 +700,13 @@ class CompilationOptions:
             elif key in ['output_file', 'output_dir']:
                 # ignore the exact name of the output file
                 continue
-            elif key in ['depfile']:
-                # external build system dependency tracking file does not influence outputs
+            elif key in ['depfile', 'profile_compile']:
+                # external build system dependency tracking and profiling files do not influence outputs
                 continue
             elif key in ['timestamps']:
                 # the cache cares about the content of files, not about the timestamps of sources
                 continue
-            elif key in ['cache']:
+            elif key in ['cache', 'cache_backend', 'pxd_cache', 'compile_server', 'low_memory']:
                 # hopefully caching has no influence on the compilation result
                 continue
             elif key in ['compiler_directives']:
@@ -795,6 +805,11 @@ default_options = dict(
     output_dir=None,
     build_dir=None,
     cache=None,
+    cache_backend=None,
+    pxd_cache=None,
+    compile_server=None,
+    profile_compile=None,
+    low_memory=False,
     create_extension=None,
     np_pythran=False,
     legacy_implicit_noexcept=None,
@@ -1362,7 +1362,7 @@ class InterpretCompilerDirectives(CythonTransform):
                 for directive in new_directives:
                     if self.check_directive_scope(node.pos, directive[0], scope_name):
                         name, value = directive
-                        if name in ('nogil', 'with_gil'):
+                        if name in ('nogil', 'with_gil', 'critical_section'):
                             if value is None:
                                 value = True
                             else:
@@ -1431,6 +1431,16 @@ class InterpretCompilerDirectives(CythonTransform):
                                 PostParseError(node.pos, "Compiler directive %s accepts one positional argument." % name))
                         node = Nodes.GILStatNode(node.pos, state=name, body=node.body, condition=condition)
                         return self.visit_Node(node)
+                    if name == 'critical_section':
+                        args = None
+                        if isinstance(node.manager, ExprNodes.SimpleCallNode):
+                            args = node.manager.args
+                        if not args or len(args) > 2:
+                            self.context.nonfatal_error(
+                                PostParseError(node.pos, "critical_section() takes one or two objects to lock."))
+                            return self.visit_Node(node.body)
+                        node = Nodes.CriticalSectionStatNode(node.pos, args=args, body=node.body)
+                        return self.visit_Node(node)
                     if self.check_directive_scope(node.pos, name, 'with statement'):
                         directive_dict[name] = value
         if directive_dict:
@@ -1596,7 +1606,11 @@ class ParallelRangeTransform(CythonTransform, SkipDeclarations):
 
             node = parallel_range_node
 
-            if not isinstance(node.target, ExprNodes.NameNode):
+            # 'for i, j in prange(n, m)' runs the collapsed loop nest
+            targets = [node.target]
+            if isinstance(node.target, ExprNodes.TupleNode):
+                targets = node.target.args
+            if not all(isinstance(target, ExprNodes.NameNode) for target in targets):
                 error(node.target.pos,
                       "Can only iterate over an iteration variable")
 
@@ -1607,6 +1621,17 @@ class ParallelRangeTransform(CythonTransform, SkipDeclarations):
         self.visitchild(node, 'else_clause')
         return node
 
+    def visit_SingleAssignmentNode(self, node):
+        "Mark 'x = min(x, y)' and 'x = max(x, y)' as reductions in prange loops"
+        self.visitchildren(node)
+        rhs = node.rhs
+        if (self.state == 'prange' and node.lhs.is_name and
+                isinstance(rhs, ExprNodes.SimpleCallNode) and rhs.function.is_name and
+                rhs.function.name in ('min', 'max') and rhs.args and len(rhs.args) == 2 and
+                [arg.is_name and arg.name == node.lhs.name for arg in rhs.args].count(True) == 1):
+            node.reduction_operator = rhs.function.name
+        return node
+
     def visit(self, node):
         "Visit a node that may be None"
         if node is not None:
@@ -2449,6 +2474,7 @@ if VALUE is not None:
         if self._handle_fused(node):
             node = self._create_fused_function(env, node)
         else:
+            self._wrap_in_critical_section(node)
             node.body.analyse_declarations(lenv)
             self._super_visit_FuncDefNode(node)
 
@@ -2459,6 +2485,31 @@ if VALUE is not None:
             return UFuncs.convert_to_ufunc(node)
         return node
 
+    def _wrap_in_critical_section(self, node):
+        """
+        With the 'critical_section' directive, the Python visible methods of extension types
+        run in a critical section on 'self'.
+        """
+        lenv = node.local_scope
+        if node.critical_section is False or not lenv.directives.get('critical_section'):
+            return
+        class_scope = node.entry.scope
+        if class_scope.is_property_scope:
+            class_scope = class_scope.parent_scope
+        if not class_scope.is_c_class_scope or node.is_generator or node.is_generator_body:
+            return
+        if node.entry.name in ('__cinit__', '__dealloc__'):
+            return
+        if isinstance(node, Nodes.CFuncDefNode):
+            if not node.overridable or node.is_static_method:
+                return
+        elif node.is_wrapper or node.is_staticmethod or node.is_classmethod:
+            return
+        if not lenv.arg_entries or lenv.arg_entries[0].type is not class_scope.parent_type:
+            return
+        self_arg = ExprNodes.NameNode(node.pos, name=lenv.arg_entries[0].name)
+        node.body = Nodes.CriticalSectionStatNode(node.body.pos, args=[self_arg], body=node.body)
+
     def visit_DefNode(self, node):
         node = self.visit_FuncDefNode(node)
         env = self.current_env()
@@ -2671,15 +2722,32 @@ if VALUE is not None:
                 template = self.basic_property
         elif entry.visibility == 'readonly':
             template = self.basic_property_ro
+        attribute = ExprNodes.AttributeNode(pos=entry.pos,
+                                            obj=ExprNodes.NameNode(pos=entry.pos, name="self"),
+                                            attribute=entry.name)
+        # Simple scalars do not need a critical section, an atomic access is enough.
+        atomic_access = (
+            entry.scope.directives.get('critical_section') and self._is_atomic_scalar_type(entry.type))
+        if atomic_access:
+            attribute.is_atomic_access = True
         property = template.substitute({
-                "ATTR": ExprNodes.AttributeNode(pos=entry.pos,
-                                                obj=ExprNodes.NameNode(pos=entry.pos, name="self"),
-                                                attribute=entry.name),
+                "ATTR": attribute,
             }, pos=entry.pos).stats[0]
         property.name = entry.name
         property.doc = entry.doc
+        if atomic_access:
+            for stat in property.body.stats:
+                stat.critical_section = False
         return property
 
+    @staticmethod
+    def _is_atomic_scalar_type(type):
+        type = type.resolve()
+        if type.is_int or type.is_enum:
+            return True
+        # long double is often too wide for lock-free atomics
+        return type.is_float and type is not PyrexTypes.c_longdouble_type
+
     def visit_AssignmentExpressionNode(self, node):
         self.visitchildren(node)
         node.analyse_declarations(self.current_env())
@@ -1,4 +1,5 @@
 import itertools
+import sys
 from time import time
 
 from . import Errors
@@ -358,6 +359,107 @@ def get_timings():
         return {}
 
 
+def _peak_rss():
+    try:
+        import resource
+    except ImportError:
+        return None
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Linux reports kilobytes, macOS reports bytes.
+    return peak if sys.platform == 'darwin' else peak * 1024
+
+
+class CompileProfile:
+    """
+    Collects the wall time, peak RSS, number of visited tree nodes and
+    number of newly used utility code blocks of each pipeline phase,
+    for all pipelines (modules and their .pxd files) that run while it
+    is active.  Nested pipelines are also included in the time of the
+    phase that started them.
+    """
+    def __init__(self):
+        self.modules = []
+
+    def activate(self):
+        threadlocal.cython_compile_profile = self
+
+    def deactivate(self):
+        threadlocal.cython_compile_profile = None
+
+    def start_module(self, source):
+        source_desc = getattr(source, 'source_desc', source)
+        module = {
+            'module': getattr(source, 'full_module_name', None),
+            'source': getattr(source_desc, 'filename', None) or str(source_desc),
+            'time': 0.0,
+            'peak_rss': None,
+            'utility_code_blocks': None,
+            'phases': [],
+        }
+        self.modules.append(module)
+        return _ModuleProfile(module)
+
+    def write(self, path):
+        """
+        Add the collected modules to the JSON report in 'path', replacing
+        earlier entries of the same source files.  Parallel compiler
+        processes can write to the same report.
+        """
+        try:
+            import fcntl
+        except ImportError:
+            fcntl = None
+        import json
+        sources = {module['source'] for module in self.modules}
+        with open(path, 'a+', encoding='utf8') as f:
+            if fcntl is not None:
+                fcntl.lockf(f, fcntl.LOCK_EX)
+            f.seek(0)
+            try:
+                report = json.loads(f.read())
+                modules = [module for module in report['modules'] if module.get('source') not in sources]
+            except (ValueError, KeyError, TypeError):
+                modules = []
+            f.seek(0)
+            f.truncate()
+            json.dump({'modules': modules + self.modules}, f, indent=1)
+            f.write('\n')
+
+
+class _ModuleProfile:
+    def __init__(self, module):
+        self.module = module
+        self.utility_codes = set()
+
+    def count_new_utility_codes(self, data):
+        if getattr(data, 'utility_code_count', None) is not None:
+            # The C code was generated, which uses all requested utility code.
+            count = data.utility_code_count - len(self.utility_codes)
+            self.module['utility_code_blocks'] = data.utility_code_count
+            return count
+        scope = getattr(data, 'scope', None)
+        utility_code_list = getattr(scope, 'utility_code_list', None)
+        if not utility_code_list:
+            return 0
+        count = len(self.utility_codes)
+        self.utility_codes.update(code for code in utility_code_list if code is not None)
+        return len(self.utility_codes) - count
+
+    def record_phase(self, phase_name, phase, data, t, visited_nodes):
+        peak_rss = _peak_rss()
+        if visited_nodes is not None:
+            visited_nodes = phase.visited_nodes - visited_nodes
+        self.module['phases'].append({
+            'phase': phase_name,
+            'time': t,
+            'peak_rss': peak_rss,
+            'visited_nodes': visited_nodes,
+            'utility_code': self.count_new_utility_codes(data),
+        })
+        self.module['time'] += t
+        self.module['peak_rss'] = peak_rss
+
+
 _pipeline_entry_points = {}
 
 def _make_debug_phase_runner(phase_name):
@@ -376,11 +478,14 @@ def _make_debug_phase_runner(phase_name):
 
 
 def run_pipeline(pipeline, source, printtree=True):
-    from .Visitor import PrintTree
+    from .Visitor import PrintTree, TreeVisitor
     try:
         timings = threadlocal.cython_pipeline_timings
     except AttributeError:
         timings = threadlocal.cython_pipeline_timings = {}
+    profile = getattr(threadlocal, 'cython_compile_profile', None)
+    if profile is not None:
+        profile = profile.start_module(source)
 
     def run(phase, data):
         return phase(data)
@@ -400,9 +505,16 @@ def run_pipeline(pipeline, source, printtree=True):
                     print("Entering pipeline phase %r" % phase)
                     run = _make_debug_phase_runner(phase_name)
 
+                if profile is not None:
+                    visited_nodes = None
+                    if isinstance(phase, TreeVisitor):
+                        phase.count_visited_nodes()
+                        visited_nodes = phase.visited_nodes
                 t = time()
                 data = run(phase, data)
                 t = time() - t
+                if profile is not None:
+                    profile.record_phase(phase_name, phase, data, t, visited_nodes)
 
                 try:
                     old_t, count = timings[phase_name]
@@ -0,0 +1,607 @@
+#
+#   Persistent cache of analysed .pxd module scopes
+#
+#   Compiling many modules in separate processes (e.g. "cythonize -j N")
+#   means that every process parses and analyses the same .pxd files again.
+#   The PxdCache stores the declarations of a .pxd file in a directory that all
+#   processes can share.  Entries are keyed by the content of the .pxd file,
+#   the Cython version and the options that influence its analysis, and they
+#   record the content hashes of all other .pxd files that they refer to.
+#
+#   A cache entry is plain data (written with marshal), no pickle of the
+#   compiler state.  It lists the declaration tables of the module scope
+#   (see _module_scope_fields) and a table of records for the entries, types
+#   and scopes that the module declares, i.e. their class (from a fixed set of
+#   declaration classes) and their attributes.  Everything else is referenced
+#   by name: the types and scopes at module level in PyrexTypes and Builtin,
+#   and other module scopes together with their entries and types.  This
+#   keeps their identity intact when the cache entry is loaded into a new
+#   compilation context.  Modules that refer to objects of any other kind,
+#   or that contain code (like inline functions), are not cached.
+#
+#   Warnings that were issued while analysing a .pxd file are not repeated
+#   when it is loaded from the cache.
+#
+#   The C code must not depend on whether a .pxd file was loaded from the
+#   cache.  Its cimported modules are loaded before it, so its include code
+#   sorts after theirs.  A .pxd file that cimports modules after declaring
+#   include code, or that shares include code with other modules, is
+#   therefore not cached.
+#
+#   A long running process (like the compile server) can keep the cache
+#   entries in memory with preload(), so that the processes that it forks
+#   do not have to read them again.
+#
+#   Cache entries can inject arbitrary C code into the compiled modules, so
+#   the cache is only used in a directory that belongs to the current user
+#   and that no one else can access (mode 0700).
+#
+
+import copy
+import hashlib
+import io
+import marshal
+import os
+import stat
+import sys
+import tempfile
+
+from .. import __version__
+from . import Errors
+from . import Options
+
+# Increase when the cache format or the recorded compiler state changes incompatibly.
+cache_format_version = 3
+
+# Content of cache files by path, see preload().
+_preloaded_files = {}
+
+
+def is_private_directory(path):
+    """
+    Check that the directory belongs to the current user and that other users
+    cannot access it.
+    """
+    if not hasattr(os, "getuid"):
+        # no POSIX file permissions (Windows)
+        return os.path.isdir(path)
+    try:
+        st = os.lstat(path)
+    except OSError:
+        return False
+    return (stat.S_ISDIR(st.st_mode) and st.st_uid == os.getuid()
+            and not st.st_mode & (stat.S_IRWXG | stat.S_IRWXO))
+
+
+def preload(path):
+    """
+    Read all cache entries in the directory that are not in memory yet.
+    """
+    if not is_private_directory(path):
+        return
+    try:
+        names = os.listdir(path)
+    except OSError:
+        return
+    for name in names:
+        if not name.endswith(".pxdcache"):
+            continue
+        cache_file = os.path.join(path, name)
+        if cache_file in _preloaded_files:
+            continue
+        try:
+            with open(cache_file, "rb") as f:
+                _preloaded_files[cache_file] = f.read()
+        except OSError:
+            pass
+
+
+def _open_cache_file(cache_file):
+    data = _preloaded_files.get(cache_file)
+    if data is not None:
+        return io.BytesIO(data)
+    return open(cache_file, "rb")
+
+
+def _file_hash(filename):
+    m = hashlib.sha1()
+    with open(filename, "rb") as f:
+        data = f.read(65000)
+        while data:
+            m.update(data)
+            data = f.read(65000)
+    return m.hexdigest()
+
+
+class _NotCacheable(Exception):
+    pass
+
+
+def _compiler_globals():
+    # Map the types and scopes at module level of the compiler, and the
+    # markers of constant values, to references by name.
+    from . import Builtin, ExprNodes, PyrexTypes, Symtab
+    refs = {
+        id(ExprNodes.not_a_constant): ("global", "ExprNodes", "not_a_constant"),
+        id(ExprNodes.constant_value_not_set): ("global", "ExprNodes", "constant_value_not_set"),
+    }
+    for module in (PyrexTypes, Builtin):
+        module_name = module.__name__.rsplit(".", 1)[1]
+        for name, value in vars(module).items():
+            if isinstance(value, (PyrexTypes.BaseType, Symtab.Scope)):
+                refs.setdefault(id(value), ("global", module_name, name))
+    return refs
+
+
+def _resolve_global(module_name, name):
+    from . import Builtin, ExprNodes, PyrexTypes
+    module = {"PyrexTypes": PyrexTypes, "Builtin": Builtin, "ExprNodes": ExprNodes}[module_name]
+    return getattr(module, name)
+
+
+def _record_classes():
+    # The classes of the objects that a cache entry can contain, by name:
+    # entries, scopes and types, and literals, e.g. the values of enums.
+    from . import Code, ExprNodes, PyrexTypes, Symtab
+    classes = {"Code.IncludeCode": Code.IncludeCode}
+    for module, base_classes in [
+            (Symtab, (Symtab.Entry, Symtab.Scope)),
+            (PyrexTypes, (PyrexTypes.BaseType,)),
+            (ExprNodes, (ExprNodes.ConstNode,))]:
+        module_name = module.__name__.rsplit(".", 1)[1]
+        for name, cls in vars(module).items():
+            if (isinstance(cls, type) and cls.__module__ == module.__name__ and
+                    issubclass(cls, base_classes) and not issubclass(cls, Symtab.ModuleScope)):
+                classes["%s.%s" % (module_name, name)] = cls
+    return classes
+
+
+# The attributes of a module scope that the declarations of a .pxd file fill in.
+# All others must keep their initial values for the module to be cached, except
+# for those that the compilation context maintains.
+_module_scope_fields = (
+    "entries", "const_entries", "type_entries", "sue_entries", "arg_entries",
+    "var_entries", "pyfunc_entries", "cfunc_entries", "c_class_entries",
+    "defined_c_classes", "imported_c_classes", "cname_to_entry", "buffer_entries",
+    "id_counters", "subscopes", "c_includes", "own_includes", "cimports_after_includes",
+    "cimported_modules", "types_imported", "included_files", "has_extern_class",
+    "cached_builtins", "undeclared_cached_builtins", "utility_code_list",
+    "_cached_tuple_types", "directives", "cpp", "doc", "has_import_star",
+)
+_module_scope_context_fields = ("context", "outer_scope", "parent_module", "parent_scope", "module_entries")
+
+
+def _module_scope_snapshot(scope):
+    # Shallow copies of the attributes of a module scope before it is processed.
+    return {
+        name: copy.copy(value) for name, value in vars(scope).items()
+        if name not in _module_scope_fields and name not in _module_scope_context_fields
+    }
+
+
+def _qualified_module_names(context):
+    # Iterate over all known module scopes, including nested submodules.
+    todo = list(context.modules.values())
+    seen = set()
+    while todo:
+        scope = todo.pop()
+        if id(scope) in seen:
+            continue
+        seen.add(id(scope))
+        yield scope
+        for entry in scope.entries.values():
+            if entry.as_module is not None:
+                todo.append(entry.as_module)
+        todo.extend(getattr(scope, "module_entries", {}).values())
+
+
+class _DeclarationWriter:
+    """
+    Converts the declarations of a module scope into plain data.
+    """
+    def __init__(self, context, scope):
+        self.scope = scope
+        self.foreign_modules = {}
+        refs = _compiler_globals()
+        refs[id(context)] = ("context",)
+        refs[id(scope)] = ("self",)
+        self.module_scopes = {}
+        for module_scope in _qualified_module_names(context):
+            if module_scope is not scope:
+                # plain strings, EncodedString cannot be marshalled
+                self.module_scopes.setdefault(str(module_scope.qualified_name), module_scope)
+
+        # Objects can be reachable from several modules, e.g. cimported names
+        # or shared include code.  Prefer the module that defines them, then
+        # the modules that the cached module cimports, in cimport order, so
+        # that we depend on the same modules as the original compilation.
+        cimported_names = [
+            str(module_scope.qualified_name) for module_scope in scope.cimported_modules
+            if self.module_scopes.get(module_scope.qualified_name) is module_scope
+        ]
+        module_names = list(dict.fromkeys(cimported_names + list(self.module_scopes)))
+        for qualified_name in module_names:
+            module_scope = self.module_scopes[qualified_name]
+            refs.setdefault(id(module_scope), ("module", qualified_name))
+            for name, entry in module_scope.entries.items():
+                if entry.scope is module_scope:
+                    refs.setdefault(id(entry), ("entry", qualified_name, str(name)))
+                    if entry.is_type and entry.type is not None:
+                        refs.setdefault(id(entry.type), ("type", qualified_name, str(name)))
+        for qualified_name in module_names:
+            module_scope = self.module_scopes[qualified_name]
+            for name, entry in module_scope.entries.items():
+                refs.setdefault(id(entry), ("entry", qualified_name, str(name)))
+                if entry.is_type and entry.type is not None:
+                    refs.setdefault(id(entry.type), ("type", qualified_name, str(name)))
+            # Included code is shared between module scopes and merged by identity.
+            # The include code that a module declares itself does not depend on
+            # its cimports, other include files are referenced by their name.
+            for i, inc in enumerate(getattr(module_scope, "own_includes", ())):
+                refs.setdefault(id(inc), ("include", qualified_name, i))
+            for key, inc in getattr(module_scope, "c_includes", {}).items():
+                if isinstance(key, str):
+                    refs.setdefault(id(inc), ("include_file", qualified_name, str(key)))
+            # Modules that only declare extern classes are not registered by name.
+            for i, cimported_module in enumerate(getattr(module_scope, "cimported_modules", ())):
+                refs.setdefault(id(cimported_module), ("cimported", qualified_name, i))
+        for qualified_name in cimported_names:
+            self.foreign_modules[qualified_name] = self.module_scopes[qualified_name]
+        self.refs = refs
+
+        self.class_names = {cls: name for name, cls in _record_classes().items()}
+        self.objects = []
+        self.object_index = {}
+
+    def write(self, snapshot, pos):
+        """
+        Return the declaration tables of the module scope and the records
+        of the objects that they refer to.
+        """
+        scope_state = vars(self.scope)
+        for name, value in scope_state.items():
+            if name in _module_scope_fields or name in _module_scope_context_fields:
+                continue
+            # Attributes that are set on the instance later start from the class attribute.
+            initial = snapshot.get(name, getattr(type(self.scope), name, _NotCacheable))
+            if initial is _NotCacheable or initial != value:
+                raise _NotCacheable("module scope attribute %s" % name)
+        fields = [
+            (name, self.encode(scope_state[name]))
+            for name in _module_scope_fields if name in scope_state
+        ]
+        pos = self.encode(pos)
+
+        # The records are filled in a loop instead of recursively, since the
+        # declarations can refer to each other in long chains.
+        records = []
+        while len(records) < len(self.objects):
+            obj = self.objects[len(records)]
+            records.append((
+                self.class_names[type(obj)],
+                [(name, self.encode(value)) for name, value in vars(obj).items()]))
+        return fields, records, pos
+
+    def encode(self, value):
+        from .Scanning import FileSourceDescriptor
+        from .StringEncoding import EncodedString, BytesLiteral
+        value_type = type(value)
+        if value is None or value_type in (bool, int, float, str, bytes):
+            return value
+        if value_type is EncodedString:
+            return ("ustr", str(value), value.encoding)
+        if value_type is BytesLiteral:
+            return ("bytes", bytes(value), value.encoding)
+        if value_type in (tuple, list, set, frozenset):
+            return (value_type.__name__, [self.encode(item) for item in value])
+        if value_type is dict:
+            return ("dict", [(self.encode(key), self.encode(item)) for key, item in value.items()])
+        if value_type is FileSourceDescriptor:
+            return ("file", str(value.filename), str(value.path_description))
+
+        ref = self.refs.get(id(value))
+        if ref is not None:
+            if ref[0] not in ("global", "context", "self"):
+                self.foreign_modules.setdefault(ref[1], self.module_scopes[ref[1]])
+            return ("ref", ref)
+        index = self.object_index.get(id(value))
+        if index is None:
+            if value_type not in self.class_names:
+                raise _NotCacheable(value_type.__name__)
+            index = self.object_index[id(value)] = len(self.objects)
+            self.objects.append(value)
+        return ("obj", index)
+
+
+class _DeclarationReader:
+    """
+    Restores the declarations of a module scope from the data of _DeclarationWriter.
+    """
+    def __init__(self, context, scope):
+        self.context = context
+        self.scope = scope
+        self.module_scopes = {
+            module_scope.qualified_name: module_scope
+            for module_scope in _qualified_module_names(context)
+        }
+        self.foreign_includes = set()
+        self.files = {}
+        self.objects = []
+
+    def read(self, declarations):
+        """
+        Fill the module scope and return the position of the module.
+        """
+        fields, records, pos = declarations
+        classes = _record_classes()
+        self.objects = [classes[class_name].__new__(classes[class_name]) for class_name, _ in records]
+        # Objects can be hashed by their attributes, so the dicts and sets are
+        # only built after all other attributes are restored.
+        containers = []
+        for obj, (_, attributes) in zip(self.objects, records):
+            for name, value in attributes:
+                if self.contains_hashed(value):
+                    containers.append((obj, name, value))
+                else:
+                    obj.__dict__[name] = self.decode(value)
+        for obj, name, value in containers:
+            obj.__dict__[name] = self.decode(value)
+        # Only change the module scope when everything could be restored.
+        fields = [(name, self.decode(value)) for name, value in fields]
+        pos = self.decode(pos)
+        for name, value in fields:
+            setattr(self.scope, name, value)
+        return pos
+
+    def contains_hashed(self, value):
+        if type(value) is not tuple:
+            return False
+        kind = value[0]
+        if kind in ("dict", "set", "frozenset"):
+            return True
+        if kind in ("tuple", "list"):
+            return any(self.contains_hashed(item) for item in value[1])
+        return False
+
+    def decode(self, value):
+        if type(value) is not tuple:
+            return value
+        kind = value[0]
+        if kind == "obj":
+            return self.objects[value[1]]
+        if kind == "ref":
+            return self.resolve(value[1])
+        if kind == "ustr":
+            from .StringEncoding import EncodedString
+            result = EncodedString(value[1])
+            result.encoding = value[2]
+            return result
+        if kind == "bytes":
+            from .StringEncoding import BytesLiteral
+            result = BytesLiteral(value[1])
+            result.encoding = value[2]
+            return result
+        if kind == "tuple":
+            return tuple([self.decode(item) for item in value[1]])
+        if kind == "list":
+            return [self.decode(item) for item in value[1]]
+        if kind == "set":
+            return {self.decode(item) for item in value[1]}
+        if kind == "frozenset":
+            return frozenset([self.decode(item) for item in value[1]])
+        if kind == "dict":
+            return {self.decode(key): self.decode(item) for key, item in value[1]}
+        if kind == "file":
+            source_desc = self.files.get(value[1:])
+            if source_desc is None:
+                from .Scanning import FileSourceDescriptor
+                source_desc = self.files[value[1:]] = FileSourceDescriptor(value[1], value[2])
+            return source_desc
+        raise ValueError("Unknown value in cache entry: %r" % (kind,))
+
+    def resolve(self, ref):
+        kind = ref[0]
+        if kind == "self":
+            return self.scope
+        if kind == "context":
+            return self.context
+        if kind == "global":
+            return _resolve_global(ref[1], ref[2])
+        module_scope = self.module_scopes[ref[1]]
+        if kind == "module":
+            return module_scope
+        if kind in ("include", "include_file"):
+            if kind == "include":
+                inc = module_scope.own_includes[ref[2]]
+            else:
+                inc = module_scope.c_includes[ref[2]]
+            self.foreign_includes.add(id(inc))
+            return inc
+        if kind == "cimported":
+            return module_scope.cimported_modules[ref[2]]
+        entry = module_scope.entries[ref[2]]
+        if kind == "entry":
+            return entry
+        if kind == "type":
+            return entry.type
+        raise ValueError("Unknown reference in cache entry: %r" % (ref,))
+
+
+class PxdCache:
+    """
+    Directory of the declarations of .pxd files, shared between compiler processes.
+    """
+    def __init__(self, path, context):
+        self.path = path
+        self.context = context
+        self.in_progress = set()
+
+    def options_fingerprint(self):
+        context = self.context
+        return repr((
+            __version__, cache_format_version, sys.version_info[:2],
+            context.cpp, context.language_level,
+            sorted(context.future_directives, key=repr),
+            sorted((key, repr(value)) for key, value in context.compiler_directives.items()),
+            context.legacy_implicit_noexcept,
+            Options.cimport_from_pyx, Options.docstrings, Options.embed_pos_in_docstring,
+        ))
+
+    def cache_file(self, module_name, pxd_pathname):
+        m = hashlib.sha1(self.options_fingerprint().encode("UTF-8"))
+        m.update(module_name.encode("UTF-8"))
+        m.update(_file_hash(pxd_pathname).encode("UTF-8"))
+        return os.path.join(self.path, "%s-%s.pxdcache" % (module_name, m.hexdigest()))
+
+    def _module_dependency(self, module_scope):
+        # Modules whose .pxd file was completely processed must be loaded
+        # (and unchanged) before the cache entry can be used.  Others, like
+        # parent packages or modules that are still being processed, must
+        # only exist.
+        qualified_name = str(module_scope.qualified_name)
+        if not getattr(module_scope, "pxd_file_loaded", False) or qualified_name in self.in_progress:
+            return qualified_name, None
+        return qualified_name, self._dependency_hash(qualified_name)
+
+    def _dependency_hash(self, module_name):
+        pxd_pathname = self.context.find_pxd_file(module_name)
+        if pxd_pathname is None:
+            return None
+        return _file_hash(pxd_pathname)
+
+    def _declare_module(self, qualified_name):
+        scope = self.context
+        for name, is_package in self.context._split_qualified_name(qualified_name):
+            scope = scope.find_submodule(name, as_package=is_package)
+        return scope
+
+    def process_pxd(self, source_desc, scope, module_name):
+        """
+        Run the pxd pipeline for the module scope, or load its result from the cache.
+        """
+        from . import Pipeline
+        pxd_pathname = source_desc.filename
+        self.in_progress.add(module_name)
+        try:
+            result = self.load(module_name, pxd_pathname, scope)
+            if result is not None:
+                return None, result
+            num_errors = Errors.get_errors_count()
+            snapshot = _module_scope_snapshot(scope)
+            pipeline = Pipeline.create_pxd_pipeline(self.context, scope, module_name)
+            err, result = Pipeline.run_pipeline(pipeline, source_desc)
+        finally:
+            self.in_progress.discard(module_name)
+        if err is None and Errors.get_errors_count() == num_errors:
+            self.store(module_name, pxd_pathname, scope, result, snapshot)
+        return err, result
+
+    def load(self, module_name, pxd_pathname, scope):
+        """
+        Fill the (empty) module scope from the cache and return the result
+        of the pxd pipeline, or None if the cache has no valid entry.
+        """
+        from .Nodes import StatListNode
+        if not is_private_directory(self.path):
+            return None
+        try:
+            cache_file = self.cache_file(module_name, pxd_pathname)
+            with _open_cache_file(cache_file) as f:
+                format_version, dependencies = marshal.load(f)
+                if format_version != cache_format_version:
+                    return None
+                # Load the cimported modules in the original order, and make sure
+                # that they are unchanged since the cache entry was written.
+                for dep_name, dep_hash in dependencies:
+                    if dep_hash is None:
+                        self._declare_module(dep_name)
+                        continue
+                    self.context.find_module(dep_name, need_pxd=0)
+                    if self._dependency_hash(dep_name) != dep_hash:
+                        return None
+                declarations = marshal.load(f)
+            reader = _DeclarationReader(self.context, scope)
+            pos = reader.read(declarations)
+        except Exception:
+            return None
+        self._renumber_includes(scope, reader.foreign_includes)
+        return StatListNode(pos, stats=[]), scope
+
+    def _renumber_includes(self, scope, foreign_includes):
+        # The order of included code is defined by a global counter of the
+        # process that created it.  Give the includes of the loaded module new
+        # numbers that sort after everything that was processed before, but
+        # keep their relative order.  This is the order of an uncached
+        # compilation, as the module declares them after all its cimports.
+        from .Code import IncludeCode
+        renumbered = {}
+        own_includes = {
+            id(inc): inc for inc in list(scope.c_includes.values()) + scope.own_includes
+            if id(inc) not in foreign_includes
+        }
+        own_includes = sorted(own_includes.values(), key=IncludeCode.sortkey)
+        for inc in own_includes:
+            renumbered[inc.order] = IncludeCode.counter
+            inc.order = IncludeCode.counter
+            IncludeCode.counter += 1
+        for inc in own_includes:
+            inc.pieces = {renumbered.get(key, key): piece for key, piece in inc.pieces.items()}
+        # Includes without an include file are keyed by their (current) order,
+        # which may also have changed for includes from other modules.
+        scope.c_includes = {
+            inc.sortkey() if isinstance(key, int) else key: inc
+            for key, inc in scope.c_includes.items()
+        }
+
+    def _includes_reproducible(self, scope):
+        # Loading the module orders its include code after that of its
+        # cimports, and only restores the include code that it owns.
+        if scope.cimports_after_includes:
+            return False
+        own_ids = {id(inc) for inc in scope.own_includes}
+        own_orders = {inc.order for inc in scope.own_includes}
+        for inc in scope.own_includes:
+            key = inc.mainpiece()
+            if key is None:
+                key = inc.sortkey()
+            # not merged into the include code of another module
+            if id(scope.c_includes.get(key)) not in own_ids:
+                return False
+            # and no code of other modules merged into it
+            if any(order and order not in own_orders for order in inc.pieces):
+                return False
+        return True
+
+    def store(self, module_name, pxd_pathname, scope, result, snapshot):
+        code_nodes, _ = result
+        if code_nodes.stats or not self._includes_reproducible(scope):
+            # Code (e.g. of inline functions) cannot be restored from declarations.
+            return
+        try:
+            writer = _DeclarationWriter(self.context, scope)
+            declarations = writer.write(snapshot, code_nodes.pos)
+        except _NotCacheable:
+            # The declarations refer to objects that we cannot record, so we
+            # just process such pxd files again the next time.
+            return
+        dependencies = [
+            self._module_dependency(module_scope)
+            for module_scope in writer.foreign_modules.values()
+        ]
+        try:
+            os.makedirs(self.path, mode=0o700, exist_ok=True)
+            if not is_private_directory(self.path):
+                return
+            cache_file = self.cache_file(module_name, pxd_pathname)
+            fd, tmp_path = tempfile.mkstemp(dir=self.path, prefix=".tmp-")
+            try:
+                with os.fdopen(fd, "wb") as f:
+                    marshal.dump((cache_format_version, dependencies), f)
+                    marshal.dump(declarations, f)
+                os.replace(tmp_path, cache_file)
+            except BaseException:
+                os.unlink(tmp_path)
+                raise
+        except (OSError, ValueError):
+            # The cache is optional, e.g. on a read-only file system.
+            pass
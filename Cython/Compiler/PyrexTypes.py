@@ -614,6 +614,9 @@ class CTypedefType(BaseType):
         return self.typedef_base_type.error_condition(result_code)
 
     def __getattr__(self, name):
+        if name.startswith('__'):
+            # we wouldn't have been called if it was there
+            raise AttributeError(name)
         return getattr(self.typedef_base_type, name)
 
     def py_type_name(self):
@@ -1201,6 +1204,9 @@ class BufferType(BaseType):
         return Buffer.BufferEntry(node.entry)
 
     def __getattr__(self, name):
+        if name.startswith('__'):
+            # we wouldn't have been called if it was there
+            raise AttributeError(name)
         return getattr(self.base, name)
 
     def __repr__(self):
@@ -1860,6 +1866,9 @@ class CConstOrVolatileType(BaseType):
         return self.cv_base_type.same_as_resolved_type(other_type)
 
     def __getattr__(self, name):
+        if name.startswith('__'):
+            # we wouldn't have been called if it was there
+            raise AttributeError(name)
         return getattr(self.cv_base_type, name)
 
 
@@ -2994,6 +3003,9 @@ class CReferenceBaseType(BaseType):
         return self.ref_base_type.deduce_template_params(actual)
 
     def __getattr__(self, name):
+        if name.startswith('__'):
+            # we wouldn't have been called if it was there
+            raise AttributeError(name)
         return getattr(self.ref_base_type, name)
 
 
@@ -4851,6 +4863,12 @@ c_gilstate_type = CEnumType("PyGILState_STATE", "PyGILState_STATE", True)
 c_threadstate_type = CStructOrUnionType("PyThreadState", "struct", None, 1, "PyThreadState")
 c_threadstate_ptr_type = CPtrType(c_threadstate_type)
 
+# critical sections (free-threading)
+c_py_critical_section_type = CStructOrUnionType(
+    "__Pyx_PyCriticalSection", "struct", None, 1, "__Pyx_PyCriticalSection")
+c_py_critical_section2_type = CStructOrUnionType(
+    "__Pyx_PyCriticalSection2", "struct", None, 1, "__Pyx_PyCriticalSection2")
+
 # PEP-539 "Py_tss_t" type
 c_pytss_t_type = CPyTSSTType()
 
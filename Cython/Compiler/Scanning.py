@@ -5,7 +5,7 @@
 
 
 import cython
-cython.declare(make_lexicon=object, lexicon=object,
+cython.declare(make_lexicon=object, load_lexicon_tables=object, lexicon=object,
                print_function=object, error=object, warning=object,
                os=object, platform=object)
 
@@ -18,7 +18,7 @@ from .. import Utils
 from ..Plex.Scanners import Scanner
 from ..Plex.Errors import UnrecognizedInput
 from .Errors import error, warning, hold_errors, release_errors, CompileError
-from .Lexicon import any_string_prefix, make_lexicon, IDENT
+from .Lexicon import any_string_prefix, make_lexicon, load_lexicon_tables, IDENT
 from .Future import print_function
 
 debug_scanner = 0
@@ -32,7 +32,8 @@ lexicon = None
 def get_lexicon():
     global lexicon
     if not lexicon:
-        lexicon = make_lexicon()
+        # Prefer the tables that "setup.py build_py" stored next to this package.
+        lexicon = load_lexicon_tables() or make_lexicon()
     return lexicon
 
 
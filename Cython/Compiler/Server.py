@@ -0,0 +1,315 @@
+#
+#   Compile server
+#
+#   "cython --server SOCKET" starts a long running process that imports the
+#   compiler, builds the scanner lexicon and reads the utility code files
+#   once, and then waits for compile requests on a Unix domain socket.
+#   Each request is run in a forked child process, so that the requests do
+#   not share any global compiler state, but start from the warm state of
+#   the server.  The client passes its stdout and stderr file descriptors
+#   along with the request, so that all compiler output goes directly to
+#   the client.
+#
+#   The socket is only accessible by the user who runs the server (mode 0600),
+#   and where the platform tells us the peer of a connection (SO_PEERCRED),
+#   connections from other users are rejected as well.  The server forks as
+#   soon as it accepts a connection, so that a client which is slow to send
+#   its request does not hold up the other clients.
+#
+#   Analysed .pxd files are shared between the requests through a pxd cache
+#   (see PxdCache.py), which the server keeps in memory.
+#
+#   The client (cython-client, or "python -m Cython.Compiler.Server") takes
+#   the same arguments as the cython command, and only imports the compiler
+#   itself if no server is running.
+#
+
+import array
+import json
+import os
+import socket
+import struct
+import sys
+
+server_env_variable = "CYTHON_SERVER"
+
+# Seconds that a client may take to send its request after connecting.
+request_timeout = 60
+
+
+def is_supported():
+    """
+    The server needs Unix domain sockets that can pass file descriptors
+    (SCM_RIGHTS), and fork().
+    """
+    return (hasattr(socket, "AF_UNIX") and hasattr(socket, "SCM_RIGHTS")
+            and hasattr(socket.socket, "sendmsg") and hasattr(os, "fork"))
+
+
+def _send_message(sock, message, fds=()):
+    data = json.dumps(message).encode("UTF-8") + b"\n"
+    if fds:
+        # The descriptors travel with the first part of the message,
+        # which may be shorter than the whole message.
+        sent = sock.sendmsg(
+            [data], [(socket.SOL_SOCKET, socket.SCM_RIGHTS, array.array("i", fds))])
+        data = data[sent:]
+    if data:
+        sock.sendall(data)
+
+
+def _receive_fds(sock, bufsize, max_fds):
+    fds = array.array("i")
+    chunk, ancdata, _, _ = sock.recvmsg(bufsize, socket.CMSG_LEN(max_fds * fds.itemsize))
+    for level, kind, cmsg_data in ancdata:
+        if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+            fds.frombytes(cmsg_data[:len(cmsg_data) - len(cmsg_data) % fds.itemsize])
+    return chunk, list(fds)
+
+
+def _receive_message(sock, max_fds=0):
+    data = b""
+    fds = []
+    while not data.endswith(b"\n"):
+        if max_fds:
+            chunk, new_fds = _receive_fds(sock, 65536, max_fds)
+            fds.extend(new_fds)
+        else:
+            chunk = sock.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+    if not data.endswith(b"\n"):
+        for fd in fds:
+            os.close(fd)
+        raise ConnectionError("Incomplete message")
+    return json.loads(data.decode("UTF-8")), fds
+
+
+# Server side
+
+def _warm_up():
+    from . import Pipeline, Scanning, Code
+    from .Main import Context
+    from .Options import CompilationOptions, default_options
+    options = CompilationOptions(default_options)
+    context = Context.from_options(options)
+    Pipeline.create_pyx_pipeline(context, options, result=None)
+    Pipeline.create_pxd_pipeline(context, context.find_submodule("__pyx_server_warmup__"), "__pyx_server_warmup__")
+    Scanning.get_lexicon()
+    for filename in sorted(os.listdir(Code.get_utility_dir())):
+        if os.path.splitext(filename)[1] in (".c", ".cpp", ".h", ".pyx", ".pxd"):
+            Code.UtilityCodeBase.load_utilities_from_file(filename)
+
+
+def _bind(socket_path):
+    if os.path.exists(socket_path):
+        probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            probe.connect(socket_path)
+        except OSError:
+            os.unlink(socket_path)  # left behind by a server that is gone
+        else:
+            probe.close()
+            raise OSError("A compile server is already listening on '%s'" % socket_path)
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    # Create the socket with mode 0600 to keep other users from connecting.
+    old_umask = os.umask(0o177)
+    try:
+        listener.bind(socket_path)
+    finally:
+        os.umask(old_umask)
+    os.chmod(socket_path, 0o600)
+    listener.listen(64)
+    return listener
+
+
+def _peer_is_trusted(conn):
+    """
+    Check that the peer of the connection runs as the same user as the server,
+    where the platform lets us ask.  Otherwise, the socket mode has to do.
+    """
+    if not hasattr(socket, "SO_PEERCRED"):
+        return True
+    creds = conn.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize("3i"))
+    _, uid, _ = struct.unpack("3i", creds)
+    return uid == os.getuid()
+
+
+def _reap_children(children):
+    for pid in list(children):
+        try:
+            finished, _ = os.waitpid(pid, os.WNOHANG)
+        except ChildProcessError:
+            finished = pid
+        if finished:
+            children.discard(pid)
+
+
+def _run_request(conn, request, fds, pxd_cache):
+    """
+    Run one compilation in the forked child process and report its exit status.
+    """
+    from . import Main
+    status = 1
+    try:
+        stdout_fd, stderr_fd = fds
+        os.dup2(stdout_fd, 1)
+        os.dup2(stderr_fd, 2)
+        for fd in fds:
+            os.close(fd)
+        os.chdir(request["cwd"])
+        os.environ.clear()
+        os.environ.update(request["env"])
+        args = list(request["args"])
+        if pxd_cache and not any(arg == "--pxd-cache" or arg.startswith("--pxd-cache=") for arg in args):
+            args[:0] = ["--pxd-cache", pxd_cache]
+        sys.argv = ["cython"] + args
+        try:
+            Main.setuptools_main()
+            status = 0
+        except SystemExit as exc:
+            if exc.code is None or isinstance(exc.code, int):
+                status = exc.code or 0
+            else:
+                sys.stderr.write("%s\n" % exc.code)
+    except BaseException:
+        import traceback
+        traceback.print_exc()
+    finally:
+        try:
+            sys.stdout.flush()
+            sys.stderr.flush()
+            _send_message(conn, {"status": status})
+        finally:
+            os._exit(0)
+
+
+def _receive_and_run(conn, pxd_cache):
+    """
+    Read the request of the client in the forked child process and run it.
+    """
+    conn.settimeout(request_timeout)
+    try:
+        request, fds = _receive_message(conn, max_fds=2)
+    except (OSError, ValueError):
+        os._exit(0)
+    conn.settimeout(None)
+    if len(fds) != 2:
+        for fd in fds:
+            os.close(fd)
+        os._exit(0)
+    _run_request(conn, request, fds, pxd_cache)
+
+
+def serve(socket_path, pxd_cache=None, quiet=False):
+    """
+    Run the compile server on the Unix domain socket 'socket_path' until it
+    is interrupted.  Without an explicit 'pxd_cache' directory, a temporary
+    one is used for the lifetime of the server.
+    """
+    if not is_supported():
+        raise OSError("The compile server is not supported on this platform")
+    import shutil
+    import signal
+    import tempfile
+    from . import PxdCache
+
+    temp_dir = None
+    if pxd_cache is None:
+        pxd_cache = temp_dir = tempfile.mkdtemp(prefix="cython-server-")
+    pxd_cache = os.path.abspath(pxd_cache)
+
+    _warm_up()
+    listener = _bind(socket_path)
+    # Terminate cleanly (and remove the socket) on SIGTERM.
+    signal.signal(signal.SIGTERM, signal.default_int_handler)
+    if not quiet:
+        sys.stderr.write("Cython compile server listening on '%s'\n" % socket_path)
+    children = set()
+    try:
+        while True:
+            conn, _ = listener.accept()
+            with conn:
+                _reap_children(children)
+                if not _peer_is_trusted(conn):
+                    continue
+                PxdCache.preload(pxd_cache)
+                sys.stdout.flush()
+                sys.stderr.flush()
+                pid = os.fork()
+                if pid == 0:
+                    listener.close()
+                    signal.signal(signal.SIGTERM, signal.SIG_DFL)
+                    signal.signal(signal.SIGINT, signal.SIG_DFL)
+                    _receive_and_run(conn, pxd_cache)
+                children.add(pid)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        listener.close()
+        try:
+            os.unlink(socket_path)
+        except OSError:
+            pass
+        if temp_dir is not None:
+            shutil.rmtree(temp_dir, ignore_errors=True)
+
+
+# Client side
+
+def compile_with_server(socket_path, args):
+    """
+    Let the server at 'socket_path' run the cython command with the
+    arguments 'args' in the current directory.  Returns the exit status,
+    or None if the server cannot be reached.
+    """
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        try:
+            sock.connect(socket_path)
+        except OSError:
+            return None
+        sys.stdout.flush()
+        sys.stderr.flush()
+        _send_message(
+            sock, {"args": list(args), "cwd": os.getcwd(), "env": dict(os.environ)},
+            fds=[sys.stdout.fileno(), sys.stderr.fileno()])
+        try:
+            reply, _ = _receive_message(sock)
+        except (OSError, ValueError):
+            sys.stderr.write("Lost connection to the compile server at '%s'\n" % socket_path)
+            return 1
+        return reply.get("status", 1)
+    finally:
+        sock.close()
+
+
+def client_main(args=None):
+    """
+    Entry point of "cython-client [--connect SOCKET] <cython arguments>".
+    The socket defaults to the CYTHON_SERVER environment variable.  Without
+    a server, the compiler runs in this process.
+    """
+    if args is None:
+        args = sys.argv[1:]
+    args = list(args)
+    socket_path = os.environ.get(server_env_variable)
+    if args and args[0].startswith("--connect="):
+        socket_path = args.pop(0)[len("--connect="):]
+    elif len(args) > 1 and args[0] == "--connect":
+        socket_path = args[1]
+        del args[:2]
+
+    status = None
+    if socket_path and is_supported():
+        status = compile_with_server(socket_path, args)
+    if status is None:
+        from .Main import setuptools_main
+        sys.argv = ["cython"] + args
+        return setuptools_main()
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    client_main()
@@ -112,6 +112,7 @@ class Entry:
     # in_subscope      boolean    Belongs to a generator expression scope
     # is_readonly      boolean    Can't be assigned to
     # func_cname       string     C func implementing Python func
+    # vectorcall_cname string     C func implementing a special method with the vectorcall protocol
     # func_modifiers   [string]   C function modifiers ('inline')
     # pos              position   Source position where declared
     # namespace_cname  string     If is_pyglobal, the C variable
@@ -199,6 +200,7 @@ class Entry:
     is_readonly = 0
     pyfunc_cname = None
     func_cname = None
+    vectorcall_cname = None
     func_modifiers = []
     final_func_cname = None
     doc = None
@@ -1318,6 +1320,8 @@ class ModuleScope(Scope):
     # utility_code_list    [UtilityCode]      Queuing utility codes for forwarding to Code.py
     # c_includes           {key: IncludeCode} C headers or verbatim code to be generated
     #                                         See process_include() for more documentation
+    # own_includes         [IncludeCode]      Include code declared in this module
+    # cimports_after_includes boolean         A module was cimported after own_includes
     # identifier_to_entry  {string : Entry}   Map identifier string const to entry
     # context              Context
     # parent_module        Scope              Parent in the import namespace
@@ -1358,6 +1362,8 @@ class ModuleScope(Scope):
         self.utility_code_list = []
         self.module_entries = {}
         self.c_includes = {}
+        self.own_includes = []
+        self.cimports_after_includes = False
         self.type_names = dict(outer_scope.type_names)
         self.pxd_file_loaded = 0
         self.cimported_modules = []
@@ -1537,6 +1543,7 @@ class ModuleScope(Scope):
         Both `filename` and `verbatim_include` can be `None` or empty.
         """
         inc = Code.IncludeCode(filename, verbatim_include, late=late)
+        self.own_includes.append(inc)
         self.process_include(inc)
 
     def process_include(self, inc):
@@ -1572,6 +1579,8 @@ class ModuleScope(Scope):
 
     def add_imported_module(self, scope):
         if scope not in self.cimported_modules:
+            if self.own_includes:
+                self.cimports_after_includes = True
             for inc in scope.c_includes.values():
                 self.process_include(inc)
             self.cimported_modules.append(scope)
@@ -2421,6 +2430,88 @@ class CClassScope(ClassScope):
             current_type_scope = current_base_type.scope if current_base_type else None
         return False
 
+    def vectorcall_type_hierarchy(self, for_instances=False):
+        """
+        Returns the list of type scopes from this type up to its base-most type
+        if all of them are implemented in this module, so that we know what their
+        tp_new() does and how their object struct looks.  Otherwise returns None.
+        Instance vectorcall adds a struct field, so it additionally requires that
+        the types are not visible outside of the module.
+        """
+        module_scope = self.global_scope()
+        hierarchy = []
+        current_type_scope = self
+        while current_type_scope:
+            current_type = current_type_scope.parent_type
+            if (current_type.is_external or not current_type_scope.implemented or
+                    current_type.multiple_bases or current_type_scope.global_scope() is not module_scope):
+                return None
+            if for_instances:
+                type_entry = module_scope.lookup_here(current_type.name)
+                if (current_type_scope.defined or not type_entry or type_entry.type is not current_type or
+                        type_entry.visibility != 'private' or type_entry.api):
+                    return None
+            hierarchy.append(current_type_scope)
+            current_base_type = current_type.base_type
+            if current_base_type and not current_base_type.is_extension_type:
+                return None
+            current_type_scope = current_base_type.scope if current_base_type else None
+        return hierarchy
+
+    def lookup_vectorcall_init(self):
+        """
+        Returns the '__init__' entry that tp_vectorcall can call after creating
+        the object with tp_new() and no arguments, or None.
+        """
+        hierarchy = self.vectorcall_type_hierarchy()
+        if hierarchy is None:
+            return None
+        for type_scope in hierarchy:
+            cinit_entry = type_scope.lookup_here("__cinit__")
+            if cinit_entry and cinit_entry.is_special and not cinit_entry.trivial_signature:
+                # __cinit__() receives the constructor arguments
+                return None
+        for type_scope in hierarchy:
+            entry = type_scope.lookup_here("__init__")
+            if entry and entry.is_special:
+                return entry if entry.vectorcall_cname else None
+        return None
+
+    def lookup_vectorcall_call(self):
+        """
+        Returns the '__call__' entry that instances can call through vectorcall
+        (or None) and the type scope whose object struct holds the vectorcall
+        function pointer (or None if there is no such field).
+        """
+        hierarchy = self.vectorcall_type_hierarchy(for_instances=True)
+        if hierarchy is None:
+            return None, None
+        call_entry = field_scope = None
+        for type_scope in hierarchy:
+            entry = type_scope.lookup_here("__call__")
+            if entry and entry.is_special:
+                if call_entry is None:
+                    call_entry = entry
+                field_scope = type_scope
+        if call_entry is not None and not call_entry.vectorcall_cname:
+            call_entry = None
+        return call_entry, field_scope
+
+    def sets_vectorcall_call(self):
+        # Instances of this type get the vectorcall function of its own '__call__' method.
+        call_entry = self.lookup_vectorcall_call()[0]
+        return call_entry is not None and call_entry is self.lookup_here("__call__")
+
+    def vectorcall_field_path(self, field_scope):
+        # Access path of the vectorcall function pointer in the object struct of this type.
+        path = []
+        type_scope = self
+        while type_scope is not field_scope:
+            path.append(Naming.obj_base_cname)
+            type_scope = type_scope.parent_type.base_type.scope
+        path.append(Naming.vectorcall_slot_cname)
+        return '.'.join(path)
+
     def get_refcounted_entries(self, include_weakref=False,
                                include_gc_simple=True):
         py_attrs = []
@@ -527,6 +527,41 @@ class CmdLineParserTest(TestCase):
         self.check_default_global_options()
         self.check_default_options(options, ['module_name'])
 
+    def test_pxd_cache(self):
+        options, sources = parse_command_line([
+            '--pxd-cache', 'cache_dir',
+            'source.pyx'
+        ])
+        self.assertEqual(options.pxd_cache, 'cache_dir')
+        self.check_default_global_options()
+        self.check_default_options(options, ['pxd_cache'])
+
+    def test_compile_server(self):
+        options, sources = parse_command_line([
+            '--server', 'cython.sock',
+        ])
+        self.assertEqual(options.compile_server, 'cython.sock')
+        self.assertEqual(sources, [])
+        self.check_default_global_options()
+        self.check_default_options(options, ['compile_server'])
+
+    def test_profile_compile(self):
+        options, sources = parse_command_line([
+            '--profile-compile', 'report.json', 'source.pyx',
+        ])
+        self.assertEqual(options.profile_compile, 'report.json')
+        self.assertEqual(sources, ['source.pyx'])
+        self.check_default_global_options()
+        self.check_default_options(options, ['profile_compile'])
+
+    def test_low_memory(self):
+        options, sources = parse_command_line([
+            '--low-memory', 'source.pyx',
+        ])
+        self.assertTrue(options.low_memory)
+        self.check_default_global_options()
+        self.check_default_options(options, ['low_memory'])
+
     def test_errors(self):
         def error(args, regex=None):
             old_stderr = sys.stderr
@@ -0,0 +1,245 @@
+import os
+import shutil
+import tempfile
+import unittest
+
+from ..Main import compile_single, CompilationOptions, default_options
+
+
+class TestPxdCache(unittest.TestCase):
+
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp(
+            prefix='pxdcache-test',
+            dir='TEST_TMP' if os.path.isdir('TEST_TMP') else None)
+        self.cache_dir = os.path.join(self.temp_dir, 'cache')
+        self.write('decl.pxd', '''
+from libc.string cimport strlen
+
+cdef extern from *:
+    """
+    static int decl_answer(void) { return 42; }
+    """
+    int decl_answer()
+
+ctypedef struct Point:
+    double x
+    double y
+
+cdef class Base:
+    cdef Point p
+    cdef int get(self)
+
+cdef size_t decl_strlen "strlen"(const char* s)
+''')
+        self.write('helpers.pxd', '''
+from decl cimport decl_strlen
+
+cdef inline size_t decl_len(const char* s):
+    return decl_strlen(s)
+''')
+        self.write('decl.pyx', '''
+cdef class Base:
+    cdef int get(self):
+        return decl_answer()
+''')
+        self.write('user.pyx', '''
+from decl cimport Base, Point
+from helpers cimport decl_len
+from libc.stdlib cimport malloc, free
+
+cdef class Derived(Base):
+    cdef int get(self):
+        cdef Point p = self.p
+        return <int> (p.x + decl_len(b"abc"))
+
+def test():
+    cdef void* mem = malloc(10)
+    free(mem)
+    return Derived().get()
+''')
+
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, ignore_errors=True)
+
+    def write(self, filename, content):
+        with open(os.path.join(self.temp_dir, filename), 'w') as f:
+            f.write(content)
+
+    def cache_files(self):
+        if not os.path.isdir(self.cache_dir):
+            return []
+        return sorted(name for name in os.listdir(self.cache_dir) if name.endswith('.pxdcache'))
+
+    def compile(self, pxd_cache=None, module_name='user'):
+        source = os.path.join(self.temp_dir, module_name + '.pyx')
+        output = os.path.join(self.temp_dir, module_name + '.c')
+        options = CompilationOptions(
+            default_options, output_file=output, language_level=3,
+            include_path=[self.temp_dir], pxd_cache=pxd_cache)
+        result = compile_single(source, options, full_module_name=module_name)
+        self.assertEqual(0, result.num_errors)
+        with open(output) as f:
+            return f.read()
+
+    def test_cached_output_unchanged(self):
+        expected = self.compile()
+        self.assertEqual(expected, self.compile(self.cache_dir))
+        cache_files = self.cache_files()
+        self.assertTrue(any(name.startswith('decl-') for name in cache_files), cache_files)
+        self.assertTrue(any(name.startswith('libc.string-') for name in cache_files), cache_files)
+        # Inline functions are code, which is not cached.
+        self.assertFalse(any(name.startswith('helpers-') for name in cache_files), cache_files)
+
+        self.assertEqual(expected, self.compile(self.cache_dir))
+        self.assertEqual(cache_files, self.cache_files())
+
+    def test_cimport_heavy_module(self):
+        self.write('shapes.pxd', '''
+from libc.stdint cimport int64_t
+
+cdef enum Kind:
+    CIRCLE = 1
+    SQUARE
+
+cpdef enum Colour:
+    RED, GREEN
+
+ctypedef fused number:
+    int
+    double
+
+ctypedef double (*area_func)(const double *sizes, Py_ssize_t count) noexcept nogil
+
+ctypedef struct Box:
+    double corners[4][2]
+    int64_t tag
+    Kind kind
+
+cdef class Shape:
+    cdef readonly Kind kind
+    cdef public double scale
+    cdef area_func area
+    cdef double size(self, number factor)
+    cpdef (double, int) describe(self)
+
+cdef class Polygon(Shape):
+    cdef Box box
+    cdef int corners(self) except -1
+''')
+        self.write('heavy.pyx', '''
+from libc.stdlib cimport malloc, free, qsort
+from libc.string cimport memcpy, strlen
+from libc.math cimport sqrt, M_PI
+from libc.stdio cimport FILE, printf
+from libc.stdint cimport int64_t, uint8_t
+from libc.limits cimport INT_MAX
+from posix.unistd cimport getpid
+from cpython.ref cimport Py_INCREF
+from cpython.object cimport PyObject
+cimport shapes
+from shapes cimport Shape, Polygon, Box, Kind, Colour, number, area_func
+
+cdef class Hexagon(Polygon):
+    cdef int corners(self) except -1:
+        return 6
+
+cdef double scaled(number value, Shape shape):
+    return value * shape.scale
+
+def test():
+    cdef Box box
+    cdef Hexagon h = Hexagon()
+    cdef uint8_t *buffer = <uint8_t *> malloc(16)
+    memcpy(buffer, b"abc", 4)
+    free(buffer)
+    box.kind = shapes.SQUARE
+    return (h.corners(), scaled[int](2, h), box.kind, Colour.GREEN,
+            sqrt(M_PI) > 1, strlen(b"xy"), INT_MAX > 0)
+''')
+        expected = self.compile(module_name='heavy')
+        self.assertEqual(expected, self.compile(self.cache_dir, module_name='heavy'))
+        cache_files = self.cache_files()
+        for module_name in ('shapes', 'libc.stdlib', 'libc.stdint', 'posix.unistd'):
+            self.assertTrue(any(name.startswith(module_name + '-') for name in cache_files), (module_name, cache_files))
+
+        # Loaded from the cache.
+        self.assertEqual(expected, self.compile(self.cache_dir, module_name='heavy'))
+        self.assertEqual(cache_files, self.cache_files())
+
+    def test_invalidation(self):
+        self.compile(self.cache_dir)
+        cache_files = self.cache_files()
+        self.write('decl.pxd', '''
+ctypedef struct Point:
+    double x
+    double y
+    double z
+
+cdef class Base:
+    cdef Point p
+    cdef int get(self)
+
+cdef size_t decl_strlen(const char* s)
+''')
+        output = self.compile(self.cache_dir)
+        self.assertNotIn('decl_answer', output)
+        self.assertIn('double z;', output)
+        self.assertEqual(len(cache_files) + 1, len(self.cache_files()))
+
+    def test_include_order(self):
+        self.write('inner.pxd', '''
+cdef extern from "inner.h":
+    int inner_func()
+''')
+        # An uncached compilation includes outer1.h before inner.h.
+        self.write('outer.pxd', '''
+cdef extern from "outer1.h":
+    int outer1()
+from inner cimport inner_func
+cdef extern from "outer2.h":
+    """
+    /* outer verbatim */
+    """
+    int outer2()
+''')
+        self.write('include_order.pyx', '''
+from outer cimport outer1, outer2
+def test():
+    return outer1() + outer2()
+''')
+        expected = self.compile(module_name='include_order')
+        self.assertLess(expected.index('"outer1.h"'), expected.index('"inner.h"'))
+        for _ in range(2):
+            self.assertEqual(expected, self.compile(self.cache_dir, module_name='include_order'))
+        cache_files = self.cache_files()
+        self.assertTrue(any(name.startswith('inner-') for name in cache_files), cache_files)
+        self.assertFalse(any(name.startswith('outer-') for name in cache_files), cache_files)
+
+    @unittest.skipUnless(hasattr(os, 'getuid'), "requires POSIX file permissions")
+    def test_shared_directory_not_used(self):
+        self.compile(self.cache_dir)
+        cache_files = self.cache_files()
+        self.assertTrue(cache_files)
+        self.assertEqual(0o700, os.stat(self.cache_dir).st_mode & 0o777)
+
+        # Entries that other users could have written are neither loaded nor replaced.
+        os.chmod(self.cache_dir, 0o770)
+        for name in cache_files:
+            with open(os.path.join(self.cache_dir, name), 'wb') as f:
+                f.write(b'invalid')
+        expected = self.compile()
+        self.assertEqual(expected, self.compile(self.cache_dir))
+        for name in cache_files:
+            with open(os.path.join(self.cache_dir, name), 'rb') as f:
+                self.assertEqual(b'invalid', f.read())
+
+    def test_fingerprint(self):
+        def fingerprint(**kwargs):
+            return CompilationOptions(default_options, **kwargs).get_fingerprint()
+        # The pxd cache does not change the C code, so cached builds can be reused either way.
+        self.assertEqual(fingerprint(), fingerprint(pxd_cache=self.cache_dir))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,11 +1,15 @@
+import os
+import tempfile
 import unittest
 from io import StringIO
 import string
 
+from .. import Lexicon
 from .. import Scanning
 from ..Symtab import ModuleScope
 from ..TreeFragment import StringParseContext
 from ..Errors import init_thread
+from ...Plex import Lexicon as PlexLexicon
 
 # generate some fake code - just a bunch of lines of the form "a0 a1 ..."
 code = []
@@ -18,7 +22,7 @@ init_thread()
 
 
 class TestScanning(unittest.TestCase):
-    def make_scanner(self):
+    def make_scanner(self, code=code):
         source = Scanning.StringSourceDescriptor("fake code", code)
         buf = StringIO(code)
         context = StringParseContext("fake context")
@@ -127,7 +131,38 @@ class TestScanning(unittest.TestCase):
             scanner.error("Oooops")
         self.assertEqual((scanner.sy, scanner.systring), (sy1, systring1))
 
-
+    def test_unicode_identifiers(self):
+        scanner = self.make_scanner("caf\xe9 \u03a9mega x\u0394\u0394 \u4e2d\u6587x\n")
+        tokens = []
+        while scanner.sy != "NEWLINE":
+            tokens.append((scanner.sy, scanner.systring))
+            scanner.next()
+        self.assertEqual([
+            ("IDENT", "caf\xe9"), ("IDENT", "\u03a9mega"), ("IDENT", "x\u0394\u0394"),
+            ("IDENT", "\u4e2d\u6587x"),
+        ], tokens)
+
+    def test_lexicon_tables(self):
+        def dump(lexicon):
+            out = StringIO()
+            lexicon.machine.dump(out)
+            return out.getvalue()
+
+        lexicon = Lexicon.make_lexicon()
+        tables = lexicon.get_tables()
+        loaded = PlexLexicon.from_tables(tables)
+        self.assertEqual(dump(lexicon), dump(loaded))
+        self.assertEqual(tables, loaded.get_tables())
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            path = os.path.join(temp_dir, "Lexicon.tables")
+            self.assertIsNone(Lexicon.load_lexicon_tables(path))
+            Lexicon.write_lexicon_tables(path)
+            self.assertIsNotNone(Lexicon.load_lexicon_tables(path))
+
+            with open(path, "wb") as f:
+                f.write(b"broken")
+            self.assertIsNone(Lexicon.load_lexicon_tables(path))
 
 
 if __name__ == "__main__":
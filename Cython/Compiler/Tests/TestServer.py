@@ -0,0 +1,97 @@
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+from unittest import mock
+
+from .. import Server
+
+package_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))))
+
+
+@unittest.skipUnless(Server.is_supported(), "requires Unix domain sockets with descriptor passing")
+class TestServer(unittest.TestCase):
+
+    def setUp(self):
+        # Unix socket paths are limited in length, so we avoid deep directories.
+        self.temp_dir = tempfile.mkdtemp(prefix='server-test')
+        self.socket_path = os.path.join(self.temp_dir, 'cython.sock')
+        self.pxd_cache = os.path.join(self.temp_dir, 'pxd_cache')
+        env = dict(os.environ, PYTHONPATH=package_root)
+        self.server = subprocess.Popen(
+            [sys.executable, '-c',
+             'from Cython.Compiler.Server import serve; serve(%r, %r, quiet=True)' % (
+                 self.socket_path, self.pxd_cache)],
+            env=env)
+        for _ in range(600):
+            if os.path.exists(self.socket_path) or self.server.poll() is not None:
+                break
+            time.sleep(0.1)
+        self.assertTrue(os.path.exists(self.socket_path))
+
+    def tearDown(self):
+        self.server.terminate()
+        self.server.wait()
+        shutil.rmtree(self.temp_dir, ignore_errors=True)
+
+    def write(self, filename, content):
+        with open(os.path.join(self.temp_dir, filename), 'w') as f:
+            f.write(content)
+
+    def test_compile(self):
+        self.write('decl.pxd', 'ctypedef int myint\n')
+        self.write('mod.pyx', 'from decl cimport myint\ndef f(myint x):\n    return x\n')
+        args = ['-3', os.path.join(self.temp_dir, 'mod.pyx')]
+        self.assertEqual(0, Server.compile_with_server(self.socket_path, args))
+        self.assertTrue(os.path.exists(os.path.join(self.temp_dir, 'mod.c')))
+        self.assertTrue(any(name.startswith('decl-') for name in os.listdir(self.pxd_cache)))
+
+    def test_compile_error(self):
+        self.write('broken.pyx', 'def f(:\n')
+        with open(os.devnull, 'w') as devnull:
+            old_stderr = os.dup(2)
+            os.dup2(devnull.fileno(), 2)
+            try:
+                status = Server.compile_with_server(
+                    self.socket_path, [os.path.join(self.temp_dir, 'broken.pyx')])
+            finally:
+                os.dup2(old_stderr, 2)
+                os.close(old_stderr)
+        self.assertEqual(1, status)
+
+    def test_large_request(self):
+        # Larger than a single sendmsg() call transfers.
+        self.write('mod.pyx', 'def f(x):\n    return x\n')
+        args = ['-3', os.path.join(self.temp_dir, 'mod.pyx')]
+        with mock.patch.dict(os.environ, CYTHON_TEST_PADDING='x' * (4 * 1024 * 1024)):
+            self.assertEqual(0, Server.compile_with_server(self.socket_path, args))
+        self.assertTrue(os.path.exists(os.path.join(self.temp_dir, 'mod.c')))
+
+    def test_socket_is_private(self):
+        self.assertEqual(0o600, os.stat(self.socket_path).st_mode & 0o777)
+
+    def test_idle_client_does_not_block(self):
+        self.write('mod.pyx', 'def f(x):\n    return x\n')
+        idle = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            idle.connect(self.socket_path)
+            args = ['-3', os.path.join(self.temp_dir, 'mod.pyx')]
+            self.assertEqual(0, Server.compile_with_server(self.socket_path, args))
+        finally:
+            idle.close()
+
+    def test_no_server(self):
+        self.assertIsNone(Server.compile_with_server(os.path.join(self.temp_dir, 'missing.sock'), []))
+
+    def test_server_stops(self):
+        self.server.terminate()
+        self.server.wait()
+        self.assertFalse(os.path.exists(self.socket_path))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,7 +1,7 @@
 from Cython.Compiler.ModuleNode import ModuleNode
 from Cython.Compiler.Symtab import ModuleScope
 from Cython.TestUtils import TransformTest
-from Cython.Compiler.Visitor import MethodDispatcherTransform
+from Cython.Compiler.Visitor import MethodDispatcherTransform, TreeVisitor
 from Cython.Compiler.ParseTreeTransforms import (
     NormalizeTree, AnalyseDeclarationsTransform,
     AnalyseExpressionsTransform, InterpretCompilerDirectives)
@@ -59,3 +59,53 @@ class TestMethodDispatcherTransform(TransformTest):
         Test(None)(tree)
         self.assertEqual(1, calls['bytes'])
         self.assertEqual(0, calls['object'])
+
+
+class TestDispatchTables(TransformTest):
+
+    def test_dispatch_table_per_class(self):
+        class Base(TreeVisitor):
+            def visit_Node(self, node):
+                self.visited.append(('Node', type(node).__name__))
+                self.visitchildren(node)
+
+            def visit_ExprNode(self, node):
+                self.visited.append(('ExprNode', type(node).__name__))
+
+        class Sub(Base):
+            def visit_NameNode(self, node):
+                self.visited.append(('NameNode', node.name))
+
+        tree = self.fragment("x = y").root
+        results = []
+        for visitor_class in [Base, Base, Sub]:
+            visitor = visitor_class()
+            visitor.visited = []
+            visitor.visit(tree)
+            results.append(visitor.visited)
+
+        self.assertEqual(results[0], results[1])
+        self.assertIn(('ExprNode', 'NameNode'), results[0])
+        self.assertIn(('NameNode', 'y'), results[2])
+        self.assertNotIn(('ExprNode', 'NameNode'), results[2])
+
+    def test_count_visited_nodes(self):
+        class Visitor(TreeVisitor):
+            def visit_Node(self, node):
+                self.visitchildren(node)
+
+        tree = self.fragment("x = y + z").root
+        visitor = Visitor()
+        visitor.visit(tree)
+        self.assertEqual(0, visitor.visited_nodes)
+
+        visitor.count_visited_nodes()
+        visitor.visit(tree)
+        count = visitor.visited_nodes
+        self.assertGreater(count, 4)
+        visitor.visit(tree)
+        self.assertEqual(2 * count, visitor.visited_nodes)
+
+        other = Visitor()
+        other.visit(tree)
+        self.assertEqual(0, other.visited_nodes)
@@ -79,7 +79,14 @@ class MarkParallelAssignments(EnvTransform):
         return node
 
     def visit_SingleAssignmentNode(self, node):
-        self.mark_assignment(node.lhs, node.rhs)
+        if node.reduction_operator:
+            # marked by ParallelRangeTransform, check that the builtin
+            # min() or max() is used directly in the prange loop
+            entry = self.current_env().lookup(node.reduction_operator)
+            if ((entry and not entry.is_builtin) or not self.parallel_block_stack or
+                    not self.parallel_block_stack[-1].is_prange):
+                node.reduction_operator = None
+        self.mark_assignment(node.lhs, node.rhs, node.reduction_operator)
         self.visitchildren(node)
         return node
 
@@ -243,6 +250,11 @@ class MarkParallelAssignments(EnvTransform):
         self.parallel_errors = False
         return node
 
+    def visit_ParallelThreadIdNode(self, node):
+        # the outermost block decides how threads are numbered
+        node.parallel_block = self.parallel_block_stack[0] if self.parallel_block_stack else None
+        return node
+
     def visit_YieldExprNode(self, node):
         if self.parallel_block_stack:
             error(node.pos, "'%s' not allowed in parallel sections" % node.expr_keyword)
@@ -458,6 +458,9 @@ class ConstructorSlot(InternalMethodSlot):
                 and not (self.slot_name == 'tp_new' and scope.parent_type.vtabslot_cname)):
             entry = scope.lookup_here(self.method) if self.method else None
             if not (entry and entry.is_special):
+                if self.slot_name == 'tp_new' and scope.sets_vectorcall_call():
+                    # tp_new() sets the vectorcall function of the instance
+                    return True
                 return False
         # Unless we can safely delegate to the parent, all types need a tp_new().
         return True
@@ -3,8 +3,11 @@ cimport cython
 cdef class TreeVisitor:
     cdef public list access_path
     cdef dict dispatch_table
+    cdef public Py_ssize_t visited_nodes
+    cdef bint counting_nodes
 
     cpdef visit(self, obj)
+    cpdef count_visited_nodes(self)
     cdef _visit(self, obj)
     cdef find_handler(self, obj)
     cdef _visitchild(self, child, parent, attrname, idx)
@@ -21,6 +21,10 @@ import cython
 
 _PRINTABLE = cython.declare(tuple, (bytes, str, int, float, complex))
 
+# Maps each visitor class to its dispatch table, which maps node types to
+# (unbound) visitor methods.  Shared by all instances of a visitor class.
+_dispatch_tables = cython.declare(dict, {})
+
 
 class TreeVisitor:
     """
@@ -67,8 +71,14 @@ class TreeVisitor:
     """
     def __init__(self):
         super().__init__()
-        self.dispatch_table = {}
+        cls = type(self)
+        try:
+            self.dispatch_table = _dispatch_tables[cls]
+        except KeyError:
+            self.dispatch_table = _dispatch_tables[cls] = {}
         self.access_path = []
+        self.visited_nodes = 0
+        self.counting_nodes = False
 
     def dump_node(self, node):
         ignored = list(node.child_attrs or []) + [
@@ -146,8 +156,9 @@ class TreeVisitor:
         # to resolve, try entire hierarchy
         cls = type(obj)
         mro = inspect.getmro(cls)
+        visitor_cls = type(self)
         for mro_cls in mro:
-            handler_method = getattr(self, "visit_" + mro_cls.__name__, None)
+            handler_method = getattr(visitor_cls, "visit_" + mro_cls.__name__, None)
             if handler_method is not None:
                 return handler_method
 
@@ -162,6 +173,16 @@ class TreeVisitor:
         # generic def entry point for calls from Python subclasses
         return self._visit(obj)
 
+    def count_visited_nodes(self):
+        """
+        Count the visited nodes in 'visited_nodes' from now on.  This uses a
+        separate dispatch table of counting handlers, so that visitors which
+        are not profiled do not pay for the counting.
+        """
+        if not self.counting_nodes:
+            self.counting_nodes = True
+            self.dispatch_table = {}
+
     @cython.final
     def _visit(self, obj):
         # fast cdef entry point for calls from Cython subclasses
@@ -170,8 +191,10 @@ class TreeVisitor:
                 handler_method = self.dispatch_table[type(obj)]
             except KeyError:
                 handler_method = self.find_handler(obj)
+                if self.counting_nodes:
+                    handler_method = _counting_handler(handler_method)
                 self.dispatch_table[type(obj)] = handler_method
-            return handler_method(obj)
+            return handler_method(self, obj)
         except Errors.CompileError:
             raise
         except Errors.AbortError:
@@ -209,9 +232,13 @@ class TreeVisitor:
 
         if parent is None: return None
         result = {}
-        for attr in parent.child_attrs:
-            if attrs is not None and attr not in attrs: continue
-            if exclude is not None and attr in exclude: continue
+        child_attrs = parent.child_attrs
+        if attrs is not None or exclude is not None:
+            child_attrs = [
+                attr for attr in child_attrs
+                if (attrs is None or attr in attrs) and (exclude is None or attr not in exclude)
+            ]
+        for attr in child_attrs:
             child = getattr(parent, attr)
             if child is not None:
                 if type(child) is list:
@@ -223,6 +250,13 @@ class TreeVisitor:
         return result
 
 
+def _counting_handler(handler_method):
+    def count_and_visit(visitor, obj):
+        visitor.visited_nodes += 1
+        return handler_method(visitor, obj)
+    return count_and_visit
+
+
 class VisitorTransform(TreeVisitor):
     """
     A tree transform is a base class for visitors that wants to do stream
@@ -20,7 +20,7 @@ and as a general human debugging helper, it always copies the current source cod
        *         z = 0                    # 3
        *         z += cy_add_nogil(x, y)  # 4
        */
-       __Pyx_TraceLine(147,1,__PYX_ERR(0, 147, __pyx_L4_error))
+       __Pyx_TraceLine(147,0,1,__PYX_ERR(0, 147, __pyx_L4_error))
       [C code generated for file line_trace.pyx, line 147, follows here]
 
 The crux is that multiple source files can contribute code to a single C (or C++) file
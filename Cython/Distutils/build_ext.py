@@ -1,5 +1,6 @@
 import sys
 import os
+import sysconfig
 
 # Always inherit from the "build_ext" in distutils since setuptools already imports
 # it from Cython if available, and does the proper distutils fallback otherwise.
@@ -47,6 +48,8 @@ class build_ext(_build_ext):
              "generate debug information for cygdb"),
         ('cython-compile-time-env', None,
             "cython compile time environment"),
+        ('cython-cache=', None,
+            "directory of a shared cache for generated C files and compiled modules"),
         ]
 
     boolean_options = _build_ext.boolean_options + [
@@ -65,6 +68,7 @@ class build_ext(_build_ext):
         self.cython_gen_pxi = 0
         self.cython_gdb = False
         self.cython_compile_time_env = None
+        self.cython_cache = None
 
     def finalize_options(self):
         super().finalize_options()
@@ -126,12 +130,69 @@ class build_ext(_build_ext):
             'compile_time_env': self.get_extension_attr(ext, 'cython_compile_time_env', default=None),
         }
 
+        cache_path = self.get_extension_attr(ext, 'cython_cache', default=None)
+        if cache_path:
+            options['cache'] = cache_path
+            options['cache_backend'] = self.get_cache_backend()
+
         new_ext = cythonize(
             ext,force=self.force, quiet=self.verbose == 0, **options
         )[0]
 
         ext.sources = new_ext.sources
+        if cache_path:
+            self.build_extension_cached(ext, cache_path)
+        else:
+            super().build_extension(ext)
+
+    def build_extension_cached(self, ext, cache_path):
+        from Cython.Build.Cache import get_cache
+
+        cache = get_cache(None if cache_path is True else cache_path, backend=self.get_cache_backend())
+        if not cache.supports_compiled:
+            super().build_extension(ext)
+            return
+        ext_path = self.get_ext_fullpath(ext.name)
+        fingerprint = cache.compiled_fingerprint(
+            ext.sources, list(ext.depends or ()) + list(ext.extra_objects or ()),
+            self.get_compiler_config(ext))
+        if fingerprint and not self.force:
+            cached = cache.lookup_compiled(fingerprint)
+            if cached:
+                if self.verbose:
+                    sys.stdout.write("Found compiled %s in cache\n" % ext.name)
+                cache.load_compiled(cached, ext_path)
+                return
+
         super().build_extension(ext)
+        if fingerprint and os.path.exists(ext_path):
+            cache.store_compiled(fingerprint, ext_path)
+
+    def get_cache_backend(self):
+        # Only some backends can store compiled modules, the content-addressed one is the default.
+        return os.environ.get('CYTHON_CACHE_BACKEND') or 'content'
+
+    def get_compiler_config(self, ext):
+        """
+        Return everything that influences the compiled extension module
+        besides its sources, for the cache fingerprint.
+        """
+        compiler = self.compiler
+        return (
+            sys.version, sys.platform, sysconfig.get_config_var('EXT_SUFFIX'),
+            getattr(compiler, 'compiler_type', None),
+            getattr(compiler, 'compiler_so', None),
+            getattr(compiler, 'compiler_so_cxx', None),
+            getattr(compiler, 'linker_so', None),
+            getattr(compiler, 'include_dirs', None),
+            getattr(compiler, 'macros', None),
+            os.environ.get('CFLAGS'), os.environ.get('LDFLAGS'),
+            ext.language, ext.define_macros, ext.undef_macros,
+            ext.include_dirs, ext.extra_compile_args, ext.extra_link_args,
+            ext.libraries, ext.library_dirs, ext.runtime_library_dirs,
+            ext.export_symbols, getattr(ext, 'py_limited_api', False),
+            self.debug, self.define, self.undef, self.libraries, self.library_dirs,
+        )
 
 # backward compatibility
 new_build_ext = build_ext
@@ -14,6 +14,9 @@ from . import Regexps
 DUMP_NFA = 1
 DUMP_DFA = 2
 
+# Transitions on special events, in the order of the state tables.
+special_events = (Regexps.BOL, Regexps.EOL, Regexps.EOF, 'else')
+
 
 class State:
     """
@@ -142,6 +145,7 @@ class Lexicon:
             debug.write("\n============= DFA ===========\n")
             dfa.dump(debug)
 
+        dfa.add_run_patterns()
         self.machine = dfa
 
     def add_token_to_machine(self, machine, initial_state, token_spec, token_number):
@@ -176,3 +180,68 @@ class Lexicon:
 
     def get_initial_state(self, name):
         return self.machine.get_initial_state(name)
+
+    def get_tables(self):
+        """
+        Return the state machine as nested tuples of strings and ints
+        (e.g. for storing it with the marshal module), see from_tables().
+
+        Each state is represented by its action, the target states of the
+        special events and a flat sequence of (first, end, target) code point
+        ranges.  States are referenced by their index.
+        """
+        machine = self.machine
+        states = machine.states
+        index = {id(state): i for i, state in enumerate(states)}
+        state_tables = []
+        for state in states:
+            action = state['action']
+            if action is not None:
+                action = action.__reduce__()
+                if not isinstance(action, str):
+                    constructor, args = action
+                    action = (constructor.__name__, args)
+            specials = tuple(
+                index[id(state[event])] if state.get(event) is not None else -1
+                for event in special_events)
+            ranges = []
+            for code0, code1, target in sorted(machine.iter_char_transitions(state), key=lambda r: r[0]):
+                target = index[id(target)]
+                if ranges and ranges[-2] == code0 and ranges[-1] == target:
+                    ranges[-2] = code1
+                else:
+                    ranges.extend((code0, code1, target))
+            state_tables.append((action, specials, tuple(ranges)))
+        initial_states = tuple(sorted(
+            (name, index[id(state)]) for name, state in machine.initial_states.items()))
+        return initial_states, tuple(state_tables)
+
+    @classmethod
+    def from_tables(cls, tables):
+        """
+        Create a Lexicon from the result of get_tables(), without building
+        the state machine from the token specifications again.
+        """
+        initial_states, state_tables = tables
+        machine = Machines.FastMachine()
+        states = []
+        for action, _, _ in state_tables:
+            if action is not None:
+                if isinstance(action, str):
+                    action = getattr(Actions, action)
+                else:
+                    constructor, args = action
+                    action = getattr(Actions, constructor)(*args)
+            states.append(machine.new_state(action))
+        for state, (_, specials, ranges) in zip(states, state_tables):
+            for event, target in zip(special_events, specials):
+                if target >= 0:
+                    state[event] = states[target]
+            for i in range(0, len(ranges), 3):
+                machine.add_transitions(state, (ranges[i], ranges[i+1]), states[ranges[i+2]])
+        for name, target in initial_states:
+            machine.make_initial_state(name, states[target])
+        machine.add_run_patterns()
+        lexicon = cls.__new__(cls)
+        lexicon.machine = machine
+        return lexicon
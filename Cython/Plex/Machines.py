@@ -5,10 +5,18 @@ Classes for building NFAs and DFAs
 """
 
 import cython
+import re
+from bisect import bisect_right
 from .Transitions import TransitionMap
 
 maxint = 2**31-1  # sentinel value
 
+# Transitions on characters below this code point are stored directly in the
+# state dicts of a FastMachine.  Others (most notably the large Unicode ranges
+# of identifier characters) are stored as sorted ranges, see FastMachine.
+# Scanner.run_machine_inlined() relies on this limit.
+max_dict_char = 128
+
 LOWEST_PRIORITY = -maxint
 
 
@@ -121,13 +129,21 @@ class FastMachine:
     """
     FastMachine is a deterministic machine represented in a way that
     allows fast scanning.
+
+    Transitions on characters from max_dict_char upwards are stored in
+    state['ranges'] as three lists ([start], [end], [state]) of character
+    code ranges, sorted by their start.
+
+    States that loop back to themselves on some characters (like the inside
+    of an identifier, a comment or a string) can have a regex 'match'
+    function in state['run'], see add_run_patterns().
     """
     def __init__(self):
         self.initial_states = {}  # {state_name:state}
         self.states = []          # [state]  where state = {event:state, 'else':state, 'action':Action}
         self.next_number = 1      # for debugging
         self.new_state_template = {
-            '': None, 'bol': None, 'eol': None, 'eof': None, 'else': None
+            '': None, 'bol': None, 'eol': None, 'eof': None, 'else': None, 'ranges': None, 'run': None,
         }
 
     def __del__(self):
@@ -156,11 +172,78 @@ class FastMachine:
             if code0 == -maxint:
                 state['else'] = new_state
             elif code1 != maxint:
-                for code in range(code0, code1):
+                for code in range(code0, min(code1, max_dict_char)):
                     state[chr(code)] = new_state
+                if code1 > max_dict_char:
+                    self.add_range(state, max(code0, max_dict_char), code1, new_state)
         else:
             state[event] = new_state
 
+    def add_range(self, state: dict, code0: cython.int, code1: cython.int, new_state):
+        ranges = state['ranges']
+        if ranges is None:
+            ranges = state['ranges'] = ([], [], [])
+        starts, ends, targets = ranges
+        i: cython.Py_ssize_t = bisect_right(starts, code0)
+        if i > 0 and ends[i-1] == code0 and targets[i-1] is new_state:
+            # The DFA adds the transitions in ascending order, so this is the common case.
+            ends[i-1] = code1
+        else:
+            starts.insert(i, code0)
+            ends.insert(i, code1)
+            targets.insert(i, new_state)
+
+    def add_run_patterns(self):
+        """
+        Give each state that loops back to itself a matcher for the longest run
+        of such characters, which the Scanner consumes in one step.  Newlines
+        are excluded because the Scanner handles them separately.
+        """
+        for state in self.states:
+            state['run'] = self.make_run_pattern(state)
+
+    def make_run_pattern(self, state: dict):
+        loop_ranges = []
+        other_ranges = [(10, 11)]  # '\n'
+        for code0, code1, target in self.iter_char_transitions(state):
+            (loop_ranges if target is state else other_ranges).append((code0, code1))
+        if state['else'] is state:
+            # Everything except the characters that lead elsewhere.
+            char_class = '^' + self.ranges_to_char_class(other_ranges)
+        else:
+            loop_ranges = [
+                (start, end)
+                for code0, code1 in loop_ranges
+                for start, end in ([(code0, 10), (11, code1)] if code0 <= 10 < code1 else [(code0, code1)])
+                if start < end
+            ]
+            if not loop_ranges:
+                return None
+            char_class = self.ranges_to_char_class(loop_ranges)
+        return re.compile('[%s]*' % char_class).match
+
+    def ranges_to_char_class(self, ranges) -> str:
+        parts = []
+        for code0, code1 in sorted(ranges):
+            if code1 - code0 == 1:
+                parts.append(re.escape(chr(code0)))
+            else:
+                parts.append('%s-%s' % (re.escape(chr(code0)), re.escape(chr(code1 - 1))))
+        return ''.join(parts)
+
+    def iter_char_transitions(self, state: dict):
+        """
+        Iterate over the (first code, end code, target state) ranges of
+        character transitions of the state.
+        """
+        for c, target in state.items():
+            if len(c) == 1 and target is not None:
+                code = ord(c)
+                yield code, code + 1, target
+        ranges = state['ranges']
+        if ranges is not None:
+            yield from zip(*ranges)
+
     def get_initial_state(self, name):
         return self.initial_states[name]
 
@@ -185,14 +268,14 @@ class FastMachine:
     def dump_transitions(self, state, file):
         chars_leading_to_state = {}
         special_to_state = {}
+        for code0, code1, s in self.iter_char_transitions(state):
+            chars = chars_leading_to_state.get(id(s))
+            if chars is None:
+                chars = []
+                chars_leading_to_state[id(s)] = chars
+            chars.extend(map(chr, range(code0, code1)))
         for (c, s) in state.items():
-            if len(c) == 1:
-                chars = chars_leading_to_state.get(id(s))
-                if chars is None:
-                    chars = []
-                    chars_leading_to_state[id(s)] = chars
-                chars.append(c)
-            elif len(c) <= 4:
+            if 1 < len(c) <= 4:
                 special_to_state[c] = s
         ranges_to_state = {}
         for state in self.states:
@@ -4,6 +4,9 @@ import cython
 
 from Cython.Plex.Actions cimport Action
 
+cdef lookup_range(tuple ranges, str c)
+
+
 cdef class Scanner:
 
     cdef public lexicon
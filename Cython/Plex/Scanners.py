@@ -6,7 +6,9 @@ Scanning an input stream
 
 import cython
 
-cython.declare(BOL=object, EOL=object, EOF=object, NOT_FOUND=object)  # noqa:E402
+cython.declare(BOL=object, EOL=object, EOF=object, NOT_FOUND=object, bisect_right=object)  # noqa:E402
+
+from bisect import bisect_right
 
 from . import Errors
 from .Regexps import BOL, EOL, EOF
@@ -14,6 +16,19 @@ from .Regexps import BOL, EOL, EOF
 NOT_FOUND = object()
 
 
+def lookup_range(ranges: tuple, c: str):
+    """
+    Find the target state for a character in the sorted code ranges
+    of a FastMachine state, or return None.
+    """
+    starts, ends, targets = ranges
+    code = ord(c)
+    i: cython.Py_ssize_t = bisect_right(starts, code) - 1
+    if i >= 0 and code < ends[i]:
+        return targets[i]
+    return None
+
+
 class Scanner:
     """
     A Scanner is used to read tokens from a stream of characters
@@ -203,11 +218,23 @@ class Scanner:
             c = cur_char
             new_state = state.get(c, NOT_FOUND)
             if new_state is NOT_FOUND:
-                new_state = c and state.get('else')
+                new_state = None
+                if c > '\x7f':
+                    # non-ASCII characters are looked up in the code ranges
+                    ranges = state['ranges']
+                    if ranges is not None:
+                        new_state = lookup_range(ranges, c)
+                if new_state is None:
+                    new_state = c and state.get('else')
 
             if new_state:
                 if trace:
                     print("State %d" % new_state['number'])
+                elif new_state is state and input_state == 1:
+                    # Skip over the following characters that also loop back to this state.
+                    run = state['run']
+                    if run is not None:
+                        next_pos = buf_start_pos + run(buffer, next_pos - buf_start_pos).end()
                 state = new_state
                 # Begin inlined: self.next_char()
                 if input_state == 1:
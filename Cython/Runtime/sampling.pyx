@@ -0,0 +1,368 @@
+# cython: language_level=3, auto_pickle=False
+
+"""
+Sampling profiler for functions compiled with the 'sampling_profile' directive.
+
+Each such function pushes a static descriptor onto a per-thread shadow stack
+on entry and pops it on exit.  While the sampler is running, a SIGPROF timer
+copies the stack of the interrupted thread into a lock-free sample buffer,
+from which 'collect()' aggregates the samples.  No Python frames are created
+and the profiled code does not need to hold the GIL.
+
+    from Cython.Runtime import sampling
+    sampling.start(0.005)
+    ...
+    sampling.stop()
+    print(sampling.format_collapsed(sampling.collect()))
+
+The output of 'format_collapsed()' uses the "collapsed stack" format of
+FlameGraph, which most flame graph and profile viewers can read.
+
+The sampler is only available on POSIX systems with GCC compatible compilers.
+"""
+
+from cpython.exc cimport PyErr_SetFromErrno
+
+cdef extern from *:
+    """
+    #include <errno.h>
+    #include <stddef.h>
+    #include <stdlib.h>
+
+    // The layout of these structs must match the one in Cython/Utility/Profile.c.
+    #define __PYX_SAMPLING_ABI_VERSION 1
+    #define __PYX_SAMPLING_MAX_DEPTH 128
+
+    typedef struct {
+        const char *name;
+        const char *filename;
+        int lineno;
+    } __Pyx_SamplingSite;
+
+    typedef struct {
+        volatile int depth;
+        const __Pyx_SamplingSite *volatile frames[__PYX_SAMPLING_MAX_DEPTH];
+    } __Pyx_SamplingStack;
+
+    typedef struct {
+        int abi_version;
+        __Pyx_SamplingStack *(*get_stack)(void);
+    } __Pyx_SamplingAPIStruct;
+
+    #if defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+    #define __PYX_SAMPLER_SUPPORTED 1
+
+    #include <pthread.h>
+    #include <signal.h>
+    #include <string.h>
+    #include <sys/time.h>
+
+    #define __PYX_SAMPLER_BUFFER_SIZE 2048  /* power of two */
+
+    // One shadow stack per thread.  The entries are never freed, but reused
+    // after their thread has ended, so that the signal handler can walk the
+    // list without locking.
+    typedef struct __pyx_sampler_thread {
+        __Pyx_SamplingStack stack;
+        pthread_t owner;
+        int active;
+        int in_use;
+        struct __pyx_sampler_thread *next;
+    } __pyx_sampler_thread;
+
+    typedef struct {
+        size_t seq;
+        int depth;
+        const __Pyx_SamplingSite *frames[__PYX_SAMPLING_MAX_DEPTH];
+    } __pyx_sampler_slot;
+
+    static __pyx_sampler_thread *__pyx_sampler_threads = NULL;
+    static pthread_key_t __pyx_sampler_key;
+
+    // Bounded multi-producer queue (D. Vyukov) that is written from the signal
+    // handler and drained by collect() under the module lock.
+    static __pyx_sampler_slot *__pyx_sampler_buffer = NULL;
+    static size_t __pyx_sampler_head = 0;
+    static size_t __pyx_sampler_tail = 0;
+    static size_t __pyx_sampler_dropped = 0;
+    static int __pyx_sampler_running = 0;
+
+    static void __pyx_sampler_thread_exit(void *arg) {
+        __pyx_sampler_thread *thread = (__pyx_sampler_thread *) arg;
+        __atomic_store_n(&thread->active, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&thread->in_use, 0, __ATOMIC_RELEASE);
+    }
+
+    static __Pyx_SamplingStack *__pyx_sampler_get_stack(void) {
+        __pyx_sampler_thread *thread = (__pyx_sampler_thread *) pthread_getspecific(__pyx_sampler_key);
+        if (thread) return &thread->stack;
+        for (thread = __atomic_load_n(&__pyx_sampler_threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+            int unused = 0;
+            if (!__atomic_load_n(&thread->in_use, __ATOMIC_RELAXED) &&
+                    __atomic_compare_exchange_n(&thread->in_use, &unused, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                break;
+        }
+        if (!thread) {
+            thread = (__pyx_sampler_thread *) calloc(1, sizeof(__pyx_sampler_thread));
+            if (!thread) return NULL;
+            thread->in_use = 1;
+            thread->next = __atomic_load_n(&__pyx_sampler_threads, __ATOMIC_RELAXED);
+            while (!__atomic_compare_exchange_n(&__pyx_sampler_threads, &thread->next, thread,
+                                                0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+        }
+        thread->stack.depth = 0;
+        thread->owner = pthread_self();
+        if (pthread_setspecific(__pyx_sampler_key, thread)) {
+            __atomic_store_n(&thread->in_use, 0, __ATOMIC_RELEASE);
+            return NULL;
+        }
+        __atomic_store_n(&thread->active, 1, __ATOMIC_RELEASE);
+        return &thread->stack;
+    }
+
+    static void __pyx_sampler_record(__pyx_sampler_thread *thread, int depth) {
+        __pyx_sampler_slot *slot;
+        size_t pos = __atomic_load_n(&__pyx_sampler_head, __ATOMIC_RELAXED);
+        for (;;) {
+            size_t seq;
+            slot = &__pyx_sampler_buffer[pos & (__PYX_SAMPLER_BUFFER_SIZE - 1)];
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq == pos) {
+                if (__atomic_compare_exchange_n(&__pyx_sampler_head, &pos, pos + 1,
+                                                1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break;
+            } else if ((ptrdiff_t) (seq - pos) < 0) {
+                // buffer full, collect() was not called often enough
+                __atomic_fetch_add(&__pyx_sampler_dropped, 1, __ATOMIC_RELAXED);
+                return;
+            } else {
+                pos = __atomic_load_n(&__pyx_sampler_head, __ATOMIC_RELAXED);
+            }
+        }
+        if (depth > __PYX_SAMPLING_MAX_DEPTH) depth = __PYX_SAMPLING_MAX_DEPTH;
+        slot->depth = depth;
+        memcpy((void *) slot->frames, (const void *) thread->stack.frames, depth * sizeof(slot->frames[0]));
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    }
+
+    static void __pyx_sampler_handler(int signum) {
+        int saved_errno = errno;
+        pthread_t self = pthread_self();
+        __pyx_sampler_thread *thread;
+        (void) signum;
+        if (!__atomic_load_n(&__pyx_sampler_running, __ATOMIC_ACQUIRE)) return;
+        for (thread = __atomic_load_n(&__pyx_sampler_threads, __ATOMIC_ACQUIRE); thread; thread = thread->next) {
+            if (__atomic_load_n(&thread->active, __ATOMIC_ACQUIRE) && pthread_equal(thread->owner, self)) {
+                // We interrupted the owner of the stack, so its entries are complete up to 'depth'.
+                int depth = thread->stack.depth;
+                __atomic_signal_fence(__ATOMIC_SEQ_CST);
+                if (depth > 0) __pyx_sampler_record(thread, depth);
+                break;
+            }
+        }
+        errno = saved_errno;
+    }
+
+    static int __pyx_sampler_init(void) {
+        return pthread_key_create(&__pyx_sampler_key, __pyx_sampler_thread_exit);
+    }
+
+    static int __pyx_sampler_start(double interval) {
+        struct sigaction action;
+        struct itimerval timer;
+        if (!__pyx_sampler_buffer) {
+            size_t i;
+            __pyx_sampler_buffer = (__pyx_sampler_slot *) malloc(__PYX_SAMPLER_BUFFER_SIZE * sizeof(__pyx_sampler_slot));
+            if (!__pyx_sampler_buffer) return -1;
+            for (i = 0; i < __PYX_SAMPLER_BUFFER_SIZE; i++) __pyx_sampler_buffer[i].seq = i;
+        }
+        // The handler stays installed after stop(), so that a signal that is
+        // still pending cannot run into the default action (terminating the process).
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = __pyx_sampler_handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, NULL)) return -1;
+        __atomic_store_n(&__pyx_sampler_running, 1, __ATOMIC_RELEASE);
+        timer.it_interval.tv_sec = (time_t) interval;
+        timer.it_interval.tv_usec = (suseconds_t) ((interval - (double) timer.it_interval.tv_sec) * 1e6);
+        if (!timer.it_interval.tv_sec && !timer.it_interval.tv_usec) timer.it_interval.tv_usec = 1;
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, NULL)) {
+            __atomic_store_n(&__pyx_sampler_running, 0, __ATOMIC_RELEASE);
+            return -1;
+        }
+        return 0;
+    }
+
+    static int __pyx_sampler_stop(void) {
+        struct itimerval timer;
+        memset(&timer, 0, sizeof(timer));
+        __atomic_store_n(&__pyx_sampler_running, 0, __ATOMIC_RELEASE);
+        return setitimer(ITIMER_PROF, &timer, NULL);
+    }
+
+    // Returns the depth of the next sample, or -1 if the buffer is empty.
+    static int __pyx_sampler_next(const __Pyx_SamplingSite ***frames) {
+        __pyx_sampler_slot *slot;
+        if (!__pyx_sampler_buffer) return -1;
+        slot = &__pyx_sampler_buffer[__pyx_sampler_tail & (__PYX_SAMPLER_BUFFER_SIZE - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != __pyx_sampler_tail + 1) return -1;
+        *frames = slot->frames;
+        return slot->depth;
+    }
+
+    static void __pyx_sampler_release(void) {
+        __pyx_sampler_slot *slot = &__pyx_sampler_buffer[__pyx_sampler_tail & (__PYX_SAMPLER_BUFFER_SIZE - 1)];
+        __atomic_store_n(&slot->seq, __pyx_sampler_tail + __PYX_SAMPLER_BUFFER_SIZE, __ATOMIC_RELEASE);
+        __pyx_sampler_tail++;
+    }
+
+    static size_t __pyx_sampler_take_dropped(void) {
+        return __atomic_exchange_n(&__pyx_sampler_dropped, 0, __ATOMIC_RELAXED);
+    }
+
+    #else
+    #define __PYX_SAMPLER_SUPPORTED 0
+    static __Pyx_SamplingStack *__pyx_sampler_get_stack(void) { return NULL; }
+    #define __pyx_sampler_init() 0
+    #define __pyx_sampler_start(interval) (errno = ENOSYS, -1)
+    #define __pyx_sampler_stop() 0
+    #define __pyx_sampler_next(frames) (-1)
+    #define __pyx_sampler_release()
+    #define __pyx_sampler_take_dropped() 0
+    #endif
+    """
+    const int MAX_DEPTH "__PYX_SAMPLING_MAX_DEPTH"
+    const bint SUPPORTED "__PYX_SAMPLER_SUPPORTED"
+
+    ctypedef struct SamplingSite "__Pyx_SamplingSite":
+        const char *name
+        const char *filename
+        int lineno
+
+    ctypedef struct SamplingStack "__Pyx_SamplingStack":
+        int depth
+        const SamplingSite **frames
+
+    ctypedef struct SamplingAPIStruct "__Pyx_SamplingAPIStruct":
+        int abi_version
+        SamplingStack *(*get_stack)() noexcept nogil
+
+    const int ABI_VERSION "__PYX_SAMPLING_ABI_VERSION"
+
+    SamplingStack *get_stack "__pyx_sampler_get_stack" () noexcept nogil
+    int sampler_init "__pyx_sampler_init" () noexcept
+    int sampler_start "__pyx_sampler_start" (double interval) noexcept
+    int sampler_stop "__pyx_sampler_stop" () noexcept
+    int sampler_next "__pyx_sampler_next" (const SamplingSite ***frames) noexcept
+    void sampler_release "__pyx_sampler_release" () noexcept
+    size_t sampler_take_dropped "__pyx_sampler_take_dropped" () noexcept
+
+cdef extern from "Python.h":
+    object PyLong_FromVoidPtr(void*)
+
+
+if sampler_init() != 0:
+    raise OSError("failed to initialise the sampling profiler")
+
+import threading
+_lock = threading.Lock()
+_running = False
+
+#: Number of samples that were lost because the buffer was full.
+dropped_samples = 0
+
+
+cdef tuple _site(const SamplingSite *site):
+    return (site.name.decode('UTF-8', 'replace'),
+            site.filename.decode('UTF-8', 'replace'),
+            site.lineno)
+
+
+cdef tuple _stack(const SamplingSite **frames, int depth):
+    if depth > MAX_DEPTH:
+        depth = MAX_DEPTH
+    return tuple([_site(frames[i]) for i in range(depth)])
+
+
+def start(double interval=0.01):
+    """
+    Start sampling the shadow stacks of all threads every 'interval'
+    seconds of CPU time.
+    """
+    global _running
+    if interval <= 0:
+        raise ValueError("interval must be positive")
+    with _lock:
+        if _running:
+            raise RuntimeError("the sampling profiler is already running")
+        if sampler_start(interval) != 0:
+            PyErr_SetFromErrno(OSError)
+        _running = True
+
+
+def stop():
+    """
+    Stop sampling.  The samples taken so far remain available to 'collect()'.
+    """
+    global _running
+    with _lock:
+        if _running:
+            sampler_stop()
+            _running = False
+
+
+def is_running():
+    return _running
+
+
+def collect():
+    """
+    Return the samples taken since the last call as a dict that maps call
+    stacks (tuples of (function name, filename, line) tuples, outermost
+    first) to their number of samples.
+    """
+    global dropped_samples
+    cdef const SamplingSite **frames = NULL
+    cdef int depth
+    samples = {}
+    with _lock:
+        while True:
+            depth = sampler_next(&frames)
+            if depth < 0:
+                break
+            key = _stack(frames, depth)
+            sampler_release()
+            samples[key] = samples.get(key, 0) + 1
+        dropped_samples += sampler_take_dropped()
+    return samples
+
+
+def current_stack():
+    """
+    Return the shadow stack of the calling thread, outermost function first.
+    """
+    cdef SamplingStack *stack = get_stack()
+    if stack is NULL:
+        return ()
+    return _stack(<const SamplingSite **> stack.frames, stack.depth)
+
+
+def format_collapsed(samples):
+    """
+    Format the result of 'collect()' in the collapsed stack format,
+    one "frame;frame;... count" line per call stack.
+    """
+    lines = []
+    for stack, count in sorted(samples.items()):
+        lines.append("%s %d" % (
+            ";".join(["%s (%s:%d)" % frame for frame in stack]), count))
+    return "\n".join(lines)
+
+
+cdef SamplingAPIStruct api
+api.abi_version = ABI_VERSION
+api.get_stack = get_stack
+
+SamplingAPI = PyLong_FromVoidPtr(<void*>&api)
@@ -104,11 +104,11 @@ cclass = ccall = cfunc = _EmptyDecoratorAndManager()
 
 annotation_typing = returns = wraparound = boundscheck = initializedcheck = \
     nonecheck = embedsignature = cdivision = cdivision_warnings = \
-    always_allow_keywords = profile = linetrace = infer_types = \
-    unraisable_tracebacks = freelist = auto_pickle = cpow = trashcan = \
+    always_allow_keywords = profile = sampling_profile = linetrace = infer_types = \
+    unraisable_tracebacks = freelist = freelist_pool = auto_pickle = cpow = trashcan = \
     auto_cpdef = c_api_binop_methods = \
     allow_none_for_extension_args = callspec = show_performance_hints = \
-    cpp_locals = py2_import = iterable_coroutine = remove_unreachable = \
+    cpp_locals = py2_import = iterable_coroutine = remove_unreachable = parallel_backend = \
         lambda _: _EmptyDecoratorAndManager()
 
 # Note that fast_getattr is untested and undocumented!
@@ -121,7 +121,7 @@ optimize = _Optimization()
 
 
 embedsignature.format = overflowcheck.fold = optimize.use_switch = \
-    optimize.unpack_method_calls = lambda arg: _EmptyDecoratorAndManager()
+    optimize.unpack_method_calls = optimize.cache_attribute_lookups = lambda arg: _EmptyDecoratorAndManager()
 
 final = internal = type_version_tag = no_gc_clear = no_gc = total_ordering = \
     ufunc = _empty_decorator
@@ -226,6 +226,23 @@ gil = _nogil()
 with_gil = _nogil()  # Actually not a context manager, but compilation will give the right error.
 del _nogil
 
+class _critical_section:
+    """Support for 'with critical_section(obj)' statement and @critical_section decorator.
+    """
+    def __call__(self, arg, arg2=None):
+        if arg2 is None and (isinstance(arg, type) or callable(arg) and hasattr(arg, '__code__')):
+            # Used as function or class decorator => return it unchanged.
+            return arg
+        return self
+
+    def __enter__(self):
+        pass
+    def __exit__(self, exc_class, exc, tb):
+        return False
+
+critical_section = _critical_section()
+del _critical_section
+
 
 # Emulated types
 
@@ -539,7 +556,7 @@ class CythonDotParallel:
     def parallel(self, num_threads=None):
         return nogil
 
-    def prange(self, start=0, stop=None, step=1, nogil=False, schedule=None, chunksize=None, num_threads=None):
+    def prange(self, start=0, stop=None, step=1, nogil=False, schedule=None, chunksize=None, num_threads=None, reduction=None):
         if stop is None:
             stop = start
             start = 0
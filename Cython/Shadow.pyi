@@ -114,7 +114,7 @@ def _compiler_directive(__val: bool = ...) -> _Decorator: ...
 # Note that c_api_binop_methods and type_version_tag is defined above.
 
 boundscheck = wraparound = initializedcheck = nonecheck = cdivision = \
-    cdivision_warnings = profile = linetrace = infer_types = \
+    cdivision_warnings = profile = sampling_profile = linetrace = infer_types = \
     emit_code_comments = _empty_decorator_and_manager
 
 binding = embedsignature = always_allow_keywords = unraisable_tracebacks = \
@@ -128,6 +128,12 @@ class _OverflowcheckClass:
 
 overflowcheck = _OverflowcheckClass()
 
+def freelist(__size: int) -> _Decorator: ...
+
+def freelist_pool(__size: int) -> _Decorator: ...
+
+def parallel_backend(__backend: str) -> _Decorator: ...
+
 class optimize:
     @staticmethod
     def use_switch(__val: bool = ...) -> _Decorator: ...
@@ -135,6 +141,9 @@ class optimize:
     @staticmethod
     def unpack_method_calls(__val: bool = ...) -> _Decorator: ...
 
+    @staticmethod
+    def cache_attribute_lookups(__val: bool = ...) -> _Decorator: ...
+
 class warn:
     @staticmethod
     def undeclared(__val: bool = ...) -> _Decorator: ...
@@ -223,6 +232,28 @@ class _nogil:
 nogil = gil = _nogil
 
 
+class _critical_section:
+    @overload
+    def __call__(self, __val: bool) -> _Decorator: ...
+
+    @overload
+    def __call__(self, __func: _C) -> _C: ...
+
+    @overload
+    def __call__(self, __obj: Any, __obj2: Any = ...) -> '_critical_section': ...
+
+    def __enter__(self) -> None: ...
+
+    def __exit__(
+        self,
+        exc_type: Optional[Type[BaseException]],
+        exc: Optional[BaseException],
+        tb: Optional[TracebackType]
+    ) -> None: ...
+
+critical_section: _critical_section
+
+
 class _ArrayType(Generic[_T]):
     is_array: bool
     subtypes: Sequence[str]
@@ -8,6 +8,7 @@ cdef class StringIOTree:
     cdef public object stream
     cdef public object write
     cdef public list markers
+    cdef public object spill
 
     cpdef bint empty(self)
     cpdef getvalue(self)
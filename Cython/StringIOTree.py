@@ -31,24 +31,88 @@ EXAMPLE:
 >>> a.copyto(out)
 >>> out.getvalue().split()
 ['first', 'second', 'alpha', 'inserted', 'beta', 'gamma', 'third']
+
+A tree (and all insertion points created from it) can move the parts that
+are finished, i.e. everything that was written before an insertion point,
+to a temporary file instead of keeping them in memory:
+
+>>> spill = SpillFile(min_size=0)
+>>> s = StringIOTree(spill=spill)
+>>> _= s.write('first\n')
+>>> t = s.insertion_point()
+>>> _= s.write('third\n')
+>>> _= t.write('second\n')
+>>> s.getvalue().split()
+['first', 'second', 'third']
+>>> spill.close()
 """
 
 
 from io import StringIO
 
 
+class SpillFile:
+    """
+    A temporary file that stores the finished parts of StringIOTrees.
+    Parts shorter than 'min_size' characters stay in memory.
+    """
+    def __init__(self, min_size=4096):
+        import tempfile
+        self.min_size = min_size
+        self.file = tempfile.TemporaryFile()
+        self.size = 0
+
+    def store(self, stream):
+        """
+        Return a stream-like replacement for the finished StringIO 'stream',
+        or the stream itself if it is too short to be worth storing.
+        """
+        if stream.tell() < self.min_size:
+            return stream
+        data = stream.getvalue().encode('utf-8', 'surrogatepass')
+        offset = self.size
+        self.file.seek(offset)
+        self.file.write(data)
+        self.size += len(data)
+        return _SpilledStream(self, offset, len(data))
+
+    def load(self, offset, length):
+        self.file.seek(offset)
+        return self.file.read(length).decode('utf-8', 'surrogatepass')
+
+    def close(self):
+        self.file.close()
+
+
+class _SpilledStream:
+    """
+    The read-only content of a finished StringIOTree buffer in a SpillFile.
+    """
+    def __init__(self, spill, offset, length):
+        self.spill = spill
+        self.offset = offset
+        self.length = length
+
+    def tell(self):
+        return self.length
+
+    def getvalue(self):
+        return self.spill.load(self.offset, self.length)
+
+
 class StringIOTree:
     """
     See module docs.
     """
 
-    def __init__(self, stream=None):
+    def __init__(self, stream=None, spill=None):
         self.prepended_children = []
         if stream is None:
             stream = StringIO()
         self.stream = stream
-        self.write = stream.write
+        self.write = getattr(stream, 'write', None)
         self.markers = []
+        self.spill = spill
 
     def empty(self):
         if self.stream.tell():
@@ -82,7 +146,10 @@ class StringIOTree:
         # Save what we have written until now so that the buffer
         # itself is empty -- this makes it ready for insertion
         if self.stream.tell():
-            self.prepended_children.append(StringIOTree(self.stream))
+            stream = self.stream
+            if self.spill is not None:
+                stream = self.spill.store(stream)
+            self.prepended_children.append(StringIOTree(stream))
             self.prepended_children[-1].markers = self.markers
             self.markers = []
             self.stream = StringIO()
@@ -115,7 +182,7 @@ class StringIOTree:
         # This is so that getvalue on the result doesn't include it.
         self.commit()
         # Construct the new forked object to return
-        other = StringIOTree()
+        other = StringIOTree(spill=self.spill)
         self.prepended_children.append(other)
         return other
 
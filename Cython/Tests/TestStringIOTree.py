@@ -55,6 +55,18 @@ class TestStringIOTree(unittest.TestCase):
         self.assertEqual(self.tree.allmarkers(), list(range(1, 17)))
         self.assertEqual(code.strip(), self.tree.getvalue().strip())
 
+    def test_spill(self):
+        spill = stringtree.SpillFile(min_size=0)
+        self.addCleanup(spill.close)
+        self.tree = stringtree.StringIOTree(spill=spill)
+        self.test_insertion()
+        self.assertGreater(spill.size, 0)
+        self.assertFalse(self.tree.empty())
+
+        out = stringtree.StringIO()
+        self.tree.copyto(out)
+        self.assertEqual(code.strip(), out.getvalue().strip())
+
 
     def write_lines(self, linenos, tree=None):
         for lineno in linenos:
@@ -695,3 +695,357 @@ static int __Pyx__DelItemOnTypeDict(PyTypeObject *tp, PyObject *k) {
     if (likely(!result)) PyType_Modified(tp);
     return result;
 }
+
+////////////////// FreelistPool.proto //////////////////////////
+//@requires: ModuleSetupCode.c::ThreadLocal
+//@requires: ModuleSetupCode.c::AccessPyMutexForFreeThreading
+
+// Two level freelist for extension types: each thread keeps a small cache of
+// instances and exchanges batches of them with a shared pool when it runs empty or full.
+// Without free-threading, the GIL protects a single module wide cache.
+#ifndef CYTHON_USE_FREELIST_POOLS
+  #if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING && !CYTHON_COMPILING_IN_LIMITED_API
+    #ifdef CYTHON_THREAD_LOCAL
+      #define CYTHON_USE_FREELIST_POOLS 1
+    #else
+      #define CYTHON_USE_FREELIST_POOLS 0
+    #endif
+  #else
+    #define CYTHON_USE_FREELIST_POOLS CYTHON_USE_FREELISTS
+  #endif
+#endif
+
+#if CYTHON_USE_FREELIST_POOLS
+typedef struct {
+    Py_ssize_t hits;
+    Py_ssize_t misses;
+    Py_ssize_t cached;
+    Py_ssize_t released;
+} __Pyx_FreelistStats;
+
+typedef struct {
+    int count;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    // 1 once the thread will return the cache to the pool when it exits, -1 if it cannot do that.
+    int registered;
+#endif
+    // Counters that were not yet merged into the pool statistics.
+    __Pyx_FreelistStats stats;
+} __Pyx_FreelistCache;
+
+typedef struct {
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex mutex;
+#else
+    __Pyx_FreelistCache *cache;
+#endif
+    PyObject **items;
+    Py_ssize_t count;
+    Py_ssize_t size;
+    int cache_size;
+    __Pyx_FreelistStats stats;
+} __Pyx_FreelistPool;
+
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+  #define __Pyx_FREELIST_CACHE_STORAGE static CYTHON_THREAD_LOCAL
+  #define __Pyx_FreelistPool_Lock(pool) PyMutex_Lock(&(pool)->mutex)
+  #define __Pyx_FreelistPool_Unlock(pool) PyMutex_Unlock(&(pool)->mutex)
+  #define __Pyx_FreelistPool_LoadCount(pool) _Py_atomic_load_ssize_relaxed(&(pool)->count)
+  #define __Pyx_FreelistPool_StoreCount(pool, value) _Py_atomic_store_ssize_relaxed(&(pool)->count, value)
+  #define __Pyx_FreelistPool_LoadSize(pool) _Py_atomic_load_ssize_relaxed(&(pool)->size)
+  #define __Pyx_FreelistPool_StoreSize(pool, value) _Py_atomic_store_ssize_relaxed(&(pool)->size, value)
+  #define __Pyx_FreelistCache_IsRegistered(cache) ((cache)->registered > 0)
+#else
+  #define __Pyx_FREELIST_CACHE_STORAGE static
+  #define __Pyx_FreelistPool_Lock(pool)
+  #define __Pyx_FreelistPool_Unlock(pool)
+  #define __Pyx_FreelistPool_LoadCount(pool) ((pool)->count)
+  #define __Pyx_FreelistPool_StoreCount(pool, value) (pool)->count = (value)
+  #define __Pyx_FreelistPool_LoadSize(pool) ((pool)->size)
+  #define __Pyx_FreelistPool_StoreSize(pool, value) (pool)->size = (value)
+  #define __Pyx_FreelistCache_IsRegistered(cache) 1
+#endif
+
+static PyObject *__Pyx__FreelistPool_Refill(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size); /*proto*/
+static int __Pyx__FreelistPool_Spill(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size, PyObject *o); /*proto*/
+static int __Pyx_FreelistPool_Setup(PyTypeObject *type, __Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, int cache_size, Py_ssize_t pool_size); /*proto*/
+static void __Pyx_FreelistPool_Clear(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items); /*proto*/
+
+// Returns a cached (dead) instance or NULL.
+static CYTHON_INLINE PyObject *__Pyx_FreelistPool_Pop(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size) {
+    if (likely(cache->count > 0)) {
+        cache->stats.hits++;
+        return items[--cache->count];
+    }
+    return __Pyx__FreelistPool_Refill(pool, cache, items, cache_size);
+}
+
+// Returns 1 if the instance was cached and 0 if the caller must free it.
+static CYTHON_INLINE int __Pyx_FreelistPool_Push(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size, PyObject *o) {
+    if (likely(cache->count < cache_size && __Pyx_FreelistCache_IsRegistered(cache))) {
+        cache->stats.cached++;
+        items[cache->count++] = o;
+        return 1;
+    }
+    return __Pyx__FreelistPool_Spill(pool, cache, items, cache_size, o);
+}
+#endif
+
+////////////////// FreelistPool //////////////////////////
+//@requires: SetItemOnTypeDict
+
+#if CYTHON_USE_FREELIST_POOLS
+#include <stdlib.h>
+#include <string.h>
+
+static void __Pyx__FreelistPool_MergeStats(__Pyx_FreelistStats *target, __Pyx_FreelistStats *source) {
+    target->hits += source->hits;
+    target->misses += source->misses;
+    target->cached += source->cached;
+    target->released += source->released;
+}
+
+static void __Pyx__FreelistPool_FlushStats(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache) {
+    __Pyx__FreelistPool_MergeStats(&pool->stats, &cache->stats);
+    memset(&cache->stats, 0, sizeof(cache->stats));
+}
+
+static void __Pyx__FreelistPool_Drain(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items) {
+    Py_ssize_t count;
+    __Pyx_FreelistPool_Lock(pool);
+    __Pyx__FreelistPool_FlushStats(pool, cache);
+    count = pool->size - pool->count;
+    if (count > cache->count) count = cache->count;
+    if (count > 0) {
+        cache->count -= (int) count;
+        memcpy(pool->items + pool->count, items + cache->count, (size_t) count * sizeof(PyObject*));
+        __Pyx_FreelistPool_StoreCount(pool, pool->count + count);
+    }
+    __Pyx_FreelistPool_Unlock(pool);
+    while (cache->count > 0) {
+        PyObject *o = items[--cache->count];
+        __Pyx_PyObject_GetSlot(o, tp_free, freefunc)(o);
+    }
+}
+
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+typedef struct {
+    __Pyx_FreelistPool *pool;
+    __Pyx_FreelistCache *cache;
+    PyObject **items;
+    unsigned long thread_id;
+} __Pyx_FreelistThreadCache;
+
+// Called when the thread state dict is cleared, which happens in the exiting thread itself.
+static void __Pyx__FreelistPool_ThreadExit(PyObject *capsule) {
+    __Pyx_FreelistThreadCache *thread_cache = (__Pyx_FreelistThreadCache *) PyCapsule_GetPointer(
+        capsule, "__Pyx_FreelistThreadCache");
+    if (unlikely(!thread_cache)) {
+        PyErr_Clear();
+        return;
+    }
+    // The cache pointers belong to the thread local storage of the registering thread.
+    if (thread_cache->thread_id == PyThread_get_thread_ident()) {
+        __Pyx__FreelistPool_Drain(thread_cache->pool, thread_cache->cache, thread_cache->items);
+        thread_cache->cache->registered = -1;
+    }
+    PyMem_Free(thread_cache);
+}
+
+// Makes the current thread return its cache to the pool when it exits.
+// Returns 0 if that failed, in which case the thread must not keep instances in its cache.
+static int __Pyx__FreelistPool_RegisterThread(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items) {
+    PyObject *exc, *dict, *key, *capsule = NULL;
+    __Pyx_FreelistThreadCache *thread_cache;
+    int result = -1;
+    if (cache->registered) return cache->registered > 0;
+    exc = PyErr_GetRaisedException();
+    dict = PyThreadState_GetDict();
+    if (unlikely(!dict)) goto done;
+    thread_cache = (__Pyx_FreelistThreadCache *) PyMem_Malloc(sizeof(__Pyx_FreelistThreadCache));
+    if (unlikely(!thread_cache)) goto done;
+    thread_cache->pool = pool;
+    thread_cache->cache = cache;
+    thread_cache->items = items;
+    thread_cache->thread_id = PyThread_get_thread_ident();
+    capsule = PyCapsule_New(thread_cache, "__Pyx_FreelistThreadCache", __Pyx__FreelistPool_ThreadExit);
+    if (unlikely(!capsule)) {
+        PyMem_Free(thread_cache);
+        goto done;
+    }
+    key = PyLong_FromVoidPtr(pool);
+    if (unlikely(!key)) goto done;
+    result = PyDict_SetItem(dict, key, capsule);
+    Py_DECREF(key);
+  done:
+    Py_XDECREF(capsule);
+    PyErr_Clear();
+    PyErr_SetRaisedException(exc);
+    cache->registered = (result == 0) ? 1 : -1;
+    return result == 0;
+}
+#endif
+
+static PyObject *__Pyx__FreelistPool_Refill(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size) {
+    Py_ssize_t count, batch = (cache_size + 1) / 2;
+    // Avoid taking the lock while the pool is empty, e.g. while the number of live objects grows.
+    if (__Pyx_FreelistPool_LoadCount(pool) == 0) {
+        cache->stats.misses++;
+        return NULL;
+    }
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    // Without a registered cache, take single instances from the pool.
+    if (unlikely(!__Pyx__FreelistPool_RegisterThread(pool, cache, items))) batch = 1;
+#endif
+    __Pyx_FreelistPool_Lock(pool);
+    __Pyx__FreelistPool_FlushStats(pool, cache);
+    count = pool->count;
+    if (count > batch) count = batch;
+    if (unlikely(count == 0)) {
+        pool->stats.misses++;
+        __Pyx_FreelistPool_Unlock(pool);
+        return NULL;
+    }
+    __Pyx_FreelistPool_StoreCount(pool, pool->count - count);
+    memcpy(items, pool->items + pool->count, (size_t) count * sizeof(PyObject*));
+    pool->stats.hits++;
+    __Pyx_FreelistPool_Unlock(pool);
+    cache->count = (int) count - 1;
+    return items[count - 1];
+}
+
+static int __Pyx__FreelistPool_Spill(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items, int cache_size, PyObject *o) {
+    Py_ssize_t count, batch = (cache_size + 1) / 2;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    if (unlikely(!cache->registered) && __Pyx__FreelistPool_RegisterThread(pool, cache, items) &&
+            cache->count < cache_size) {
+        cache->stats.cached++;
+        items[cache->count++] = o;
+        return 1;
+    }
+#endif
+    if (__Pyx_FreelistPool_LoadCount(pool) >= __Pyx_FreelistPool_LoadSize(pool)) {
+        cache->stats.released++;
+        return 0;
+    }
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    if (unlikely(cache->registered < 0)) {
+        // Without a registered cache, put the instance itself into the pool.
+        __Pyx_FreelistPool_Lock(pool);
+        __Pyx__FreelistPool_FlushStats(pool, cache);
+        if (unlikely(pool->count >= pool->size)) {
+            pool->stats.released++;
+            __Pyx_FreelistPool_Unlock(pool);
+            return 0;
+        }
+        pool->items[pool->count] = o;
+        __Pyx_FreelistPool_StoreCount(pool, pool->count + 1);
+        pool->stats.cached++;
+        __Pyx_FreelistPool_Unlock(pool);
+        return 1;
+    }
+#endif
+    __Pyx_FreelistPool_Lock(pool);
+    __Pyx__FreelistPool_FlushStats(pool, cache);
+    count = pool->size - pool->count;
+    if (count > batch) count = batch;
+    if (unlikely(count <= 0)) {
+        pool->stats.released++;
+        __Pyx_FreelistPool_Unlock(pool);
+        return 0;
+    }
+    cache->count -= (int) count;
+    memcpy(pool->items + pool->count, items + cache->count, (size_t) count * sizeof(PyObject*));
+    __Pyx_FreelistPool_StoreCount(pool, pool->count + count);
+    pool->stats.cached++;
+    __Pyx_FreelistPool_Unlock(pool);
+    items[cache->count++] = o;
+    return 1;
+}
+
+static PyObject *__Pyx_FreelistPool_GetStats(PyObject *capsule, CYTHON_UNUSED PyObject *unused) {
+    __Pyx_FreelistStats stats;
+    Py_ssize_t count, size;
+    int cache_size;
+    __Pyx_FreelistPool *pool = (__Pyx_FreelistPool *) PyCapsule_GetPointer(capsule, "__Pyx_FreelistPool");
+    if (unlikely(!pool)) return NULL;
+    __Pyx_FreelistPool_Lock(pool);
+    stats = pool->stats;
+    count = pool->count;
+    size = pool->size;
+    cache_size = pool->cache_size;
+    __Pyx_FreelistPool_Unlock(pool);
+#if !CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    // The only cache is module wide, so its counters can be included directly.
+    __Pyx__FreelistPool_MergeStats(&stats, &pool->cache->stats);
+    count += pool->cache->count;
+#endif
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:n,s:i}",
+        "hits", stats.hits,
+        "misses", stats.misses,
+        "cached", stats.cached,
+        "released", stats.released,
+        "pooled", count,
+        "pool_size", size,
+        "thread_cache_size", cache_size);
+}
+
+static PyMethodDef __Pyx_FreelistPool_StatsMethodDef = {
+    "__freelist_stats__", (PyCFunction) __Pyx_FreelistPool_GetStats, METH_NOARGS,
+    PyDoc_STR("Return the usage statistics of the instance freelist of this type.")
+};
+
+static int __Pyx_FreelistPool_Setup(PyTypeObject *type, __Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, int cache_size, Py_ssize_t pool_size) {
+    PyObject *capsule, *stats_func;
+    int result;
+    const char *env_size = getenv("CYTHON_FREELIST_POOL_SIZE");
+    if (env_size && *env_size) {
+        char *end;
+        long value = strtol(env_size, &end, 10);
+        if (*end == '\0' && value >= 0) pool_size = (Py_ssize_t) value;
+    }
+#if !CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    pool->cache = cache;
+#else
+    CYTHON_UNUSED_VAR(cache);
+#endif
+    pool->cache_size = cache_size;
+    if (!pool->items && pool_size > 0) {
+        pool->items = (PyObject **) PyMem_Malloc((size_t) pool_size * sizeof(PyObject*));
+        if (unlikely(!pool->items)) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        __Pyx_FreelistPool_StoreSize(pool, pool_size);
+    }
+
+    capsule = PyCapsule_New(pool, "__Pyx_FreelistPool", NULL);
+    if (unlikely(!capsule)) return -1;
+    stats_func = PyCFunction_New(&__Pyx_FreelistPool_StatsMethodDef, capsule);
+    Py_DECREF(capsule);
+    if (unlikely(!stats_func)) return -1;
+    result = __Pyx_SetItemOnTypeDict(type, PYIDENT("__freelist_stats__"), stats_func);
+    Py_DECREF(stats_func);
+    return result;
+}
+
+static void __Pyx_FreelistPool_Clear(__Pyx_FreelistPool *pool, __Pyx_FreelistCache *cache, PyObject **items) {
+    PyObject **pool_items;
+    Py_ssize_t i, count;
+    // Only the cache of the current thread is reachable here.  Other threads return
+    // their caches to the pool when they exit, which frees them after this point.
+    __Pyx__FreelistPool_Drain(pool, cache, items);
+    __Pyx_FreelistPool_Lock(pool);
+    pool_items = pool->items;
+    count = pool->count;
+    pool->items = NULL;
+    __Pyx_FreelistPool_StoreCount(pool, 0);
+    __Pyx_FreelistPool_StoreSize(pool, 0);
+    __Pyx_FreelistPool_Unlock(pool);
+    for (i = 0; i < count; i++) {
+        PyObject *o = pool_items[i];
+        __Pyx_PyObject_GetSlot(o, tp_free, freefunc)(o);
+    }
+    PyMem_Free(pool_items);
+}
+#endif
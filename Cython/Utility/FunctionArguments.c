@@ -389,6 +389,166 @@ bad:
 }
 
 
+//////////////////// ParseKeywordsHashed.proto ////////////////////
+
+static int __Pyx_ParseKeywordsHashed(PyObject *kwds, PyObject *const *kwvalues,
+    PyObject **argnames[], const unsigned char *hash_table, uint32_t hash_seed, size_t hash_mask,
+    PyObject *kwds2, PyObject *values[], Py_ssize_t num_pos_args,
+    const char* function_name); /*proto*/
+
+//////////////////// ParseKeywordsHashed ////////////////////
+//@requires: RaiseDoubleKeywords
+
+//  __Pyx_ParseKeywordsHashed works like __Pyx_ParseOptionalKeywords,
+//  but finds the argument name of each keyword in a single step.
+//  The compiler generates a perfect hash table for the argument names
+//  of the function: "hash_table[hash & hash_mask]" is the index of the
+//  name in argnames plus one, or 0 if no name has that hash.
+//
+//  The hash function covers the characters of the name, not the address
+//  of the interned string, so that keywords that are not interned are
+//  also found without comparing them against all argument names.
+
+// Returns the index of key in argnames, -1 if it is not an argument name, or -2 on error.
+static Py_ssize_t __Pyx_FindKeywordHashed(PyObject *key, PyObject **argnames[],
+                                          const unsigned char *hash_table, uint32_t hash_seed, size_t hash_mask) {
+    Py_ssize_t i, length;
+    int kind;
+    const void *data;
+    unsigned char slot;
+    PyObject *name;
+    // FNV-1a over the code points, must match Nodes.keyword_hash().
+    uint32_t hash = hash_seed;
+
+    if (unlikely(__Pyx_PyUnicode_READY(key) < 0)) return -2;
+    length = __Pyx_PyUnicode_GET_LENGTH(key);
+    #if !CYTHON_ASSUME_SAFE_SIZE
+    if (unlikely(length < 0)) return -2;
+    #endif
+    kind = __Pyx_PyUnicode_KIND(key);
+    data = __Pyx_PyUnicode_DATA(key);
+    for (i = 0; i < length; i++) {
+        hash = (hash ^ (uint32_t) __Pyx_PyUnicode_READ(kind, data, i)) * 16777619U;
+    }
+
+    slot = hash_table[hash & hash_mask];
+    if (!slot) return -1;
+    name = *argnames[slot - 1];
+    if (likely(name == key)) return slot - 1;
+    {
+        int cmp = (
+        #if CYTHON_ASSUME_SAFE_SIZE
+            (PyUnicode_GET_LENGTH(name) != length) ? 1 :
+        #endif
+            PyUnicode_Compare(name, key)
+        );
+        if (cmp < 0 && unlikely(PyErr_Occurred())) return -2;
+        return (cmp == 0) ? slot - 1 : -1;
+    }
+}
+
+static int __Pyx_ParseKeywordsHashed(
+    PyObject *kwds,
+    PyObject *const *kwvalues,
+    PyObject **argnames[],
+    const unsigned char *hash_table,
+    uint32_t hash_seed,
+    size_t hash_mask,
+    PyObject *kwds2,
+    PyObject *values[],
+    Py_ssize_t num_pos_args,
+    const char* function_name)
+{
+    PyObject *key = 0, *value = 0;
+    Py_ssize_t pos = 0, index;
+    int kwds_is_tuple = CYTHON_METH_FASTCALL && likely(PyTuple_Check(kwds));
+
+    while (1) {
+        // clean up key and value when the loop is "continued"
+        Py_XDECREF(key); key = NULL;
+        Py_XDECREF(value); value = NULL;
+
+        if (kwds_is_tuple) {
+            Py_ssize_t size;
+#if CYTHON_ASSUME_SAFE_SIZE
+            size = PyTuple_GET_SIZE(kwds);
+#else
+            size = PyTuple_Size(kwds);
+            if (size < 0) goto bad;
+#endif
+            if (pos >= size) break;
+
+#if CYTHON_AVOID_BORROWED_REFS
+            key = __Pyx_PySequence_ITEM(kwds, pos);
+            if (!key) goto bad;
+#elif CYTHON_ASSUME_SAFE_MACROS
+            key = PyTuple_GET_ITEM(kwds, pos);
+#else
+            key = PyTuple_GetItem(kwds, pos);
+            if (!key) goto bad;
+#endif
+
+            value = kwvalues[pos];
+            pos++;
+        }
+        else
+        {
+            if (!PyDict_Next(kwds, &pos, &key, &value)) break;
+#if CYTHON_AVOID_BORROWED_REFS
+            Py_INCREF(key);
+#endif
+        }
+
+        index = likely(PyUnicode_Check(key)) ?
+            __Pyx_FindKeywordHashed(key, argnames, hash_table, hash_seed, hash_mask) : -3;
+        if (likely(index >= num_pos_args)) {
+            values[index] = value;
+#if CYTHON_AVOID_BORROWED_REFS
+            Py_INCREF(value);  /* transfer ownership of value to values */
+            Py_DECREF(key);
+#endif
+            key = NULL;
+            value = NULL;
+            continue;
+        }
+
+        // Now make sure we own both references since we're doing non-trivial Python operations.
+#if !CYTHON_AVOID_BORROWED_REFS
+        Py_INCREF(key);
+#endif
+        Py_INCREF(value);
+
+        if (unlikely(index == -2)) goto bad;
+        if (unlikely(index == -3)) goto invalid_keyword_type;
+        if (index >= 0) goto arg_passed_twice;
+
+        if (kwds2) {
+            if (unlikely(PyDict_SetItem(kwds2, key, value))) goto bad;
+        } else {
+            goto invalid_keyword;
+        }
+    }
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    return 0;
+arg_passed_twice:
+    __Pyx_RaiseDoubleKeywordsError(function_name, key);
+    goto bad;
+invalid_keyword_type:
+    PyErr_Format(PyExc_TypeError,
+        "%.200s() keywords must be strings", function_name);
+    goto bad;
+invalid_keyword:
+    PyErr_Format(PyExc_TypeError,
+        "%s() got an unexpected keyword argument '%U'",
+        function_name, key);
+bad:
+    Py_XDECREF(key);
+    Py_XDECREF(value);
+    return -1;
+}
+
+
 //////////////////// MergeKeywords.proto ////////////////////
 
 static int __Pyx_MergeKeywords(PyObject *kwdict, PyObject *source_mapping); /*proto*/
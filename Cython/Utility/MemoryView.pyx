@@ -87,6 +87,13 @@ cdef extern from *:
     bint slices_overlap "__pyx_slices_overlap" ({{memviewslice_name}} *slice1,
                                                 {{memviewslice_name}} *slice2,
                                                 int ndim, size_t itemsize) nogil
+    void copy_strided "__pyx_memoryview_copy_strided" (
+                            char *src_data, Py_ssize_t *src_strides,
+                            char *dst_data, Py_ssize_t *dst_strides,
+                            Py_ssize_t *shape, int ndim, size_t itemsize) nogil
+    bint copy_overlapping "__pyx_memoryview_copy_overlapping" (
+                            {{memviewslice_name}} *src, {{memviewslice_name}} *dst,
+                            int ndim, size_t itemsize) nogil
 
 
 cdef extern from "<stdlib.h>":
@@ -1125,42 +1132,12 @@ cdef char get_best_order({{memviewslice_name}} *mslice, int ndim) noexcept nogil
     else:
         return 'F'
 
-@cython.cdivision(True)
-cdef void _copy_strided_to_strided(char *src_data, Py_ssize_t *src_strides,
-                                   char *dst_data, Py_ssize_t *dst_strides,
-                                   Py_ssize_t *src_shape, Py_ssize_t *dst_shape,
-                                   int ndim, size_t itemsize) noexcept nogil:
-    # Note: src_extent is 1 if we're broadcasting
-    # dst_extent always >= src_extent as we don't do reductions
-    cdef Py_ssize_t i
-    cdef Py_ssize_t src_extent = src_shape[0]
-    cdef Py_ssize_t dst_extent = dst_shape[0]
-    cdef Py_ssize_t src_stride = src_strides[0]
-    cdef Py_ssize_t dst_stride = dst_strides[0]
-
-    if ndim == 1:
-        if (src_stride > 0 and dst_stride > 0 and
-            <size_t> src_stride == itemsize == <size_t> dst_stride):
-            memcpy(dst_data, src_data, itemsize * dst_extent)
-        else:
-            for i in range(dst_extent):
-                memcpy(dst_data, src_data, itemsize)
-                src_data += src_stride
-                dst_data += dst_stride
-    else:
-        for i in range(dst_extent):
-            _copy_strided_to_strided(src_data, src_strides + 1,
-                                     dst_data, dst_strides + 1,
-                                     src_shape + 1, dst_shape + 1,
-                                     ndim - 1, itemsize)
-            src_data += src_stride
-            dst_data += dst_stride
-
 cdef void copy_strided_to_strided({{memviewslice_name}} *src,
                                   {{memviewslice_name}} *dst,
                                   int ndim, size_t itemsize) noexcept nogil:
-    _copy_strided_to_strided(src.data, src.strides, dst.data, dst.strides,
-                             src.shape, dst.shape, ndim, itemsize)
+    # Note: src.strides are 0 in broadcast dimensions, so dst.shape covers both
+    copy_strided(src.data, src.strides, dst.data, dst.strides,
+                 dst.shape, ndim, itemsize)
 
 @cname('__pyx_memoryview_slice_get_size')
 cdef Py_ssize_t slice_get_size({{memviewslice_name}} *src, int ndim) noexcept nogil:
@@ -1289,7 +1266,11 @@ cdef int memoryview_copy_contents({{memviewslice_name}} src,
             _err_dim(PyExc_ValueError, "Dimension %d is not direct", i)
 
     if slices_overlap(&src, &dst, ndim, itemsize):
-        # slices overlap, copy to temp, copy temp to dst
+        # slices overlap, e.g. shifted views of the same array can be copied
+        # in place, otherwise copy to temp, copy temp to dst
+        if not dtype_is_object and copy_overlapping(&src, &dst, ndim, itemsize):
+            return 0
+
         if not slice_is_contig(src, order, ndim):
             order = get_best_order(&dst, ndim)
 
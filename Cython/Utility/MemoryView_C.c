@@ -18,94 +18,14 @@ typedef struct {
 
 /////////// Atomics.proto /////////////
 //@proto_block: utility_code_proto_before_types
+//@requires: ModuleSetupCode.c::Atomics
 
 #include <pythread.h>
 
-#ifndef CYTHON_ATOMICS
-    #define CYTHON_ATOMICS 1
-#endif
 // using CYTHON_ATOMICS as a cdef extern bint in the Cython memoryview code
 // interacts badly with "import *". Therefore, define a helper function-like macro
 #define __PYX_CYTHON_ATOMICS_ENABLED() CYTHON_ATOMICS
 
-#define __pyx_atomic_int_type int
-#define __pyx_nonatomic_int_type int
-
-// For standard C/C++ atomics, get the headers first so we have ATOMIC_INT_LOCK_FREE
-// defined when we decide to use them.
-#if CYTHON_ATOMICS && (defined(__STDC_VERSION__) && \
-                        (__STDC_VERSION__ >= 201112L) && \
-                        !defined(__STDC_NO_ATOMICS__))
-    #include <stdatomic.h>
-#elif CYTHON_ATOMICS && (defined(__cplusplus) && ( \
-                    (__cplusplus >= 201103L) || \
-                    (defined(_MSC_VER) && _MSC_VER >= 1700)))
-    #include <atomic>
-#endif
-
-#if CYTHON_ATOMICS && (defined(__STDC_VERSION__) && \
-                        (__STDC_VERSION__ >= 201112L) && \
-                        !defined(__STDC_NO_ATOMICS__) && \
-                       ATOMIC_INT_LOCK_FREE == 2)
-    // C11 atomics are available and  ATOMIC_INT_LOCK_FREE is definitely on
-    #undef __pyx_atomic_int_type
-    #define __pyx_atomic_int_type atomic_int
-    #define __pyx_atomic_incr_aligned(value) atomic_fetch_add_explicit(value, 1, memory_order_relaxed)
-    #define __pyx_atomic_decr_aligned(value) atomic_fetch_sub_explicit(value, 1, memory_order_acq_rel)
-    #if defined(__PYX_DEBUG_ATOMICS) && defined(_MSC_VER)
-        #pragma message ("Using standard C atomics")
-    #elif defined(__PYX_DEBUG_ATOMICS)
-        #warning "Using standard C atomics"
-    #endif
-#elif CYTHON_ATOMICS && (defined(__cplusplus) && ( \
-                    (__cplusplus >= 201103L) || \
-                    /*_MSC_VER 1700 is Visual Studio 2012 */ \
-                    (defined(_MSC_VER) && _MSC_VER >= 1700)) && \
-                    ATOMIC_INT_LOCK_FREE == 2)
-    // C++11 atomics are available and ATOMIC_INT_LOCK_FREE is definitely on
-    #undef __pyx_atomic_int_type
-    #define __pyx_atomic_int_type std::atomic_int
-    #define __pyx_atomic_incr_aligned(value) std::atomic_fetch_add_explicit(value, 1, std::memory_order_relaxed)
-    #define __pyx_atomic_decr_aligned(value) std::atomic_fetch_sub_explicit(value, 1, std::memory_order_acq_rel)
-
-    #if defined(__PYX_DEBUG_ATOMICS) && defined(_MSC_VER)
-        #pragma message ("Using standard C++ atomics")
-    #elif defined(__PYX_DEBUG_ATOMICS)
-        #warning "Using standard C++ atomics"
-    #endif
-#elif CYTHON_ATOMICS && (__GNUC__ >= 5 || (__GNUC__ == 4 && \
-                    (__GNUC_MINOR__ > 1 ||  \
-                    (__GNUC_MINOR__ == 1 && __GNUC_PATCHLEVEL__ >= 2))))
-    /* gcc >= 4.1.2 */
-    #define __pyx_atomic_incr_aligned(value) __sync_fetch_and_add(value, 1)
-    #define __pyx_atomic_decr_aligned(value) __sync_fetch_and_sub(value, 1)
-
-    #ifdef __PYX_DEBUG_ATOMICS
-        #warning "Using GNU atomics"
-    #endif
-#elif CYTHON_ATOMICS && defined(_MSC_VER)
-    /* msvc */
-    #include <intrin.h>
-    #undef __pyx_atomic_int_type
-    #define __pyx_atomic_int_type long
-    #undef __pyx_nonatomic_int_type
-    #define __pyx_nonatomic_int_type long
-    #pragma intrinsic (_InterlockedExchangeAdd)
-    #define __pyx_atomic_incr_aligned(value) _InterlockedExchangeAdd(value, 1)
-    #define __pyx_atomic_decr_aligned(value) _InterlockedExchangeAdd(value, -1)
-
-    #ifdef __PYX_DEBUG_ATOMICS
-        #pragma message ("Using MSVC atomics")
-    #endif
-#else
-    #undef CYTHON_ATOMICS
-    #define CYTHON_ATOMICS 0
-
-    #ifdef __PYX_DEBUG_ATOMICS
-        #warning "Not using atomics"
-    #endif
-#endif
-
 #if CYTHON_ATOMICS
     #define __pyx_add_acquisition_count(memview) \
              __pyx_atomic_incr_aligned(__pyx_get_slice_count_pointer(memview))
@@ -747,6 +667,361 @@ __pyx_slices_overlap({{memviewslice_name}} *slice1,
 }
 
 
+////////// MemviewSliceBroadcast.proto //////////
+
+static int __pyx_memoryview_needs_copy({{memviewslice_name}} *src, int src_ndim, size_t src_itemsize,
+                                       {{memviewslice_name}} *dst, int dst_ndim, size_t dst_itemsize);
+static int __pyx_memoryview_broadcast_strides({{memviewslice_name}} *src, int src_ndim,
+                                              {{memviewslice_name}} *dst, int dst_ndim,
+                                              Py_ssize_t *strides);
+
+////////// MemviewSliceBroadcast //////////
+//@requires: OverlappingSlices
+
+/* Returns 1 if writing the items of 'dst' one by one can modify items of 'src'
+   before they are read, i.e. if the slices overlap but do not have the same layout. */
+static int
+__pyx_memoryview_needs_copy({{memviewslice_name}} *src, int src_ndim, size_t src_itemsize,
+                            {{memviewslice_name}} *dst, int dst_ndim, size_t dst_itemsize)
+{
+    void *src_start, *src_end, *dst_start, *dst_end;
+    int i;
+
+    if (src->data == dst->data && src_ndim == dst_ndim && src_itemsize == dst_itemsize) {
+        for (i = 0; i < src_ndim; i++) {
+            if (src->shape[i] != dst->shape[i] || src->strides[i] != dst->strides[i])
+                break;
+        }
+        if (i == src_ndim)
+            return 0;
+    }
+
+    __pyx_get_array_memory_extents(src, &src_start, &src_end, src_ndim, src_itemsize);
+    __pyx_get_array_memory_extents(dst, &dst_start, &dst_end, dst_ndim, dst_itemsize);
+    return (src_start < dst_end) && (dst_start < src_end);
+}
+
+/* Calculates the strides for iterating over 'src' in the shape of 'dst'.
+   As in NumPy, the dimensions are aligned at the end and dimensions of extent 1
+   are repeated with a zero stride.  Leading dimensions of 'src' that 'dst' lacks
+   must have extent 1.  Raises ValueError for differing extents, without requiring the GIL. */
+static int
+__pyx_memoryview_broadcast_strides({{memviewslice_name}} *src, int src_ndim,
+                                   {{memviewslice_name}} *dst, int dst_ndim,
+                                   Py_ssize_t *strides)
+{
+    int i;
+    int offset = src_ndim - dst_ndim;
+    Py_ssize_t src_extent, dst_extent;
+
+    for (i = 0; i < offset; i++) {
+        if (unlikely(src->shape[i] != 1)) {
+            src_extent = src->shape[i];
+            dst_extent = 1;
+            goto bad_extent;
+        }
+    }
+    for (i = 0; i < dst_ndim; i++) {
+        if (i + offset < 0) {
+            strides[i] = 0;
+            continue;
+        }
+        src_extent = src->shape[i + offset];
+        dst_extent = dst->shape[i];
+        if (src_extent == dst_extent) {
+            strides[i] = src->strides[i + offset];
+        } else if (src_extent == 1) {
+            strides[i] = 0;
+        } else {
+            goto bad_extent;
+        }
+    }
+    return 0;
+
+bad_extent:
+    {
+        PyGILState_STATE gilstate = PyGILState_Ensure();
+        PyErr_Format(PyExc_ValueError,
+                     "got differing extents in dimension %d (got %" CYTHON_FORMAT_SSIZE_T "d and %" CYTHON_FORMAT_SSIZE_T "d)",
+                     i, dst_extent, src_extent);
+        PyGILState_Release(gilstate);
+    }
+    return -1;
+}
+
+
+////////// MemviewSliceCopyStrided.proto //////////
+
+/* Minimum size in bytes of a strided copy that is split across OpenMP threads.
+   Disabled by default, since OpenMP cannot see threads that already run copies
+   in parallel, e.g. the threads of a parallel_backend=threadpool loop. */
+#ifndef CYTHON_MEMVIEW_PARALLEL_COPY_SIZE
+#define CYTHON_MEMVIEW_PARALLEL_COPY_SIZE 0
+#endif
+
+static void __pyx_memoryview_copy_strided(char *src_data, const Py_ssize_t *src_strides,
+                                          char *dst_data, const Py_ssize_t *dst_strides,
+                                          const Py_ssize_t *shape, int ndim, size_t itemsize);
+static int __pyx_memoryview_copy_overlapping({{memviewslice_name}} *src, {{memviewslice_name}} *dst,
+                                             int ndim, size_t itemsize);
+
+////////// MemviewSliceCopyStrided //////////
+
+/* Number of items in both dimensions of the tiles of a transposing copy. */
+#define __PYX_MEMVIEW_COPY_TILE_SIZE 32
+
+static CYTHON_INLINE void
+__pyx_memoryview_copy_items_sized(char *src, Py_ssize_t src_stride,
+                                  char *dst, Py_ssize_t dst_stride,
+                                  Py_ssize_t extent, size_t itemsize)
+{
+    Py_ssize_t i;
+    for (i = 0; i < extent; i++) {
+        memcpy(dst, src, itemsize);
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+static void
+__pyx_memoryview_copy_items(char *src, Py_ssize_t src_stride,
+                            char *dst, Py_ssize_t dst_stride,
+                            Py_ssize_t extent, size_t itemsize)
+{
+    if (src_stride == (Py_ssize_t) itemsize && dst_stride == (Py_ssize_t) itemsize) {
+        memcpy(dst, src, itemsize * (size_t) extent);
+        return;
+    }
+    /* Constant item sizes allow C compilers to replace memcpy() by simple loads and stores. */
+    switch (itemsize) {
+        case 1: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, 1); break;
+        case 2: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, 2); break;
+        case 4: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, 4); break;
+        case 8: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, 8); break;
+        case 16: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, 16); break;
+        default: __pyx_memoryview_copy_items_sized(src, src_stride, dst, dst_stride, extent, itemsize);
+    }
+}
+
+/* Copies two dimensions in square tiles, so that both the source and the
+   destination items of a tile stay in the cache when one of them is accessed
+   across the rows. */
+static void
+__pyx_memoryview_copy_tiled(char *src, const Py_ssize_t *src_strides,
+                            char *dst, const Py_ssize_t *dst_strides,
+                            const Py_ssize_t *shape, size_t itemsize)
+{
+    Py_ssize_t i, i0, j0, i_end, j_extent;
+
+    for (i0 = 0; i0 < shape[0]; i0 += __PYX_MEMVIEW_COPY_TILE_SIZE) {
+        i_end = (shape[0] - i0 > __PYX_MEMVIEW_COPY_TILE_SIZE) ? i0 + __PYX_MEMVIEW_COPY_TILE_SIZE : shape[0];
+        for (j0 = 0; j0 < shape[1]; j0 += __PYX_MEMVIEW_COPY_TILE_SIZE) {
+            j_extent = (shape[1] - j0 > __PYX_MEMVIEW_COPY_TILE_SIZE) ? __PYX_MEMVIEW_COPY_TILE_SIZE : shape[1] - j0;
+            for (i = i0; i < i_end; i++) {
+                __pyx_memoryview_copy_items(
+                    src + i * src_strides[0] + j0 * src_strides[1], src_strides[1],
+                    dst + i * dst_strides[0] + j0 * dst_strides[1], dst_strides[1],
+                    j_extent, itemsize);
+            }
+        }
+    }
+}
+
+static void
+__pyx_memoryview_copy_strided_nd(char *src, const Py_ssize_t *src_strides,
+                                 char *dst, const Py_ssize_t *dst_strides,
+                                 const Py_ssize_t *shape, int ndim, size_t itemsize, int tiled)
+{
+    Py_ssize_t i;
+
+    if (ndim == 1) {
+        __pyx_memoryview_copy_items(src, src_strides[0], dst, dst_strides[0], shape[0], itemsize);
+    } else if (ndim == 2 && tiled) {
+        __pyx_memoryview_copy_tiled(src, src_strides, dst, dst_strides, shape, itemsize);
+    } else {
+        for (i = 0; i < shape[0]; i++) {
+            __pyx_memoryview_copy_strided_nd(src, src_strides + 1, dst, dst_strides + 1,
+                                             shape + 1, ndim - 1, itemsize, tiled);
+            src += src_strides[0];
+            dst += dst_strides[0];
+        }
+    }
+}
+
+#if defined(_OPENMP) && CYTHON_MEMVIEW_PARALLEL_COPY_SIZE > 0
+/* Splits the first dimension into one block per thread. */
+static void
+__pyx_memoryview_copy_strided_parallel(char *src, const Py_ssize_t *src_strides,
+                                       char *dst, const Py_ssize_t *dst_strides,
+                                       const Py_ssize_t *shape, int ndim, size_t itemsize, int tiled)
+{
+    int block, num_blocks = omp_get_max_threads();
+    Py_ssize_t block_extent;
+
+    if (num_blocks > shape[0])
+        num_blocks = (int) shape[0];
+    block_extent = (shape[0] + num_blocks - 1) / num_blocks;
+    if (tiled && ndim == 2) {
+        /* keep the tiles complete */
+        block_extent = (block_extent + __PYX_MEMVIEW_COPY_TILE_SIZE - 1) / __PYX_MEMVIEW_COPY_TILE_SIZE * __PYX_MEMVIEW_COPY_TILE_SIZE;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (block = 0; block < num_blocks; block++) {
+        Py_ssize_t block_shape[{{max_dims}}];
+        Py_ssize_t start = block * block_extent;
+        if (start < shape[0]) {
+            memcpy(block_shape, shape, (size_t) ndim * sizeof(Py_ssize_t));
+            block_shape[0] = (shape[0] - start > block_extent) ? block_extent : shape[0] - start;
+            __pyx_memoryview_copy_strided_nd(src + start * src_strides[0], src_strides,
+                                             dst + start * dst_strides[0], dst_strides,
+                                             block_shape, ndim, itemsize, tiled);
+        }
+    }
+}
+#endif
+
+/* Finds the dimension with the smallest non-zero stride, or -1. */
+static int
+__pyx_memoryview_fastest_dim(const Py_ssize_t *strides, const Py_ssize_t *shape, int ndim)
+{
+    int i, dim = -1;
+    Py_ssize_t stride, min_stride = 0;
+
+    for (i = 0; i < ndim; i++) {
+        stride = strides[i] < 0 ? -strides[i] : strides[i];
+        if (shape[i] > 1 && stride != 0 && (dim == -1 || stride < min_stride)) {
+            dim = i;
+            min_stride = stride;
+        }
+    }
+    return dim;
+}
+
+/* Copies the items of non-overlapping slices.  If the source and the destination
+   are contiguous along different dimensions, e.g. when copying from C to Fortran
+   order, these two dimensions are copied last, in tiles. */
+static void
+__pyx_memoryview_copy_strided(char *src_data, const Py_ssize_t *src_strides,
+                              char *dst_data, const Py_ssize_t *dst_strides,
+                              const Py_ssize_t *shape, int ndim, size_t itemsize)
+{
+    Py_ssize_t src_strides_buf[{{max_dims}}], dst_strides_buf[{{max_dims}}], shape_buf[{{max_dims}}];
+    int i, k, tiled = 0;
+    int src_dim = __pyx_memoryview_fastest_dim(src_strides, shape, ndim);
+    int dst_dim = __pyx_memoryview_fastest_dim(dst_strides, shape, ndim);
+
+    if (src_dim >= 0 && dst_dim >= 0 && src_dim != dst_dim) {
+        k = 0;
+        for (i = 0; i < ndim; i++) {
+            if (i != src_dim && i != dst_dim) {
+                src_strides_buf[k] = src_strides[i];
+                dst_strides_buf[k] = dst_strides[i];
+                shape_buf[k] = shape[i];
+                k++;
+            }
+        }
+        src_strides_buf[k] = src_strides[src_dim];
+        dst_strides_buf[k] = dst_strides[src_dim];
+        shape_buf[k] = shape[src_dim];
+        src_strides_buf[k+1] = src_strides[dst_dim];
+        dst_strides_buf[k+1] = dst_strides[dst_dim];
+        shape_buf[k+1] = shape[dst_dim];
+        src_strides = src_strides_buf;
+        dst_strides = dst_strides_buf;
+        shape = shape_buf;
+        tiled = 1;
+    }
+
+#if defined(_OPENMP) && CYTHON_MEMVIEW_PARALLEL_COPY_SIZE > 0
+    if (shape[0] > 1 && !omp_in_parallel() && omp_get_max_threads() > 1) {
+        size_t size = itemsize;
+        for (i = 0; i < ndim; i++)
+            size *= (size_t) shape[i];
+        if (size >= (size_t) CYTHON_MEMVIEW_PARALLEL_COPY_SIZE) {
+            __pyx_memoryview_copy_strided_parallel(src_data, src_strides, dst_data, dst_strides,
+                                                   shape, ndim, itemsize, tiled);
+            return;
+        }
+    }
+#endif
+
+    __pyx_memoryview_copy_strided_nd(src_data, src_strides, dst_data, dst_strides,
+                                     shape, ndim, itemsize, tiled);
+}
+
+static void
+__pyx_memoryview_move_items(char *src, char *dst, const Py_ssize_t *strides,
+                            const Py_ssize_t *shape, int ndim, size_t itemsize)
+{
+    Py_ssize_t i, offset;
+
+    if (ndim == 0) {
+        memmove(dst, src, itemsize);
+    } else if (ndim == 1 && (strides[0] == (Py_ssize_t) itemsize || strides[0] == -(Py_ssize_t) itemsize)) {
+        offset = strides[0] < 0 ? (shape[0] - 1) * strides[0] : 0;
+        memmove(dst + offset, src + offset, itemsize * (size_t) shape[0]);
+    } else {
+        for (i = 0; i < shape[0]; i++) {
+            __pyx_memoryview_move_items(src, dst, strides + 1, shape + 1, ndim - 1, itemsize);
+            src += strides[0];
+            dst += strides[0];
+        }
+    }
+}
+
+/* Copies between overlapping slices with the same strides without a temporary
+   buffer, by iterating in the direction of the data movement like memmove().
+   This requires that the items of each dimension lie beyond all items of the
+   inner dimensions in memory, as for slices of contiguous arrays.
+   Returns 1 if the items were copied, 0 if the slices need a temporary copy. */
+static int
+__pyx_memoryview_copy_overlapping({{memviewslice_name}} *src, {{memviewslice_name}} *dst,
+                                  int ndim, size_t itemsize)
+{
+    Py_ssize_t strides[{{max_dims}}], shape[{{max_dims}}];
+    Py_ssize_t stride, span;
+    char *src_data = src->data, *dst_data = dst->data;
+    int backwards = dst_data > src_data;
+    int i, k, n = 0;
+
+    for (i = 0; i < ndim; i++) {
+        if (src->strides[i] != dst->strides[i])
+            return 0;
+        if (dst->shape[i] == 0)
+            return 1;
+        if (dst->shape[i] == 1)
+            continue;
+        stride = dst->strides[i];
+        if ((stride > 0) == backwards) {
+            /* read each item before it gets overwritten */
+            src_data += (dst->shape[i] - 1) * stride;
+            dst_data += (dst->shape[i] - 1) * stride;
+            stride = -stride;
+        }
+        /* sort the dimensions by decreasing stride */
+        for (k = n; k > 0 && (strides[k-1] < 0 ? -strides[k-1] : strides[k-1]) < (stride < 0 ? -stride : stride); k--) {
+            strides[k] = strides[k-1];
+            shape[k] = shape[k-1];
+        }
+        strides[k] = stride;
+        shape[k] = dst->shape[i];
+        n++;
+    }
+
+    span = (Py_ssize_t) itemsize;
+    for (k = n - 1; k >= 0; k--) {
+        stride = strides[k] < 0 ? -strides[k] : strides[k];
+        if (stride < span)
+            return 0;
+        span += stride * (shape[k] - 1);
+    }
+
+    __pyx_memoryview_move_items(src_data, dst_data, strides, shape, n, itemsize);
+    return 1;
+}
+
+
 ////////// MemviewSliceCheckContig.proto //////////
 
 #define __pyx_memviewslice_is_contig_{{contig_type}}{{ndim}}(slice) \
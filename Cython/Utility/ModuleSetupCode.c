@@ -391,6 +391,17 @@
 /* Whether to use METH_FASTCALL with a fake backported implementation of vectorcall */
 #define CYTHON_BACKPORT_VECTORCALL (CYTHON_METH_FASTCALL && PY_VERSION_HEX < 0x030800B1)
 
+/* Whether extension types set tp_vectorcall for construction and a vectorcall function for __call__().
+   Types only use tp_vectorcall when called since Py3.9, and setting the slots requires access to the type struct. */
+#ifndef CYTHON_USE_TYPE_VECTORCALL
+#define CYTHON_USE_TYPE_VECTORCALL (CYTHON_COMPILING_IN_CPYTHON && CYTHON_VECTORCALL && CYTHON_METH_FASTCALL && PY_VERSION_HEX >= 0x030900B1)
+#endif
+
+/* Whether to create the Python string constants from their zlib compressed data, if the module provides it. */
+#ifndef CYTHON_COMPRESS_STRINGS
+#define CYTHON_COMPRESS_STRINGS 0
+#endif
+
 #if CYTHON_USE_PYLONG_INTERNALS
   /* These short defines from the PyLong header can easily conflict with other code */
   #undef SHIFT
@@ -1403,23 +1414,172 @@ bad:
 //#endif
 
 
+/////////////// Atomics.proto ///////////////
+//@proto_block: utility_code_proto_before_types
+
+// Atomic integer and pointer operations, used for the acquisition counts of memoryviews
+// and for data that is read without a lock, e.g. the code object cache.
+#ifndef CYTHON_ATOMICS
+    #define CYTHON_ATOMICS 1
+#endif
+
+#define __pyx_atomic_int_type int
+#define __pyx_nonatomic_int_type int
+#define __pyx_atomic_ptr_type void*
+
+// For standard C/C++ atomics, get the headers first so we have ATOMIC_INT_LOCK_FREE
+// defined when we decide to use them.
+#if CYTHON_ATOMICS && (defined(__STDC_VERSION__) && \
+                        (__STDC_VERSION__ >= 201112L) && \
+                        !defined(__STDC_NO_ATOMICS__))
+    #include <stdatomic.h>
+#elif CYTHON_ATOMICS && (defined(__cplusplus) && ( \
+                    (__cplusplus >= 201103L) || \
+                    (defined(_MSC_VER) && _MSC_VER >= 1700)))
+    #include <atomic>
+#endif
+
+#if CYTHON_ATOMICS && (defined(__STDC_VERSION__) && \
+                        (__STDC_VERSION__ >= 201112L) && \
+                        !defined(__STDC_NO_ATOMICS__) && \
+                       ATOMIC_INT_LOCK_FREE == 2)
+    // C11 atomics are available and  ATOMIC_INT_LOCK_FREE is definitely on
+    #undef __pyx_atomic_int_type
+    #define __pyx_atomic_int_type atomic_int
+    #define __pyx_atomic_incr_aligned(value) atomic_fetch_add_explicit(value, 1, memory_order_relaxed)
+    #define __pyx_atomic_decr_aligned(value) atomic_fetch_sub_explicit(value, 1, memory_order_acq_rel)
+    #undef __pyx_atomic_ptr_type
+    #define __pyx_atomic_ptr_type atomic_uintptr_t
+    #define __pyx_atomic_load_acquire(value) atomic_load_explicit(value, memory_order_acquire)
+    #define __pyx_atomic_store_release(value, new_value) atomic_store_explicit(value, new_value, memory_order_release)
+    #define __pyx_atomic_pointer_load_acquire(value) atomic_load_explicit(value, memory_order_acquire)
+    #define __pyx_atomic_pointer_store_release(value, new_value) \
+            atomic_store_explicit(value, (uintptr_t) (new_value), memory_order_release)
+    #if defined(__PYX_DEBUG_ATOMICS) && defined(_MSC_VER)
+        #pragma message ("Using standard C atomics")
+    #elif defined(__PYX_DEBUG_ATOMICS)
+        #warning "Using standard C atomics"
+    #endif
+#elif CYTHON_ATOMICS && (defined(__cplusplus) && ( \
+                    (__cplusplus >= 201103L) || \
+                    /*_MSC_VER 1700 is Visual Studio 2012 */ \
+                    (defined(_MSC_VER) && _MSC_VER >= 1700)) && \
+                    ATOMIC_INT_LOCK_FREE == 2)
+    // C++11 atomics are available and ATOMIC_INT_LOCK_FREE is definitely on
+    #undef __pyx_atomic_int_type
+    #define __pyx_atomic_int_type std::atomic_int
+    #define __pyx_atomic_incr_aligned(value) std::atomic_fetch_add_explicit(value, 1, std::memory_order_relaxed)
+    #define __pyx_atomic_decr_aligned(value) std::atomic_fetch_sub_explicit(value, 1, std::memory_order_acq_rel)
+    #undef __pyx_atomic_ptr_type
+    #define __pyx_atomic_ptr_type std::atomic_uintptr_t
+    #define __pyx_atomic_load_acquire(value) std::atomic_load_explicit(value, std::memory_order_acquire)
+    #define __pyx_atomic_store_release(value, new_value) std::atomic_store_explicit(value, new_value, std::memory_order_release)
+    #define __pyx_atomic_pointer_load_acquire(value) std::atomic_load_explicit(value, std::memory_order_acquire)
+    #define __pyx_atomic_pointer_store_release(value, new_value) \
+            std::atomic_store_explicit(value, (uintptr_t) (new_value), std::memory_order_release)
+
+    #if defined(__PYX_DEBUG_ATOMICS) && defined(_MSC_VER)
+        #pragma message ("Using standard C++ atomics")
+    #elif defined(__PYX_DEBUG_ATOMICS)
+        #warning "Using standard C++ atomics"
+    #endif
+#elif CYTHON_ATOMICS && (__GNUC__ >= 5 || (__GNUC__ == 4 && \
+                    (__GNUC_MINOR__ > 1 ||  \
+                    (__GNUC_MINOR__ == 1 && __GNUC_PATCHLEVEL__ >= 2))))
+    /* gcc >= 4.1.2 */
+    #define __pyx_atomic_incr_aligned(value) __sync_fetch_and_add(value, 1)
+    #define __pyx_atomic_decr_aligned(value) __sync_fetch_and_sub(value, 1)
+    #ifdef __ATOMIC_ACQUIRE
+    #define __pyx_atomic_load_acquire(value) __atomic_load_n(value, __ATOMIC_ACQUIRE)
+    #define __pyx_atomic_store_release(value, new_value) __atomic_store_n(value, new_value, __ATOMIC_RELEASE)
+    #else
+    /* gcc < 4.7 only has full barriers */
+    #define __pyx_atomic_load_acquire(value) __extension__ ({ \
+            __typeof__(*(value)) __pyx_atomic_value = *(volatile __typeof__(*(value))*) (value); \
+            __sync_synchronize(); \
+            __pyx_atomic_value; })
+    #define __pyx_atomic_store_release(value, new_value) \
+            (__sync_synchronize(), (void) (*(volatile __typeof__(*(value))*) (value) = (new_value)))
+    #endif
+    #define __pyx_atomic_pointer_load_acquire(value) __pyx_atomic_load_acquire(value)
+    #define __pyx_atomic_pointer_store_release(value, new_value) __pyx_atomic_store_release(value, (void*) (new_value))
+
+    #ifdef __PYX_DEBUG_ATOMICS
+        #warning "Using GNU atomics"
+    #endif
+#elif CYTHON_ATOMICS && defined(_MSC_VER)
+    /* msvc */
+    #include <intrin.h>
+    #undef __pyx_atomic_int_type
+    #define __pyx_atomic_int_type long
+    #undef __pyx_nonatomic_int_type
+    #define __pyx_nonatomic_int_type long
+    #pragma intrinsic (_InterlockedExchangeAdd)
+    #define __pyx_atomic_incr_aligned(value) _InterlockedExchangeAdd(value, 1)
+    #define __pyx_atomic_decr_aligned(value) _InterlockedExchangeAdd(value, -1)
+    #pragma intrinsic (_InterlockedCompareExchange, _InterlockedExchange)
+    #define __pyx_atomic_load_acquire(value) _InterlockedCompareExchange(value, 0, 0)
+    #define __pyx_atomic_store_release(value, new_value) (void) _InterlockedExchange(value, new_value)
+    #define __pyx_atomic_pointer_load_acquire(value) _InterlockedCompareExchangePointer(value, 0, 0)
+    #define __pyx_atomic_pointer_store_release(value, new_value) (void) _InterlockedExchangePointer(value, (void*) (new_value))
+
+    #ifdef __PYX_DEBUG_ATOMICS
+        #pragma message ("Using MSVC atomics")
+    #endif
+#else
+    #undef CYTHON_ATOMICS
+    #define CYTHON_ATOMICS 0
+    // Plain accesses, for data that the GIL or a lock protects.
+    #define __pyx_atomic_load_acquire(value) (*(value))
+    #define __pyx_atomic_store_release(value, new_value) (void) (*(value) = (new_value))
+    #define __pyx_atomic_pointer_load_acquire(value) (*(value))
+    #define __pyx_atomic_pointer_store_release(value, new_value) (void) (*(value) = (void*) (new_value))
+
+    #ifdef __PYX_DEBUG_ATOMICS
+        #warning "Not using atomics"
+    #endif
+#endif
+
+
 /////////////// CodeObjectCache.proto ///////////////
+//@requires: AccessPyMutexForFreeThreading
+//@requires: Atomics
 
 #if !CYTHON_COMPILING_IN_LIMITED_API
 typedef struct {
-    PyCodeObject* code_object;
-    int code_line;
+    __pyx_atomic_ptr_type code_object;
+    __pyx_atomic_int_type code_line;
 } __Pyx_CodeObjectCacheEntry;
 
+// An open addressing hash table that maps (non-zero) code lines to code objects.
+// Lookups do not take a lock.  Writers hold a lock in free-threaded builds and
+// replace the table when it grows.  Replaced tables are kept until module cleanup,
+// so that concurrent readers never access freed memory.
+typedef struct __Pyx_CodeObjectCacheTable {
+    struct __Pyx_CodeObjectCacheTable *previous;
+    unsigned int mask;  /* size - 1, the size is a power of 2 */
+    unsigned int count;
+    __Pyx_CodeObjectCacheEntry entries[1];
+} __Pyx_CodeObjectCacheTable;
+
+// Code objects that were replaced in the table while readers might still use them.
+typedef struct __Pyx_CodeObjectCacheRetired {
+    struct __Pyx_CodeObjectCacheRetired *next;
+    PyCodeObject *code_object;
+} __Pyx_CodeObjectCacheRetired;
+
 struct __Pyx_CodeObjectCache {
-    int count;
-    int max_count;
-    __Pyx_CodeObjectCacheEntry* entries;
+    __pyx_atomic_ptr_type table;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    __Pyx_CodeObjectCacheRetired *retired;
+    PyMutex mutex;
+#endif
 };
 
-static struct __Pyx_CodeObjectCache __pyx_code_cache = {0,0,NULL};
+static struct __Pyx_CodeObjectCache __pyx_code_cache;
+#define __Pyx_CodeObjectCache_LoadTable() \
+    ((__Pyx_CodeObjectCacheTable*) __pyx_atomic_pointer_load_acquire(&__pyx_code_cache.table))
 
-static int __pyx_bisect_code_objects(__Pyx_CodeObjectCacheEntry* entries, int count, int code_line);
 static PyCodeObject *__pyx_find_code_object(int code_line);
 static void __pyx_insert_code_object(int code_line, PyCodeObject* code_object);
 #endif
@@ -1429,102 +1589,170 @@ static void __pyx_insert_code_object(int code_line, PyCodeObject* code_object);
 // This is just a cache, if a lookup or insertion fails - so what?
 
 #if !CYTHON_COMPILING_IN_LIMITED_API
-static int __pyx_bisect_code_objects(__Pyx_CodeObjectCacheEntry* entries, int count, int code_line) {
-    int start = 0, mid = 0, end = count - 1;
-    if (end >= 0 && code_line > entries[end].code_line) {
-        return count;
-    }
-    while (start < end) {
-        mid = start + (end - start) / 2;
-        if (code_line < entries[mid].code_line) {
-            end = mid;
-        } else if (code_line > entries[mid].code_line) {
-             start = mid + 1;
-        } else {
-            return mid;
+static CYTHON_INLINE unsigned int __pyx_code_object_cache_hash(int code_line) {
+    // Fibonacci hashing spreads the (mostly consecutive) line numbers over the table.
+    unsigned int h = ((unsigned int) code_line) * 2654435769U;
+    return h ^ (h >> 16);
+}
+
+// Returns the entry of the code line, or the empty slot for it, and the line found there.
+static __Pyx_CodeObjectCacheEntry *__pyx_code_object_cache_slot(
+        __Pyx_CodeObjectCacheTable *table, int code_line, int *found_line) {
+    __Pyx_CodeObjectCacheEntry *entry;
+    unsigned int i;
+    int line;
+    // The table is never more than half full, so the probing ends at an empty slot.
+    for (i = __pyx_code_object_cache_hash(code_line); ; i++) {
+        entry = &table->entries[i & table->mask];
+        line = (int) __pyx_atomic_load_acquire(&entry->code_line);
+        if (line == code_line || !line) {
+            *found_line = line;
+            return entry;
         }
     }
-    if (code_line <= entries[mid].code_line) {
-        return mid;
-    } else {
-        return mid + 1;
-    }
 }
 
 static PyCodeObject *__pyx_find_code_object(int code_line) {
-    PyCodeObject* code_object;
-    int pos;
-    if (unlikely(!code_line) || unlikely(!__pyx_code_cache.entries)) {
+    __Pyx_CodeObjectCacheTable *table;
+    __Pyx_CodeObjectCacheEntry *entry;
+    PyCodeObject *code_object = NULL;
+    int line;
+    if (unlikely(!code_line)) {
         return NULL;
     }
-    pos = __pyx_bisect_code_objects(__pyx_code_cache.entries, __pyx_code_cache.count, code_line);
-    if (unlikely(pos >= __pyx_code_cache.count) || unlikely(__pyx_code_cache.entries[pos].code_line != code_line)) {
-        return NULL;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING && !CYTHON_ATOMICS
+    // Without atomics, readers need the lock as well.
+    PyMutex_Lock(&__pyx_code_cache.mutex);
+#endif
+    table = __Pyx_CodeObjectCache_LoadTable();
+    if (likely(table)) {
+        entry = __pyx_code_object_cache_slot(table, code_line, &line);
+        if (line) {
+            code_object = (PyCodeObject*) __pyx_atomic_pointer_load_acquire(&entry->code_object);
+            Py_INCREF(code_object);
+        }
     }
-    code_object = __pyx_code_cache.entries[pos].code_object;
-    Py_INCREF(code_object);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING && !CYTHON_ATOMICS
+    PyMutex_Unlock(&__pyx_code_cache.mutex);
+#endif
     return code_object;
 }
 
-static void __pyx_insert_code_object(int code_line, PyCodeObject* code_object) {
-    int pos, i;
-    __Pyx_CodeObjectCacheEntry* entries = __pyx_code_cache.entries;
-    if (unlikely(!code_line)) {
+// Fills an empty slot without taking a reference.
+static void __pyx_fill_code_object_slot(__Pyx_CodeObjectCacheTable *table, __Pyx_CodeObjectCacheEntry *entry,
+                                        int code_line, PyCodeObject* code_object) {
+    // Readers must see the code object before they can find its line.
+    __pyx_atomic_pointer_store_release(&entry->code_object, code_object);
+    __pyx_atomic_store_release(&entry->code_line, code_line);
+    table->count++;
+}
+
+static void __pyx_replace_code_object(__Pyx_CodeObjectCacheEntry *entry, PyCodeObject* code_object) {
+    PyCodeObject *old_code_object = (PyCodeObject*) __pyx_atomic_pointer_load_acquire(&entry->code_object);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    // Concurrent readers may be about to take a reference to the old code object,
+    // so it stays alive until module cleanup.
+    __Pyx_CodeObjectCacheRetired *retired;
+    if (old_code_object == code_object) {
         return;
     }
-    if (unlikely(!entries)) {
-        entries = (__Pyx_CodeObjectCacheEntry*)PyMem_Malloc(64*sizeof(__Pyx_CodeObjectCacheEntry));
-        if (likely(entries)) {
-            __pyx_code_cache.entries = entries;
-            __pyx_code_cache.max_count = 64;
-            __pyx_code_cache.count = 1;
-            entries[0].code_line = code_line;
-            entries[0].code_object = code_object;
-            Py_INCREF(code_object);
-        }
+    retired = (__Pyx_CodeObjectCacheRetired*) PyMem_Malloc(sizeof(__Pyx_CodeObjectCacheRetired));
+    if (unlikely(!retired)) {
         return;
     }
-    pos = __pyx_bisect_code_objects(__pyx_code_cache.entries, __pyx_code_cache.count, code_line);
-    if ((pos < __pyx_code_cache.count) && unlikely(__pyx_code_cache.entries[pos].code_line == code_line)) {
-        PyCodeObject* tmp = entries[pos].code_object;
-        entries[pos].code_object = code_object;
-        Py_DECREF(tmp);
-        return;
+    retired->code_object = old_code_object;
+    retired->next = __pyx_code_cache.retired;
+    __pyx_code_cache.retired = retired;
+#endif
+    Py_INCREF(code_object);
+    __pyx_atomic_pointer_store_release(&entry->code_object, code_object);
+#if !CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    Py_DECREF(old_code_object);
+#endif
+}
+
+static __Pyx_CodeObjectCacheTable *__pyx_grow_code_object_cache(__Pyx_CodeObjectCacheTable *old_table) {
+    __Pyx_CodeObjectCacheTable *table;
+    __Pyx_CodeObjectCacheEntry *entry;
+    unsigned int i, size = old_table ? (old_table->mask + 1) * 2 : 64;
+    int line, free_line;
+    table = (__Pyx_CodeObjectCacheTable*) PyMem_Calloc(
+        1, sizeof(__Pyx_CodeObjectCacheTable) + (size - 1) * sizeof(__Pyx_CodeObjectCacheEntry));
+    if (unlikely(!table)) {
+        return NULL;
     }
-    if (__pyx_code_cache.count == __pyx_code_cache.max_count) {
-        int new_max = __pyx_code_cache.max_count + 64;
-        entries = (__Pyx_CodeObjectCacheEntry*)PyMem_Realloc(
-            __pyx_code_cache.entries, ((size_t)new_max) * sizeof(__Pyx_CodeObjectCacheEntry));
-        if (unlikely(!entries)) {
-            return;
+    table->mask = size - 1;
+    table->previous = old_table;
+    if (old_table) {
+        for (i = 0; i <= old_table->mask; i++) {
+            line = (int) __pyx_atomic_load_acquire(&old_table->entries[i].code_line);
+            if (line) {
+                entry = __pyx_code_object_cache_slot(table, line, &free_line);
+                __pyx_fill_code_object_slot(table, entry, line,
+                    (PyCodeObject*) __pyx_atomic_pointer_load_acquire(&old_table->entries[i].code_object));
+            }
         }
-        __pyx_code_cache.entries = entries;
-        __pyx_code_cache.max_count = new_max;
     }
-    for (i=__pyx_code_cache.count; i>pos; i--) {
-        entries[i] = entries[i-1];
+    __pyx_atomic_pointer_store_release(&__pyx_code_cache.table, table);
+    return table;
+}
+
+static void __pyx_insert_code_object(int code_line, PyCodeObject* code_object) {
+    __Pyx_CodeObjectCacheTable *table;
+    __Pyx_CodeObjectCacheEntry *entry;
+    int line;
+    if (unlikely(!code_line)) {
+        return;
+    }
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Lock(&__pyx_code_cache.mutex);
+#endif
+    table = __Pyx_CodeObjectCache_LoadTable();
+    if (unlikely(!table) || unlikely(2 * (table->count + 1) > table->mask + 1)) {
+        table = __pyx_grow_code_object_cache(table);
     }
-    entries[pos].code_line = code_line;
-    entries[pos].code_object = code_object;
-    __pyx_code_cache.count++;
-    Py_INCREF(code_object);
+    if (likely(table)) {
+        entry = __pyx_code_object_cache_slot(table, code_line, &line);
+        if (line) {
+            __pyx_replace_code_object(entry, code_object);
+        } else {
+            Py_INCREF(code_object);
+            __pyx_fill_code_object_slot(table, entry, code_line, code_object);
+        }
+    }
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Unlock(&__pyx_code_cache.mutex);
+#endif
 }
 #endif
 
 /////////////// CodeObjectCache.cleanup ///////////////
 
   #if !CYTHON_COMPILING_IN_LIMITED_API
-  if (__pyx_code_cache.entries) {
-      __Pyx_CodeObjectCacheEntry* entries = __pyx_code_cache.entries;
-      int i, count = __pyx_code_cache.count;
-      __pyx_code_cache.count = 0;
-      __pyx_code_cache.max_count = 0;
-      __pyx_code_cache.entries = NULL;
-      for (i=0; i<count; i++) {
-          Py_DECREF(entries[i].code_object);
+  if (__Pyx_CodeObjectCache_LoadTable()) {
+      __Pyx_CodeObjectCacheTable *table = __Pyx_CodeObjectCache_LoadTable(), *previous;
+      unsigned int i;
+      __pyx_atomic_pointer_store_release(&__pyx_code_cache.table, NULL);
+      // Older tables refer to the same code objects, without owning them.
+      for (i = 0; i <= table->mask; i++) {
+          if (__pyx_atomic_load_acquire(&table->entries[i].code_line)) {
+              Py_DECREF((PyCodeObject*) __pyx_atomic_pointer_load_acquire(&table->entries[i].code_object));
+          }
+      }
+      while (table) {
+          previous = table->previous;
+          PyMem_Free(table);
+          table = previous;
       }
-      PyMem_Free(entries);
   }
+  #if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+  while (__pyx_code_cache.retired) {
+      __Pyx_CodeObjectCacheRetired *retired = __pyx_code_cache.retired;
+      __pyx_code_cache.retired = retired->next;
+      Py_DECREF(retired->code_object);
+      PyMem_Free(retired);
+  }
+  #endif
   #endif
 
 /////////////// CheckBinaryVersion.proto ///////////////
@@ -1809,8 +2037,24 @@ __Pyx_FastGilFuncInit();
 #define __Pyx_FastGIL_Forget()
 #define __Pyx_FastGilFuncInit()
 
+/////////////// ThreadLocal.proto ///////////////
+//@proto_block: utility_code_proto_before_types
+
+#ifndef CYTHON_THREAD_LOCAL
+  #if defined(__cplusplus) && __cplusplus >= 201103L
+    #define CYTHON_THREAD_LOCAL thread_local
+  #elif defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112
+    #define CYTHON_THREAD_LOCAL _Thread_local
+  #elif defined(__GNUC__)
+    #define CYTHON_THREAD_LOCAL __thread
+  #elif defined(_MSC_VER)
+    #define CYTHON_THREAD_LOCAL __declspec(thread)
+  #endif
+#endif
+
 /////////////// FastGil.proto ///////////////
 //@proto_block: utility_code_proto_before_types
+//@requires: ThreadLocal
 
 #if CYTHON_FAST_GIL
 
@@ -1836,18 +2080,6 @@ static void __Pyx_FastGilFuncInit(void);
 #define __Pyx_FastGIL_Remember __Pyx_FastGilFuncs.FastGIL_Remember
 #define __Pyx_FastGIL_Forget __Pyx_FastGilFuncs.FastGIL_Forget
 
-#ifndef CYTHON_THREAD_LOCAL
-  #if defined(__cplusplus) && __cplusplus >= 201103L
-    #define CYTHON_THREAD_LOCAL thread_local
-  #elif defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112
-    #define CYTHON_THREAD_LOCAL _Thread_local
-  #elif defined(__GNUC__)
-    #define CYTHON_THREAD_LOCAL __thread
-  #elif defined(_MSC_VER)
-    #define CYTHON_THREAD_LOCAL __declspec(thread)
-  #endif
-#endif
-
 #else
 #define __Pyx_PyGILState_Ensure PyGILState_Ensure
 #define __Pyx_PyGILState_Release PyGILState_Release
@@ -2244,4 +2476,95 @@ done:
 #define __Pyx_shared_in_cpython_freethreading(x) shared(x)
 #else
 #define __Pyx_shared_in_cpython_freethreading(x)
-#endif
\ No newline at end of file
+#endif
+
+////////////////////////// CriticalSections.proto //////////////////
+
+// Critical sections on one or two objects, which only lock anything in free-threaded Python.
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+  #define __Pyx_PyCriticalSection PyCriticalSection
+  #define __Pyx_PyCriticalSection2 PyCriticalSection2
+  #define __Pyx_PyCriticalSection_Begin1 PyCriticalSection_Begin
+  #define __Pyx_PyCriticalSection_Begin2 PyCriticalSection2_Begin
+  #define __Pyx_PyCriticalSection_End1 PyCriticalSection_End
+  #define __Pyx_PyCriticalSection_End2 PyCriticalSection2_End
+#else
+  typedef int __Pyx_PyCriticalSection;
+  typedef int __Pyx_PyCriticalSection2;
+  #define __Pyx_PyCriticalSection_Begin1(cs, arg) (void)(cs)
+  #define __Pyx_PyCriticalSection_Begin2(cs, arg1, arg2) (void)(cs)
+  #define __Pyx_PyCriticalSection_End1(cs)
+  #define __Pyx_PyCriticalSection_End2(cs)
+#endif
+
+////////////////////////// AtomicScalarAccess.proto //////////////////
+
+// Relaxed atomic loads and stores of scalar attributes that are not protected by a critical section.
+// 'type' is the C type of the attribute.  The Float variants are used for floating point attributes.
+// Without free-threading, the GIL protects plain accesses.
+#if !CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+  #define __Pyx_AtomicScalarLoad(type, lvalue) (lvalue)
+  #define __Pyx_AtomicScalarStore(type, lvalue, value) (lvalue) = (value)
+  #define __Pyx_AtomicScalarLoadFloat(type, lvalue) (lvalue)
+  #define __Pyx_AtomicScalarStoreFloat(type, lvalue, value) (lvalue) = (value)
+#elif defined(__GNUC__) || defined(__clang__)
+  #define __Pyx_AtomicScalarLoad(type, lvalue) __extension__ ({ \
+      type __pyx_atomic_value; \
+      __atomic_load(&(lvalue), &__pyx_atomic_value, __ATOMIC_RELAXED); \
+      __pyx_atomic_value; })
+  #define __Pyx_AtomicScalarStore(type, lvalue, value) { \
+      type __pyx_atomic_value = (value); \
+      __atomic_store(&(lvalue), &__pyx_atomic_value, __ATOMIC_RELAXED); }
+  #define __Pyx_AtomicScalarLoadFloat(type, lvalue) __Pyx_AtomicScalarLoad(type, lvalue)
+  #define __Pyx_AtomicScalarStoreFloat(type, lvalue, value) __Pyx_AtomicScalarStore(type, lvalue, value)
+#elif defined(_MSC_VER)
+  // MSVC has no generic atomics in C, so the accesses dispatch on the size of the attribute.
+  // The __iso_volatile intrinsics are single, untorn accesses without memory barriers.
+  #include <intrin.h>
+  #include <string.h>
+  #define __Pyx_AtomicScalarLoad(type, lvalue) ((type) ( \
+      sizeof(lvalue) == 1 ? __iso_volatile_load8((const volatile __int8 *) &(lvalue)) : \
+      sizeof(lvalue) == 2 ? __iso_volatile_load16((const volatile __int16 *) &(lvalue)) : \
+      sizeof(lvalue) == 4 ? __iso_volatile_load32((const volatile __int32 *) &(lvalue)) : \
+      __iso_volatile_load64((const volatile __int64 *) &(lvalue))))
+  #define __Pyx_AtomicScalarStore(type, lvalue, value) { \
+      type __pyx_atomic_value = (value); \
+      switch (sizeof(lvalue)) { \
+          case 1: __iso_volatile_store8((volatile __int8 *) &(lvalue), (__int8) __pyx_atomic_value); break; \
+          case 2: __iso_volatile_store16((volatile __int16 *) &(lvalue), (__int16) __pyx_atomic_value); break; \
+          case 4: __iso_volatile_store32((volatile __int32 *) &(lvalue), (__int32) __pyx_atomic_value); break; \
+          default: __iso_volatile_store64((volatile __int64 *) &(lvalue), (__int64) __pyx_atomic_value); break; \
+      } }
+  #define __Pyx_AtomicScalarLoadFloat(type, lvalue) ((type) (sizeof(lvalue) == sizeof(float) ? \
+      __Pyx__AtomicScalarLoadFloat((const float *) &(lvalue)) : \
+      __Pyx__AtomicScalarLoadDouble((const double *) &(lvalue))))
+  #define __Pyx_AtomicScalarStoreFloat(type, lvalue, value) { \
+      if (sizeof(lvalue) == sizeof(float)) __Pyx__AtomicScalarStoreFloat((float *) &(lvalue), (float) (value)); \
+      else __Pyx__AtomicScalarStoreDouble((double *) &(lvalue), (double) (value)); }
+
+  // Floating point values are loaded and stored through integers of the same size.
+  static CYTHON_INLINE float __Pyx__AtomicScalarLoadFloat(const float *p) {
+      __int32 bits = __iso_volatile_load32((const volatile __int32 *) p);
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+  }
+  static CYTHON_INLINE double __Pyx__AtomicScalarLoadDouble(const double *p) {
+      __int64 bits = __iso_volatile_load64((const volatile __int64 *) p);
+      double value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+  }
+  static CYTHON_INLINE void __Pyx__AtomicScalarStoreFloat(float *p, float value) {
+      __int32 bits;
+      memcpy(&bits, &value, sizeof(bits));
+      __iso_volatile_store32((volatile __int32 *) p, bits);
+  }
+  static CYTHON_INLINE void __Pyx__AtomicScalarStoreDouble(double *p, double value) {
+      __int64 bits;
+      memcpy(&bits, &value, sizeof(bits));
+      __iso_volatile_store64((volatile __int64 *) p, bits);
+  }
+#else
+  #error "Cython does not support atomic attribute accesses in free-threaded builds with this compiler."
+#endif
@@ -1391,6 +1391,7 @@ static int __Pyx_SetNewInClass(PyObject *ns, PyObject *name, PyObject *value) {
 
 /////////////// GetModuleGlobalName.proto ///////////////
 //@requires: PyDictVersioning
+//@requires: GlobalsWatcher
 //@substitute: naming
 
 #if CYTHON_USE_DICT_VERSIONS
@@ -1407,6 +1408,26 @@ static int __Pyx_SetNewInClass(PyObject *ns, PyObject *name, PyObject *value) {
     (var) = __Pyx__GetModuleGlobalName(name, &__pyx_dict_version, &__pyx_dict_cached_value); \
 } while(0)
 static PyObject *__Pyx__GetModuleGlobalName(PyObject *name, PY_UINT64_T *dict_version, PyObject **dict_cached_value); /*proto*/
+#elif CYTHON_USE_DICT_WATCHERS
+typedef struct {
+    // The value is a borrowed reference that is valid as long as the epoch matches.
+    // Free-threaded builds only cache immortal objects, which readers can use without locking.
+    uint64_t epoch;
+    PyObject *value;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex mutex;
+#endif
+} __Pyx_GlobalNameCache;
+
+#define __Pyx_GetModuleGlobalName(var, name)  do { \
+    static __Pyx_GlobalNameCache __pyx_global_name_cache; \
+    (var) = __Pyx_GlobalNameCache_Lookup(&__pyx_global_name_cache, name); \
+} while(0)
+#define __Pyx_GetModuleGlobalNameUncached(var, name)  (var) = __Pyx__GetModuleGlobalName(name, NULL)
+static CYTHON_INLINE PyObject *__Pyx_GlobalNameCache_Lookup(__Pyx_GlobalNameCache *cache, PyObject *name); /*proto*/
+static PyObject *__Pyx__GetModuleGlobalName(PyObject *name, __Pyx_GlobalNameCache *cache); /*proto*/
+static CYTHON_INLINE void __Pyx_GlobalNameCache_Store(__Pyx_GlobalNameCache *cache, uint64_t epoch, PyObject *value); /*proto*/
+static int __Pyx_GlobalsWatcher_Init(void); /*proto*/
 #else
 #define __Pyx_GetModuleGlobalName(var, name)  (var) = __Pyx__GetModuleGlobalName(name)
 #define __Pyx_GetModuleGlobalNameUncached(var, name)  (var) = __Pyx__GetModuleGlobalName(name)
@@ -1414,17 +1435,62 @@ static CYTHON_INLINE PyObject *__Pyx__GetModuleGlobalName(PyObject *name); /*pro
 #endif
 
 
+/////////////// GetModuleGlobalName.init ///////////////
+
+#if !CYTHON_USE_DICT_VERSIONS && CYTHON_USE_DICT_WATCHERS
+if (unlikely(__Pyx_GlobalsWatcher_Init() < 0)) PyErr_Clear();
+#endif
+
 /////////////// GetModuleGlobalName ///////////////
 //@requires: GetBuiltinName
 //@substitute: naming
 
 #if CYTHON_USE_DICT_VERSIONS
 static PyObject *__Pyx__GetModuleGlobalName(PyObject *name, PY_UINT64_T *dict_version, PyObject **dict_cached_value)
+#elif CYTHON_USE_DICT_WATCHERS
+static PyObject *__Pyx__GetModuleGlobalName(PyObject *name, __Pyx_GlobalNameCache *cache)
 #else
 static CYTHON_INLINE PyObject *__Pyx__GetModuleGlobalName(PyObject *name)
 #endif
 {
     PyObject *result;
+#if CYTHON_USE_DICT_WATCHERS && !CYTHON_USE_DICT_VERSIONS
+    uint64_t epoch;
+    if (!cache || unlikely(__Pyx_GlobalsEpoch_Load(__pyx_globals_epoch) == (uint64_t) -1)) {
+        // Not cached, fall through to the plain lookup below.
+    } else {
+        PyObject *builtins_dict = PyModule_GetDict($builtins_cname);
+        int cacheable;
+        // The watcher is called (and bumps the epoch) before a dict is modified, while holding
+        // the dict's critical section in free-threaded builds.  Holding it here while reading
+        // the epoch guarantees that the value we find belongs to that epoch.
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+        Py_BEGIN_CRITICAL_SECTION2($moddict_cname, builtins_dict);
+#endif
+        epoch = __Pyx_GlobalsEpoch_Load(__pyx_globals_epoch);
+        result = __Pyx_PyDict_GetItemStrWithError($moddict_cname, name);
+        if (!result && !PyErr_Occurred()) {
+            result = __Pyx_PyDict_GetItemStrWithError(builtins_dict, name);
+        }
+        Py_XINCREF(result);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+        Py_END_CRITICAL_SECTION2();
+#endif
+        if (unlikely(!result)) {
+            return PyErr_Occurred() ? NULL : __Pyx_GetBuiltinName(name);
+        }
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+        cacheable = _Py_IsImmortal(result);
+#else
+        cacheable = 1;
+#endif
+        // The module dict may have been deallocated in the meantime.
+        if (cacheable && likely(epoch != (uint64_t) -1)) {
+            __Pyx_GlobalNameCache_Store(cache, epoch, result);
+        }
+        return result;
+    }
+#endif
 // FIXME: clean up the macro guard order here: limited API first, then borrowed refs, then cpython
 #if !CYTHON_AVOID_BORROWED_REFS
 #if CYTHON_COMPILING_IN_CPYTHON && PY_VERSION_HEX < 0x030d0000
@@ -1462,6 +1528,268 @@ static CYTHON_INLINE PyObject *__Pyx__GetModuleGlobalName(PyObject *name)
     return __Pyx_GetBuiltinName(name);
 }
 
+#if CYTHON_USE_DICT_WATCHERS && !CYTHON_USE_DICT_VERSIONS
+static CYTHON_INLINE PyObject *__Pyx_GlobalNameCache_Lookup(__Pyx_GlobalNameCache *cache, PyObject *name) {
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    // Stores publish the value before the epoch and never go back to an older epoch,
+    // so the value we read is at least as recent as the epoch.
+    if (likely(_Py_atomic_load_uint64_acquire(&cache->epoch) == __Pyx_GlobalsEpoch_Load(__pyx_globals_epoch))) {
+        return __Pyx_NewRef((PyObject *) _Py_atomic_load_ptr_relaxed(&cache->value));
+    }
+#else
+    if (likely(cache->epoch == *__pyx_globals_epoch)) {
+        return __Pyx_NewRef(cache->value);
+    }
+#endif
+    return __Pyx__GetModuleGlobalName(name, cache);
+}
+#endif
+
+
+/////////////// GlobalsWatcher.proto ///////////////
+//@requires: ModuleSetupCode.c::AccessPyMutexForFreeThreading
+
+// Python 3.12 deprecated the dict versions.  Instead, a dict watcher that all Cython
+// modules share invalidates the caches when a watched module dict or the builtins change.
+#ifndef CYTHON_USE_DICT_WATCHERS
+  #define CYTHON_USE_DICT_WATCHERS (CYTHON_COMPILING_IN_CPYTHON && PY_VERSION_HEX >= 0x030C0000 && !CYTHON_USE_DICT_VERSIONS)
+#endif
+
+#if CYTHON_USE_DICT_WATCHERS && !CYTHON_USE_DICT_VERSIONS
+typedef struct {
+    PyObject *dict;   /* not owned, removed when the dict is deallocated */
+    uint64_t *epoch;  /* NULL for the builtins, which change the epochs of all modules */
+} __Pyx_GlobalsWatcherEntry;
+
+// Shared by all modules of the same Cython ABI version through a capsule in the
+// ABI module, since CPython only provides a handful of dict watcher IDs.
+// The table maps the watched dicts to the epochs of the modules that use them.
+typedef struct {
+    int watcher_id;
+    size_t mask;  /* size - 1, the size is a power of 2 */
+    size_t count;
+    __Pyx_GlobalsWatcherEntry *entries;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex mutex;
+#endif
+} __Pyx_GlobalsWatcherState;
+
+// An epoch of -1 disables the caches, e.g. after the module dict was deallocated.
+static uint64_t __pyx_globals_epoch_disabled = (uint64_t) -1;
+// The epoch of this module, which changes with its dict and the builtins.
+static uint64_t __pyx_globals_epoch_value = 1;
+// Points to the module's epoch once the module dict and the builtins are watched.
+static uint64_t *__pyx_globals_epoch = &__pyx_globals_epoch_disabled;
+// Set in the module that registered the watcher, for its callback.
+static __Pyx_GlobalsWatcherState *__pyx_globals_watcher_state = NULL;
+
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+#define __Pyx_GlobalsEpoch_Load(epoch)  _Py_atomic_load_uint64_acquire(epoch)
+#else
+#define __Pyx_GlobalsEpoch_Load(epoch)  (*(epoch))
+#endif
+#endif
+
+/////////////// GlobalsWatcher ///////////////
+//@substitute: naming
+
+#if CYTHON_USE_DICT_WATCHERS && !CYTHON_USE_DICT_VERSIONS
+#define __Pyx_GlobalsWatcher_CapsuleName  "_globals_watcher"
+
+// The watched dicts can still change during interpreter shutdown, after the capsule
+// is gone, so the shared state lives in the (never unloaded) module that created it.
+static __Pyx_GlobalsWatcherState __pyx_globals_watcher_storage = {
+    -1, 0, 0, NULL
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    , {0}
+#endif
+};
+
+static CYTHON_INLINE size_t __Pyx_GlobalsWatcher_Hash(PyObject *dict) {
+    size_t h = ((size_t) dict >> 4) * (size_t) 2654435769U;
+    return h ^ (h >> 16);
+}
+
+// Returns the index of the dict in the table, or of the empty slot for it.
+static size_t __Pyx_GlobalsWatcher_Find(__Pyx_GlobalsWatcherState *state, PyObject *dict) {
+    size_t i = __Pyx_GlobalsWatcher_Hash(dict) & state->mask;
+    while (state->entries[i].dict && state->entries[i].dict != dict) {
+        i = (i + 1) & state->mask;
+    }
+    return i;
+}
+
+static int __Pyx_GlobalsWatcher_Register(__Pyx_GlobalsWatcherState *state, PyObject *dict, uint64_t *epoch) {
+    size_t i;
+    if (!state->entries || 2 * (state->count + 1) > state->mask + 1) {
+        __Pyx_GlobalsWatcherEntry *old_entries = state->entries;
+        size_t old_size = old_entries ? state->mask + 1 : 0;
+        size_t size = old_size ? 2 * old_size : 16;
+        // The table is also used during interpreter shutdown, so it does not use the Python allocator.
+        __Pyx_GlobalsWatcherEntry *entries = (__Pyx_GlobalsWatcherEntry *) PyMem_RawCalloc(
+            size, sizeof(__Pyx_GlobalsWatcherEntry));
+        if (unlikely(!entries)) return -1;
+        state->entries = entries;
+        state->mask = size - 1;
+        for (i = 0; i < old_size; i++) {
+            if (old_entries[i].dict) {
+                entries[__Pyx_GlobalsWatcher_Find(state, old_entries[i].dict)] = old_entries[i];
+            }
+        }
+        PyMem_RawFree(old_entries);
+    }
+    i = __Pyx_GlobalsWatcher_Find(state, dict);
+    if (!state->entries[i].dict) {
+        state->entries[i].dict = dict;
+        state->count++;
+    }
+    state->entries[i].epoch = epoch;
+    return 0;
+}
+
+static void __Pyx_GlobalsWatcher_Remove(__Pyx_GlobalsWatcherState *state, size_t i) {
+    // Move later entries of the same probe sequence up, so that lookups still find them.
+    size_t j = i, home;
+    for (;;) {
+        j = (j + 1) & state->mask;
+        if (!state->entries[j].dict) break;
+        home = __Pyx_GlobalsWatcher_Hash(state->entries[j].dict) & state->mask;
+        if (((j - home) & state->mask) >= ((j - i) & state->mask)) {
+            state->entries[i] = state->entries[j];
+            i = j;
+        }
+    }
+    state->entries[i].dict = NULL;
+    state->entries[i].epoch = NULL;
+    state->count--;
+}
+
+static CYTHON_INLINE void __Pyx_GlobalsWatcher_Bump(uint64_t *epoch) {
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    _Py_atomic_add_uint64(epoch, 1);
+#else
+    (*epoch)++;
+#endif
+}
+
+static int __Pyx_GlobalsWatcher_Callback(PyDict_WatchEvent event, PyObject *dict, PyObject *key, PyObject *new_value) {
+    __Pyx_GlobalsWatcherState *state = __pyx_globals_watcher_state;
+    __Pyx_GlobalsWatcherEntry *entry;
+    size_t i;
+    CYTHON_UNUSED_VAR(key);
+    CYTHON_UNUSED_VAR(new_value);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Lock(&state->mutex);
+#endif
+    if (unlikely(!state->entries)) goto done;
+    i = __Pyx_GlobalsWatcher_Find(state, dict);
+    entry = &state->entries[i];
+    if (unlikely(!entry->dict)) goto done;
+    if (entry->epoch) {
+        __Pyx_GlobalsWatcher_Bump(entry->epoch);
+    } else {
+        size_t j;
+        for (j = 0; j <= state->mask; j++) {
+            if (state->entries[j].epoch) __Pyx_GlobalsWatcher_Bump(state->entries[j].epoch);
+        }
+    }
+    if (unlikely(event == PyDict_EVENT_DEALLOCATED)) {
+        // Another dict may later use the same address, so the module stops caching for good.
+        if (entry->epoch) {
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+            _Py_atomic_store_uint64_release(entry->epoch, (uint64_t) -1);
+#else
+            *entry->epoch = (uint64_t) -1;
+#endif
+        }
+        __Pyx_GlobalsWatcher_Remove(state, i);
+    }
+done:
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Unlock(&state->mutex);
+#endif
+    return 0;
+}
+
+static int __Pyx_GlobalsWatcher_Init(void) {
+    __Pyx_GlobalsWatcherState *state;
+    PyObject *abi_module, *capsule, *builtins_dict;
+    int watcher_id, result;
+    abi_module = __Pyx_PyImport_AddModuleRef(__PYX_ABI_MODULE_NAME);
+    if (unlikely(!abi_module)) return -1;
+    capsule = PyObject_GetAttrString(abi_module, __Pyx_GlobalsWatcher_CapsuleName);
+    if (capsule) {
+        state = (__Pyx_GlobalsWatcherState *) PyCapsule_GetPointer(capsule, __Pyx_GlobalsWatcher_CapsuleName);
+        Py_DECREF(capsule);
+        if (unlikely(!state)) goto bad;
+    } else {
+        // Concurrently initialising modules might each register their own watcher,
+        // which is wasteful but correct, since each of them watches its own dicts.
+        if (unlikely(!PyErr_ExceptionMatches(PyExc_AttributeError))) goto bad;
+        PyErr_Clear();
+        state = &__pyx_globals_watcher_storage;
+        capsule = PyCapsule_New(state, __Pyx_GlobalsWatcher_CapsuleName, NULL);
+        if (unlikely(!capsule)) goto bad;
+        if (unlikely(PyObject_SetAttrString(abi_module, __Pyx_GlobalsWatcher_CapsuleName, capsule) < 0)) {
+            Py_DECREF(capsule);
+            goto bad;
+        }
+        Py_DECREF(capsule);
+        __pyx_globals_watcher_state = state;
+        watcher_id = PyDict_AddWatcher(__Pyx_GlobalsWatcher_Callback);
+        // Without a watcher ID left, all modules keep using uncached lookups.
+        if (unlikely(watcher_id < 0)) goto bad;
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+        _Py_atomic_store_int_release(&state->watcher_id, watcher_id);
+#else
+        state->watcher_id = watcher_id;
+#endif
+    }
+    Py_DECREF(abi_module);
+
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    watcher_id = _Py_atomic_load_int_acquire(&state->watcher_id);
+#else
+    watcher_id = state->watcher_id;
+#endif
+    if (unlikely(watcher_id < 0)) return 0;
+    builtins_dict = PyModule_GetDict($builtins_cname);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Lock(&state->mutex);
+#endif
+    result = __Pyx_GlobalsWatcher_Register(state, $moddict_cname, &__pyx_globals_epoch_value);
+    if (likely(result == 0)) result = __Pyx_GlobalsWatcher_Register(state, builtins_dict, NULL);
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Unlock(&state->mutex);
+#endif
+    if (unlikely(result < 0)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (unlikely(PyDict_Watch(watcher_id, $moddict_cname) < 0)) return -1;
+    if (unlikely(PyDict_Watch(watcher_id, builtins_dict) < 0)) return -1;
+    __pyx_globals_epoch = &__pyx_globals_epoch_value;
+    return 0;
+bad:
+    Py_DECREF(abi_module);
+    return -1;
+}
+
+static CYTHON_INLINE void __Pyx_GlobalNameCache_Store(__Pyx_GlobalNameCache *cache, uint64_t epoch, PyObject *value) {
+#if CYTHON_COMPILING_IN_CPYTHON_FREETHREADING
+    PyMutex_Lock(&cache->mutex);
+    if (epoch > cache->epoch) {
+        _Py_atomic_store_ptr_relaxed(&cache->value, value);
+        _Py_atomic_store_uint64_release(&cache->epoch, epoch);
+    }
+    PyMutex_Unlock(&cache->mutex);
+#else
+    cache->value = value;
+    cache->epoch = epoch;
+#endif
+}
+#endif
+
 //////////////////// GetAttr.proto ////////////////////
 
 static CYTHON_INLINE PyObject *__Pyx_GetAttr(PyObject *, PyObject *); /*proto*/
@@ -1722,6 +2050,197 @@ try_unpack:
 }
 
 
+/////////////// PyObjectGetAttrStrCached.proto ///////////////
+//@requires: PyObjectGetAttrStr
+//@requires: PyObjectGetMethod
+
+// Per call site inline caches for attribute lookups on objects that use the generic
+// attribute lookup.  The cache is keyed on the type version tag, which CPython
+// changes whenever the type or one of its bases is modified, so the cached
+// descriptor (borrowed from the type's MRO) stays alive while the tag matches.
+#ifndef CYTHON_USE_ATTRIBUTE_CACHE
+  #define CYTHON_USE_ATTRIBUTE_CACHE (CYTHON_COMPILING_IN_CPYTHON && CYTHON_USE_TYPE_SLOTS && \
+                                      CYTHON_USE_PYTYPE_LOOKUP && !CYTHON_COMPILING_IN_CPYTHON_FREETHREADING)
+#endif
+
+#if CYTHON_USE_ATTRIBUTE_CACHE
+typedef struct {
+    unsigned int type_version;  /* 0 = empty */
+    int kind;
+    PyObject *descr;
+    Py_ssize_t offset;
+} __Pyx_AttrCache;
+
+#define __Pyx_PyObject_GetAttrStrCached(var, obj, name)  do { \
+    static __Pyx_AttrCache __pyx_attr_cache = {0, 0, NULL, 0}; \
+    (var) = __Pyx__PyObject_GetAttrStrCached(obj, name, &__pyx_attr_cache); \
+} while(0)
+#define __Pyx_PyObject_GetMethodCached(var, is_method, obj, name)  do { \
+    static __Pyx_AttrCache __pyx_attr_cache = {0, 0, NULL, 0}; \
+    (is_method) = __Pyx__PyObject_GetMethodCached(obj, name, &(var), &__pyx_attr_cache); \
+} while(0)
+static CYTHON_INLINE PyObject* __Pyx__PyObject_GetAttrStrCached(PyObject *obj, PyObject *name, __Pyx_AttrCache *cache); /*proto*/
+static CYTHON_INLINE int __Pyx__PyObject_GetMethodCached(PyObject *obj, PyObject *name, PyObject **method, __Pyx_AttrCache *cache); /*proto*/
+#else
+#define __Pyx_PyObject_GetAttrStrCached(var, obj, name)  (var) = __Pyx_PyObject_GetAttrStr(obj, name)
+#define __Pyx_PyObject_GetMethodCached(var, is_method, obj, name)  \
+    ((var) = NULL, (is_method) = __Pyx_PyObject_GetMethod(obj, name, &(var)))
+#endif
+
+/////////////// PyObjectGetAttrStrCached ///////////////
+//@requires: ModuleSetupCode.c::IncludeStructmemberH
+
+#if CYTHON_USE_ATTRIBUTE_CACHE
+enum {
+    __Pyx_AttrCache_Generic = 1,       /* nothing to gain, use the type's lookup */
+    __Pyx_AttrCache_InstanceOnly,      /* not found in the type, only in the instance dict */
+    __Pyx_AttrCache_Slot,              /* object member at a fixed offset (__slots__, cdef class attributes) */
+    __Pyx_AttrCache_DataDescr,         /* other data descriptor, e.g. a property */
+    __Pyx_AttrCache_Method,            /* method descriptor, can be called unbound */
+    __Pyx_AttrCache_NonDataDescr,      /* other non-data descriptor, e.g. a classmethod */
+    __Pyx_AttrCache_ClassAttr          /* plain class attribute */
+};
+
+#if PY_VERSION_HEX >= 0x030C0000
+// CPython 3.12 resets the tag to 0 when invalidating it.
+#define __Pyx_AttrCache_TypeVersion(tp)  ((tp)->tp_version_tag)
+#else
+#define __Pyx_AttrCache_TypeVersion(tp)  \
+    (__Pyx_PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG) ? (tp)->tp_version_tag : 0)
+#endif
+
+// Types that can keep the instance attributes outside of a dict (CPython 3.11+).
+#if defined(Py_TPFLAGS_INLINE_VALUES)
+#define __Pyx_AttrCache_MANAGED_DICT_FLAGS  (Py_TPFLAGS_MANAGED_DICT | Py_TPFLAGS_INLINE_VALUES)
+#elif defined(Py_TPFLAGS_MANAGED_DICT)
+#define __Pyx_AttrCache_MANAGED_DICT_FLAGS  Py_TPFLAGS_MANAGED_DICT
+#else
+#define __Pyx_AttrCache_MANAGED_DICT_FLAGS  0
+#endif
+
+// Returns 1 and a new reference if the name is found in the instance dict, 0 if not, -1 on error.
+// Not for types with a managed dict, for which _PyObject_GetDictPtr() creates the dict.
+static CYTHON_INLINE int __Pyx_AttrCache_LookupInstanceDict(PyObject *obj, PyObject *name, PyObject **value) {
+    PyObject **dictptr = _PyObject_GetDictPtr(obj);
+    PyObject *dict, *result;
+    if (!dictptr || !(dict = *dictptr)) return 0;
+    Py_INCREF(dict);
+    result = __Pyx_PyDict_GetItemStrWithError(dict, name);
+    Py_XINCREF(result);
+    Py_DECREF(dict);
+    if (result) {
+        *value = result;
+        return 1;
+    }
+    return unlikely(PyErr_Occurred()) ? -1 : 0;
+}
+
+static PyObject* __Pyx__PyObject_GetAttrStrFillCache(PyObject *obj, PyObject *name, __Pyx_AttrCache *cache) {
+    PyTypeObject *tp = Py_TYPE(obj);
+    PyObject *descr;
+    unsigned int type_version;
+    int kind;
+    cache->type_version = 0;
+    if (unlikely(tp->tp_getattro != PyObject_GenericGetAttr) || unlikely(!tp->tp_dict)) goto lookup;
+
+    descr = _PyType_Lookup(tp, name);
+    type_version = __Pyx_AttrCache_TypeVersion(tp);
+#if PY_VERSION_HEX >= 0x030C0000
+    if (!type_version && PyUnstable_Type_AssignVersionTag(tp)) {
+        type_version = __Pyx_AttrCache_TypeVersion(tp);
+    }
+#endif
+    if (unlikely(!type_version)) goto lookup;
+
+    if (!descr) {
+        kind = __Pyx_AttrCache_InstanceOnly;
+    } else if (!Py_TYPE(descr)->tp_descr_get) {
+        kind = __Pyx_AttrCache_ClassAttr;
+    } else if (PyDescr_IsData(descr)) {
+        kind = __Pyx_AttrCache_DataDescr;
+        if (__Pyx_IS_TYPE(descr, &PyMemberDescr_Type)) {
+            PyMemberDef *member = ((PyMemberDescrObject*) descr)->d_member;
+            if (member->type == T_OBJECT_EX && !(member->flags & READ_RESTRICTED)
+#ifdef Py_RELATIVE_OFFSET
+                    && !(member->flags & Py_RELATIVE_OFFSET)
+#endif
+                    && PyObject_TypeCheck(obj, PyDescr_TYPE(descr))) {
+                kind = __Pyx_AttrCache_Slot;
+                cache->offset = member->offset;
+            }
+        }
+    } else if (__Pyx_PyType_HasFeature(Py_TYPE(descr), Py_TPFLAGS_METHOD_DESCRIPTOR)) {
+        kind = __Pyx_AttrCache_Method;
+    } else {
+        kind = __Pyx_AttrCache_NonDataDescr;
+    }
+    if (kind != __Pyx_AttrCache_Slot && kind != __Pyx_AttrCache_DataDescr &&
+            __Pyx_PyType_HasFeature(tp, __Pyx_AttrCache_MANAGED_DICT_FLAGS)) {
+        // _PyObject_GetDictPtr() would create the instance dict of these types, so we
+        // let the type's lookup check the instance attributes.
+        kind = __Pyx_AttrCache_Generic;
+    }
+    cache->kind = kind;
+    cache->descr = descr;
+    cache->type_version = type_version;
+
+lookup:
+    // Let the type do the first lookup to get all corner cases and error messages right.
+    return __Pyx_PyObject_GetAttrStr(obj, name);
+}
+
+static CYTHON_INLINE PyObject* __Pyx__PyObject_GetAttrStrCached(PyObject *obj, PyObject *name, __Pyx_AttrCache *cache) {
+    PyTypeObject *tp = Py_TYPE(obj);
+    PyObject *descr, *result;
+    int found;
+    if (unlikely(!cache->type_version) || unlikely(cache->type_version != __Pyx_AttrCache_TypeVersion(tp))) {
+        return __Pyx__PyObject_GetAttrStrFillCache(obj, name, cache);
+    }
+    descr = cache->descr;
+    switch (cache->kind) {
+        case __Pyx_AttrCache_Slot:
+            result = *(PyObject **) ((char *) obj + cache->offset);
+            if (likely(result)) return __Pyx_NewRef(result);
+            // Let the descriptor raise the AttributeError.
+            break;
+        case __Pyx_AttrCache_DataDescr:
+            Py_INCREF(descr);
+            result = Py_TYPE(descr)->tp_descr_get(descr, obj, (PyObject *) tp);
+            Py_DECREF(descr);
+            return result;
+        case __Pyx_AttrCache_Generic:
+            break;
+        default:
+            found = __Pyx_AttrCache_LookupInstanceDict(obj, name, &result);
+            if (found) return likely(found > 0) ? result : NULL;
+            if (cache->kind == __Pyx_AttrCache_ClassAttr) return __Pyx_NewRef(descr);
+            if (cache->kind == __Pyx_AttrCache_InstanceOnly) break;
+            Py_INCREF(descr);
+            result = Py_TYPE(descr)->tp_descr_get(descr, obj, (PyObject *) tp);
+            Py_DECREF(descr);
+            return result;
+    }
+    return __Pyx_PyObject_GetAttrStr(obj, name);
+}
+
+static CYTHON_INLINE int __Pyx__PyObject_GetMethodCached(PyObject *obj, PyObject *name, PyObject **method, __Pyx_AttrCache *cache) {
+    if (likely(cache->type_version) && likely(cache->kind == __Pyx_AttrCache_Method) &&
+            likely(cache->type_version == __Pyx_AttrCache_TypeVersion(Py_TYPE(obj)))) {
+        int found = __Pyx_AttrCache_LookupInstanceDict(obj, name, method);
+        if (likely(!found)) {
+            // Avoid creating a bound method object, the caller passes 'obj' as first argument.
+            *method = __Pyx_NewRef(cache->descr);
+            return 1;
+        }
+        if (found < 0) *method = NULL;
+        return 0;
+    }
+    *method = __Pyx__PyObject_GetAttrStrCached(obj, name, cache);
+    return 0;
+}
+#endif
+
+
 /////////////// UnpackUnboundCMethod.proto ///////////////
 
 typedef struct {
@@ -0,0 +1,607 @@
+/////////////// ParallelReductionBuffer.proto ///////////////
+
+static char *__Pyx_ParallelReductionBuffer(int num_threads, Py_ssize_t size); /*proto*/
+
+/////////////// ParallelReductionBuffer ///////////////
+
+// Allocates the zero initialised accumulators of a memoryview reduction in a
+// prange loop, 'size' bytes for each thread that may run the loop.
+// Called without the GIL, raises MemoryError on failure.
+static char *__Pyx_ParallelReductionBuffer(int num_threads, Py_ssize_t size) {
+    char *buffer;
+#ifdef _OPENMP
+    if (num_threads <= 0)
+        num_threads = omp_get_max_threads();
+#endif
+    if (num_threads <= 0)
+        num_threads = 1;
+    buffer = (char *) calloc((size_t) num_threads, size > 0 ? (size_t) size : 1);
+    if (unlikely(!buffer)) {
+        PyGILState_STATE gilstate = PyGILState_Ensure();
+        PyErr_NoMemory();
+        PyGILState_Release(gilstate);
+    }
+    return buffer;
+}
+
+/////////////// ThreadPool.proto ///////////////
+
+// The 'parallel_backend=threadpool' directive moves the body of a prange loop
+// into a separate function that the threads of a pool call instead of using
+// OpenMP.  The pool is shared by all Cython modules of the process through the
+// function table below, which the first module that gets imported publishes
+// as a capsule in the module CYTHON_THREADPOOL_MODULE.  All prange loops of the
+// process therefore share one thread budget.
+
+#ifndef CYTHON_THREADPOOL_MODULE
+  #define CYTHON_THREADPOOL_MODULE "_cython_threadpool"
+#endif
+
+// The thread budget if the environment variable CYTHON_NUM_THREADS is not set,
+// 0 for the number of CPUs.
+#ifndef CYTHON_THREADPOOL_NUM_THREADS
+  #define CYTHON_THREADPOOL_NUM_THREADS 0
+#endif
+
+#define __PYX_THREADPOOL_ABI_VERSION 1
+
+// values of the 'schedule' argument of run()
+#define __Pyx_ThreadPool_SCHEDULE_STEAL   0
+#define __Pyx_ThreadPool_SCHEDULE_STATIC  1
+#define __Pyx_ThreadPool_SCHEDULE_DYNAMIC 2
+#define __Pyx_ThreadPool_SCHEDULE_GUIDED  3
+
+typedef void (*__Pyx_ThreadPool_Body)(void *ctx, void *thread);
+
+typedef struct {
+    int abi_version;
+    // maximum number of threads that run() uses for 'num_threads' (0 for no limit)
+    int (*max_threads)(int num_threads);
+    // calls 'body' in up to 'num_threads' threads, including the calling one,
+    // and returns when all of them are done
+    void (*run)(__Pyx_ThreadPool_Body body, void *ctx, Py_ssize_t nsteps,
+                int schedule, Py_ssize_t chunksize, int num_threads);
+    // the next iterations [*begin, *end) of the calling thread, returns 0 at the end
+    int (*next_chunk)(void *thread, Py_ssize_t *begin, Py_ssize_t *end);
+    int (*thread_num)(void *thread);
+    // a lock for the critical sections of the threads of one run() call
+    void (*lock)(void *thread);
+    void (*unlock)(void *thread);
+} __Pyx_ThreadPoolAPIStruct;
+
+static __Pyx_ThreadPoolAPIStruct *__Pyx_ThreadPoolAPI = NULL;
+static int __Pyx_ThreadPool_Import(void); /*proto*/
+
+#define __Pyx_ThreadPool_MaxThreads(num_threads)  (__Pyx_ThreadPoolAPI->max_threads(num_threads))
+#define __Pyx_ThreadPool_Run(body, ctx, nsteps, schedule, chunksize, num_threads) \
+    __Pyx_ThreadPoolAPI->run(body, ctx, nsteps, schedule, chunksize, num_threads)
+#define __Pyx_ThreadPool_NextChunk(thread, begin, end)  (__Pyx_ThreadPoolAPI->next_chunk(thread, begin, end))
+#define __Pyx_ThreadPool_ThreadNum(thread)  (__Pyx_ThreadPoolAPI->thread_num(thread))
+#define __Pyx_ThreadPool_Lock(thread)  __Pyx_ThreadPoolAPI->lock(thread)
+#define __Pyx_ThreadPool_Unlock(thread)  __Pyx_ThreadPoolAPI->unlock(thread)
+
+/////////////// ThreadPool.init ///////////////
+
+if (likely(__Pyx_ThreadPool_Import() == 0)); else
+// error propagation code is appended automatically
+
+/////////////// ThreadPool ///////////////
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#ifndef PYTHREAD_INVALID_THREAD_ID
+  #define PYTHREAD_INVALID_THREAD_ID ((unsigned long)-1)
+#endif
+
+// Sequentially consistent accesses to the iteration ranges of the work stealing
+// schedule.  Without them, the owner of a range also takes its steal lock.
+#if defined(__GNUC__) || defined(__clang__)
+  #define __Pyx_ThreadPool_ATOMIC_RANGES 1
+  #define __Pyx_ThreadPool_FetchAdd(p, value)  __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST)
+  #define __Pyx_ThreadPool_Load(p)  __atomic_load_n(p, __ATOMIC_SEQ_CST)
+  #define __Pyx_ThreadPool_Store(p, value)  __atomic_store_n(p, value, __ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+  #include <intrin.h>
+  #define __Pyx_ThreadPool_ATOMIC_RANGES 1
+  #if defined(_WIN64)
+    #define __Pyx_ThreadPool_FetchAdd(p, value)  _InterlockedExchangeAdd64((volatile __int64 *) (p), value)
+    #define __Pyx_ThreadPool_Load(p)  _InterlockedCompareExchange64((volatile __int64 *) (p), 0, 0)
+    #define __Pyx_ThreadPool_Store(p, value)  (void) _InterlockedExchange64((volatile __int64 *) (p), value)
+  #else
+    #define __Pyx_ThreadPool_FetchAdd(p, value)  _InterlockedExchangeAdd((volatile long *) (p), value)
+    #define __Pyx_ThreadPool_Load(p)  _InterlockedCompareExchange((volatile long *) (p), 0, 0)
+    #define __Pyx_ThreadPool_Store(p, value)  (void) _InterlockedExchange((volatile long *) (p), value)
+  #endif
+#else
+  #define __Pyx_ThreadPool_ATOMIC_RANGES 0
+  #define __Pyx_ThreadPool_FetchAdd(p, value)  ((*(p) += (value)) - (value))
+  #define __Pyx_ThreadPool_Load(p)  (*(p))
+  #define __Pyx_ThreadPool_Store(p, value)  (void) (*(p) = (value))
+#endif
+
+typedef struct __Pyx_ThreadPoolTask __Pyx_ThreadPoolTask;
+
+typedef struct {
+    __Pyx_ThreadPoolTask *task;
+    int num;
+    // the iterations that are left to this thread (static and work stealing
+    // schedules), or the next chunk of a static schedule with a chunksize
+    Py_ssize_t begin, end;
+    // Work stealing: the owner claims chunks by advancing 'begin' atomically,
+    // thieves hold this lock while they move 'end' down.
+    PyThread_type_lock steal_lock;
+} __Pyx_ThreadPoolThread;
+
+struct __Pyx_ThreadPoolTask {
+    __Pyx_ThreadPool_Body body;
+    void *ctx;
+    Py_ssize_t nsteps, chunksize, next;
+    int schedule, num_threads, running;
+    PyThread_type_lock lock;  // protects 'next' (dynamic and guided schedules) and 'running'
+    PyThread_type_lock critical;  // the critical sections of the loop body
+    PyThread_type_lock done;  // held until the last worker is done
+    __Pyx_ThreadPoolThread *threads;
+};
+
+typedef struct __Pyx_ThreadPoolWorker {
+    struct __Pyx_ThreadPoolWorker *next_idle;
+    PyThread_type_lock wakeup;  // held while the worker is idle
+    __Pyx_ThreadPoolThread *thread;
+} __Pyx_ThreadPoolWorker;
+
+static struct {
+    PyThread_type_lock lock;  // protects the fields below
+    int budget;  // the number of threads of a loop, including the calling thread
+    int num_workers;  // the workers started so far, at most budget - 1
+    __Pyx_ThreadPoolWorker *idle;
+} __Pyx_ThreadPoolState;
+
+static int __Pyx_ThreadPool_MaxThreads0(int num_threads) {
+    int budget = __Pyx_ThreadPoolState.budget;
+    return (num_threads > 0 && num_threads < budget) ? num_threads : budget;
+}
+
+static int __Pyx_ThreadPool_ThreadNum0(void *thread) {
+    return ((__Pyx_ThreadPoolThread *) thread)->num;
+}
+
+static void __Pyx_ThreadPool_Lock0(void *thread) {
+    PyThread_type_lock lock = ((__Pyx_ThreadPoolThread *) thread)->task->critical;
+    if (lock) PyThread_acquire_lock(lock, WAIT_LOCK);
+}
+
+static void __Pyx_ThreadPool_Unlock0(void *thread) {
+    PyThread_type_lock lock = ((__Pyx_ThreadPoolThread *) thread)->task->critical;
+    if (lock) PyThread_release_lock(lock);
+}
+
+// Claims the next chunk of the own range of a thread, returns 0 if it is used up.
+// The owner advances 'begin' first and then checks 'end', a thief moves 'end' down
+// first and then checks 'begin', so that at least one of them sees the other.
+static int __Pyx_ThreadPool_ClaimChunk(__Pyx_ThreadPoolThread *thread, Py_ssize_t *begin, Py_ssize_t *end) {
+    Py_ssize_t chunksize = thread->task->chunksize, first, last;
+#if !__Pyx_ThreadPool_ATOMIC_RANGES
+    PyThread_acquire_lock(thread->steal_lock, WAIT_LOCK);
+#endif
+    first = __Pyx_ThreadPool_FetchAdd(&thread->begin, chunksize);
+    last = __Pyx_ThreadPool_Load(&thread->end);
+#if __Pyx_ThreadPool_ATOMIC_RANGES
+    if (unlikely(first + chunksize > last)) {
+        // A thief may be moving 'end', wait for it to finish.
+        PyThread_acquire_lock(thread->steal_lock, WAIT_LOCK);
+        last = __Pyx_ThreadPool_Load(&thread->end);
+        PyThread_release_lock(thread->steal_lock);
+    }
+#else
+    PyThread_release_lock(thread->steal_lock);
+#endif
+    if (first >= last) return 0;
+    *begin = first;
+    *end = (last - first > chunksize) ? first + chunksize : last;
+    return 1;
+}
+
+// Takes the back half of the range of another thread, returns 0 if there is nothing left.
+static int __Pyx_ThreadPool_Steal(__Pyx_ThreadPoolThread *thread) {
+    __Pyx_ThreadPoolTask *task = thread->task;
+    for (;;) {
+        __Pyx_ThreadPoolThread *victim = NULL;
+        Py_ssize_t size, largest = 0, first, last, split, owned;
+        int i;
+        // Choose the largest range, without locking.
+        for (i = 0; i < task->num_threads; i++) {
+            if (&task->threads[i] == thread) continue;
+            size = __Pyx_ThreadPool_Load(&task->threads[i].end) - __Pyx_ThreadPool_Load(&task->threads[i].begin);
+            if (size > largest) {
+                largest = size;
+                victim = &task->threads[i];
+            }
+        }
+        if (!victim) return 0;
+
+        PyThread_acquire_lock(victim->steal_lock, WAIT_LOCK);
+        last = __Pyx_ThreadPool_Load(&victim->end);
+        first = __Pyx_ThreadPool_Load(&victim->begin);
+        if (first >= last) {
+            // The owner used it up in the meantime, look again.
+            PyThread_release_lock(victim->steal_lock);
+            continue;
+        }
+        split = first + (last - first) / 2;
+        __Pyx_ThreadPool_Store(&victim->end, split);
+        // The owner may have claimed chunks beyond 'split' before it saw the new end.
+        owned = __Pyx_ThreadPool_Load(&victim->begin);
+        if (owned > split) {
+            split = owned < last ? owned : last;
+            __Pyx_ThreadPool_Store(&victim->end, split);
+        }
+        PyThread_release_lock(victim->steal_lock);
+        if (split >= last) continue;
+
+        // Other thieves may look at the own range now, which was empty.
+        PyThread_acquire_lock(thread->steal_lock, WAIT_LOCK);
+        __Pyx_ThreadPool_Store(&thread->end, last);
+        __Pyx_ThreadPool_Store(&thread->begin, split);
+        PyThread_release_lock(thread->steal_lock);
+        return 1;
+    }
+}
+
+static int __Pyx_ThreadPool_NextStolenChunk(__Pyx_ThreadPoolThread *thread, Py_ssize_t *begin, Py_ssize_t *end) {
+    do {
+        if (__Pyx_ThreadPool_ClaimChunk(thread, begin, end)) return 1;
+    } while (__Pyx_ThreadPool_Steal(thread));
+    return 0;
+}
+
+static int __Pyx_ThreadPool_NextChunk0(void *thread_, Py_ssize_t *begin, Py_ssize_t *end) {
+    __Pyx_ThreadPoolThread *thread = (__Pyx_ThreadPoolThread *) thread_;
+    __Pyx_ThreadPoolTask *task = thread->task;
+    Py_ssize_t size, nsteps = task->nsteps, chunksize = task->chunksize;
+    int found = 1;
+
+    if (task->schedule == __Pyx_ThreadPool_SCHEDULE_STATIC) {
+        // No locking, the chunks of each thread are known in advance.
+        if (thread->begin >= thread->end) return 0;
+        *begin = thread->begin;
+        if (!chunksize) {
+            *end = thread->end;
+            thread->begin = thread->end;
+        } else {
+            // round robin, chunk k goes to thread k % num_threads
+            *end = (nsteps - *begin > chunksize) ? *begin + chunksize : nsteps;
+            size = chunksize * task->num_threads;
+            thread->begin = (nsteps - *begin > size) ? *begin + size : nsteps;
+        }
+        return 1;
+    }
+
+    if (task->schedule == __Pyx_ThreadPool_SCHEDULE_STEAL) {
+        return __Pyx_ThreadPool_NextStolenChunk(thread, begin, end);
+    }
+
+    PyThread_acquire_lock(task->lock, WAIT_LOCK);
+    if (task->next < nsteps) {
+        size = nsteps - task->next;
+        if (task->schedule == __Pyx_ThreadPool_SCHEDULE_GUIDED) {
+            // a share of the remaining iterations, at least 'chunksize'
+            Py_ssize_t share = (size + task->num_threads - 1) / task->num_threads;
+            if (share > chunksize) chunksize = share;
+        }
+        *begin = task->next;
+        *end = task->next + (size > chunksize ? chunksize : size);
+        task->next = *end;
+    } else {
+        found = 0;
+    }
+    PyThread_release_lock(task->lock);
+    return found;
+}
+
+static void __Pyx_ThreadPool_WorkerMain(void *arg) {
+    __Pyx_ThreadPoolWorker *worker = (__Pyx_ThreadPoolWorker *) arg;
+    for (;;) {
+        __Pyx_ThreadPoolThread *thread;
+        __Pyx_ThreadPoolTask *task;
+        int last;
+        PyThread_acquire_lock(worker->wakeup, WAIT_LOCK);
+        thread = worker->thread;
+        task = thread->task;
+        task->body(task->ctx, thread);
+
+        // Make the worker available again before the task ends, so that the
+        // next loop of the calling thread can use it.
+        PyThread_acquire_lock(__Pyx_ThreadPoolState.lock, WAIT_LOCK);
+        worker->next_idle = __Pyx_ThreadPoolState.idle;
+        __Pyx_ThreadPoolState.idle = worker;
+        PyThread_release_lock(__Pyx_ThreadPoolState.lock);
+
+        // The task may be gone as soon as 'done' is released.
+        PyThread_acquire_lock(task->lock, WAIT_LOCK);
+        last = --task->running == 0;
+        PyThread_release_lock(task->lock);
+        if (last) PyThread_release_lock(task->done);
+    }
+}
+
+// Takes up to 'count' idle workers, and starts new ones within the budget.
+// Called with the pool lock held.
+static int __Pyx_ThreadPool_TakeWorkers(__Pyx_ThreadPoolWorker **workers, int count) {
+    int taken = 0;
+    while (taken < count && __Pyx_ThreadPoolState.idle) {
+        workers[taken++] = __Pyx_ThreadPoolState.idle;
+        __Pyx_ThreadPoolState.idle = __Pyx_ThreadPoolState.idle->next_idle;
+    }
+    while (taken < count && __Pyx_ThreadPoolState.num_workers < __Pyx_ThreadPoolState.budget - 1) {
+        __Pyx_ThreadPoolWorker *worker = (__Pyx_ThreadPoolWorker *) calloc(1, sizeof(__Pyx_ThreadPoolWorker));
+        if (unlikely(!worker)) break;
+        worker->wakeup = PyThread_allocate_lock();
+        if (unlikely(!worker->wakeup)) {
+            free(worker);
+            break;
+        }
+        PyThread_acquire_lock(worker->wakeup, WAIT_LOCK);
+        if (unlikely(PyThread_start_new_thread(__Pyx_ThreadPool_WorkerMain, worker) == PYTHREAD_INVALID_THREAD_ID)) {
+            PyThread_free_lock(worker->wakeup);
+            free(worker);
+            break;
+        }
+        __Pyx_ThreadPoolState.num_workers++;
+        workers[taken++] = worker;
+    }
+    return taken;
+}
+
+static void __Pyx_ThreadPool_FreeStealLocks(__Pyx_ThreadPoolThread *threads, int count) {
+    int i;
+    for (i = 0; i < count; i++) {
+        if (threads[i].steal_lock) PyThread_free_lock(threads[i].steal_lock);
+    }
+}
+
+static void __Pyx_ThreadPool_Run0(__Pyx_ThreadPool_Body body, void *ctx, Py_ssize_t nsteps,
+                                  int schedule, Py_ssize_t chunksize, int num_threads) {
+    __Pyx_ThreadPoolTask task;
+    __Pyx_ThreadPoolThread single;
+    __Pyx_ThreadPoolWorker **workers = NULL;
+    Py_ssize_t base, extra;
+    int i, num_workers = 0, num_steal_locks = 0;
+
+    task.body = body;
+    task.ctx = ctx;
+    task.nsteps = nsteps;
+    task.next = 0;
+    task.schedule = schedule;
+    task.threads = NULL;
+    task.lock = task.critical = task.done = NULL;
+
+    num_threads = __Pyx_ThreadPool_MaxThreads0(num_threads);
+    if (num_threads > nsteps) num_threads = (int) nsteps;
+    if (num_threads > 1) {
+        // Everything that can fail is allocated up front, so that a failure
+        // only means running in the calling thread.
+        task.threads = (__Pyx_ThreadPoolThread *) calloc((size_t) num_threads, sizeof(__Pyx_ThreadPoolThread));
+        workers = (__Pyx_ThreadPoolWorker **) calloc((size_t) num_threads, sizeof(__Pyx_ThreadPoolWorker *));
+        task.lock = PyThread_allocate_lock();
+        task.critical = PyThread_allocate_lock();
+        task.done = PyThread_allocate_lock();
+        if (schedule == __Pyx_ThreadPool_SCHEDULE_STEAL && task.threads) {
+            for (; num_steal_locks < num_threads; num_steal_locks++) {
+                task.threads[num_steal_locks].steal_lock = PyThread_allocate_lock();
+                if (unlikely(!task.threads[num_steal_locks].steal_lock)) break;
+            }
+        }
+        if (likely(task.threads && workers && task.lock && task.critical && task.done &&
+                   (schedule != __Pyx_ThreadPool_SCHEDULE_STEAL || num_steal_locks == num_threads))) {
+            PyThread_acquire_lock(__Pyx_ThreadPoolState.lock, WAIT_LOCK);
+            num_workers = __Pyx_ThreadPool_TakeWorkers(workers, num_threads - 1);
+            PyThread_release_lock(__Pyx_ThreadPoolState.lock);
+        }
+    }
+
+    if (!num_workers) {
+        // Run all iterations in the calling thread.
+        __Pyx_ThreadPool_FreeStealLocks(task.threads, num_steal_locks);
+        free(task.threads);
+        single.task = &task;
+        single.num = 0;
+        single.begin = 0;
+        single.end = nsteps;
+        single.steal_lock = NULL;
+        task.schedule = __Pyx_ThreadPool_SCHEDULE_STATIC;
+        task.chunksize = 0;
+        task.num_threads = 1;
+        task.threads = &single;
+        if (task.critical) PyThread_free_lock(task.critical);
+        task.critical = NULL;
+        body(ctx, &single);
+        goto done;
+    }
+
+    num_threads = task.num_threads = num_workers + 1;
+    if (schedule == __Pyx_ThreadPool_SCHEDULE_STEAL) {
+        // start with static blocks, and take chunks of ~1/16 of them as grain
+        chunksize = chunksize > 0 ? chunksize : nsteps / (16 * (Py_ssize_t) num_threads);
+    } else if (schedule != __Pyx_ThreadPool_SCHEDULE_STATIC && chunksize <= 0) {
+        chunksize = 1;
+    }
+    if (schedule == __Pyx_ThreadPool_SCHEDULE_STATIC && chunksize < 0) chunksize = 0;
+    if (schedule == __Pyx_ThreadPool_SCHEDULE_STEAL && chunksize < 1) chunksize = 1;
+    task.chunksize = chunksize;
+
+    base = nsteps / num_threads;
+    extra = nsteps % num_threads;
+    for (i = 0; i < num_threads; i++) {
+        __Pyx_ThreadPoolThread *thread = &task.threads[i];
+        thread->task = &task;
+        thread->num = i;
+        if (schedule == __Pyx_ThreadPool_SCHEDULE_STATIC && chunksize) {
+            thread->begin = i * chunksize < nsteps ? i * chunksize : nsteps;
+            thread->end = nsteps;
+        } else {
+            thread->begin = i * base + (i < extra ? i : extra);
+            thread->end = thread->begin + base + (i < extra);
+        }
+    }
+
+    task.running = num_workers;
+    PyThread_acquire_lock(task.done, WAIT_LOCK);
+    for (i = 0; i < num_workers; i++) {
+        workers[i]->thread = &task.threads[i + 1];
+        PyThread_release_lock(workers[i]->wakeup);
+    }
+    body(ctx, &task.threads[0]);
+    PyThread_acquire_lock(task.done, WAIT_LOCK);
+    PyThread_release_lock(task.done);
+    __Pyx_ThreadPool_FreeStealLocks(task.threads, num_steal_locks);
+    free(task.threads);
+
+done:
+    free(workers);
+    if (task.lock) PyThread_free_lock(task.lock);
+    if (task.critical) PyThread_free_lock(task.critical);
+    if (task.done) PyThread_free_lock(task.done);
+}
+
+#if !defined(_WIN32)
+// fork() only copies the calling thread, so the pool lock is held across it
+// to keep the pool consistent in the child, where the workers do not exist.
+static void __Pyx_ThreadPool_BeforeFork(void) {
+    PyThread_acquire_lock(__Pyx_ThreadPoolState.lock, WAIT_LOCK);
+}
+
+static void __Pyx_ThreadPool_AfterForkParent(void) {
+    PyThread_release_lock(__Pyx_ThreadPoolState.lock);
+}
+
+static void __Pyx_ThreadPool_AfterForkChild(void) {
+    // The idle workers can be freed, the busy ones belong to loops of other
+    // threads of the parent that will never finish in the child.
+    __Pyx_ThreadPoolWorker *worker = __Pyx_ThreadPoolState.idle;
+    while (worker) {
+        __Pyx_ThreadPoolWorker *next = worker->next_idle;
+        PyThread_free_lock(worker->wakeup);
+        free(worker);
+        worker = next;
+    }
+    __Pyx_ThreadPoolState.idle = NULL;
+    __Pyx_ThreadPoolState.num_workers = 0;
+    PyThread_release_lock(__Pyx_ThreadPoolState.lock);
+}
+#endif
+
+static __Pyx_ThreadPoolAPIStruct __Pyx_ThreadPoolAPI0 = {
+    __PYX_THREADPOOL_ABI_VERSION,
+    __Pyx_ThreadPool_MaxThreads0,
+    __Pyx_ThreadPool_Run0,
+    __Pyx_ThreadPool_NextChunk0,
+    __Pyx_ThreadPool_ThreadNum0,
+    __Pyx_ThreadPool_Lock0,
+    __Pyx_ThreadPool_Unlock0
+};
+
+// The thread budget is the environment variable CYTHON_NUM_THREADS (if it is a
+// positive number), or CYTHON_THREADPOOL_NUM_THREADS, or the number of CPUs
+// that the process may use.
+static int __Pyx_ThreadPool_Budget(void) {
+    long budget = CYTHON_THREADPOOL_NUM_THREADS;
+    const char *env = getenv("CYTHON_NUM_THREADS");
+    int env_valid = 0;
+    if (env && *env) {
+        // Ignore values that are not fully numeric or out of range, as for CYTHON_FREELIST_POOL_SIZE.
+        char *end;
+        long value;
+        errno = 0;
+        value = strtol(env, &end, 10);
+        if (*end == '\0' && errno == 0 && value > 0) {
+            budget = value;
+            env_valid = 1;
+        }
+    }
+    if (!env_valid && budget <= 0) {
+        PyObject *os = PyImport_ImportModule("os");
+        if (os) {
+            PyObject *cpu_count = PyObject_GetAttrString(os, "process_cpu_count");
+            if (!cpu_count) {
+                PyErr_Clear();
+                cpu_count = PyObject_GetAttrString(os, "cpu_count");
+            }
+            Py_DECREF(os);
+            if (cpu_count) {
+                PyObject *result = PyObject_CallObject(cpu_count, NULL);
+                Py_DECREF(cpu_count);
+                if (result) {
+                    if (result != Py_None) budget = PyLong_AsLong(result);
+                    Py_DECREF(result);
+                }
+            }
+        }
+        PyErr_Clear();
+    }
+    if (budget < 1) budget = 1;
+    if (budget > 1024) budget = 1024;
+    return (int) budget;
+}
+
+static int __Pyx_ThreadPool_Import(void) {
+    const char *capsule_name = CYTHON_THREADPOOL_MODULE ".ThreadPoolAPI";
+    PyObject *module, *capsule;
+    int publish = 1;
+    module = __Pyx_PyImport_AddModuleRef(CYTHON_THREADPOOL_MODULE);
+    if (unlikely(!module)) return -1;
+    capsule = PyObject_GetAttrString(module, "ThreadPoolAPI");
+    if (capsule) {
+        __Pyx_ThreadPoolAPI = (__Pyx_ThreadPoolAPIStruct *) PyCapsule_GetPointer(capsule, capsule_name);
+        Py_DECREF(capsule);
+        if (unlikely(!__Pyx_ThreadPoolAPI)) goto bad;
+        if (__Pyx_ThreadPoolAPI->abi_version == __PYX_THREADPOOL_ABI_VERSION) goto done;
+        // An incompatible pool, use a separate one.
+        __Pyx_ThreadPoolAPI = NULL;
+        publish = 0;
+    } else if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
+        PyErr_Clear();
+    } else {
+        goto bad;
+    }
+
+    // The state of this module's pool is set up only once, even if the module
+    // CYTHON_THREADPOOL_MODULE was replaced since it was published, because
+    // its workers may still be running.
+    if (!__Pyx_ThreadPoolState.lock) {
+        __Pyx_ThreadPoolState.lock = PyThread_allocate_lock();
+        if (unlikely(!__Pyx_ThreadPoolState.lock)) {
+            PyErr_NoMemory();
+            goto bad;
+        }
+#if !defined(_WIN32)
+        if (unlikely(pthread_atfork(__Pyx_ThreadPool_BeforeFork,
+                                    __Pyx_ThreadPool_AfterForkParent,
+                                    __Pyx_ThreadPool_AfterForkChild) != 0)) {
+            PyThread_free_lock(__Pyx_ThreadPoolState.lock);
+            __Pyx_ThreadPoolState.lock = NULL;
+            PyErr_NoMemory();
+            goto bad;
+        }
+#endif
+        __Pyx_ThreadPoolState.budget = __Pyx_ThreadPool_Budget();
+    }
+    __Pyx_ThreadPoolAPI = &__Pyx_ThreadPoolAPI0;
+    if (publish) {
+        capsule = PyCapsule_New(&__Pyx_ThreadPoolAPI0, capsule_name, NULL);
+        if (unlikely(!capsule)) goto bad;
+        if (unlikely(PyObject_SetAttrString(module, "ThreadPoolAPI", capsule) < 0)) {
+            Py_DECREF(capsule);
+            goto bad;
+        }
+        Py_DECREF(capsule);
+    }
+
+done:
+    Py_DECREF(module);
+    return 0;
+bad:
+    Py_DECREF(module);
+    return -1;
+}
@@ -33,7 +33,77 @@
   #define CYTHON_PROFILE_REUSE_FRAME 0
 #endif
 
-#if CYTHON_PROFILE || CYTHON_TRACE
+// Python 3.13+ can report the events through the C-API of sys.monitoring (PEP 669)
+// instead of the legacy trace and profile functions.  Legacy tools that use
+// sys.settrace() or sys.setprofile() then do not see the Cython functions as frames.
+#ifndef CYTHON_USE_SYS_MONITORING
+  #define CYTHON_USE_SYS_MONITORING 0
+#endif
+
+#if CYTHON_USE_SYS_MONITORING && (PY_VERSION_HEX < 0x030d0000 || !(CYTHON_PROFILE || CYTHON_TRACE) || \
+        CYTHON_COMPILING_IN_LIMITED_API || CYTHON_COMPILING_IN_PYPY || CYTHON_COMPILING_IN_GRAAL)
+  #undef CYTHON_USE_SYS_MONITORING
+  #define CYTHON_USE_SYS_MONITORING 0
+#endif
+
+#if CYTHON_USE_SYS_MONITORING
+  // Each traced function has static arrays of monitoring states and their event
+  // types (see Code.py): its start, return and unwind events, followed by one LINE
+  // state per traced source line.  When a tool returns sys.monitoring.DISABLE for a
+  // line, CPython clears the 'active' flag of that line's state, so that the line
+  // only costs a flag check until the tool restarts the events.
+  #define __Pyx_MonitoringStartState  0
+  #define __Pyx_MonitoringReturnState 1
+  #define __Pyx_MonitoringUnwindState 2
+  #define __Pyx_MonitoringLineStates  3
+
+  #define __Pyx_TraceDeclarations                                         \
+      static PyCodeObject *$frame_code_cname = NULL;                      \
+      int __Pyx_use_tracing = 0;
+
+  #define __Pyx_TraceFrameInit(codeobj)                                   \
+      if (codeobj) $frame_code_cname = (PyCodeObject*) codeobj;
+
+  #define __Pyx_MonitoringStartCall(funcname, srcfile, firstlineno)                            \
+      __Pyx_MonitoringStart($monitoring_states_cname, &$monitoring_version_cname,               \
+                            $monitoring_events_cname, sizeof($monitoring_events_cname),         \
+                            &$frame_code_cname, funcname, srcfile, firstlineno)
+
+  #define __Pyx_TraceCall(funcname, srcfile, firstlineno, nogil, goto_error)             \
+  if (nogil) {                                                                           \
+      if (CYTHON_TRACE_NOGIL) {                                                          \
+          PyGILState_STATE state = PyGILState_Ensure();                                  \
+          __Pyx_use_tracing = __Pyx_MonitoringStartCall(funcname, srcfile, firstlineno); \
+          PyGILState_Release(state);                                                     \
+          if (unlikely(__Pyx_use_tracing < 0)) goto_error;                               \
+      }                                                                                  \
+  } else {                                                                               \
+      __Pyx_use_tracing = __Pyx_MonitoringStartCall(funcname, srcfile, firstlineno);     \
+      if (unlikely(__Pyx_use_tracing < 0)) goto_error;                                   \
+  }
+
+  #define __Pyx_TraceException()
+
+  #define __Pyx_TraceReturn(result, nogil)                                                \
+  if (likely(!__Pyx_use_tracing)); else {                                                 \
+      if (nogil) {                                                                        \
+          if (CYTHON_TRACE_NOGIL) {                                                       \
+              PyGILState_STATE state = PyGILState_Ensure();                               \
+              __Pyx_MonitoringReturn($monitoring_states_cname, $frame_code_cname, (PyObject*)result); \
+              PyGILState_Release(state);                                                  \
+          }                                                                               \
+      } else {                                                                            \
+          __Pyx_MonitoringReturn($monitoring_states_cname, $frame_code_cname, (PyObject*)result); \
+      }                                                                                   \
+  }
+
+  static int __Pyx_MonitoringStart(PyMonitoringState *states, uint64_t *version, const uint8_t *event_types,
+                                   Py_ssize_t count, PyCodeObject **code,
+                                   const char *funcname, const char *srcfile, int firstlineno); /*proto*/
+  static void __Pyx_MonitoringReturn(PyMonitoringState *states, PyCodeObject *code, PyObject *result); /*proto*/
+  static PyCodeObject *__Pyx_createFrameCodeObject(const char *funcname, const char *srcfile, int firstlineno); /*proto*/
+
+#elif CYTHON_PROFILE || CYTHON_TRACE
 
   #include "compile.h"
   #include "frameobject.h"
@@ -196,7 +266,39 @@
 
 #endif /* CYTHON_PROFILE */
 
-#if CYTHON_TRACE
+#if CYTHON_USE_SYS_MONITORING && CYTHON_TRACE
+  #define __Pyx_TraceLine(lineno, index, nogil, goto_error)                                \
+  if (likely(!__Pyx_use_tracing) ||                                                        \
+      likely(!$monitoring_states_cname[__Pyx_MonitoringLineStates + (index)].active)); else { \
+      if (nogil) {                                                                         \
+          if (CYTHON_TRACE_NOGIL) {                                                        \
+              int ret;                                                                     \
+              PyGILState_STATE state = __Pyx_PyGILState_Ensure();                          \
+              ret = __Pyx_MonitoringLine(                                                  \
+                  &$monitoring_states_cname[__Pyx_MonitoringLineStates + (index)], $frame_code_cname, index, lineno); \
+              __Pyx_PyGILState_Release(state);                                             \
+              if (unlikely(ret)) goto_error;                                               \
+          }                                                                                \
+      } else {                                                                             \
+          if (unlikely(__Pyx_MonitoringLine(                                               \
+                  &$monitoring_states_cname[__Pyx_MonitoringLineStates + (index)], $frame_code_cname, index, lineno))) \
+              goto_error;                                                                  \
+      }                                                                                    \
+  }
+
+  static int __Pyx_MonitoringLine(PyMonitoringState *state, PyCodeObject *code, int offset, int lineno) {
+      int ret;
+      // keep an exception that is being raised
+      PyObject *exc = PyErr_GetRaisedException();
+      ret = PyMonitoring_FireLineEvent(state, (PyObject*) code, offset, lineno);
+      if (exc) {
+          if (likely(!ret)) PyErr_SetRaisedException(exc);
+          else Py_DECREF(exc);
+      }
+      return ret;
+  }
+
+#elif CYTHON_TRACE
   // see call_trace_protected() in CPython's ceval.c
   static int __Pyx_call_line_trace_func(PyThreadState *tstate, PyFrameObject *frame, int lineno) {
       int ret;
@@ -218,7 +320,7 @@
       return ret;
   }
 
-  #define __Pyx_TraceLine(lineno, nogil, goto_error)                                       \
+  #define __Pyx_TraceLine(lineno, index, nogil, goto_error)                                \
   if (likely(!__Pyx_use_tracing)); else {                                                  \
       if (nogil) {                                                                         \
           if (CYTHON_TRACE_NOGIL) {                                                        \
@@ -242,13 +344,45 @@
   }
 #else
   // mark error label as used to avoid compiler warnings
-  #define __Pyx_TraceLine(lineno, nogil, goto_error)   if ((1)); else goto_error;
+  #define __Pyx_TraceLine(lineno, index, nogil, goto_error)   if ((1)); else goto_error;
 #endif
 
 /////////////// Profile ///////////////
 //@substitute: naming
 
-#if CYTHON_PROFILE
+#if CYTHON_USE_SYS_MONITORING
+
+static int __Pyx_MonitoringStart(PyMonitoringState *states, uint64_t *version, const uint8_t *event_types,
+                                 Py_ssize_t count, PyCodeObject **code,
+                                 const char *funcname, const char *srcfile, int firstlineno) {
+    if (unlikely(PyMonitoring_EnterScope(states, version, event_types, count) < 0)) return -1;
+    if (unlikely(!*code)) {
+        *code = __Pyx_createFrameCodeObject(funcname, srcfile, firstlineno);
+        if (unlikely(!*code)) return -1;
+    }
+    if (states[__Pyx_MonitoringStartState].active) {
+        if (unlikely(PyMonitoring_FirePyStartEvent(
+                &states[__Pyx_MonitoringStartState], (PyObject*) *code, 0) < 0)) return -1;
+    }
+    return 1;
+}
+
+static void __Pyx_MonitoringReturn(PyMonitoringState *states, PyCodeObject *code, PyObject *result) {
+    // Generators end with a StopIteration, which is a normal return for the tools.
+    if (PyErr_Occurred() && !PyErr_ExceptionMatches(PyExc_StopIteration) &&
+            !PyErr_ExceptionMatches(PyExc_StopAsyncIteration)) {
+        // A failing tool replaces the exception, as in Python code.
+        if (states[__Pyx_MonitoringUnwindState].active)
+            (void) PyMonitoring_FirePyUnwindEvent(&states[__Pyx_MonitoringUnwindState], (PyObject*) code, 0);
+    } else if (states[__Pyx_MonitoringReturnState].active) {
+        // Like the legacy return trace, ignore errors of the tool.
+        if (unlikely(PyMonitoring_FirePyReturnEvent(
+                &states[__Pyx_MonitoringReturnState], (PyObject*) code, 0, result ? result : Py_None) < 0))
+            PyErr_Clear();
+    }
+}
+
+#elif CYTHON_PROFILE
 
 static int __Pyx_TraceSetupAndCall(PyCodeObject** code,
                                    PyFrameObject** frame,
@@ -301,6 +435,10 @@ static int __Pyx_TraceSetupAndCall(PyCodeObject** code,
     }
 }
 
+#endif
+
+#if CYTHON_PROFILE
+
 static PyCodeObject *__Pyx_createFrameCodeObject(const char *funcname, const char *srcfile, int firstlineno) {
     PyCodeObject *py_code = PyCode_NewEmpty(srcfile, funcname, firstlineno);
     // make CPython use a fresh dict for "f_locals" at need (see GH #1836)
@@ -311,3 +449,122 @@ static PyCodeObject *__Pyx_createFrameCodeObject(const char *funcname, const cha
 }
 
 #endif /* CYTHON_PROFILE */
+
+
+/////////////// SamplingProfile.proto ///////////////
+//@requires: ModuleSetupCode.c::ThreadLocal
+
+// The 'sampling_profile' directive makes each function push a pointer to a
+// static descriptor onto a per-thread shadow stack on entry and pop it on exit.
+// The stacks are owned by the runtime module "Cython.Runtime.sampling" (or the
+// module named by CYTHON_SAMPLING_MODULE), which samples them from a profiling
+// timer signal.  If that module is not available, the markers only cost a NULL
+// check.
+//
+// The layout of the structs below must match the one in Cython/Runtime/sampling.pyx.
+
+#ifndef CYTHON_SAMPLING_PROFILE
+  #define CYTHON_SAMPLING_PROFILE 1
+#endif
+#ifndef CYTHON_SAMPLING_MODULE
+  #define CYTHON_SAMPLING_MODULE "Cython.Runtime.sampling"
+#endif
+
+#define __PYX_SAMPLING_ABI_VERSION 1
+#define __PYX_SAMPLING_MAX_DEPTH 128
+
+typedef struct {
+    const char *name;
+    const char *filename;
+    int lineno;
+} __Pyx_SamplingSite;
+
+typedef struct {
+    volatile int depth;
+    const __Pyx_SamplingSite *volatile frames[__PYX_SAMPLING_MAX_DEPTH];
+} __Pyx_SamplingStack;
+
+typedef struct {
+    int abi_version;
+    __Pyx_SamplingStack *(*get_stack)(void);
+} __Pyx_SamplingAPIStruct;
+
+#if CYTHON_SAMPLING_PROFILE
+  static __Pyx_SamplingAPIStruct *__Pyx_SamplingAPI = NULL;
+  static void __Pyx_SamplingImportAPI(void); /*proto*/
+
+  #if defined(__GNUC__)
+    #define __Pyx_SamplingSignalFence() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+  #elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define __Pyx_SamplingSignalFence() _ReadWriteBarrier()
+  #else
+    // 'volatile' keeps the order of the stores
+    #define __Pyx_SamplingSignalFence()
+  #endif
+
+  #define __Pyx_SamplingDeclarations(name, filename, lineno) \
+      static const __Pyx_SamplingSite __pyx_sampling_site = {name, filename, lineno}; \
+      __Pyx_SamplingStack *__pyx_sampling_stack = NULL;
+  #define __Pyx_SamplingEnter()  __pyx_sampling_stack = __Pyx_SamplingPush(&__pyx_sampling_site)
+  #define __Pyx_SamplingExit()  __Pyx_SamplingPop(__pyx_sampling_stack)
+
+  static CYTHON_INLINE __Pyx_SamplingStack *__Pyx_SamplingGetStack(void) {
+  #ifdef CYTHON_THREAD_LOCAL
+      static CYTHON_THREAD_LOCAL __Pyx_SamplingStack *stack = NULL;
+      if (likely(stack)) return stack;
+      if (likely(__Pyx_SamplingAPI)) stack = __Pyx_SamplingAPI->get_stack();
+      return stack;
+  #else
+      return likely(__Pyx_SamplingAPI) ? __Pyx_SamplingAPI->get_stack() : NULL;
+  #endif
+  }
+
+  static CYTHON_INLINE __Pyx_SamplingStack *__Pyx_SamplingPush(const __Pyx_SamplingSite *site) {
+      __Pyx_SamplingStack *stack = __Pyx_SamplingGetStack();
+      if (likely(stack)) {
+          int depth = stack->depth;
+          if (likely(depth < __PYX_SAMPLING_MAX_DEPTH)) stack->frames[depth] = site;
+          // The sampler interrupts this thread, so a compiler barrier is enough to
+          // make the frame visible before the new depth.
+          __Pyx_SamplingSignalFence();
+          stack->depth = depth + 1;
+      }
+      return stack;
+  }
+
+  static CYTHON_INLINE void __Pyx_SamplingPop(__Pyx_SamplingStack *stack) {
+      if (likely(stack)) stack->depth--;
+  }
+
+#else
+  #define __Pyx_SamplingImportAPI()
+  #define __Pyx_SamplingDeclarations(name, filename, lineno)
+  #define __Pyx_SamplingEnter()
+  #define __Pyx_SamplingExit()
+#endif
+
+/////////////// SamplingProfile.init ///////////////
+
+__Pyx_SamplingImportAPI();
+
+/////////////// SamplingProfile ///////////////
+
+#if CYTHON_SAMPLING_PROFILE
+static void __Pyx_SamplingImportAPI(void) {
+    // A missing or incompatible runtime module only disables the sampling.
+    PyObject *module, *api = NULL;
+    module = PyImport_ImportModule(CYTHON_SAMPLING_MODULE);
+    if (module) {
+        api = PyObject_GetAttrString(module, "SamplingAPI");
+        Py_DECREF(module);
+    }
+    if (api) {
+        __Pyx_SamplingAPIStruct *sampling_api = (__Pyx_SamplingAPIStruct *) PyLong_AsVoidPtr(api);
+        Py_DECREF(api);
+        if (sampling_api && sampling_api->abi_version == __PYX_SAMPLING_ABI_VERSION)
+            __Pyx_SamplingAPI = sampling_api;
+    }
+    PyErr_Clear();
+}
+#endif
@@ -50,23 +50,27 @@ static CYTHON_INLINE size_t __Pyx_Py_UNICODE_strlen(const Py_UNICODE *u)
 //////////////////// InitStrings.proto ////////////////////
 //@proto_block: pystring_table
 
-static int __Pyx_InitStrings(__Pyx_StringTabEntry const *t, PyObject **target, const char* const* encoding_names); /*proto*/
+static int __Pyx_InitStrings(__Pyx_StringTabEntry const *t, Py_ssize_t count, const char *data, PyObject **target, const char* const* encoding_names); /*proto*/
 
 //////////////////// InitStrings ////////////////////
 
-static int __Pyx_InitStrings(__Pyx_StringTabEntry const *t, PyObject **target, const char* const* encoding_names) {
-    while (t->s) {
+// The bytes of the strings follow each other in 'data', without terminating NUL characters.
+static int __Pyx_InitStrings(__Pyx_StringTabEntry const *t, Py_ssize_t count, const char *data, PyObject **target, const char* const* encoding_names) {
+    __Pyx_StringTabEntry const *end = t + count;
+    for (; t != end; ++t, ++target) {
         PyObject *str;
+        Py_ssize_t n = (Py_ssize_t) t->n;
         if (t->is_unicode | t->is_str) {
             if (t->intern) {
-                str = PyUnicode_InternFromString(t->s);
+                str = PyUnicode_DecodeUTF8(data, n, NULL);
+                if (likely(str)) PyUnicode_InternInPlace(&str);
             } else if (t->encoding) {
-                str = PyUnicode_Decode(t->s, t->n - 1, encoding_names[t->encoding], NULL);
+                str = PyUnicode_Decode(data, n, encoding_names[t->encoding], NULL);
             } else {
-                str = PyUnicode_FromStringAndSize(t->s, t->n - 1);
+                str = PyUnicode_FromStringAndSize(data, n);
             }
         } else {
-            str = PyBytes_FromStringAndSize(t->s, t->n - 1);
+            str = PyBytes_FromStringAndSize(data, n);
         }
         if (!str)
             return -1;
@@ -74,12 +78,48 @@ static int __Pyx_InitStrings(__Pyx_StringTabEntry const *t, PyObject **target, c
         // initialise cached hash value
         if (PyObject_Hash(str) == -1)
             return -1;
-        ++t;
-        ++target;
+        data += n;
     }
     return 0;
 }
 
+//////////////////// InitCompressedStrings.proto ////////////////////
+//@proto_block: pystring_table
+
+#if CYTHON_COMPRESS_STRINGS
+static int __Pyx_InitCompressedStrings(__Pyx_StringTabEntry const *t, Py_ssize_t count,
+                                       const char *zlib_data, Py_ssize_t zlib_size,
+                                       PyObject **target, const char* const* encoding_names); /*proto*/
+#endif
+
+//////////////////// InitCompressedStrings ////////////////////
+//@requires: InitStrings
+
+#if CYTHON_COMPRESS_STRINGS
+static int __Pyx_InitCompressedStrings(__Pyx_StringTabEntry const *t, Py_ssize_t count,
+                                       const char *zlib_data, Py_ssize_t zlib_size,
+                                       PyObject **target, const char* const* encoding_names) {
+    int result = -1;
+    PyObject *compressed, *data = NULL;
+    PyObject *zlib_module = PyImport_ImportModule("zlib");
+    if (unlikely(!zlib_module)) return -1;
+    compressed = PyMemoryView_FromMemory((char*) zlib_data, zlib_size, PyBUF_READ);
+    if (likely(compressed)) {
+        data = PyObject_CallMethod(zlib_module, "decompress", "O", compressed);
+        Py_DECREF(compressed);
+    }
+    Py_DECREF(zlib_module);
+    if (likely(data)) {
+        const char *s = PyBytes_AsString(data);
+        if (likely(s)) {
+            result = __Pyx_InitStrings(t, count, s, target, encoding_names);
+        }
+        Py_DECREF(data);
+    }
+    return result;
+}
+#endif
+
 //////////////////// BytesContains.proto ////////////////////
 
 static CYTHON_INLINE int __Pyx_BytesContains(PyObject* bytes, char character); /*proto*/
@@ -225,7 +225,8 @@ python runtests.py \
   --backends=$BACKEND \
   $LIMITED_API \
   $EXCLUDE \
-  $RUNTESTS_ARGS
+  $RUNTESTS_ARGS \
+  $TEST_SELECTOR
 
 EXIT_CODE=$?
 
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+
+"""
+Microbenchmark for the Cython scanner.
+
+Tokenises all .py/.pyx/.pxd/.pxi files below the given directories
+(default: the Cython package) and reports the best time of several runs.
+
+    python Tools/scanner_benchmark.py [--repeat N] [DIR ...]
+"""
+
+import argparse
+import os
+import sys
+import time
+from io import StringIO
+
+cython_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+if os.path.exists(os.path.join(cython_dir, "Cython")):
+    sys.path.insert(0, cython_dir)
+
+from Cython.Compiler import Errors
+from Cython.Compiler.Scanning import PyrexScanner, StringSourceDescriptor, get_lexicon
+from Cython.Compiler.Symtab import ModuleScope
+from Cython.Compiler.TreeFragment import StringParseContext
+
+
+def find_sources(directories):
+    sources = []
+    for directory in directories:
+        for root, _, files in os.walk(directory):
+            for filename in sorted(files):
+                if filename.endswith((".py", ".pyx", ".pxd", ".pxi")):
+                    sources.append(os.path.join(root, filename))
+    return sorted(sources)
+
+
+def read_sources(paths):
+    sources = []
+    for path in paths:
+        try:
+            with open(path, encoding="utf8") as f:
+                sources.append((path, f.read()))
+        except (OSError, UnicodeDecodeError):
+            pass
+    return sources
+
+
+def scan(path, code, context, scope):
+    scanner = PyrexScanner(
+        StringIO(code), StringSourceDescriptor(path, code), scope=scope, context=context)
+    tokens = 1
+    try:
+        while scanner.sy != "EOF":
+            scanner.next()
+            tokens += 1
+    except Errors.CompileError:
+        pass  # e.g. Python 2 syntax in test files
+    return tokens
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--repeat", type=int, default=5)
+    parser.add_argument("directories", nargs="*", default=[os.path.join(cython_dir, "Cython")])
+    options = parser.parse_args(args)
+
+    Errors.init_thread()
+    Errors.LEVEL = 10  # suppress warnings
+    get_lexicon()
+    sources = read_sources(find_sources(options.directories))
+    context = StringParseContext("scanner benchmark")
+    scope = ModuleScope("scanner_benchmark", None, None)
+    old_stderr = sys.stderr
+    timings = []
+    try:
+        sys.stderr = StringIO()  # scanner errors are reported but not relevant here
+        for _ in range(options.repeat):
+            t = time.perf_counter()
+            tokens = sum(scan(path, code, context, scope) for path, code in sources)
+            timings.append(time.perf_counter() - t)
+    finally:
+        sys.stderr = old_stderr
+
+    lines = sum(code.count("\n") for _, code in sources)
+    best = min(timings)
+    print("%d files, %d lines, %d tokens: best %.3f s (%.0f lines/s)" % (
+        len(sources), lines, tokens, best, lines / best))
+
+
+if __name__ == "__main__":
+    main()
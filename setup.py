@@ -38,6 +38,27 @@ class sdist(sdist_orig):
         sdist_orig.run(self)
 add_command_class('sdist', sdist)
 
+try:
+    from setuptools.command.build_py import build_py as build_py_orig
+except ImportError:
+    from distutils.command.build_py import build_py as build_py_orig
+class build_py(build_py_orig):
+    # Store the scanner tables in the build directory, so that the installed
+    # compiler does not need to build them at runtime.
+    def run(self):
+        build_py_orig.run(self)
+        if not self.dry_run:
+            from Cython.Compiler.Lexicon import write_lexicon_tables
+            write_lexicon_tables(self._lexicon_tables_path())
+
+    def get_outputs(self, *args, **kwargs):
+        return build_py_orig.get_outputs(self, *args, **kwargs) + [self._lexicon_tables_path()]
+
+    def _lexicon_tables_path(self):
+        from Cython.Compiler.Lexicon import lexicon_tables_file
+        return os.path.join(self.build_lib, 'Cython', 'Compiler', lexicon_tables_file)
+add_command_class('build_py', build_py)
+
 pxd_include_dirs = [
     directory for directory, dirs, files
     in os.walk(os.path.join('Cython', 'Includes'))
@@ -68,13 +89,14 @@ if 'setuptools' in sys.modules:
         'console_scripts': [
             'cython = Cython.Compiler.Main:setuptools_main',
             'cythonize = Cython.Build.Cythonize:main',
+            'cython-client = Cython.Compiler.Server:client_main',
             'cygdb = Cython.Debugger.Cygdb:main',
         ]
     }
     scripts = []
 else:
     if os.name == "posix":
-        scripts = ["bin/cython", "bin/cythonize", "bin/cygdb"]
+        scripts = ["bin/cython", "bin/cythonize", "bin/cygdb", "bin/cython-client"]
     else:
         scripts = ["cython.py", "cythonize.py", "cygdb.py"]
 
@@ -88,6 +110,7 @@ def compile_cython_modules(profile=False, coverage=False, compile_minimal=False,
         "Cython.Compiler.Scanning",
         "Cython.Compiler.Visitor",
         "Cython.Runtime.refnanny",
+        "Cython.Runtime.sampling",
     ]
     if not compile_minimal:
         compiled_modules.extend([
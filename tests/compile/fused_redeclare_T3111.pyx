@@ -27,10 +27,10 @@ _WARNINGS = """
 36:10: 'cpdef_cname_method' redeclared
 
 # from MemoryView.pyx
-958:29: Ambiguous exception value, same as default return value: 0
-958:29: Ambiguous exception value, same as default return value: 0
-999:46: Ambiguous exception value, same as default return value: 0
-999:46: Ambiguous exception value, same as default return value: 0
-1089:29: Ambiguous exception value, same as default return value: 0
-1089:29: Ambiguous exception value, same as default return value: 0
+965:29: Ambiguous exception value, same as default return value: 0
+965:29: Ambiguous exception value, same as default return value: 0
+1006:46: Ambiguous exception value, same as default return value: 0
+1006:46: Ambiguous exception value, same as default return value: 0
+1096:29: Ambiguous exception value, same as default return value: 0
+1096:29: Ambiguous exception value, same as default return value: 0
 """
@@ -0,0 +1,29 @@
+# mode: error
+# tag: cpp, openmp
+
+from cython.parallel cimport prange
+from libcpp.vector cimport vector
+
+cdef vector[int] make_range(int n):
+    return vector[int](n)
+
+def sequence(obj):
+    cdef int x, total = 0
+
+    for x in prange(make_range(10), nogil=True):
+        total += x
+
+    for x in prange(<vector[int]>obj, nogil=True):
+        total += x
+
+    for x in prange(make_range(len(obj)), nogil=True):
+        total += x
+
+    return total
+
+_ERRORS = u"""
+13:30: Calling gil-requiring function not allowed without gil
+16:33: Coercion from Python not allowed without the GIL
+19:30: Calling gil-requiring function not allowed without gil
+19:34: Calling gil-requiring function not allowed without gil
+"""
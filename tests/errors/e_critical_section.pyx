@@ -0,0 +1,22 @@
+# mode: error
+# tag: freethreading
+
+cimport cython
+
+def gen(l):
+    with cython.critical_section(l):
+        yield 1
+
+def no_args():
+    with cython.critical_section():
+        pass
+
+def too_many(a, b, c):
+    with cython.critical_section(a, b, c):
+        pass
+
+_ERRORS = """
+8:8: Cannot yield or await inside of a critical section
+11:9: critical_section() takes one or two objects to lock.
+15:9: critical_section() takes one or two objects to lock.
+"""
@@ -170,6 +170,52 @@ def bar():
     with nogil, parallel.parallel(use_threads_if=python_var):
         pass
 
+def reductions(double[:] hist, const double[:] chist, x):
+    cdef int i, j
+    cdef double smallest = 0
+    cdef double *ptr = NULL
+    cdef double[:] other = hist
+
+    for i in prange(10, nogil=True, reduction=ptr):
+        pass
+
+    for i in prange(10, nogil=True, reduction=chist):
+        pass
+
+    for i in prange(10, nogil=True, reduction=(hist, ptr[0])):
+        pass
+
+    for i in prange(10, nogil=True, reduction=hist):
+        hist = other
+
+    for i in prange(10, nogil=True):
+        for j in prange(10, reduction=hist):
+            pass
+
+    with nogil, cython.parallel.parallel():
+        for i in prange(10):
+            smallest = min(smallest, i)
+
+    for i in prange(10, nogil=True):
+        smallest = min(smallest, i)
+        hist[0] = smallest
+
+def collapsed(double[:, :] m):
+    cdef Py_ssize_t i, j
+    cdef int *ptr = NULL
+
+    for i, j in prange(m.shape[0], nogil=True):
+        pass
+
+    for i, j in prange(m.shape[0], m, nogil=True):
+        pass
+
+    for i, ptr[0] in prange(10, 10, nogil=True):
+        pass
+
+    for i, ptr in prange(10, 10, nogil=True):
+        pass
+
 _ERRORS = u"""
 3:8: cython.parallel.parallel is not a module
 4:0: No such directive: cython.parallel.something
@@ -208,4 +254,16 @@ _ERRORS = u"""
 158:57: Calling gil-requiring function not allowed without gil
 167:51: use_threads_if may not be a Python object as we don't have the GIL
 170:49: use_threads_if may not be a Python object as we don't have the GIL
+179:46: reduction argument to prange must be a memoryview or C++ object, reductions of C variables are inferred from in-place operators
+182:46: Memoryview reductions require a writable C integer or floating point item type, not 'const double'
+185:47: reduction argument to prange must be a variable or a tuple of variables
+188:46: Cannot assign to reduction variable 'hist'
+189:8: Memoryview slices can only be shared in parallel sections
+192:23: The reduction argument of prange is not supported inside of other parallel sections
+196:23: min() and max() reductions are not supported in prange loops inside of parallel blocks
+201:18: Cannot read reduction variable in loop body
+207:22: prange() over 2 variables needs one extent argument per variable
+210:35: extent argument must be numeric
+213:8: Can only iterate over an iteration variable
+216:11: Must be of numeric type, not int *
 """
@@ -0,0 +1,229 @@
+# mode: run
+# tag: memoryview, openmp
+# distutils: define_macros=CYTHON_MEMVIEW_PARALLEL_COPY_SIZE=1
+
+from cython cimport view
+cimport openmp
+
+# Let even small copies run in several threads.
+openmp.omp_set_num_threads(4)
+
+
+cdef int[:, :] matrix(Py_ssize_t rows, Py_ssize_t cols, mode="c"):
+    cdef int[:, :] m = view.array(shape=(rows, cols), itemsize=sizeof(int), format="i", mode=mode)
+    cdef Py_ssize_t i, j
+    for i in range(rows):
+        for j in range(cols):
+            m[i, j] = i * 1000 + j
+    return m
+
+
+cdef double[:, :, :] cube(Py_ssize_t n0, Py_ssize_t n1, Py_ssize_t n2, mode="c"):
+    cdef double[:, :, :] m = view.array(shape=(n0, n1, n2), itemsize=sizeof(double), format="d", mode=mode)
+    cdef Py_ssize_t i, j, k
+    for i in range(n0):
+        for j in range(n1):
+            for k in range(n2):
+                m[i, j, k] = i * 10000 + j * 100 + k
+    return m
+
+
+cdef bint same_2d(int[:, :] a, int[:, :] b):
+    cdef Py_ssize_t i, j
+    if a.shape[0] != b.shape[0] or a.shape[1] != b.shape[1]:
+        return False
+    for i in range(a.shape[0]):
+        for j in range(a.shape[1]):
+            if a[i, j] != b[i, j]:
+                return False
+    return True
+
+
+cdef bint same_3d(double[:, :, :] a, double[:, :, :] b):
+    cdef Py_ssize_t i, j, k
+    for i in range(a.shape[0]):
+        for j in range(a.shape[1]):
+            for k in range(a.shape[2]):
+                if a[i, j, k] != b[i, j, k]:
+                    return False
+    return True
+
+
+def transpose_2d(Py_ssize_t rows, Py_ssize_t cols):
+    """
+    >>> transpose_2d(3, 5)
+    (True, True, True)
+    >>> transpose_2d(37, 70)
+    (True, True, True)
+    >>> transpose_2d(64, 1)
+    (True, True, True)
+    """
+    cdef int[:, :] c = matrix(rows, cols)
+    cdef int[:, :] f = matrix(rows, cols, mode="fortran")
+    cdef int[:, :] f_copy = matrix(rows, cols, mode="fortran")
+    f_copy[...] = 0
+    f_copy[:, :] = c
+    c_copy = f.copy()
+    return same_2d(f_copy, c), same_2d(c_copy, f), same_2d(c.copy_fortran(), c)
+
+
+def transpose_view(Py_ssize_t n):
+    """
+    >>> transpose_view(5)
+    True
+    >>> transpose_view(45)
+    True
+    """
+    cdef int[:, :] c = matrix(n, n)
+    cdef int[:, :] out = matrix(n, n)
+    out[...] = c.T
+    cdef Py_ssize_t i, j
+    for i in range(n):
+        for j in range(n):
+            if out[i, j] != c[j, i]:
+                return False
+    return True
+
+
+def transpose_3d(Py_ssize_t n0, Py_ssize_t n1, Py_ssize_t n2):
+    """
+    >>> transpose_3d(2, 3, 4)
+    (True, True)
+    >>> transpose_3d(5, 33, 40)
+    (True, True)
+    """
+    cdef double[:, :, :] c = cube(n0, n1, n2)
+    cdef double[:, :, :] f = cube(n0, n1, n2, mode="fortran")
+    f[...] = 0
+    f[...] = c
+    return same_3d(f, c), same_3d(c.copy_fortran(), c)
+
+
+def strided_source(Py_ssize_t rows, Py_ssize_t cols):
+    """
+    >>> strided_source(6, 9)
+    True
+    >>> strided_source(70, 90)
+    True
+    """
+    cdef int[:, :] c = matrix(rows, cols)
+    cdef int[:, :] f = matrix(rows // 2, cols // 3, mode="fortran")
+    f[...] = c[::2, ::3]
+    return same_2d(f, c[::2, ::3])
+
+
+def broadcast_rows(Py_ssize_t rows, Py_ssize_t cols):
+    """
+    >>> broadcast_rows(40, 35)
+    True
+    """
+    cdef int[:, :] f = matrix(rows, cols, mode="fortran")
+    cdef int[:, :] row = matrix(1, cols)
+    f[...] = row
+    cdef Py_ssize_t i
+    for i in range(rows):
+        if not same_2d(f[i:i+1, :], row):
+            return False
+    return True
+
+
+def shift_1d(Py_ssize_t shift, Py_ssize_t step=1):
+    """
+    >>> shift_1d(1)
+    [0, 0, 1, 2, 3, 4, 5, 6, 7, 8]
+    >>> shift_1d(-1)
+    [1, 2, 3, 4, 5, 6, 7, 8, 9, 9]
+    >>> shift_1d(3, 2)
+    [0, 1, 2, 0, 4, 2, 6, 4, 8, 6]
+    >>> shift_1d(2, 2)
+    [0, 1, 0, 3, 2, 5, 4, 7, 6, 9]
+    >>> shift_1d(-2, 2)
+    [2, 1, 4, 3, 6, 5, 8, 7, 8, 9]
+    """
+    cdef int[:] a = matrix(1, 10)[0]
+    if shift >= 0:
+        a[shift::step] = a[:a.shape[0] - shift:step]
+    else:
+        a[:a.shape[0] + shift:step] = a[-shift::step]
+    return list(a)
+
+
+def reversed_shift_1d():
+    """
+    >>> reversed_shift_1d()
+    [0, 0, 1, 2, 3, 4, 5, 6, 7, 8]
+    """
+    cdef int[:] a = matrix(1, 10)[0]
+    a[:0:-1] = a[-2::-1]
+    return list(a)
+
+
+def reversed_overlap_1d():
+    """
+    >>> reversed_overlap_1d()
+    [9, 8, 7, 6, 5, 4, 3, 2, 1, 0]
+    """
+    cdef int[:] a = matrix(1, 10)[0]
+    a[:] = a[::-1]
+    return list(a)
+
+
+def shift_rows(Py_ssize_t shift):
+    """
+    >>> shift_rows(1)
+    [[0, 1, 2], [0, 1, 2], [1000, 1001, 1002], [2000, 2001, 2002]]
+    >>> shift_rows(-1)
+    [[1000, 1001, 1002], [2000, 2001, 2002], [3000, 3001, 3002], [3000, 3001, 3002]]
+    """
+    cdef int[:, :] m = matrix(4, 3)
+    if shift > 0:
+        m[shift:, :] = m[:-shift, :]
+    else:
+        m[:shift, :] = m[-shift:, :]
+    return [list(row) for row in m]
+
+
+def shift_columns_fortran(Py_ssize_t shift):
+    """
+    >>> shift_columns_fortran(1)
+    [[0, 0, 1, 2], [1000, 1000, 1001, 1002]]
+    >>> shift_columns_fortran(-2)
+    [[2, 3, 2, 3], [1002, 1003, 1002, 1003]]
+    """
+    cdef int[:, :] m = matrix(2, 4, mode="fortran")
+    if shift > 0:
+        m[:, shift:] = m[:, :-shift]
+    else:
+        m[:, :shift] = m[:, -shift:]
+    return [list(row) for row in m]
+
+
+def shift_diagonal():
+    """
+    >>> shift_diagonal()
+    [[0, 1, 2, 3], [1000, 0, 1, 2], [2000, 1000, 1001, 1002], [3000, 2000, 2001, 2002]]
+    """
+    cdef int[:, :] m = matrix(4, 4)
+    m[1:, 1:] = m[:-1, :-1]
+    return [list(row) for row in m]
+
+
+def overlap_transposed():
+    """
+    >>> overlap_transposed()
+    [[0, 1000, 2000], [1, 1001, 2001], [2, 1002, 2002]]
+    """
+    cdef int[:, :] m = matrix(3, 3)
+    m[...] = m.T
+    return [list(row) for row in m]
+
+
+def overlap_objects():
+    """
+    >>> overlap_objects()
+    ['a', 'a', 'b', 'c']
+    """
+    cdef object[:] a = view.array(shape=(4,), itemsize=sizeof(void*), format="O")
+    a[0], a[1], a[2], a[3] = 'a', 'b', 'c', 'd'
+    a[1:] = a[:-1]
+    return list(a)
@@ -0,0 +1,234 @@
+# mode: run
+# tag: memoryview, broadcast
+
+cimport cython
+from cython cimport view
+from cpython.array cimport array  # make Cython aware of the array type
+
+from array import array as pyarray
+
+
+def darray(*values):
+    return pyarray('d', values)
+
+
+def matrix(rows, cols, mode="c", start=0.0):
+    cdef double[:, :] m = view.array(shape=(rows, cols), itemsize=sizeof(double), format="d", mode=mode)
+    cdef Py_ssize_t i, j
+    for i in range(rows):
+        for j in range(cols):
+            m[i, j] = start + i * 10 + j
+    return m
+
+
+def rows(double[:, :] m):
+    return [list(m[i, :]) for i in range(m.shape[0])]
+
+
+def contig_1d(double[::1] out, double[::1] a, double[::1] b, double c):
+    """
+    >>> out = darray(0, 0, 0, 0, 0)
+    >>> contig_1d(out, darray(1, 2, 3, 4, 5), darray(2, 2, 2, 3, 3), 0.5)
+    >>> list(out)
+    [2.5, 4.5, 6.5, 12.5, 15.5]
+    >>> contig_1d(out, darray(1, 2), darray(2, 2), 0.5)
+    Traceback (most recent call last):
+    ValueError: got differing extents in dimension 0 (got 5 and 2)
+    """
+    out[:] = a[:] * b[:] + c
+
+
+def strided_1d(double[:] out, double[:] a, int scale):
+    """
+    >>> out = darray(0, 0, 0)
+    >>> strided_1d(out, darray(1, 2, 3, 4, 5, 6), 3)
+    >>> list(out)
+    [3.0, 9.0, 15.0]
+    """
+    out[...] = scale * a[::2]
+
+
+def mixed_types(double[::1] out, float[::1] a, int[::1] b):
+    """
+    >>> out = darray(0, 0, 0)
+    >>> mixed_types(out, pyarray('f', [0.5, 1.5, 2.5]), pyarray('i', [1, 2, 3]))
+    >>> list(out)
+    [1.5, 3.5, 5.5]
+    """
+    out[:] = a + b
+
+
+def int_result(int[:] out, int[:] a, int[:] b):
+    """
+    >>> out = pyarray('i', [0, 0, 0])
+    >>> int_result(out, pyarray('i', [7, -7, 9]), pyarray('i', [2, 2, 3]))
+    >>> list(out)
+    [4, -3, 3]
+    >>> int_result(out, pyarray('i', [1, 2, 3]), pyarray('i', [1, 0, 1]))
+    Traceback (most recent call last):
+    ZeroDivisionError: integer division or modulo by zero
+    """
+    out[:] = a // b + a % b
+
+
+@cython.cdivision(True)
+def c_division(double[::1] out, double[::1] a, double[::1] b):
+    """
+    >>> out = darray(0, 0)
+    >>> c_division(out, darray(1, 3), darray(4, 2))
+    >>> list(out)
+    [0.25, 1.5]
+    """
+    out[:] = a / b
+
+
+@cython.overflowcheck(True)
+def overflow_check(int[::1] out, int[::1] a):
+    """
+    >>> out = pyarray('i', [0, 0])
+    >>> overflow_check(out, pyarray('i', [2, 3]))
+    >>> list(out)
+    [4, 9]
+    >>> overflow_check(out, pyarray('i', [2, 2**30]))
+    Traceback (most recent call last):
+    OverflowError: value too large
+    """
+    out[:] = a * a
+
+
+def python_division(double[::1] out, double[::1] a, double[::1] b):
+    """
+    >>> out = darray(0, 0)
+    >>> python_division(out, darray(1, 3), darray(4, 0))
+    Traceback (most recent call last):
+    ZeroDivisionError: float division
+    """
+    out[:] = a / b
+
+
+def broadcast_2d(double[:, :] out, double[:, :] a, double[:] row):
+    """
+    >>> out = matrix(2, 3)
+    >>> broadcast_2d(out, matrix(2, 3), darray(1, 2, 3))
+    >>> rows(out)
+    [[1.0, 3.0, 5.0], [11.0, 13.0, 15.0]]
+    >>> broadcast_2d(out, matrix(1, 3), darray(1, 2, 3))
+    >>> rows(out)
+    [[1.0, 3.0, 5.0], [1.0, 3.0, 5.0]]
+    >>> broadcast_2d(out, matrix(2, 1), darray(1, 2, 3))
+    >>> rows(out)
+    [[1.0, 2.0, 3.0], [11.0, 12.0, 13.0]]
+    >>> broadcast_2d(out, matrix(2, 3), darray(1, 2))
+    Traceback (most recent call last):
+    ValueError: got differing extents in dimension 1 (got 3 and 2)
+    >>> broadcast_2d(out, matrix(3, 3), darray(1, 2, 3))
+    Traceback (most recent call last):
+    ValueError: got differing extents in dimension 0 (got 2 and 3)
+    """
+    out[:, :] = a + row
+
+
+def broadcast_contig_2d(double[:, ::1] out, double[:, ::1] a, double[::1] row):
+    """
+    >>> out = matrix(2, 3)
+    >>> broadcast_contig_2d(out, matrix(2, 3), darray(1, 2, 3))
+    >>> rows(out)
+    [[0.0, 2.0, 6.0], [10.0, 22.0, 36.0]]
+    >>> broadcast_contig_2d(out, matrix(2, 3), darray(2))
+    >>> rows(out)
+    [[0.0, 2.0, 4.0], [20.0, 22.0, 24.0]]
+    """
+    out[:, :] = (a + 1) * row - row
+
+
+def fortran_2d(double[::1, :] out, double[::1, :] a, double[::1, :] b):
+    """
+    >>> out = matrix(2, 3, mode="fortran")
+    >>> fortran_2d(out, matrix(2, 3, mode="fortran"), matrix(2, 3, mode="fortran", start=1))
+    >>> rows(out)
+    [[1.0, 3.0, 5.0], [21.0, 23.0, 25.0]]
+    """
+    out[...] = a + b
+
+
+def lower_dimensional(double[:] out, double[:, :] a):
+    """
+    >>> out = darray(0, 0, 0)
+    >>> lower_dimensional(out, matrix(1, 3))
+    >>> list(out)
+    [0.0, 2.0, 4.0]
+    >>> lower_dimensional(out, matrix(2, 3))
+    Traceback (most recent call last):
+    ValueError: got differing extents in dimension 0 (got 1 and 2)
+    """
+    out[:] = a * 2
+
+
+def in_place(double[::1] a, double c):
+    """
+    >>> a = darray(1, 2, 3)
+    >>> in_place(a, 2)
+    >>> list(a)
+    [3.0, 6.0, 11.0]
+    """
+    a[:] = a * a + c
+
+
+def overlapping(double[:] a):
+    """
+    >>> a = darray(1, 2, 3, 4)
+    >>> overlapping(a)
+    >>> list(a)
+    [1.0, 2.0, 4.0, 6.0]
+    """
+    a[1:] = a[:-1] * 2
+
+
+cdef int calls = 0
+
+cdef double counted(double value):
+    global calls
+    calls += 1
+    return value
+
+
+def scalar_evaluated_once(double[::1] out, double[::1] a):
+    """
+    >>> out = darray(0, 0, 0)
+    >>> scalar_evaluated_once(out, darray(1, 2, 3))
+    1
+    >>> list(out)
+    [3.0, 6.0, 9.0]
+    """
+    global calls
+    calls = 0
+    out[:] = a * counted(3.0)
+    return calls
+
+
+def without_gil(double[::1] out, double[::1] a, double[::1] b):
+    """
+    >>> out = darray(0, 0)
+    >>> without_gil(out, darray(1, 2), darray(3, 4))
+    >>> list(out)
+    [-2.0, -2.0]
+    >>> without_gil(out, darray(1, 2), darray(3))
+    >>> list(out)
+    [-2.0, -1.0]
+    >>> without_gil(out, darray(1, 2, 3), darray(3))
+    Traceback (most recent call last):
+    ValueError: got differing extents in dimension 0 (got 2 and 3)
+    """
+    with nogil:
+        out[:] = a - b
+
+
+def empty(double[::1] out, double[::1] a):
+    """
+    >>> out = darray()
+    >>> empty(out, darray())
+    >>> empty(out, darray(1))
+    >>> list(out)
+    []
+    """
+    out[:] = a + 1.0
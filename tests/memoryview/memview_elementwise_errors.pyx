@@ -0,0 +1,18 @@
+# mode: error
+# tag: memoryview
+
+cdef double[:] a, b
+cdef object[:] o
+cdef int[:] i
+
+x = a + b
+print(a * 2)
+a[:] = o + a
+i[:] = a * 2
+
+_ERRORS = u"""
+8:6: Element-wise memoryview arithmetic is only supported when assigning to a slice, e.g. 'out[:] = a + b'
+9:8: Element-wise memoryview arithmetic is only supported when assigning to a slice, e.g. 'out[:] = a + b'
+10:9: Invalid operand types for '+' (object[:]; double[:])
+11:9: Cannot assign type 'double' to 'int'
+"""
@@ -0,0 +1,201 @@
+# mode: run
+# tag: getattr, type_version_tag
+# cython: optimize.cache_attribute_lookups=True
+
+
+class Plain(object):
+    cls_attr = 'class'
+
+    def __init__(self, value):
+        self.value = value
+
+    def method(self, x):
+        return (self.value, x)
+
+    @classmethod
+    def cmethod(cls, x):
+        return (cls.__name__, x)
+
+    @staticmethod
+    def smethod(x):
+        return ('static', x)
+
+    @property
+    def prop(self):
+        return ('prop', self.value)
+
+
+class Slotted(object):
+    __slots__ = ('value',)
+
+    def __init__(self, value):
+        self.value = value
+
+    def method(self, x):
+        return ('slotted', self.value, x)
+
+
+class WithGetattr(object):
+    def __getattr__(self, name):
+        return lambda *args: ('getattr', name) + args
+
+
+cdef class Ext:
+    cdef public object value
+
+    def __init__(self, value):
+        self.value = value
+
+    def method(self, x):
+        return ('ext', self.value, x)
+
+
+def get_value(obj):
+    return obj.value
+
+
+def call_method(obj, x):
+    return obj.method(x)
+
+
+def get_attrs(obj):
+    return obj.cls_attr, obj.prop, obj.cmethod(1), obj.smethod(2)
+
+
+def test_instance_attributes():
+    """
+    >>> test_instance_attributes()
+    [1, 2, 3, 4, 5, 6]
+    """
+    objects = [Plain(1), Plain(2), Slotted(3), Slotted(4), Ext(5), Ext(6)]
+    return [get_value(obj) for obj in objects]
+
+
+def test_missing_attribute():
+    """
+    >>> test_missing_attribute()
+    ['Slotted', 'Slotted', 'Plain', 'Plain']
+    """
+    result = []
+    for obj in [Slotted(1), Slotted(2), Plain(3), Plain(4)]:
+        del obj.value
+        try:
+            get_value(obj)
+        except AttributeError:
+            result.append(type(obj).__name__)
+    return result
+
+
+def test_methods():
+    """
+    >>> test_methods()
+    [(1, 'a'), (2, 'b'), ('slotted', 3, 'c'), ('ext', 4, 'd'), ('getattr', 'method', 'x'), (5, 'e')]
+    """
+    objects = [(Plain(1), 'a'), (Plain(2), 'b'), (Slotted(3), 'c'), (Ext(4), 'd'), (WithGetattr(), 'x'), (Plain(5), 'e')]
+    return [call_method(obj, x) for obj, x in objects]
+
+
+def test_instance_dict_shadows_method():
+    """
+    >>> test_instance_dict_shadows_method()
+    [(1, 'x'), ('shadowed', 'x'), (3, 'x')]
+    """
+    objects = [Plain(1), Plain(2), Plain(3)]
+    objects[1].method = lambda x: ('shadowed', x)
+    return [call_method(obj, 'x') for obj in objects]
+
+
+def test_class_attributes():
+    """
+    >>> test_class_attributes()
+    [('class', ('prop', 1), ('Plain', 1), ('static', 2)), ('instance', ('prop', 2), ('Plain', 1), ('static', 2))]
+    """
+    a, b = Plain(1), Plain(2)
+    b.cls_attr = 'instance'
+    return [get_attrs(a), get_attrs(b)]
+
+
+def test_type_modification():
+    """
+    >>> test_type_modification()
+    [(1, 'x'), ('new', 1, 'x'), ('sub', 1, 'x'), ('new', 1, 'x')]
+    """
+    class A(object):
+        def __init__(self, value):
+            self.value = value
+        def method(self, x):
+            return (self.value, x)
+
+    class B(A):
+        pass
+
+    result = [call_method(A(1), 'x')]
+    A.method = lambda self, x: ('new', self.value, x)
+    result.append(call_method(B(1), 'x'))
+    B.method = lambda self, x: ('sub', self.value, x)
+    result.append(call_method(B(1), 'x'))
+    del B.method
+    result.append(call_method(B(1), 'x'))
+    return result
+
+
+def test_property_replaced_by_class_attribute():
+    """
+    >>> test_property_replaced_by_class_attribute()
+    [1, 'class', 3]
+    """
+    class A(object):
+        @property
+        def value(self):
+            return self._value
+        def __init__(self, value):
+            self._value = value
+
+    result = [get_value(A(1))]
+    A.value = 'class'
+    result.append(get_value(A(2)))
+    del A.value
+    A.value = property(lambda self: self._value)
+    result.append(get_value(A(3)))
+    return result
+
+
+def test_no_instance_dict_created():
+    """
+    >>> test_no_instance_dict_created()
+    True
+    """
+    import sys
+    count = 1000
+    objects = [Plain(i) for i in range(count)]
+    for obj in objects[:2]:
+        get_value(obj); call_method(obj, 'x'); get_attrs(obj)
+    # Instances that keep their attributes inline (CPython 3.11+) must not get a
+    # __dict__ from the lookups, which would allocate one block per object.
+    blocks = sys.getallocatedblocks()
+    for obj in objects:
+        get_value(obj); call_method(obj, 'x'); get_attrs(obj)
+    return sys.getallocatedblocks() - blocks < count // 2
+
+
+def test_instance_dict_shadows_class_attribute():
+    """
+    >>> test_instance_dict_shadows_class_attribute()
+    [(1, 'x'), ('inline', 'x'), ('dict', 'x'), 'instance', 'dict']
+    """
+    class Sub(Plain):
+        pass
+
+    inline, with_dict = Sub(1), Sub(2)
+    # Requesting the __dict__ creates it (CPython 3.11+ keeps the attributes inline before).
+    with_dict.__dict__
+    result = [call_method(inline, 'x')]
+    inline.method = lambda x: ('inline', x)
+    result.append(call_method(inline, 'x'))
+    with_dict.__dict__['method'] = lambda x: ('dict', x)
+    result.append(call_method(with_dict, 'x'))
+    inline.cls_attr = 'instance'
+    with_dict.__dict__['cls_attr'] = 'dict'
+    result.append(get_attrs(inline)[0])
+    result.append(get_attrs(with_dict)[0])
+    return result
@@ -6,57 +6,58 @@
 ### low level tests
 
 cimport cython
+from cpython.ref cimport PyObject, Py_DECREF
 
 cdef extern from *:
-    # evil hack to access the internal utility function
+    # evil hack to access the internal utility functions
     ctypedef struct PyCodeObject
-    ctypedef struct __Pyx_CodeObjectCacheEntry:
-        int code_line
-        PyCodeObject* code_object
-    int __pyx_bisect_code_objects(__Pyx_CodeObjectCacheEntry* entries, int count, int code_line)
-
-def test_lowlevel_bisect2(*indices):
-    """
-    >>> test_lowlevel_bisect2(1, 2, 3, 4, 5, 6)
-    [0, 0, 1, 1, 2, 2]
+    PyCodeObject* __pyx_find_code_object(int code_line)
+    void __pyx_insert_code_object(int code_line, PyCodeObject* code_object)
+
+cdef object find_code_object(int code_line):
+    cdef PyCodeObject* code_object = __pyx_find_code_object(code_line)
+    if code_object is NULL:
+        return None
+    result = <object><PyObject*>code_object
+    Py_DECREF(result)
+    return result
+
+def test_lowlevel_insert_find(int count):
     """
-    cdef __Pyx_CodeObjectCacheEntry* cache = [
-        __Pyx_CodeObjectCacheEntry(2, NULL),
-        __Pyx_CodeObjectCacheEntry(4, NULL),
-        ]
-    return [ __pyx_bisect_code_objects(cache, 2, i)
-             for i in indices ]
-
-def test_lowlevel_bisect5(*indices):
+    >>> test_lowlevel_insert_find(1000)
+    (True, True, True, True)
     """
-    >>> test_lowlevel_bisect5(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11)
-    [0, 1, 2, 2, 2, 3, 3, 3, 4, 5, 5]
+    codes = [compile(str(i), "<test>", "eval") for i in range(count)]
+    # Line numbers far beyond this module, positive and negative like Python and C lines.
+    lines = [1000000 + i * (-1) ** i for i in range(count)]
+    for line, code in zip(lines, codes):
+        __pyx_insert_code_object(line, <PyCodeObject*>code)
+    found_all = all(find_code_object(line) is code for line, code in zip(lines, codes))
+    # Existing entries are replaced.
+    __pyx_insert_code_object(lines[0], <PyCodeObject*>codes[1])
+    replaced = find_code_object(lines[0]) is codes[1] and find_code_object(lines[1]) is codes[1]
+    missing = find_code_object(3000000) is None and find_code_object(-3000000) is None
+    ignored_zero = find_code_object(0) is None
+    return found_all, replaced, missing, ignored_zero
+
+
+def test_lowlevel_replace_refcount():
     """
-    cdef __Pyx_CodeObjectCacheEntry* cache = [
-        __Pyx_CodeObjectCacheEntry(1, NULL),
-        __Pyx_CodeObjectCacheEntry(2, NULL),
-        __Pyx_CodeObjectCacheEntry(5, NULL),
-        __Pyx_CodeObjectCacheEntry(8, NULL),
-        __Pyx_CodeObjectCacheEntry(9, NULL),
-        ]
-    return [ __pyx_bisect_code_objects(cache, 5, i)
-             for i in indices ]
-
-def test_lowlevel_bisect6(*indices):
+    >>> test_lowlevel_replace_refcount()
+    (True, True)
     """
-    >>> test_lowlevel_bisect6(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13)
-    [0, 0, 1, 2, 2, 2, 3, 3, 4, 5, 5, 5, 6]
-    """
-    cdef __Pyx_CodeObjectCacheEntry* cache = [
-        __Pyx_CodeObjectCacheEntry(2, NULL),
-        __Pyx_CodeObjectCacheEntry(3, NULL),
-        __Pyx_CodeObjectCacheEntry(6, NULL),
-        __Pyx_CodeObjectCacheEntry(8, NULL),
-        __Pyx_CodeObjectCacheEntry(9, NULL),
-        __Pyx_CodeObjectCacheEntry(12, NULL),
-        ]
-    return [ __pyx_bisect_code_objects(cache, 6, i)
-             for i in indices ]
+    import sys
+    old, new = compile("1", "<test>", "eval"), compile("2", "<test>", "eval")
+    line = 2000000
+    __pyx_insert_code_object(line, <PyCodeObject*>old)
+    old_refcount, new_refcount = sys.getrefcount(old), sys.getrefcount(new)
+    __pyx_insert_code_object(line, <PyCodeObject*>new)
+    __pyx_insert_code_object(line, <PyCodeObject*>new)
+    # The table owns one reference to the current code object.  In free-threaded
+    # builds, replaced code objects are only released at module cleanup.
+    released = sys.getrefcount(old) == old_refcount - 1 or hasattr(sys, "_is_gil_enabled")
+    return find_code_object(line) is new, released and sys.getrefcount(new) == new_refcount + 1
+
 
 ### Python level tests
 
@@ -0,0 +1,67 @@
+# mode: run
+# tag: cpp, openmp, no-cpp-locals
+# no-cpp-locals because C++ reductions are not supported with cpp_locals
+
+from cython.parallel cimport prange
+
+from array import array
+
+cdef extern from *:
+    """
+    #include <limits>
+
+    struct ArgMin {
+        double value;
+        long index;
+
+        ArgMin() : value(std::numeric_limits<double>::infinity()), index(-1) {}
+
+        void update(double v, long i) {
+            if (v < value || (v == value && i < index)) {
+                value = v;
+                index = i;
+            }
+        }
+        ArgMin operator+(const ArgMin &other) const {
+            ArgMin result = *this;
+            if (other.index >= 0)
+                result.update(other.value, other.index);
+            return result;
+        }
+    };
+    """
+    cdef cppclass ArgMin:
+        double value
+        long index
+        void update(double, long) nogil
+        ArgMin operator+(ArgMin&)
+
+
+def argmin(values):
+    """
+    >>> argmin([3.5, -2.0, 7.25, -2.0, 1.0])
+    (-2.0, 1)
+    >>> argmin([5.0])
+    (5.0, 0)
+    >>> argmin([])
+    (inf, -1)
+    """
+    cdef double[:] data = array('d', values)
+    cdef Py_ssize_t n = len(values)
+    cdef Py_ssize_t i
+    cdef ArgMin result
+    for i in prange(n, nogil=True, num_threads=3, reduction=result):
+        result.update(data[i], i)
+    return result.value, result.index
+
+
+def argmin_chunks(long n):
+    """
+    >>> argmin_chunks(1000)
+    (0.0, 500)
+    """
+    cdef long i
+    cdef ArgMin result
+    for i in prange(n, nogil=True, schedule='static', chunksize=7, reduction=result):
+        result.update(abs(i - n // 2), i)
+    return result.value, result.index
@@ -0,0 +1,53 @@
+# mode: run
+# tag: cpp, openmp
+
+from cython.parallel cimport prange
+from libcpp.deque cimport deque
+from libcpp.vector cimport vector
+
+
+def vector_sum(values):
+    """
+    >>> vector_sum([1.5, 2.0, 3.5])
+    (7.0, 3.5)
+    >>> vector_sum([])
+    (0.0, -1.0)
+    """
+    cdef vector[double] vec = values
+    cdef double x = -1, total = 0
+    for x in prange(vec, nogil=True):
+        total += x
+    return total, x
+
+
+cdef vector[int] make_range(int n) noexcept nogil:
+    cdef vector[int] result
+    cdef int i
+    for i in range(n):
+        result.push_back(i)
+    return result
+
+
+def temporary_sum(int n):
+    """
+    >>> temporary_sum(1000)
+    499500
+    """
+    cdef long x, total = 0
+    for x in prange(make_range(n), nogil=True, schedule='dynamic'):
+        total += x
+    return total
+
+
+def deque_max(values):
+    """
+    >>> deque_max([3, -2, 7, 1])
+    7
+    """
+    cdef deque[int] d
+    cdef int x, largest = -1000
+    for x in values:
+        d.push_back(x)
+    for x in prange(d, nogil=True):
+        largest = max(largest, x)
+    return largest
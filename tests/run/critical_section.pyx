@@ -0,0 +1,131 @@
+# mode: run
+# tag: freethreading
+
+cimport cython
+
+import threading
+
+
+@cython.critical_section
+cdef class Counter:
+    cdef public long count
+    cdef public double ratio
+    cdef public object name
+    cdef readonly list items
+
+    def __cinit__(self):
+        self.items = []
+
+    def add(self, x):
+        """
+        >>> c = Counter()
+        >>> c.add('a'), c.add('b')
+        (1, 2)
+        >>> c.items
+        ['a', 'b']
+        """
+        self.items.append(x)
+        self.count += 1
+        return self.count
+
+    def fail(self):
+        """
+        >>> Counter().fail()
+        Traceback (most recent call last):
+        ValueError: failed
+        """
+        raise ValueError("failed")
+
+    cpdef long total(self):
+        """
+        >>> c = Counter()
+        >>> c.count = 5
+        >>> c.total()
+        5
+        """
+        return self.count
+
+    @staticmethod
+    def make():
+        """
+        >>> Counter.make().count
+        0
+        """
+        return Counter()
+
+    def values(self):
+        """
+        >>> c = Counter()
+        >>> c.count = 3
+        >>> list(c.values())
+        [3]
+        """
+        yield self.count
+
+
+def test_properties():
+    """
+    >>> test_properties()
+    (7, 0.5, 'counter', [])
+    """
+    c = Counter()
+    c.count = 7
+    c.ratio = 0.5
+    c.name = 'counter'
+    return c.count, c.ratio, c.name, c.items
+
+
+def locked_append(list l, x, y):
+    """
+    >>> l = []
+    >>> locked_append(l, 1, 2)
+    [1, 2]
+    >>> locked_append(l, 0, 3)
+    [1, 2, 0, 3]
+    """
+    with cython.critical_section(l):
+        l.append(x)
+    with cython.critical_section(l, y):
+        if x:
+            l.append(y)
+            return l
+        l.append(y)
+    return l
+
+
+def locked_raise(obj):
+    """
+    >>> locked_raise([])
+    Traceback (most recent call last):
+    KeyError: 'x'
+    >>> locked_raise([1])
+    1
+    """
+    with cython.critical_section(obj[:]):
+        if not obj:
+            raise KeyError('x')
+        return obj[0]
+
+
+def test_threads():
+    """
+    >>> test_threads()
+    (4000, 4000, True)
+    """
+    c = Counter()
+    ratios = (0.25, 0.5)
+
+    def worker(n):
+        for i in range(1000):
+            c.add(i)
+            # the property accesses of scalars are atomic, not locked
+            c.ratio = ratios[(n + i) % 2]
+            assert c.ratio in ratios, c.ratio
+
+    c.ratio = ratios[0]
+    threads = [threading.Thread(target=worker, args=(n,)) for n in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return c.count, len(c.items), c.ratio in ratios
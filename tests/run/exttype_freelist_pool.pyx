@@ -0,0 +1,145 @@
+# mode: run
+# tag: freelist, cyclicgc, freethreading
+
+cimport cython
+
+import os
+import subprocess
+import sys
+import threading
+
+
+@cython.freelist(4)
+@cython.freelist_pool(8)
+cdef class Event:
+    """
+    >>> obj = Event(1)
+    >>> obj.payload
+    1
+    >>> obj = Event(2)
+    >>> obj.payload
+    2
+    >>> obj = Event()
+    >>> obj.payload is None
+    True
+
+    >>> class PyClass(Event): a = 1
+    >>> obj = PyClass()
+    >>> obj = PyClass()
+    >>> del PyClass, obj
+    """
+    cdef public object payload
+    cdef public double value
+
+    def __cinit__(self, payload=None):
+        self.payload = payload
+
+
+@cython.final
+@cython.freelist(3)
+@cython.freelist_pool(4)
+cdef class FinalEvent:
+    cdef public int value
+
+
+def stats_delta(before, after):
+    return {key: after[key] - before[key] for key in ('hits', 'misses', 'cached', 'released')}
+
+
+def test_stats():
+    """
+    >>> stats = Event.__freelist_stats__()
+    >>> stats['thread_cache_size'], stats['pool_size']
+    (4, 8)
+
+    >>> delta, pooled = test_stats()
+    >>> sorted(delta.items())
+    [('cached', 12), ('hits', 0), ('misses', 20), ('released', 8)]
+    >>> pooled
+    12
+    """
+    # Empty the freelist first.
+    alive = []
+    while Event.__freelist_stats__()['pooled']:
+        alive.append(Event())
+    before = Event.__freelist_stats__()
+    events = [Event(i) for i in range(20)]
+    del events
+    after = Event.__freelist_stats__()
+    return stats_delta(before, after), after['pooled']
+
+
+def test_reuse():
+    """
+    >>> delta, values = test_reuse()
+    >>> sorted(delta.items())
+    [('cached', 10), ('hits', 10), ('misses', 0), ('released', 0)]
+    >>> values
+    [(None, 0.0), (None, 0.0), (None, 0.0)]
+    """
+    events = [Event(i) for i in range(10)]
+    for event in events:
+        event.value = 1.5
+    before = Event.__freelist_stats__()
+    del events, event
+    events = [Event() for i in range(10)]
+    after = Event.__freelist_stats__()
+    return stats_delta(before, after), [(event.payload, event.value) for event in events[:3]]
+
+
+def test_final_type():
+    """
+    >>> test_final_type()
+    [0, 0, 0, 0, 0, 0, 0, 0, 0, 0]
+    >>> stats = FinalEvent.__freelist_stats__()
+    >>> stats['pooled'] <= 7, stats['hits'] > 0
+    (True, True)
+    """
+    result = []
+    for i in range(10):
+        events = [FinalEvent() for _ in range(10)]
+        result.append(events[i].value)
+        for event in events:
+            event.value = i + 1
+    return result
+
+
+def test_threads():
+    """
+    >>> delta, pooled, capacity = test_threads()
+    >>> delta['hits'] + delta['misses'], delta['cached'] + delta['released']
+    (4000, 4000)
+    >>> pooled <= capacity
+    True
+    """
+    def worker():
+        for _ in range(100):
+            events = [Event(i) for i in range(10)]
+            del events
+
+    before = Event.__freelist_stats__()
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    after = Event.__freelist_stats__()
+    # Without free-threading, 'pooled' includes the single module wide cache.
+    return stats_delta(before, after), after['pooled'], after['pool_size'] + after['thread_cache_size']
+
+
+def pool_size_from_env(value):
+    """
+    >>> pool_size_from_env('3')
+    3
+    >>> pool_size_from_env('invalid')
+    8
+    """
+    env = dict(os.environ, CYTHON_FREELIST_POOL_SIZE=value)
+    # The test runner may import support modules (e.g. refnanny) from sys.path.
+    env['PYTHONPATH'] = os.pathsep.join([os.path.dirname(__file__)] + sys.path)
+    output = subprocess.check_output([
+        sys.executable, '-c',
+        'from %s import Event; print(Event.__freelist_stats__()["pool_size"])' % __name__,
+    ], env=env)
+    return int(output)
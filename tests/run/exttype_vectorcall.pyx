@@ -0,0 +1,158 @@
+# mode: run
+# tag: cclass, vectorcall, call
+
+cdef class Point:
+    """
+    >>> p = Point(1, 2)
+    >>> p.x, p.y, p.tag
+    (1.0, 2.0, None)
+    >>> p = Point(y=3, x=4, tag='a')
+    >>> p.x, p.y, p.tag
+    (4.0, 3.0, 'a')
+    >>> p = Point(*(5,), **{'tag': 'b'})
+    >>> p.x, p.y, p.tag
+    (5.0, 0.0, 'b')
+    >>> p.__init__(6)
+    >>> p.x, p.y, p.tag
+    (6.0, 0.0, None)
+    >>> Point()  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__init__() takes at least 1 positional argument (0 given)
+    >>> Point(1, 2, 3)  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__init__() takes at most 2 positional arguments (3 given)
+    >>> Point(1, z=2)  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__init__() got an unexpected keyword argument 'z'
+    >>> Point(1, x=2)  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__init__() got multiple values for keyword argument 'x'
+    >>> Point('x')  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: must be real number, not str
+    """
+    cdef public double x, y
+    cdef public object tag
+
+    def __init__(self, double x, double y=0.0, *, tag=None):
+        self.x = x
+        self.y = y
+        self.tag = tag
+
+
+cdef class Point3(Point):
+    """
+    >>> p = Point3(1, tag='c')
+    >>> p.x, p.y, p.z, p.tag
+    (1.0, 0.0, 0.0, 'c')
+    """
+    cdef public double z
+
+
+class PyPoint(Point):
+    """
+    >>> p = PyPoint(1, 2, 3)
+    >>> p.x, p.y, p.z
+    (1.0, 2.0, 3)
+    """
+    def __init__(self, x, y, z):
+        super().__init__(x, y)
+        self.z = z
+
+
+cdef class WithCinit:
+    """
+    >>> WithCinit(1, b=2).args
+    ((1,), {'b': 2}, 1, 2)
+    """
+    cdef public tuple args
+
+    def __cinit__(self, *args, **kwargs):
+        self.args = (args, kwargs)
+
+    def __init__(self, a, b):
+        self.args += (a, b)
+
+
+cdef class WithTrivialCinit:
+    """
+    >>> WithTrivialCinit(a=1).args
+    ('cinit', 1)
+    """
+    cdef public tuple args
+
+    def __cinit__(self):
+        self.args = ('cinit',)
+
+    def __init__(self, a):
+        self.args += (a,)
+
+
+cdef class Caller:
+    """
+    >>> c = Caller()
+    >>> c(1)
+    ('Caller', 1, 2, {})
+    >>> c(1, b=3, c=4)
+    ('Caller', 1, 3, {'c': 4})
+    >>> c(*(1, 5))
+    ('Caller', 1, 5, {})
+    >>> c.__call__(a=6)
+    ('Caller', 6, 2, {})
+    >>> c()  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__call__() takes at least 1 positional argument (0 given)
+    """
+    def __call__(self, a, b=2, **kwargs):
+        return (type(self).__name__, a, b, kwargs)
+
+
+cdef class InheritedCaller(Caller):
+    """
+    >>> InheritedCaller()(1, c=2)
+    ('InheritedCaller', 1, 2, {'c': 2})
+    """
+
+
+cdef class OverridingCaller(Caller):
+    """
+    >>> OverridingCaller()(1)
+    ('OverridingCaller', 1)
+    >>> OverridingCaller()(a=1, b=2)  # doctest: +ELLIPSIS
+    Traceback (most recent call last):
+    TypeError: ...__call__() got an unexpected keyword argument 'b'
+    """
+    def __call__(self, a):
+        return (type(self).__name__, a)
+
+
+class PyCaller(Caller):
+    """
+    >>> PyCaller()(1)
+    ('PyCaller', 1, 2, {})
+    >>> PyOverridingCaller()(1)
+    ('py', 1)
+    """
+
+
+class PyOverridingCaller(Caller):
+    def __call__(self, a):
+        return ('py', a)
+
+
+cdef class StarCaller:
+    """
+    >>> StarCaller()(1, 2)
+    (1, 2)
+    """
+    def __call__(self, *args):
+        return args
+
+
+cdef class StarSubCaller(StarCaller):
+    """
+    >>> StarSubCaller()(1, 2)
+    (1, (2,))
+    """
+    def __call__(self, a, *args):
+        return (a, args)
@@ -0,0 +1,73 @@
+# mode: run
+# tag: kwargs
+
+# Functions with many keyword arguments look up the keywords in a perfect hash table.
+
+
+def many(a, b, c=3, d=4, e=5, f=6, *, g=7, h=8, i, j=10):
+    """
+    >>> many(1, 2, i=9)
+    (1, 2, 3, 4, 5, 6, 7, 8, 9, 10)
+    >>> many(j=0, i=1, h=2, g=3, f=4, e=5, d=6, c=7, b=8, a=9)
+    (9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+    >>> many(1, 2, 3, e=50, i=90, h=80)
+    (1, 2, 3, 4, 50, 6, 7, 80, 90, 10)
+
+    Keywords that are not interned:
+
+    >>> kwargs = {''.join(['e']): 50, ''.join(['g', '']): 70, 'i': 90}
+    >>> many(1, 2, **kwargs)
+    (1, 2, 3, 4, 50, 6, 70, 8, 90, 10)
+    >>> str_subclass = type('S', (str,), {})
+    >>> many(1, 2, **{str_subclass('h'): 80, str_subclass('i'): 90})
+    (1, 2, 3, 4, 5, 6, 7, 80, 90, 10)
+
+    >>> many(1, 2, i=9, k=11)
+    Traceback (most recent call last):
+    TypeError: many() got an unexpected keyword argument 'k'
+    >>> many(1, 2, 3, i=9, c=4)
+    Traceback (most recent call last):
+    TypeError: many() got multiple values for keyword argument 'c'
+    >>> many(1, 2)
+    Traceback (most recent call last):
+    TypeError: many() needs keyword-only argument i
+    >>> many(1, i=9)
+    Traceback (most recent call last):
+    TypeError: many() takes at least 2 positional arguments (1 given)
+    """
+    return a, b, c, d, e, f, g, h, i, j
+
+
+def posonly_and_kwargs(a, b, /, c=3, d=4, e=5, f=6, g=7, h=8, i=9, j=10, **kwargs):
+    """
+    >>> posonly_and_kwargs(1, 2, j=0, c=30)
+    (1, 2, 30, 4, 5, 6, 7, 8, 9, 0, [])
+    >>> posonly_and_kwargs(1, 2, a=11, b=12, z=13, d=40)
+    (1, 2, 3, 40, 5, 6, 7, 8, 9, 10, [('a', 11), ('b', 12), ('z', 13)])
+    >>> posonly_and_kwargs(1, 2, 3, 4, d=40)
+    Traceback (most recent call last):
+    TypeError: posonly_and_kwargs() got multiple values for keyword argument 'd'
+    """
+    return a, b, c, d, e, f, g, h, i, j, sorted(kwargs.items())
+
+
+def star_args(*args, alpha=1, beta=2, gamma=3, delta=4, epsilon=5, zeta=6, eta=7, theta=8):
+    """
+    >>> star_args(0, theta=80, alpha=10)
+    ((0,), 10, 2, 3, 4, 5, 6, 7, 80)
+    >>> star_args(iota=9)
+    Traceback (most recent call last):
+    TypeError: star_args() got an unexpected keyword argument 'iota'
+    """
+    return args, alpha, beta, gamma, delta, epsilon, zeta, eta, theta
+
+
+cdef class C:
+    def method(self, a1=1, a2=2, a3=3, a4=4, a5=5, a6=6, a7=7, a8=8, a9=9):
+        """
+        >>> C().method(a9=90, a1=10)
+        (10, 2, 3, 4, 5, 6, 7, 8, 90)
+        >>> C().method(**{'a' + '5': 50})
+        (1, 2, 3, 4, 50, 6, 7, 8, 9)
+        """
+        return a1, a2, a3, a4, a5, a6, a7, a8, a9
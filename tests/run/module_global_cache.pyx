@@ -0,0 +1,80 @@
+# mode: run
+# tag: globals, builtins, allow_unknown_names
+
+import builtins
+
+value = 1
+
+
+def get_value():
+    return value
+
+
+def get_len():
+    return len
+
+
+def get_undefined():
+    return undefined_name
+
+
+def test_rebinding():
+    """
+    >>> test_rebinding()
+    [1, 2, 'three']
+    """
+    global value
+    result = [get_value()]
+    value = 2
+    result.append(get_value())
+    globals()['value'] = 'three'
+    result.append(get_value())
+    value = 1
+    return result
+
+
+def test_shadowing_builtins():
+    """
+    >>> test_shadowing_builtins()
+    [True, False, True]
+    """
+    global len
+    result = [get_len() is builtins.len]
+    len = lambda x: 0
+    result.append(get_len() is builtins.len)
+    del len
+    result.append(get_len() is builtins.len)
+    return result
+
+
+def test_modifying_builtins():
+    """
+    >>> test_modifying_builtins()
+    ['undefined', 'builtin', 'undefined']
+    """
+    result = []
+    for i in range(3):
+        if i == 1:
+            builtins.undefined_name = 'builtin'
+        elif i == 2:
+            del builtins.undefined_name
+        try:
+            result.append(get_undefined())
+        except NameError:
+            result.append('undefined')
+    return result
+
+
+def test_loop():
+    """
+    >>> test_loop()
+    [1, 1, 5, 5]
+    """
+    global value
+    result = []
+    for i in range(4):
+        if i == 2:
+            value = 5
+        result.append(get_value())
+    value = 1
+    return result
@@ -0,0 +1,356 @@
+# mode: run
+# tag: parallel
+# cython: parallel_backend=threadpool
+# distutils: define_macros=CYTHON_THREADPOOL_NUM_THREADS=4
+
+cimport cython
+from cython.parallel cimport prange, threadid
+
+from array import array
+
+
+def sum_range(long n):
+    """
+    >>> sum_range(0)
+    0
+    >>> sum_range(1)
+    0
+    >>> sum_range(10000)
+    49995000
+    """
+    cdef long i, total = 0
+    for i in prange(n, nogil=True):
+        total += i
+    return total
+
+
+def schedules(long n, long chunksize):
+    """
+    >>> schedules(1000, 0)
+    [499500, 499500, 499500, 499500, 499500]
+    >>> schedules(1000, 7)
+    [499500, 499500, 499500, 499500, 499500]
+    >>> schedules(3, 100)
+    [3, 3, 3, 3, 3]
+    """
+    cdef long i, a = 0, b = 0, c = 0, d = 0, e = 0
+    if chunksize:
+        for i in prange(n, nogil=True, schedule='static', chunksize=chunksize):
+            a += i
+        for i in prange(n, nogil=True, schedule='dynamic', chunksize=chunksize):
+            b += i
+        for i in prange(n, nogil=True, schedule='guided', chunksize=chunksize):
+            c += i
+    else:
+        for i in prange(n, nogil=True, schedule='static'):
+            a += i
+        for i in prange(n, nogil=True, schedule='dynamic'):
+            b += i
+        for i in prange(n, nogil=True, schedule='guided'):
+            c += i
+    for i in prange(n, nogil=True, schedule='runtime'):
+        d += i
+    for i in prange(n, nogil=True):
+        e += i
+    return [a, b, c, d, e]
+
+
+def start_stop_step(long start, long stop, long step):
+    """
+    >>> start_stop_step(5, 105, 3)
+    (1853, 104, 104)
+    >>> start_stop_step(100, 0, -7)
+    (765, 2, 2)
+    >>> start_stop_step(3, 3, 1)
+    (0, -1, -1)
+    """
+    cdef long i = -1, last = -1, total = 0
+    for i in prange(start, stop, step, nogil=True):
+        total += i
+        last = i
+    return total, i, last
+
+
+def operators(int n):
+    """
+    >>> operators(20)
+    (190, -190, 2432902008176640000, 31, 0, 60, 20)
+    """
+    cdef int i
+    cdef long plus = 0, minus = 0, bit_or = 0, bit_and = -1, bit_xor = 0
+    cdef long long prod = 1
+    for i in prange(n, nogil=True):
+        plus += i
+        minus -= i
+        prod *= i + 1
+        bit_or |= i
+        bit_and &= i
+        bit_xor ^= i * 3
+    return plus, minus, prod, bit_or, bit_and, bit_xor, i + 1
+
+
+def minmax(values):
+    """
+    >>> minmax([3.5, -2.0, 7.25, 1.0] * 100)
+    (-2.0, 7.25)
+    >>> minmax([])
+    (inf, -inf)
+    """
+    cdef double[:] data = array('d', values)
+    cdef Py_ssize_t i
+    cdef double lo = float('inf'), hi = -float('inf')
+    for i in prange(data.shape[0], nogil=True):
+        lo = min(lo, data[i])
+        hi = max(hi, data[i])
+    return lo, hi
+
+
+def argmin(values):
+    """
+    >>> argmin([3.5, -2.0, 7.25, -2.0] * 100)
+    (-2.0, 1)
+    >>> argmin([])
+    (inf, -1)
+    """
+    cdef double[:] data = array('d', values)
+    cdef Py_ssize_t i, n = data.shape[0], index = n
+    cdef double lo = float('inf')
+    for i in prange(n, nogil=True):
+        lo = min(lo, data[i])
+    for i in prange(n, nogil=True):
+        if data[i] == lo:
+            index = min(index, i)
+    return lo, (index if index < n else -1)
+
+
+def histogram(long n, int bins):
+    """
+    >>> histogram(1000, 4)
+    [250.0, 250.0, 250.0, 250.0]
+    >>> histogram(10, 3)
+    [4.0, 3.0, 3.0]
+    """
+    cdef double[:] counts = array('d', [0.0] * bins)
+    cdef long i
+    for i in prange(n, nogil=True, reduction=counts):
+        counts[i % bins] += 1
+    return list(counts)
+
+
+def thread_ids(long n, int num_threads):
+    """
+    >>> thread_ids(1000, 3)
+    True
+    >>> thread_ids(1000, 1)
+    True
+    """
+    cdef long i
+    cdef int[:] seen = array('i', [-1] * n)
+    for i in prange(n, nogil=True, num_threads=num_threads):
+        seen[i] = threadid()
+    return all(0 <= tid < num_threads for tid in seen)
+
+
+def unbalanced(long n, int repeat):
+    """
+    >>> unbalanced(1000, 50)
+    True
+    """
+    # The first iterations take much longer, so that the other threads steal them.
+    cdef long i, j
+    cdef int r
+    cdef int[:] runs = array('i', [0] * n)
+    cdef double[:] work = array('d', [0.0] * n)
+    for r in range(repeat):
+        for i in prange(n, nogil=True):
+            runs[i] += 1
+            if i < n // 8:
+                for j in range(1000):
+                    work[i] += j * 0.5
+    return all(count == repeat for count in runs)
+
+
+def use_threads_if(long n, bint condition):
+    """
+    >>> use_threads_if(1000, True)
+    True
+    >>> use_threads_if(1000, False)
+    True
+    """
+    cdef long i
+    cdef int[:] seen = array('i', [-1] * n)
+    for i in prange(n, nogil=True, num_threads=4, use_threads_if=condition):
+        seen[i] = threadid()
+    return condition or all(tid == 0 for tid in seen)
+
+
+def nested(int n):
+    """
+    >>> nested(30)
+    (4495, 29, 29)
+    """
+    cdef int i, j
+    cdef long total = 0
+    for i in prange(n, nogil=True):
+        for j in prange(i + 1):
+            total += j
+    return total, i, j
+
+
+def break_out(long n, long stop_at):
+    """
+    >>> break_out(1000, 500)
+    'break'
+    >>> break_out(10, 20)
+    'else'
+    """
+    cdef long i
+    cdef int how = 0
+    for i in prange(n, nogil=True):
+        if i == stop_at:
+            how = 1
+            break
+    else:
+        how = 2
+    return ['none', 'break', 'else'][how]
+
+
+cdef long find(long n, long value) noexcept nogil:
+    cdef long i
+    for i in prange(n):
+        if i == value:
+            return i
+    else:
+        return -1
+
+
+def return_value(long n, long value):
+    """
+    >>> return_value(1000, 700)
+    700
+    >>> return_value(10, 700)
+    -1
+    """
+    return find(n, value)
+
+
+cdef int check(long i) except -1 nogil:
+    if i == 250:
+        with gil:
+            raise ValueError(i)
+    return 0
+
+
+def propagate_exception(long n):
+    """
+    >>> propagate_exception(1000)
+    Traceback (most recent call last):
+    ValueError: 250
+    >>> propagate_exception(100)
+    """
+    cdef long i
+    for i in prange(n, nogil=True):
+        check(i)
+
+
+def with_gil(long n):
+    """
+    >>> sorted(with_gil(50)) == list(range(50))
+    True
+    """
+    cdef long i
+    result = []
+    for i in prange(n, nogil=True):
+        with gil:
+            result.append(i)
+    return result
+
+
+cdef long nogil_function(long n) noexcept nogil:
+    cdef long i, total = 0
+    for i in prange(n):
+        total += i * i
+    return total
+
+
+def from_nogil_function(long n):
+    """
+    >>> from_nogil_function(100)
+    (328350, 328350)
+    """
+    cdef long without_gil
+    with nogil:
+        without_gil = nogil_function(n)
+    return without_gil, nogil_function(n)
+
+
+def closure(long n):
+    """
+    >>> closure(100)
+    (4950, 5050)
+    """
+    cdef long i, total = 0
+
+    def inner():
+        return total + n
+
+    for i in prange(n, nogil=True):
+        total += i
+    return total, inner()
+
+
+def lastprivate(long n):
+    """
+    >>> lastprivate(1000)
+    (999, 1998, 998001)
+    """
+    cdef long i, twice = 0, square = 0
+    for i in prange(n, nogil=True, schedule='dynamic', chunksize=3):
+        twice = 2 * i
+        square = i * i
+    return i, twice, square
+
+
+def buffers(double[:, :] m):
+    """
+    >>> m = array('d', range(12))
+    >>> buffers(memoryview(m).cast('B').cast('d', [3, 4]))
+    [6.0, 22.0, 38.0]
+    """
+    cdef Py_ssize_t i, j
+    cdef double[:] out = array('d', [0.0] * m.shape[0])
+    for i in prange(m.shape[0], nogil=True, schedule='static', chunksize=1):
+        for j in range(m.shape[1]):
+            out[i] += m[i, j]
+    return list(out)
+
+
+def collapsed(double[:, :, :] m):
+    """
+    >>> m = array('d', range(24))
+    >>> collapsed(memoryview(m).cast('B').cast('d', [2, 3, 4]))
+    (276.0, 1, 2, 3)
+    """
+    cdef Py_ssize_t i, j, k
+    cdef double total = 0
+    for i, j, k in prange(m.shape[0], m.shape[1], m.shape[2], nogil=True):
+        total += m[i, j, k]
+    return total, i, j, k
+
+
+def after_fork(long n):
+    """
+    >>> after_fork(10000)
+    (49995000, True)
+    """
+    import os
+    import sys
+    total = sum_range(n)  # start the workers of the pool
+    if not hasattr(os, 'fork') or sys.platform == 'emscripten':
+        return total, True
+    pid = os.fork()
+    if pid == 0:
+        # the workers of the parent do not exist in the child
+        os._exit(0 if sum_range(n) == total and schedules(n, 7)[1] == total else 1)
+    _, status = os.waitpid(pid, 0)
+    return total, os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
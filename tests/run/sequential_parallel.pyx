@@ -849,3 +849,116 @@ def test_prange_call_exception_checked_function():
             assert buf[i] == i
     finally:
         free(buf)
+
+def test_min_max_reduction(values):
+    """
+    >>> test_min_max_reduction([3.5, -2.0, 7.25, 1.0, -1.5])
+    (-2.0, 7.25, -2)
+    >>> test_min_max_reduction([])
+    (100.0, -100.0, 100)
+    """
+    cdef double[:] data = array(shape=(max(len(values), 1),), itemsize=sizeof(double), format="d")
+    cdef Py_ssize_t i, n = len(values)
+    cdef double smallest = 100, largest = -100
+    cdef int smallest_int = 100
+    for i in range(n):
+        data[i] = values[i]
+
+    for i in prange(n, nogil=True, num_threads=3):
+        smallest = min(smallest, data[i])
+        largest = max(data[i], largest)
+        smallest_int = min(<int> data[i], smallest_int)
+
+    return smallest, largest, smallest_int
+
+def test_memoryview_reduction(int nbins):
+    """
+    >>> test_memoryview_reduction(4)
+    ([25, 25, 25, 25], [3.0, 1.0, 3.0, 1.0])
+    """
+    cdef long[:] counts = array(shape=(nbins,), itemsize=sizeof(long), format="l")
+    cdef double[:, :] sums = array(shape=(2, nbins), itemsize=sizeof(double), format="d")
+    cdef double[:] row = sums[1]
+    cdef Py_ssize_t i
+    counts[:] = 0
+    sums[:, :] = 1.0
+
+    for i in prange(100, nogil=True, reduction=(counts, row), schedule='dynamic'):
+        counts[i % nbins] += 1
+        row[i % 2 * 2] += 0.04
+        row[i % 2 * 2 + 1] -= 0.0
+
+    return list(counts), [round(x, 9) for x in row]
+
+def test_memoryview_reduction_strided():
+    """
+    >>> test_memoryview_reduction_strided()
+    [[10, 0, 20], [0, 0, 0], [30, 0, 40]]
+    """
+    cdef int[:, :] data = array(shape=(3, 3), itemsize=sizeof(int), format="i", mode="fortran")
+    cdef int[:, :] corners = data[::2, ::2]
+    cdef int i
+    data[:, :] = 0
+    corners[0, 0] = 9
+
+    for i in prange(10, nogil=True, reduction=corners):
+        corners[0, 0] += 1
+        corners[0, 1] += 2
+        corners[1, 0] += 3
+        corners[1, 1] += 4
+    corners[0, 0] -= 9
+
+    return [list(data[j, :]) for j in range(3)]
+
+def test_collapsed(int n, int m):
+    """
+    >>> test_collapsed(3, 4)
+    (66, 12, 2, 3)
+    >>> test_collapsed(0, 4)
+    (0, 0, -1, -1)
+    >>> test_collapsed(4, -2)
+    (0, 0, -1, -1)
+    """
+    cdef int i = -1, j = -1
+    cdef long total = 0, count = 0
+
+    for i, j in prange(n, m, nogil=True):
+        total += i * m + j
+        count += 1
+
+    return total, count, i, j
+
+def test_collapsed_large_product(short n, short m):
+    """
+    >>> test_collapsed_large_product(300, 300)
+    (90000, 299, 299)
+    """
+    cdef short i = -1, j = -1
+    cdef long count = 0
+
+    for i, j in prange(n, m, nogil=True):
+        count += 1
+
+    return count, i, j
+
+def test_collapsed_stencil():
+    """
+    >>> for row in test_collapsed_stencil(): print(row)
+    [0.0, 0.0, 0.0, 0.0, 0.0]
+    [0.0, 6.0, 7.0, 8.0, 0.0]
+    [0.0, 11.0, 12.0, 13.0, 0.0]
+    [0.0, 0.0, 0.0, 0.0, 0.0]
+    """
+    cdef double[:, :] src = array(shape=(4, 5), itemsize=sizeof(double), format="d")
+    cdef double[:, :] dst = array(shape=(4, 5), itemsize=sizeof(double), format="d")
+    cdef Py_ssize_t i, j
+    for i in range(src.shape[0]):
+        for j in range(src.shape[1]):
+            src[i, j] = i * src.shape[1] + j
+    dst[:, :] = 0
+
+    for i, j in prange(dst.shape[0] - 2, dst.shape[1] - 2, nogil=True, schedule='static'):
+        dst[i + 1, j + 1] = (src[i, j + 1] + src[i + 2, j + 1] +
+                             src[i + 1, j] + src[i + 1, j + 2]) / 4
+
+    return [list(dst[i, :]) for i in range(dst.shape[0])]